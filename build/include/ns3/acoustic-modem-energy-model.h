@@ -0,0 +1 @@
+#include "/root/repo/src/uan/model/acoustic-modem-energy-model.h"
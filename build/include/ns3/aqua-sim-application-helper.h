@@ -0,0 +1 @@
+#include "/root/repo/src/aqua-sim-ng/helper/aqua-sim-application-helper.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/aqua-sim-ng/model/aqua-sim-attack-model.h"
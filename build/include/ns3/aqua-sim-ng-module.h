@@ -0,0 +1,95 @@
+#ifdef NS3_MODULE_COMPILATION 
+    error "Do not include ns3 module aggregator headers from other modules these are meant only for end user scripts." 
+#endif 
+#ifndef NS3_MODULE_AQUA_SIM_NG
+    // Module headers: 
+    #include <ns3/aqua-sim-application.h>
+    #include <ns3/aqua-sim-address.h>
+    #include <ns3/aqua-sim-pt-tag.h>
+    #include <ns3/aqua-sim-channel.h>
+    #include <ns3/aqua-sim-energy-model.h>
+    #include <ns3/aqua-sim-hash-table.h>
+    #include <ns3/aqua-sim-header.h>
+    #include <ns3/aqua-sim-header-goal.h>
+    #include <ns3/aqua-sim-header-mac.h>
+    #include <ns3/aqua-sim-mac.h>
+    #include <ns3/aqua-sim-mobility-pattern.h>
+    #include <ns3/aqua-sim-modulation.h>
+    #include <ns3/aqua-sim-net-device.h>
+    #include <ns3/aqua-sim-node.h>
+    #include <ns3/aqua-sim-noise-generator.h>
+    #include <ns3/aqua-sim-phy.h>
+    #include <ns3/aqua-sim-phy-cmn.h>
+    #include <ns3/aqua-sim-propagation.h>
+    #include <ns3/aqua-sim-range-propagation.h>
+    #include <ns3/aqua-sim-simple-propagation.h>
+    #include <ns3/aqua-sim-routing.h>
+    #include <ns3/aqua-sim-signal-cache.h>
+    #include <ns3/aqua-sim-sinr-checker.h>
+    #include <ns3/aqua-sim-helper.h>
+    #include <ns3/aqua-sim-mac-broadcast.h>
+    #include <ns3/aqua-sim-mac-fama.h>
+    #include <ns3/aqua-sim-mac-aloha.h>
+    #include <ns3/aqua-sim-mac-copemac.h>
+    #include <ns3/aqua-sim-mac-goal.h>
+    #include <ns3/aqua-sim-mac-sfama.h>
+    #include <ns3/aqua-sim-mac-libra.h>
+    #include <ns3/aqua-sim-mac-trumac.h>
+    #include <ns3/aqua-sim-mac-jmac.h>
+    #include <ns3/aqua-sim-mac-tdma.h>
+    #include <ns3/aqua-sim-mac-uwan.h>
+    #include <ns3/aqua-sim-rmac.h>
+    #include <ns3/aqua-sim-rmac-buffer.h>
+    #include <ns3/aqua-sim-tmac.h>
+    #include <ns3/aqua-sim-routing-static.h>
+    #include <ns3/aqua-sim-header-routing.h>
+    #include <ns3/aqua-sim-routing-dynamic.h>
+    #include <ns3/aqua-sim-routing-flooding.h>
+    #include <ns3/aqua-sim-datastructure.h>
+    #include <ns3/aqua-sim-routing-buffer.h>
+    #include <ns3/aqua-sim-routing-vbf.h>
+    #include <ns3/aqua-sim-routing-dbr.h>
+    #include <ns3/aqua-sim-routing-vbva.h>
+    #include <ns3/aqua-sim-mobility-kinematic.h>
+    #include <ns3/aqua-sim-mobility-rwp.h>
+    #include <ns3/aqua-sim-synchronization.h>
+    #include <ns3/aqua-sim-localization.h>
+    #include <ns3/aqua-sim-routing-ddos.h>
+    #include <ns3/aqua-sim-attack-model.h>
+    #include <ns3/aqua-sim-trace-reader.h>
+    #include <ns3/aqua-sim-time-tag.h>
+    #include <ns3/named-data.h>
+    #include <ns3/named-data-header.h>
+    #include <ns3/name-discovery.h>
+    #include <ns3/pit.h>
+    #include <ns3/fib.h>
+    #include <ns3/content-storage.h>
+    #include <ns3/cs-fifo.h>
+    #include <ns3/cs-lru.h>
+    #include <ns3/cs-random.h>
+    #include <ns3/onoff-nd-application.h>
+    #include <ns3/named-data-helper.h>
+    #include <ns3/on-off-nd-helper.h>
+    #include <ns3/aqua-sim-application-helper.h>
+    #include <ns3/aqua-sim-traffic-gen-helper.h>
+    #include <ns3/aqua-sim-dataset-writer.h>
+    #include <ns3/aqua-sim-traffic-gen.h>
+    #include <ns3/aqua-sim-routing-dummy.h>
+    #include <ns3/aqua-sim-routing-ddbr.h>
+    #include <ns3/aqua-sim-spatial-index.h>
+    #include <ns3/aqua-sim-rx-info-tag.h>
+    #include <ns3/aqua-sim-link-cache.h>
+    #include <ns3/aqua-sim-position-snapshot.h>
+    #include <ns3/aqua-sim-pkt-window.h>
+    #include <ns3/aqua-sim-trumac-schedule.h>
+    #include <ns3/aqua-sim-addr-pair-table.h>
+    #include <ns3/name-table.h>
+    #include <ns3/aqua-sim-ddos-model.h>
+    #include <ns3/aqua-sim-ids-model.h>
+    #include <ns3/aqua-sim-ids-detector.h>
+    #include <ns3/aqua-sim-multilateration.h>
+    #include <ns3/aqua-sim-ladder-scheduler.h>
+    #include <ns3/aqua-sim-recording-scheduler.h>
+    #include <ns3/aqua-sim-adaptive-scheduler.h>
+    #include <ns3/svm.h>
+#endif 
\ No newline at end of file
@@ -0,0 +1 @@
+#include "/root/repo/src/core/model/attribute-accessor-helper.h"
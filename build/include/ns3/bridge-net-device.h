@@ -0,0 +1 @@
+#include "/root/repo/src/bridge/model/bridge-net-device.h"
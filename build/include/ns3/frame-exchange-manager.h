@@ -0,0 +1 @@
+#include "/root/repo/src/wifi/model/frame-exchange-manager.h"
@@ -0,0 +1 @@
+#include "/root/repo/src/aqua-sim-ng/helper/named-data-helper.h"
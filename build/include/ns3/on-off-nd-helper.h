@@ -0,0 +1 @@
+#include "/root/repo/src/aqua-sim-ng/helper/on-off-nd-helper.h"
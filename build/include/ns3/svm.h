@@ -0,0 +1 @@
+#include "/root/repo/src/aqua-sim-ng/model/lib/svm.h"
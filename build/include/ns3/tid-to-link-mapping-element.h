@@ -0,0 +1 @@
+#include "/root/repo/src/wifi/model/eht/tid-to-link-mapping-element.h"
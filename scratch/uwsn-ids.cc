@@ -8,17 +8,24 @@
 #include "ns3/aqua-sim-header-mac.h"
 #include "ns3/aqua-sim-address.h"
 #include "ns3/aqua-sim-application.h"
+#include "ns3/aqua-sim-dataset-writer.h"
+#include "ns3/aqua-sim-ids-detector.h"
 
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("UwsnDataGenerationFixed");
 
-std::ofstream g_csvFile;
+Ptr<AquaSimDatasetWriter> g_dataset;
 
 class SensorDataTag : public Tag
 {
@@ -140,12 +147,45 @@ PhyRxEndTrace(Ptr<const Packet> packet, double rssi, Vector senderPos, Time prop
 
     Time recvTime = Simulator::Now();
 
-    g_csvFile << recvTime.GetSeconds() << "," << nodeId << "," << sendTime.GetSeconds() << ","
-              << propDelay.GetSeconds() << "," << rssi << "," << senderPos.x << "," << senderPos.y
-              << "," << senderPos.z << "," << reportedPos.x << "," << reportedPos.y << ","
-              << reportedPos.z << "," << isAnomaly << "\n";
+    g_dataset->Set(0, recvTime.GetSeconds());
+    g_dataset->Set(1, nodeId);
+    g_dataset->Set(2, sendTime.GetSeconds());
+    g_dataset->Set(3, propDelay.GetSeconds());
+    g_dataset->Set(4, rssi);
+    g_dataset->Set(5, senderPos.x);
+    g_dataset->Set(6, senderPos.y);
+    g_dataset->Set(7, senderPos.z);
+    g_dataset->Set(8, reportedPos.x);
+    g_dataset->Set(9, reportedPos.y);
+    g_dataset->Set(10, reportedPos.z);
+    g_dataset->Set(11, isAnomaly);
+    g_dataset->Commit();
+}
 
-    g_csvFile.flush();
+/// Output of one forked branch: the scenario name in front of the file name.
+std::string
+BranchFileName(const std::string& file, int runType)
+{
+    static const char* names[] = {"normal", "jump", "drift"};
+    std::string name = (runType >= 0 && runType < 3) ? names[runType] : std::to_string(runType);
+    size_t slash = file.find_last_of('/');
+    size_t base = (slash == std::string::npos) ? 0 : slash + 1;
+    return file.substr(0, base) + name + "_" + file.substr(base);
+}
+
+bool
+IdsReport(Ptr<const Packet> packet, AquaSimIdsReception& rx)
+{
+    SensorDataTag tag;
+    if (!packet->PeekPacketTag(tag))
+    {
+        return false;
+    }
+    rx.nodeId = tag.GetNodeId();
+    rx.sendTime = tag.GetSendTime();
+    rx.reportedPos = tag.GetReportedPos();
+    rx.label = tag.GetIsAnomaly();
+    return true;
 }
 
 void
@@ -195,6 +235,12 @@ class SensorApp : public Application
         m_sendInterval = interval;
     }
 
+    int64_t AssignStreams(int64_t stream)
+    {
+        m_rand->SetStream(stream);
+        return 1;
+    }
+
     void SetAttacker(int attackType, Time startTime)
     {
         m_isAttacker = true;
@@ -212,6 +258,7 @@ class SensorApp : public Application
         {
             TypeId tid = TypeId::LookupByName("ns3::PacketSocketFactory");
             m_socket = Socket::CreateSocket(GetNode(), tid);
+            m_socket->Bind(); // a packet socket only connects once bound
             m_socket->Connect(m_peerAddress); // Sẽ kết nối đến địa chỉ ĐÍCH
         }
         Time firstSend = Seconds(m_sendInterval.GetSeconds() * m_rand->GetValue(0.0, 1.0));
@@ -288,26 +335,76 @@ main(int argc, char* argv[])
 {
     int runType = 0;
     uint32_t seed = 1;
+    int run = -1;
     std::string csvFileName = "uwsn_data_default.csv";
     double simTime = 2000.0;
     uint32_t numSensorNodes = 30;
+    std::string format = "csv";
+    uint32_t bufferRows = 4096;
+    std::string ids = "none";
+    uint32_t idsBatch = 32;
+    std::string branches;
+    double branchTime = 500.0;
+    const Time attackStart = Seconds(500.0);
 
     LogComponentEnable("UwsnDataGenerationFixed", LOG_LEVEL_INFO);
 
     CommandLine cmd;
     cmd.AddValue("runType", "Loại kịch bản (0: Bth, 1: Jump, 2: Drift)", runType);
     cmd.AddValue("seed", "Giá trị seed cho RNG", seed);
+    cmd.AddValue("run", "RNG run stream (default: runType)", run);
     cmd.AddValue("csvFile", "Tên file CSV output", csvFileName);
     cmd.AddValue("simTime", "Thời gian mô phỏng (s)", simTime);
     cmd.AddValue("numNodes", "Số lượng nút cảm biến", numSensorNodes);
+    cmd.AddValue("format", "Output format: csv or bin (row-group binary)", format);
+    cmd.AddValue("bufferRows", "Rows buffered in memory between writes", bufferRows);
+    cmd.AddValue("ids", "Online detector at the sink: none, threshold, logistic or svm", ids);
+    cmd.AddValue("idsBatch", "Receptions scored per detector batch", idsBatch);
+    cmd.AddValue("branches",
+                 "Comma separated runTypes: simulate the warm-up once, then fork one child "
+                 "per runType at branchTime (output <runType name>_<csvFile>, RNG run "
+                 "run + 1 + runType)",
+                 branches);
+    cmd.AddValue("branchTime", "Fork time (s) for --branches, at most the attack start", branchTime);
     cmd.Parse(argc, argv);
 
-    RngSeedManager::SetSeed(seed);
-    RngSeedManager::SetRun(runType);
+    std::vector<int> branchTypes;
+    std::istringstream branchList(branches);
+    std::string token;
+    while (std::getline(branchList, token, ','))
+    {
+        branchTypes.push_back(std::stoi(token));
+    }
+    if (!branchTypes.empty())
+    {
+        NS_ABORT_MSG_UNLESS(branchTime > 1.0 && Seconds(branchTime) <= attackStart &&
+                                branchTime < simTime,
+                            "branchTime must lie between the app start and the attack start");
+        runType = 0; // the warm-up is attack free; children set their attackers
+    }
+    std::string datasetFile = branchTypes.empty() ? csvFileName : csvFileName + ".prefix";
 
-    g_csvFile.open(csvFileName);
-    g_csvFile << "RecvTime,NodeID,SendTime,PropDelay,RSSI,Real_X,Real_Y,Real_Z,Reported_X,"
-                 "Reported_Y,Reported_Z,Is_Anomaly\n";
+    RngSeedManager::SetSeed(seed);
+    RngSeedManager::SetRun(run >= 0 ? run : runType);
+
+    g_dataset = CreateObjectWithAttributes<AquaSimDatasetWriter>(
+        "Format",
+        EnumValue(format == "bin" ? AquaSimDatasetWriter::BINARY : AquaSimDatasetWriter::CSV),
+        "BufferRows",
+        UintegerValue(bufferRows));
+    g_dataset->AddColumn("RecvTime");
+    g_dataset->AddColumn("NodeID", AquaSimDatasetWriter::INT64);
+    g_dataset->AddColumn("SendTime");
+    g_dataset->AddColumn("PropDelay");
+    g_dataset->AddColumn("RSSI");
+    g_dataset->AddColumn("Real_X");
+    g_dataset->AddColumn("Real_Y");
+    g_dataset->AddColumn("Real_Z");
+    g_dataset->AddColumn("Reported_X");
+    g_dataset->AddColumn("Reported_Y");
+    g_dataset->AddColumn("Reported_Z");
+    g_dataset->AddColumn("Is_Anomaly", AquaSimDatasetWriter::INT64);
+    g_dataset->Open(datasetFile);
     NS_LOG_INFO("Bắt đầu mô phỏng Kịch bản " << runType << ". Output: " << csvFileName);
 
     NodeContainer sinkNode;
@@ -353,7 +450,9 @@ main(int argc, char* argv[])
     channel.SetPropagation("ns3::AquaSimRangePropagation");
 
     AquaSimHelper asHelper = AquaSimHelper::Default();
-    asHelper.SetChannel(channel.Create());
+    Ptr<AquaSimChannel> aquaChannel = channel.Create();
+    aquaChannel->SetAttribute("PositionSnapshot", BooleanValue(true));
+    asHelper.SetChannel(aquaChannel);
 
     asHelper.SetPhy("ns3::AquaSimPhyCmn", "PT", DoubleValue(20.0));
     asHelper.SetMac("ns3::AquaSimAloha",
@@ -397,6 +496,7 @@ main(int argc, char* argv[])
     sinkDestAddress.SetProtocol(0);
 
     Time sendInterval = Seconds(30.0);
+    std::vector<Ptr<SensorApp>> apps;
     for (uint32_t i = 0; i < sensorNodes.GetN(); ++i)
     {
         Ptr<SensorApp> app = CreateObject<SensorApp>();
@@ -404,24 +504,141 @@ main(int argc, char* argv[])
         app->SetPeer(sinkDestAddress);
         app->SetInterval(sendInterval);
 
+        sensorNodes.Get(i)->AddApplication(app);
         if (runType > 0 && i < 5)
         {
-            app->SetAttacker(runType, Seconds(500.0));
+            app->SetAttacker(runType, attackStart);
         }
+        apps.push_back(app);
 
-        sensorNodes.Get(i)->AddApplication(app);
         app->SetStartTime(Seconds(1.0));
         app->SetStopTime(Seconds(simTime));
     }
 
-    sinkDev->GetPhy()->TraceConnectWithoutContext("RxEnd", MakeCallback(&PhyRxEndTrace));
+    bool connected =
+        sinkDev->GetPhy()->TraceConnectWithoutContext("RxEnd", MakeCallback(&PhyRxEndTrace));
+    NS_ABORT_MSG_UNLESS(connected, "PHY of the sink has no RxEnd trace source");
+
+    Ptr<AquaSimIdsDetector> detector;
+    if (ids != "none")
+    {
+        Ptr<AquaSimIdsModel> model;
+        if (ids == "threshold")
+        {
+            model = CreateObject<AquaSimIdsThresholdModel>();
+        }
+        else if (ids == "logistic")
+        {
+            model = CreateObject<AquaSimIdsLogisticModel>();
+        }
+        else if (ids == "svm")
+        {
+            model = CreateObject<AquaSimIdsSvmModel>();
+        }
+        NS_ABORT_MSG_UNLESS(model, "unknown detector model " << ids);
+        detector = CreateObjectWithAttributes<AquaSimIdsDetector>("Model",
+                                                                  PointerValue(model),
+                                                                  "BatchSize",
+                                                                  UintegerValue(idsBatch));
+        detector->SetReportCallback(MakeCallback(&IdsReport));
+        detector->Attach(sinkDev);
+    }
 
     NS_LOG_INFO("Start simulating...");
     Simulator::Stop(Seconds(simTime + 2.0));
+    auto wallStart = std::chrono::steady_clock::now();
+
+    if (!branchTypes.empty())
+    {
+        // common warm-up, then one copy-on-write child per scenario
+        Simulator::Stop(Seconds(branchTime));
+        Simulator::Run();
+        double prefixWall =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        g_dataset->Flush();
+        std::cout.flush();
+
+        int branchType = -1;
+        std::vector<pid_t> children;
+        for (int type : branchTypes)
+        {
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork failed");
+            if (pid == 0)
+            {
+                branchType = type;
+                break;
+            }
+            children.push_back(pid);
+        }
+
+        if (branchType < 0)
+        {
+            uint32_t failed = 0;
+            for (pid_t pid : children)
+            {
+                int status;
+                waitpid(pid, &status, 0);
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                {
+                    failed++;
+                }
+            }
+            Simulator::Destroy();
+            g_dataset = nullptr;
+            std::remove(datasetFile.c_str());
+            std::cout << "BRANCH time=" << branchTime << " prefix_wall=" << prefixWall
+                      << " children=" << children.size() << " failed=" << failed << std::endl;
+            return failed ? 1 : 0;
+        }
+
+        // own substream for everything drawn from here on
+        runType = branchType;
+        RngSeedManager::SetRun((run >= 0 ? run : 0) + 1 + runType);
+        int64_t stream = mobility.AssignStreams(sensorNodes, 0);
+        NetDeviceContainer allDevices(sinkDevice, sensorDevices);
+        stream += asHelper.AssignStreams(allDevices, stream); // devices and the channel
+        for (Ptr<SensorApp> app : apps)
+        {
+            stream += app->AssignStreams(stream);
+        }
+        for (uint32_t i = 0; runType > 0 && i < apps.size() && i < 5; ++i)
+        {
+            apps[i]->SetAttacker(runType, attackStart);
+        }
+        csvFileName = BranchFileName(csvFileName, runType);
+        g_dataset->Branch(csvFileName);
+        wallStart = std::chrono::steady_clock::now();
+    }
+
     Simulator::Run();
+    uint64_t events = Simulator::GetEventCount();
+    if (detector)
+    {
+        detector->Flush();
+        uint32_t detected;
+        Time latency = detector->GetMeanDetectionLatency(detected);
+        std::cout << "IDS model=" << ids << " rx=" << detector->GetNReceptions()
+                  << " alerts=" << detector->GetNAlerts() << " tp=" << detector->GetTruePositives()
+                  << " fp=" << detector->GetFalsePositives()
+                  << " fn=" << detector->GetFalseNegatives() << " detected=" << detected
+                  << " latency=" << latency.GetSeconds() << std::endl;
+        detector->Dispose();
+    }
     Simulator::Destroy();
+    double wall =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // one machine-readable line for sweep drivers (scripts/uwsn_ids_sweep.py)
+    std::cout << "SHARD ";
+    if (!branchTypes.empty())
+    {
+        std::cout << "runType=" << runType << " ";
+    }
+    std::cout << "events=" << events << " rows=" << g_dataset->GetRowCount()
+              << " wall=" << wall << std::endl;
 
-    g_csvFile.close();
+    g_dataset = nullptr; // closed and flushed by Simulator::Destroy
     NS_LOG_INFO("Finish simulating, log saved into" << csvFileName);
 
     return 0;
@@ -0,0 +1,2120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/aqua-sim-ng-module.h"
+#include "ns3/aqua-sim-address.h"
+#include "ns3/aqua-sim-header-routing.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-ids-detector.h"
+#include "ns3/aqua-sim-mac-libra.h"
+#include "ns3/aqua-sim-multilateration.h"
+#include "ns3/aqua-sim-phy-cmn.h"
+#include "ns3/aqua-sim-range-propagation.h"
+#include "ns3/aqua-sim-routing-dbr.h"
+#include "ns3/aqua-sim-routing-vbf.h"
+#include "ns3/aqua-sim-routing-vbva.h"
+#include "ns3/aqua-sim-trumac-schedule.h"
+#include "ns3/cs-lru.h"
+#include "ns3/fib.h"
+#include "ns3/name-table.h"
+#include "ns3/pit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * aqua-sim-ng benchmark driver.
+ *
+ * Every benchmark of the module behind one program: --bench names it and
+ * all other options are the benchmark's own, listed by
+ * "--bench=<name> --PrintHelp". Without --bench the benchmarks are listed.
+ *
+ *   ./ns3 run "AquaSimBench --bench=fanout --copies=500000"
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimBench");
+
+/*
+ * Receiver lookup benchmark: full device-list scan vs AquaSimSpatialIndex.
+ *
+ * Nodes are spread uniformly with a fixed mean spacing, so the number of
+ * receivers within range stays constant while the network grows. For each
+ * node count the same set of senders is resolved both ways and the wall
+ * time per transmission is reported.
+ *
+ *   ./ns3 run "AquaSimBench --bench=spatial-index --minNodes=30 --maxNodes=10000"
+ */
+namespace spatial_index_bench {
+
+static double
+RunScan (Ptr<AquaSimRangePropagation> prop, Ptr<AquaSimSpatialIndex> index,
+         std::vector<Ptr<AquaSimNetDevice> > &devices, uint32_t txs, double range,
+         uint64_t &recvers)
+{
+  std::vector<Ptr<AquaSimNetDevice> > candidates;
+  std::vector<PktRecvUnit> res;
+  AquaSimPacketStamp pstamp;
+  pstamp.SetTxRange (range);
+  pstamp.SetPt (20);
+  pstamp.SetFreq (25);
+  Ptr<Packet> p = Create<Packet> (32);
+  p->AddHeader (pstamp);
+
+  recvers = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < txs; i++)
+    {
+      Ptr<AquaSimNetDevice> sender = devices[(i * 7919) % devices.size ()];
+      if (index)
+        {
+          index->GetCandidates (sender->GetNode ()->GetObject<MobilityModel> ()->GetPosition (),
+                                range, devices, candidates);
+          prop->ReceivedCopies (sender, p, candidates, res);
+        }
+      else
+        prop->ReceivedCopies (sender, p, devices, res);
+      recvers += res.size ();
+    }
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t minNodes = 30;
+  uint32_t maxNodes = 10000;
+  uint32_t txs = 2000;
+  double range = 1500;
+  double spacing = 500;
+
+  CommandLine cmd;
+  cmd.AddValue ("minNodes", "Smallest node count of the sweep", minNodes);
+  cmd.AddValue ("maxNodes", "Largest node count of the sweep", maxNodes);
+  cmd.AddValue ("txs", "Transmissions resolved per node count", txs);
+  cmd.AddValue ("range", "TxRange of every transmission (m)", range);
+  cmd.AddValue ("spacing", "Mean horizontal distance between nodes (m)", spacing);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (8) << "nodes" << std::setw (12) << "recv/tx"
+            << std::setw (14) << "scan(us/tx)" << std::setw (14) << "grid(us/tx)"
+            << std::setw (10) << "speedup" << "\n";
+
+  const uint32_t sweep[] = {30, 100, 300, 1000, 3000, 10000};
+  for (uint32_t n : sweep)
+    {
+      if (n < minNodes || n > maxNodes)
+        continue;
+      double side = spacing * std::sqrt ((double) n);
+      Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+      std::vector<Ptr<AquaSimNetDevice> > devices;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Ptr<Node> node = CreateObject<Node> ();
+          Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+          mob->SetPosition (Vector (rand->GetValue (0, side), rand->GetValue (0, side),
+                                    rand->GetValue (0, 1000)));
+          node->AggregateObject (mob);
+          Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+          dev->SetNode (node);
+          devices.push_back (dev);
+        }
+
+      Ptr<AquaSimRangePropagation> prop = CreateObject<AquaSimRangePropagation> ();
+      Ptr<AquaSimSpatialIndex> index = CreateObject<AquaSimSpatialIndex> ();
+      uint64_t scanRecv, gridRecv;
+      double scan = RunScan (prop, 0, devices, txs, range, scanRecv);
+      double grid = RunScan (prop, index, devices, txs, range, gridRecv);
+      NS_ABORT_MSG_UNLESS (scanRecv == gridRecv, "index and scan disagree");
+
+      std::cout << std::setw (8) << n
+                << std::setw (12) << std::fixed << std::setprecision (1) << (double) scanRecv / txs
+                << std::setw (14) << std::setprecision (2) << scan * 1e6 / txs
+                << std::setw (14) << grid * 1e6 / txs
+                << std::setw (10) << (grid > 0 ? scan / grid : 0) << "\n";
+
+      index->Dispose ();
+      devices.clear ();
+      Simulator::Destroy ();
+    }
+  return 0;
+}
+
+}  // namespace spatial_index_bench
+
+/*
+ * Channel fan-out benchmark.
+ *
+ * Hands packets straight to AquaSimChannel::Recv, as AquaSimPhyCmn does
+ * after stamping, and measures how many per-receiver copies the channel
+ * produces per wall-clock second. The default AquaSimSimplePropagation
+ * delivers to every other node. The simulator is never run; pending
+ * receptions are discarded between node counts.
+ *
+ *   ./ns3 run "AquaSimBench --bench=fanout --copies=500000"
+ */
+namespace fanout_bench {
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t copies = 300000;
+
+  CommandLine cmd;
+  cmd.AddValue ("copies", "Approximate receiver copies generated per node count", copies);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (8) << "nodes" << std::setw (8) << "txs"
+            << std::setw (12) << "copies" << std::setw (12) << "wall(s)"
+            << std::setw (14) << "copies/s" << "\n";
+
+  const uint32_t sweep[] = {100, 1000, 5000};
+  for (uint32_t n : sweep)
+    {
+      NodeContainer nodes;
+      nodes.Create (n);
+
+      MobilityHelper mobility;
+      mobility.SetPositionAllocator ("ns3::RandomBoxPositionAllocator",
+        "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=5000.0]"),
+        "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=5000.0]"),
+        "Z", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1000.0]"));
+      mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+      mobility.Install (nodes);
+
+      AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+      AquaSimHelper asHelper = AquaSimHelper::Default ();
+      asHelper.SetChannel (channel.Create ());
+
+      std::vector<Ptr<AquaSimNetDevice> > devices;
+      for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+        {
+          Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+          asHelper.Create (*i, dev);
+          devices.push_back (dev);
+        }
+      Ptr<AquaSimChannel> ch = asHelper.GetChannel ();
+
+      uint32_t txs = std::max<uint32_t> (10, copies / n);
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      for (uint32_t t = 0; t < txs; t++)
+        {
+          Ptr<AquaSimNetDevice> sender = devices[(t * 7919) % n];
+          Ptr<Packet> p = Create<Packet> (64);
+          AquaSimHeader ash;
+          ash.SetSize (64);
+          ash.SetDirection (AquaSimHeader::DOWN);
+          ash.SetTxTime (Seconds (0.1));
+          AquaSimPacketStamp pstamp;
+          pstamp.SetPt (sender->GetPhy ()->GetPt ());
+          pstamp.SetFreq (sender->GetPhy ()->GetFrequency ());
+          pstamp.SetTxRange (sender->GetPhy ()->GetTransRange ());
+          p->AddHeader (ash);
+          p->AddHeader (pstamp);
+          ch->Recv (p, sender->GetPhy ());
+        }
+      double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+      uint64_t fanned = (uint64_t) txs * (n - 1);
+
+      std::cout << std::setw (8) << n << std::setw (8) << txs
+                << std::setw (12) << fanned
+                << std::setw (12) << std::fixed << std::setprecision (3) << wall
+                << std::setw (14) << std::setprecision (0) << (wall > 0 ? fanned / wall : 0) << "\n";
+
+      devices.clear ();
+      Simulator::Destroy ();
+    }
+  return 0;
+}
+
+}  // namespace fanout_bench
+
+/*
+ * Microbenchmark of the scalar acoustic models against their batch forms.
+ *
+ * Each kernel is run over arrays of `batch` random receivers until at least
+ * `minTime` seconds have elapsed; the table follows Google Benchmark's
+ * layout (time per iteration, iterations, items per second).
+ *
+ *   ./ns3 run "AquaSimBench --bench=acoustic-batch --batch=256 --minTime=0.5"
+ */
+namespace acoustic_batch_bench {
+
+namespace {
+
+class ScalarPropagation : public AquaSimRangePropagation
+{
+public:
+  using AquaSimPropagation::Rayleigh;
+};
+
+volatile double g_sink;
+
+void
+Report (const std::string &name, uint32_t batch, double minTime, std::function<void (void)> body)
+{
+  uint64_t iters = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  double wall = 0;
+  while (wall < minTime)
+    {
+      for (int k = 0; k < 16; k++)
+        body ();
+      iters += 16;
+      wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    }
+  std::cout << std::left << std::setw (32) << (name + "/" + std::to_string (batch)) << std::right
+            << std::setw (12) << std::fixed << std::setprecision (0) << wall * 1e9 / iters << " ns"
+            << std::setw (12) << iters
+            << std::setw (14) << std::setprecision (2) << iters * batch / wall / 1e6 << "M items/s\n";
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t batch = 256;
+  double minTime = 0.5;
+
+  CommandLine cmd;
+  cmd.AddValue ("batch", "Receivers per transmission", batch);
+  cmd.AddValue ("minTime", "Minimum wall time per benchmark (s)", minTime);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  std::vector<double> dist (batch), depth (batch), out (batch);
+  for (uint32_t i = 0; i < batch; i++)
+    {
+      dist[i] = rand->GetValue (1, 5000);
+      depth[i] = rand->GetValue (0, 2000);
+    }
+  Ptr<ScalarPropagation> prop = CreateObject<ScalarPropagation> ();
+
+  std::cout << std::left << std::setw (32) << "Benchmark" << std::right
+            << std::setw (15) << "Time" << std::setw (12) << "Iterations"
+            << std::setw (23) << "Throughput" << "\n"
+            << std::string (82, '-') << "\n";
+
+  Report ("BM_Rayleigh/scalar", batch, minTime, [&] () {
+    double acc = 0;
+    for (uint32_t i = 0; i < batch; i++)
+      acc += prop->Rayleigh (dist[i], 25);
+    g_sink = acc;
+  });
+  Report ("BM_Rayleigh/batch", batch, minTime, [&] () {
+    prop->RayleighBatch (&dist[0], 25, &out[0], batch);
+    g_sink = out[batch - 1];
+  });
+  Report ("BM_AcousticSpeed/scalar", batch, minTime, [&] () {
+    double acc = 0;
+    for (uint32_t i = 0; i < batch; i++)
+      acc += prop->AcousticSpeed (depth[i]);
+    g_sink = acc;
+  });
+  Report ("BM_AcousticSpeed/batch", batch, minTime, [&] () {
+    prop->AcousticSpeedBatch (&depth[0], &out[0], batch);
+    g_sink = out[batch - 1];
+  });
+  return 0;
+}
+
+}  // namespace acoustic_batch_bench
+
+/*
+ * Idle energy accounting benchmark.
+ *
+ * Runs an idle network once with the periodic one-second settlement and
+ * once with lazy accounting (EnergyUpdateInterval=0), and reports executed
+ * events, wall time and the largest difference in remaining energy.
+ *
+ *   ./ns3 run "AquaSimBench --bench=energy --nodes=1000 --time=2000"
+ */
+namespace energy_bench {
+
+static uint64_t
+Run (uint32_t n, double simTime, Time interval, std::vector<double> &energy, double &wall)
+{
+  NodeContainer nodes;
+  nodes.Create (n);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomBoxPositionAllocator",
+    "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=5000.0]"),
+    "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=5000.0]"),
+    "Z", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1000.0]"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  asHelper.SetPhy ("ns3::AquaSimPhyCmn", "EnergyUpdateInterval", TimeValue (interval));
+
+  std::vector<Ptr<AquaSimNetDevice> > devices;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      asHelper.Create (*i, dev);
+      devices.push_back (dev);
+    }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+  wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  energy.clear ();
+  for (uint32_t i = 0; i < devices.size (); i++)
+    energy.push_back (devices[i]->EnergyModel ()->GetEnergy ());
+  uint64_t events = Simulator::GetEventCount ();
+  devices.clear ();
+  Simulator::Destroy ();
+  return events;
+}
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t n = 1000;
+  double simTime = 2000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", n);
+  cmd.AddValue ("time", "Simulated time (s)", simTime);
+  cmd.Parse (argc, argv);
+
+  std::vector<double> periodic, lazy;
+  double periodicWall, lazyWall;
+  uint64_t periodicEvents = Run (n, simTime, Seconds (1), periodic, periodicWall);
+  uint64_t lazyEvents = Run (n, simTime, Seconds (0), lazy, lazyWall);
+
+  double maxDiff = 0;
+  for (uint32_t i = 0; i < n; i++)
+    maxDiff = std::max (maxDiff, std::fabs (periodic[i] - lazy[i]));
+
+  std::cout << std::setw (10) << "mode" << std::setw (14) << "events" << std::setw (12) << "wall(s)" << "\n"
+            << std::setw (10) << "periodic" << std::setw (14) << periodicEvents
+            << std::setw (12) << std::fixed << std::setprecision (3) << periodicWall << "\n"
+            << std::setw (10) << "lazy" << std::setw (14) << lazyEvents
+            << std::setw (12) << lazyWall << "\n"
+            << "events saved: " << periodicEvents - lazyEvents
+            << std::setprecision (1) << " (" << 100.0 * (periodicEvents - lazyEvents) / periodicEvents << "%)"
+            << std::scientific << std::setprecision (2) << ", max energy difference " << maxDiff << " J\n";
+  return 0;
+}
+
+}  // namespace energy_bench
+
+/*
+ * Benchmark of the VBF and VBVA duplicate-suppression tables.
+ *
+ * Every source emits `packets` sequence numbers, interleaved across
+ * sources, each heard `copies` times with a lookup before the insert as on
+ * the forwarding path. A map table evicting the way the old tables did is
+ * run over the first `legacyPackets` numbers for comparison; its cost per
+ * packet grows with the sequence number.
+ *
+ *   ./ns3 run "AquaSimBench --bench=pkt-table --packets=1000000 --sources=4"
+ */
+namespace pkt_table_bench {
+
+namespace {
+
+volatile uint64_t g_sink;
+
+/* Old AquaSimPktHashTable storage and eviction, kept for reference. */
+class LegacyTable
+{
+public:
+  ~LegacyTable ()
+  {
+    for (std::map<hash_entry, vbf_neighborhood *>::iterator it = m_htable.begin ();
+         it != m_htable.end (); ++it)
+      delete it->second;
+  }
+  vbf_neighborhood *GetHash (AquaSimAddress s, unsigned int n)
+  {
+    std::map<hash_entry, vbf_neighborhood *>::iterator it = m_htable.find (std::make_pair (s, n));
+    return it == m_htable.end () ? 0 : it->second;
+  }
+  void PutInHash (AquaSimAddress s, unsigned int n, Vector p)
+  {
+    int k = n - WINDOW_SIZE;
+    for (int i = 0; i < k; i++)
+      {
+        std::map<hash_entry, vbf_neighborhood *>::iterator it = m_htable.find (std::make_pair (s, (unsigned int) i));
+        if (it != m_htable.end ())
+          {
+            delete it->second;
+            m_htable.erase (it);
+          }
+      }
+    vbf_neighborhood *h = GetHash (s, n);
+    if (h != 0)
+      {
+        if (h->number < MAX_NEIGHBOR)
+          h->neighbor[h->number++] = p;
+        return;
+      }
+    h = new vbf_neighborhood;
+    h->number = 1;
+    h->neighbor[0] = p;
+    m_htable[std::make_pair (s, n)] = h;
+  }
+
+private:
+  std::map<hash_entry, vbf_neighborhood *> m_htable;
+};
+
+template <typename Body>
+void
+Report (const std::string &name, uint64_t items, Body body)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  uint64_t hits = body ();
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  g_sink = hits;
+  std::cout << std::left << std::setw (32) << name << std::right
+            << std::setw (12) << std::fixed << std::setprecision (1) << wall * 1e9 / items << " ns"
+            << std::setw (14) << items
+            << std::setw (12) << std::setprecision (3) << wall << " s\n";
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t packets = 1000000;
+  uint32_t sources = 4;
+  uint32_t copies = 3;
+  uint32_t legacyPackets = 20000;
+
+  CommandLine cmd;
+  cmd.AddValue ("packets", "Sequence numbers per source", packets);
+  cmd.AddValue ("sources", "Number of sources", sources);
+  cmd.AddValue ("copies", "Times each packet is heard", copies);
+  cmd.AddValue ("legacyPackets", "Sequence numbers per source for the map baseline", legacyPackets);
+  cmd.Parse (argc, argv);
+
+  uint64_t items = (uint64_t) packets * sources * copies;
+  Vector pos (1, 2, 3);
+
+  std::cout << std::left << std::setw (32) << "Benchmark" << std::right
+            << std::setw (15) << "Time/op" << std::setw (14) << "Operations"
+            << std::setw (14) << "Wall" << "\n"
+            << std::string (75, '-') << "\n";
+
+  Report ("BM_VBF/window", items, [&] () {
+    AquaSimPktHashTable table;
+    uint64_t hits = 0;
+    for (uint32_t n = 0; n < packets; n++)
+      for (uint32_t s = 0; s < sources; s++)
+        for (uint32_t c = 0; c < copies; c++)
+          {
+            AquaSimAddress src (s + 1);
+            if (table.GetHash (src, n) != 0)
+              hits++;
+            table.PutInHash (src, n, pos);
+          }
+    return hits;
+  });
+
+  Report ("BM_VBVA/window", items, [&] () {
+    AquaSimVBVAPktHashTable table;
+    VBHeader vbh;
+    Vector3D sp (0, 0, 0), tp (1, 1, 1), fp (pos);
+    uint64_t hits = 0;
+    for (uint32_t n = 0; n < packets; n++)
+      for (uint32_t s = 0; s < sources; s++)
+        for (uint32_t c = 0; c < copies; c++)
+          {
+            AquaSimAddress src (s + 1);
+            vbh.SetForwardAddr (src);
+            vbh.SetPkNum (n);
+            if (table.GetHash (src, n) != 0)
+              hits++;
+            table.PutInHash (&vbh, &sp, &tp, &fp);
+          }
+    return hits;
+  });
+
+  uint64_t legacyItems = (uint64_t) legacyPackets * sources * copies;
+  Report ("BM_VBF/legacy-map", legacyItems, [&] () {
+    LegacyTable table;
+    uint64_t hits = 0;
+    for (uint32_t n = 0; n < legacyPackets; n++)
+      for (uint32_t s = 0; s < sources; s++)
+        for (uint32_t c = 0; c < copies; c++)
+          {
+            AquaSimAddress src (s + 1);
+            if (table.GetHash (src, n) != 0)
+              hits++;
+            table.PutInHash (src, n, pos);
+          }
+    return hits;
+  });
+  return 0;
+}
+
+}  // namespace pkt_table_bench
+
+/*
+ * Flooding-storm benchmark of the DBR sending queue.
+ *
+ * The queue is held at `depth` pending packets while copies of queued
+ * packets keep arriving (update, and insert if earlier), new packets
+ * arrive and the earliest leaves (pop), and overheard forwards cancel
+ * queued packets (purge). The sorted deque the queue used to be, peeking
+ * DBR headers to find packet IDs, is run for comparison up to
+ * `legacyMaxDepth`.
+ *
+ *   ./ns3 run "AquaSimBench --bench=dbr-queue --ops=200000 --maxDepth=16384"
+ */
+namespace dbr_queue_bench {
+
+namespace {
+
+/* The old MyPacketQueue, with update's missing iterator advance added. */
+class LegacyQueue
+{
+public:
+  ~LegacyQueue ()
+  {
+    for (std::deque<QueueItemDbr *>::iterator it = m_dq.begin (); it != m_dq.end (); ++it)
+      delete *it;
+  }
+  bool empty () { return m_dq.empty (); }
+  QueueItemDbr *front () { return m_dq.front (); }
+  void pop () { m_dq.pop_front (); }
+  void insert (QueueItemDbr *q)
+  {
+    std::deque<QueueItemDbr *>::iterator iter = m_dq.begin ();
+    while (iter != m_dq.end () && (*iter)->m_sendTime <= q->m_sendTime)
+      iter++;
+    m_dq.insert (iter, q);
+  }
+  std::deque<QueueItemDbr *>::iterator find (Ptr<Packet> p)
+  {
+    AquaSimHeader ash;
+    DBRHeader dbrh;
+    p->RemoveHeader (ash);
+    p->PeekHeader (dbrh);
+    p->AddHeader (ash);
+    uint32_t curID = dbrh.GetPacketID ();
+    std::deque<QueueItemDbr *>::iterator iter = m_dq.begin ();
+    for (; iter != m_dq.end (); iter++)
+      {
+        (*iter)->m_p->RemoveHeader (ash);
+        (*iter)->m_p->PeekHeader (dbrh);
+        (*iter)->m_p->AddHeader (ash);
+        if (dbrh.GetPacketID () == curID)
+          break;
+      }
+    return iter;
+  }
+  bool update (Ptr<Packet> p, double t)
+  {
+    std::deque<QueueItemDbr *>::iterator iter = find (p);
+    if (iter == m_dq.end ())
+      return true;
+    if ((*iter)->m_sendTime > t)
+      {
+        delete *iter;
+        m_dq.erase (iter);
+        return true;
+      }
+    return false;
+  }
+  bool purge (Ptr<Packet> p)
+  {
+    std::deque<QueueItemDbr *>::iterator iter = find (p);
+    if (iter == m_dq.end ())
+      return false;
+    delete *iter;
+    m_dq.erase (iter);
+    return true;
+  }
+
+private:
+  std::deque<QueueItemDbr *> m_dq;
+};
+
+Ptr<Packet>
+MakePacket (uint32_t id)
+{
+  DBRHeader dbrh;
+  dbrh.SetPacketID (id);
+  AquaSimHeader ash;
+  Ptr<Packet> p = Create<Packet> (32);
+  p->AddHeader (dbrh);
+  p->AddHeader (ash);
+  return p;
+}
+
+/* One storm step; returns the number of queue operations it made. */
+template <typename Queue, typename Key>
+uint32_t
+Step (Queue &q, std::vector<Ptr<Packet> > &pkts, uint32_t &next, uint32_t depth,
+      Ptr<UniformRandomVariable> rand, double now, Key key)
+{
+  double r = rand->GetValue ();
+  double t = now + rand->GetValue (0, 1);
+  if (r < 0.6)
+    {
+      /* another copy of a (probably) queued packet */
+      uint32_t id = next - 1 - rand->GetInteger (0, depth - 1);
+      if (q.update (key (pkts[id]), t))
+        q.insert (new QueueItemDbr (pkts[id], id, t));
+      return 2;
+    }
+  if (r < 0.8)
+    {
+      /* a new packet arrives and the earliest one leaves */
+      uint32_t id = next++;
+      if (q.update (key (pkts[id]), t))
+        q.insert (new QueueItemDbr (pkts[id], id, t));
+      QueueItemDbr *f = q.front ();
+      q.pop ();
+      delete f;
+      return 4;
+    }
+  /* an overheard forward cancels a queued packet, a new one takes its place */
+  uint32_t id = next - 1 - rand->GetInteger (0, depth - 1);
+  q.purge (key (pkts[id]));
+  id = next++;
+  q.insert (new QueueItemDbr (pkts[id], id, t));
+  return 2;
+}
+
+template <typename Queue, typename Key>
+void
+Run (const std::string &name, uint32_t depth, uint32_t steps, Key key)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  std::vector<Ptr<Packet> > pkts;
+  pkts.reserve (depth + steps);
+  for (uint32_t i = 0; i < depth + steps; i++)
+    pkts.push_back (MakePacket (i));
+
+  Queue q;
+  uint32_t next = 0;
+  for (; next < depth; next++)
+    q.insert (new QueueItemDbr (pkts[next], next, rand->GetValue (0, 1)));
+
+  uint64_t ops = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t s = 0; s < steps; s++)
+    ops += Step (q, pkts, next, depth, rand, s * 1e-3, key);
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  std::cout << std::left << std::setw (32) << (name + "/" + std::to_string (depth)) << std::right
+            << std::setw (12) << std::fixed << std::setprecision (1) << wall * 1e9 / ops << " ns"
+            << std::setw (12) << ops << "\n";
+}
+
+uint32_t
+ById (Ptr<Packet> p)
+{
+  AquaSimHeader ash;
+  DBRHeader dbrh;
+  p->RemoveHeader (ash);
+  p->PeekHeader (dbrh);
+  p->AddHeader (ash);
+  return dbrh.GetPacketID ();
+}
+
+Ptr<Packet>
+ByPacket (Ptr<Packet> p)
+{
+  return p;
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t ops = 200000;
+  uint32_t maxDepth = 16384;
+  uint32_t legacyMaxDepth = 4096;
+
+  CommandLine cmd;
+  cmd.AddValue ("ops", "Storm steps per depth", ops);
+  cmd.AddValue ("maxDepth", "Largest queue depth", maxDepth);
+  cmd.AddValue ("legacyMaxDepth", "Largest queue depth for the sorted deque", legacyMaxDepth);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (32) << "Benchmark" << std::right
+            << std::setw (15) << "Time/op" << std::setw (12) << "Operations" << "\n"
+            << std::string (59, '-') << "\n";
+
+  for (uint32_t depth = 64; depth <= maxDepth; depth *= 4)
+    {
+      /* the forwarding path peeks the packet ID once per received copy */
+      Run<MyPacketQueue> ("BM_DbrQueue/heap", depth, ops, ById);
+      if (depth <= legacyMaxDepth)
+        {
+          Run<LegacyQueue> ("BM_DbrQueue/sorted-deque", depth,
+                            std::max (ops / (depth / 64), 1000u), ByPacket);
+        }
+    }
+  return 0;
+}
+
+}  // namespace dbr_queue_bench
+
+/*
+ * TR-MAC schedule rebuild benchmark.
+ *
+ * For swarms of 50 to `maxNodes` nodes scattered in a 3 km x 3 km x 500 m
+ * box, times one schedule rebuild and reports the closed tour length:
+ * nearest-neighbor only, and refined by 2-opt under the default and a
+ * larger move budget. The old construction (every start node, greedy
+ * steps over a std::map of node pairs) is run up to `legacyMaxNodes`; it
+ * ran on every node, while the shared schedule is built once per swarm.
+ *
+ *   ./ns3 run "AquaSimBench --bench=trumac-schedule --maxNodes=2000"
+ */
+namespace trumac_schedule_bench {
+
+namespace {
+
+/* The old AquaSimTrumac::runNearestNeighborTSP over m_graph. */
+std::vector<uint32_t>
+LegacyTsp (const std::map<std::pair<uint32_t, uint32_t>, double> &graph, uint32_t total)
+{
+  std::vector<uint32_t> optimalSchedule;
+  std::vector<uint32_t> currentSchedule;
+  double optimalSum = 100000000;
+  for (uint32_t n = 0; n < total; n++)
+    {
+      currentSchedule.clear ();
+      currentSchedule.push_back (n);
+      double currentSum = 0;
+      uint32_t nextNode = n;
+      while (currentSchedule.size () < total)
+        {
+          double w = 1000000000;
+          uint32_t currentBestNode = 0;
+          for (std::map<std::pair<uint32_t, uint32_t>, double>::const_iterator it = graph.begin ();
+               it != graph.end (); it++)
+            {
+              if (it->first.first == nextNode
+                  && std::find (currentSchedule.begin (), currentSchedule.end (),
+                                it->first.second) == currentSchedule.end ()
+                  && it->second < w)
+                {
+                  w = it->second;
+                  currentBestNode = it->first.second;
+                }
+            }
+          nextNode = currentBestNode;
+          currentSchedule.push_back (nextNode);
+          currentSum += w;
+        }
+      if (currentSum < optimalSum)
+        {
+          optimalSum = currentSum;
+          optimalSchedule = currentSchedule;
+        }
+    }
+  return optimalSchedule;
+}
+
+void
+Report (const std::string &name, uint32_t n, double wall, double length)
+{
+  std::cout << std::left << std::setw (36) << (name + "/" + std::to_string (n)) << std::right
+            << std::setw (14) << std::fixed << std::setprecision (3) << wall * 1e3 << " ms"
+            << std::setw (14) << std::setprecision (0) << length << "\n";
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t maxNodes = 2000;
+  uint32_t legacyMaxNodes = 100;
+  uint64_t budget = 5000000;
+  uint64_t largeBudget = 100000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("maxNodes", "Largest swarm", maxNodes);
+  cmd.AddValue ("legacyMaxNodes", "Largest swarm for the old construction", legacyMaxNodes);
+  cmd.AddValue ("budget", "2-opt move budget (TwoOptBudget default)", budget);
+  cmd.AddValue ("largeBudget", "Larger 2-opt move budget", largeBudget);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (36) << "Benchmark" << std::right
+            << std::setw (17) << "Rebuild" << std::setw (14) << "Tour length" << "\n"
+            << std::string (67, '-') << "\n";
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  const uint32_t sizes[] = {50, 100, 200, 500, 1000, 2000};
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]) && sizes[s] <= maxNodes; s++)
+    {
+      uint32_t n = sizes[s];
+      std::vector<Vector> pos;
+      for (uint32_t i = 0; i < n; i++)
+        pos.push_back (Vector (rand->GetValue (0, 3000), rand->GetValue (0, 3000), rand->GetValue (0, 500)));
+
+      const uint64_t budgets[] = {0, budget, largeBudget};
+      const char *names[] = {"BM_TrumacSchedule/nearest-neighbor", "BM_TrumacSchedule/2opt-default",
+                             "BM_TrumacSchedule/2opt-large"};
+      for (uint32_t b = 0; b < 3; b++)
+        {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+          AquaSimTrumacSchedule sched (pos, budgets[b]);
+          double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+          Report (names[b], n, wall, sched.GetLength ());
+        }
+
+      if (n <= legacyMaxNodes)
+        {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+          std::map<std::pair<uint32_t, uint32_t>, double> graph;
+          for (uint32_t i = 0; i < n; i++)
+            for (uint32_t j = 0; j < n; j++)
+              if (i != j)
+                graph.insert (std::make_pair (std::make_pair (i, j), CalculateDistance (pos[i], pos[j])));
+          std::vector<uint32_t> tour = LegacyTsp (graph, n);
+          double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+          Report ("BM_TrumacSchedule/legacy-per-node", n, wall,
+                  AquaSimTrumacSchedule::TourLength (AquaSimTrumacSchedule::DistanceMatrix (pos), tour));
+          Report ("BM_TrumacSchedule/legacy-per-swarm", n, wall * n,
+                  AquaSimTrumacSchedule::TourLength (AquaSimTrumacSchedule::DistanceMatrix (pos), tour));
+        }
+    }
+  return 0;
+}
+
+}  // namespace trumac_schedule_bench
+
+/*
+ * LIBRA forwarding-table microbenchmark.
+ *
+ * One node's MAC learns `flows` (src, dst) entries over a swarm of `nodes`
+ * addresses, `nextHops` next hops each. Then it times two paths: the
+ * reward update (UpdateWeight) and the softmax next-hop pick
+ * (SelectNextHop). The std::map-keyed tables the MAC used before are
+ * replayed on the same operations for comparison.
+ *
+ *   ./ns3 run "AquaSimBench --bench=libra-table --ops=200000 --nextHops=16"
+ */
+namespace libra_table_bench {
+
+namespace {
+
+/* The old tables, keyed on one-element maps, and their update paths. */
+class LegacyTables
+{
+public:
+  typedef std::map<AquaSimAddress, AquaSimAddress> PairKey;
+
+  LegacyTables (void) : m_rand (CreateObject<UniformRandomVariable> ()) {}
+
+  void UpdateWeight (AquaSimAddress src, AquaSimAddress dst, AquaSimAddress next_hop_addr, double reward)
+  {
+    std::map<AquaSimAddress, AquaSimAddress> src_dst_map;
+    src_dst_map.insert (std::make_pair (src, dst));
+    if (m_forwarding_table.count (src_dst_map) == 0)
+      {
+        std::map<AquaSimAddress, double> m;
+        m.insert (std::make_pair (next_hop_addr, reward));
+        m_forwarding_table.insert (std::make_pair (src_dst_map, m));
+      }
+    else
+      {
+        if (m_forwarding_table.find (src_dst_map)->second.count (next_hop_addr) == 0)
+          {
+            m_forwarding_table.find (src_dst_map)->second.insert (std::make_pair (next_hop_addr, reward));
+            return;
+          }
+        double current_weight = m_forwarding_table.find (src_dst_map)->second.find (next_hop_addr)->second;
+        m_forwarding_table.find (src_dst_map)->second.at (next_hop_addr) = (current_weight + reward) / 2;
+      }
+  }
+
+  AquaSimAddress SelectNextHop (AquaSimAddress src, AquaSimAddress dst)
+  {
+    std::map<AquaSimAddress, AquaSimAddress> src_dst_map;
+    src_dst_map.insert (std::make_pair (src, dst));
+    std::vector<AquaSimAddress> next_hop_addresses;
+    std::vector<double> selection_probabilities;
+    double weight_sum = 0;
+    for (auto const &x : m_forwarding_table.find (src_dst_map)->second)
+      weight_sum += exp (x.second);
+    for (auto const &x : m_forwarding_table.find (src_dst_map)->second)
+      {
+        selection_probabilities.push_back (exp (x.second) / weight_sum);
+        next_hop_addresses.push_back (x.first);
+      }
+    uint32_t next_hop_index = selection_probabilities.size () - 1;
+    double point = m_rand->GetValue ();
+    double cur_cutoff = 0;
+    for (uint32_t i = 0; i < selection_probabilities.size (); i++)
+      {
+        cur_cutoff += selection_probabilities[i];
+        if (point < cur_cutoff)
+          {
+            next_hop_index = i;
+            break;
+          }
+      }
+    return next_hop_addresses[next_hop_index];
+  }
+
+private:
+  Ptr<UniformRandomVariable> m_rand;
+  std::map<PairKey, std::map<AquaSimAddress, double> > m_forwarding_table;
+};
+
+struct Op
+{
+  AquaSimAddress src, dst, next;
+  double reward;
+};
+
+void
+Report (const std::string &name, uint32_t nodes, double wall, uint32_t ops)
+{
+  std::cout << std::left << std::setw (36) << (name + "/" + std::to_string (nodes)) << std::right
+            << std::setw (12) << std::fixed << std::setprecision (1) << wall * 1e9 / ops << " ns"
+            << std::setw (12) << ops << "\n";
+}
+
+template <typename Mac>
+void
+Run (const std::string &name, Mac &mac, uint32_t nodes, const std::vector<Op> &learn,
+     const std::vector<Op> &ops)
+{
+  typedef std::chrono::steady_clock Clock;
+  for (uint32_t i = 0; i < learn.size (); i++)
+    mac.UpdateWeight (learn[i].src, learn[i].dst, learn[i].next, learn[i].reward);
+
+  Clock::time_point start = Clock::now ();
+  for (uint32_t i = 0; i < ops.size (); i++)
+    mac.UpdateWeight (ops[i].src, ops[i].dst, ops[i].next, ops[i].reward);
+  Report ("BM_LibraReward/" + name, nodes, std::chrono::duration<double> (Clock::now () - start).count (),
+          ops.size ());
+
+  uint32_t sink = 0;
+  start = Clock::now ();
+  for (uint32_t i = 0; i < ops.size (); i++)
+    sink += mac.SelectNextHop (ops[i].src, ops[i].dst).GetAsInt ();
+  Report ("BM_LibraSelect/" + name, nodes, std::chrono::duration<double> (Clock::now () - start).count (),
+          ops.size ());
+  NS_LOG_INFO ("checksum " << sink);
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t ops = 200000;
+  uint32_t nextHops = 16;
+  uint32_t maxNodes = 4096;
+
+  CommandLine cmd;
+  cmd.AddValue ("ops", "Operations per path", ops);
+  cmd.AddValue ("nextHops", "Next hops learned per (src, dst) entry", nextHops);
+  cmd.AddValue ("maxNodes", "Largest swarm", maxNodes);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (36) << "Benchmark" << std::right
+            << std::setw (15) << "Time/op" << std::setw (12) << "Operations" << "\n"
+            << std::string (63, '-') << "\n";
+
+  for (uint32_t nodes = 64; nodes <= maxNodes; nodes *= 4)
+    {
+      Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+      /* one flow per node through this MAC, each with its own next hops */
+      std::vector<Op> flows;
+      for (uint32_t f = 0; f < nodes; f++)
+        {
+          Op o;
+          o.src = AquaSimAddress ((uint16_t) rand->GetInteger (1, nodes));
+          o.dst = AquaSimAddress ((uint16_t) rand->GetInteger (1, nodes));
+          flows.push_back (o);
+        }
+      std::vector<Op> learn, run;
+      for (uint32_t f = 0; f < flows.size (); f++)
+        {
+          for (uint32_t h = 0; h < nextHops; h++)
+            {
+              Op o = flows[f];
+              o.next = AquaSimAddress ((uint16_t) rand->GetInteger (1, nodes));
+              o.reward = rand->GetValue ();
+              learn.push_back (o);
+            }
+        }
+      for (uint32_t i = 0; i < ops; i++)
+        {
+          Op o = learn[rand->GetInteger (0, learn.size () - 1)];
+          o.reward = rand->GetValue ();
+          run.push_back (o);
+        }
+
+      Ptr<AquaSimMacLibra> mac = CreateObject<AquaSimMacLibra> ();
+      Run ("flat", *mac, nodes, learn, run);
+      LegacyTables legacy;
+      Run ("map", legacy, nodes, learn, run);
+    }
+  return 0;
+}
+
+}  // namespace libra_table_bench
+
+/*
+ * NDN forwarding-table benchmark.
+ *
+ * Every node of a `nodes` swarm holds a FIB with one prefix per region, a
+ * PIT and an LRU content store. On/off consumers send `ops` interests
+ * for Zipf-popular names over `duration` seconds; each interest reaches a
+ * random node as a fresh payload copy, the way NamedData pulls it out of
+ * a packet, and most pending interests are answered by a data packet a
+ * second later. The interned tables are compared with the pointer-keyed
+ * FIB, PIT and content store they replaced, which only match a name when
+ * the very same buffer comes back: fed payload copies they never match,
+ * so they are also run on one shared buffer per name ("canonical") to
+ * time them doing the same forwarding work.
+ *
+ *   ./ns3 run "AquaSimBench --bench=ndn-tables --ops=400000 --alpha=0.9"
+ */
+namespace ndn_tables_bench {
+
+namespace {
+
+const uint32_t REGIONS = 16;
+const uint32_t SENSORS = 64;
+
+/* The old tables, keyed on the payload buffer, and their paths. */
+class LegacyNode
+{
+public:
+  struct PitEntry {
+    std::list<AquaSimAddress> address;
+    Timer timeout;
+  };
+
+  LegacyNode (Time timeout, size_t csSize) : m_timeout (timeout), m_csSize (csSize) {}
+
+  void FibAdd (uint8_t* name, AquaSimAddress address)
+  {
+    m_fib[name].push_back (std::make_pair (address, 0));
+  }
+
+  std::list<AquaSimAddress> FibRecv (uint8_t* name)
+  {
+    std::list<AquaSimAddress> addressList;
+    std::map<uint8_t*, std::list<std::pair<AquaSimAddress,int> > >::iterator it = m_fib.find (name);
+    if (it == m_fib.end ())
+      return addressList;
+    std::list<std::pair<AquaSimAddress,int> > entry = it->second;
+    for (std::list<std::pair<AquaSimAddress,int> >::iterator e = entry.begin (); e != entry.end (); e++)
+      addressList.push_back (e->first);
+    return addressList;
+  }
+
+  bool PitRemove (uint8_t* name)
+  {
+    std::map<uint8_t*, PitEntry>::iterator entry = m_pit.find (name);
+    if (entry == m_pit.end ())
+      return false;
+    if (entry->second.timeout.IsRunning ())
+      entry->second.timeout.Cancel ();
+    m_pit.erase (entry);
+    return true;
+  }
+
+  bool PitAdd (uint8_t* name, AquaSimAddress address)
+  {
+    std::map<uint8_t*, PitEntry>::iterator entry = m_pit.find (name);
+    if (entry == m_pit.end ())
+      {
+        PitEntry &newEntry = m_pit[name];
+        newEntry.address.push_back (address);
+        newEntry.timeout.SetArguments (name);
+        newEntry.timeout.SetFunction (&LegacyNode::PitRemove, this);
+        newEntry.timeout.Schedule (m_timeout);
+        return true;
+      }
+    entry->second.address.push_back (address);
+    entry->second.address.sort ();
+    entry->second.address.unique ();
+    return false;
+  }
+
+  std::list<AquaSimAddress> PitGet (uint8_t* name)
+  {
+    std::map<uint8_t*, PitEntry>::iterator entry = m_pit.find (name);
+    if (entry == m_pit.end ())
+      return std::list<AquaSimAddress> ();
+    return entry->second.address;
+  }
+
+  size_t PitSize (void) const { return m_pit.size (); }
+
+  void CsAdd (uint8_t* key, uint8_t* data)
+  {
+    auto it = m_csMap.find (key);
+    if (it != m_csMap.end ())
+      {
+        m_csList.erase (it->second);
+        m_csMap.erase (it);
+      }
+    m_csList.push_front (std::make_pair (key, data));
+    m_csMap.insert (std::make_pair (key, m_csList.begin ()));
+    while (m_csMap.size () > m_csSize)
+      {
+        m_csMap.erase (m_csList.back ().first);
+        m_csList.pop_back ();
+      }
+  }
+
+  uint8_t* CsGet (uint8_t* key)
+  {
+    auto it = m_csMap.find (key);
+    if (it == m_csMap.end ())
+      return NULL;
+    m_csList.splice (m_csList.begin (), m_csList, it->second);
+    return it->second->second;
+  }
+
+private:
+  Time m_timeout;
+  size_t m_csSize;
+  std::map<uint8_t*, std::list<std::pair<AquaSimAddress,int> > > m_fib;
+  std::map<uint8_t*, PitEntry> m_pit;
+  std::list<std::pair<uint8_t*,uint8_t*> > m_csList;
+  std::unordered_map<uint8_t*, decltype (m_csList.begin ())> m_csMap;
+};
+
+struct InternedNode
+{
+  Ptr<Fib> fib;
+  Ptr<Pit> pit;
+  Ptr<CSLru> cs;
+};
+
+struct Interest
+{
+  uint32_t node;
+  uint32_t name;
+  AquaSimAddress from;
+  bool answered;    // a data packet comes back a second later
+};
+
+struct Stats
+{
+  uint64_t interests, csHits, fibHits, forwarded, data, satisfied;
+  size_t peakPit;
+};
+
+std::vector<std::string> g_names;     // catalog, with a terminating NUL each
+std::vector<std::vector<Interest> > g_batches;   // one per simulated second
+
+uint8_t*
+CopyPayload (const std::string &name)
+{
+  uint8_t *buf = new uint8_t[name.size () + 1];
+  memcpy (buf, name.c_str (), name.size () + 1);
+  return buf;
+}
+
+/* ---- interned tables ---- */
+
+std::vector<InternedNode> g_interned;
+std::vector<uint8_t> g_payload;
+uint8_t g_content[] = "reading";
+Stats g_stats;
+
+NameId
+InternPayload (const std::string &name)
+{
+  // same path as NamedData::GetInterestPktName: copy, then intern to the NUL
+  g_payload.assign (name.c_str (), name.c_str () + name.size () + 1);
+  const char *s = reinterpret_cast<const char*> (g_payload.data ());
+  const void *end = memchr (s, '\0', g_payload.size ());
+  return NameTable::Intern (s, (const char*) end - s);
+}
+
+void
+InternedData (uint32_t second)
+{
+  const std::vector<Interest> &batch = g_batches[second];
+  for (size_t i = 0; i < batch.size (); i++)
+    {
+      if (!batch[i].answered)
+        continue;
+      InternedNode &n = g_interned[batch[i].node];
+      NameId name = InternPayload (g_names[batch[i].name]);
+      g_stats.data++;
+      if (!n.pit->GetEntry (name).empty ())
+        {
+          g_stats.satisfied++;
+          n.cs->AddEntry (name, g_content);
+          n.pit->RemoveEntry (name);
+        }
+    }
+}
+
+void
+InternedInterests (uint32_t second)
+{
+  const std::vector<Interest> &batch = g_batches[second];
+  for (size_t i = 0; i < batch.size (); i++)
+    {
+      InternedNode &n = g_interned[batch[i].node];
+      NameId name = InternPayload (g_names[batch[i].name]);
+      g_stats.interests++;
+      if (n.cs->GetEntry (name) != NULL)
+        {
+          g_stats.csHits++;
+          continue;
+        }
+      std::vector<AquaSimAddress> hops = n.fib->InterestRecv (name);
+      if (hops.empty ())
+        continue;
+      g_stats.fibHits++;
+      if (n.pit->AddEntry (name, batch[i].from))
+        g_stats.forwarded += hops.size ();
+    }
+  size_t pending = 0;
+  for (size_t i = 0; i < g_interned.size (); i++)
+    pending += g_interned[i].pit->GetPitSize ();
+  g_stats.peakPit = std::max (g_stats.peakPit, pending);
+  Simulator::Schedule (Seconds (1), &InternedData, second);
+}
+
+/* ---- legacy tables ---- */
+
+std::vector<LegacyNode*> g_legacy;
+std::vector<uint8_t*> g_buffers;   // the old tables keep payload pointers
+std::map<std::string, uint8_t*> g_canonical;
+bool g_useCanonical;
+
+uint8_t*
+LegacyPayload (const std::string &name)
+{
+  if (g_useCanonical)
+    {
+      uint8_t* &buf = g_canonical[name];
+      if (buf == NULL)
+        buf = CopyPayload (name);
+      return buf;
+    }
+  uint8_t *buf = CopyPayload (name);
+  g_buffers.push_back (buf);
+  return buf;
+}
+
+void
+LegacyData (uint32_t second)
+{
+  const std::vector<Interest> &batch = g_batches[second];
+  for (size_t i = 0; i < batch.size (); i++)
+    {
+      if (!batch[i].answered)
+        continue;
+      LegacyNode &n = *g_legacy[batch[i].node];
+      uint8_t *name = LegacyPayload (g_names[batch[i].name]);
+      g_stats.data++;
+      if (!n.PitGet (name).empty ())
+        {
+          g_stats.satisfied++;
+          n.CsAdd (name, g_content);
+          n.PitRemove (name);
+        }
+    }
+}
+
+void
+LegacyInterests (uint32_t second)
+{
+  const std::vector<Interest> &batch = g_batches[second];
+  for (size_t i = 0; i < batch.size (); i++)
+    {
+      LegacyNode &n = *g_legacy[batch[i].node];
+      uint8_t *name = LegacyPayload (g_names[batch[i].name]);
+      g_stats.interests++;
+      if (n.CsGet (name) != NULL)
+        {
+          g_stats.csHits++;
+          continue;
+        }
+      std::list<AquaSimAddress> hops = n.FibRecv (name);
+      if (hops.empty ())
+        continue;
+      g_stats.fibHits++;
+      if (n.PitAdd (name, batch[i].from))
+        g_stats.forwarded += hops.size ();
+    }
+  size_t pending = 0;
+  for (size_t i = 0; i < g_legacy.size (); i++)
+    pending += g_legacy[i]->PitSize ();
+  g_stats.peakPit = std::max (g_stats.peakPit, pending);
+  Simulator::Schedule (Seconds (1), &LegacyData, second);
+}
+
+void
+Report (const std::string &name, uint32_t nodes, double wall)
+{
+  double n = g_stats.interests;
+  std::cout << std::left << std::setw (28) << (name + "/" + std::to_string (nodes)) << std::right
+            << std::setw (10) << std::fixed << std::setprecision (1) << wall * 1e9 / n << " ns"
+            << std::setw (10) << std::setprecision (3) << g_stats.csHits / n
+            << std::setw (10) << g_stats.fibHits / n
+            << std::setw (10) << (g_stats.data ? (double) g_stats.satisfied / g_stats.data : 0.0)
+            << std::setw (10) << g_stats.peakPit << "\n";
+}
+
+template <typename F>
+void
+Run (const std::string &name, uint32_t nodes, F interests)
+{
+  typedef std::chrono::steady_clock Clock;
+  g_stats = Stats ();
+  for (uint32_t s = 0; s < g_batches.size (); s++)
+    Simulator::Schedule (Seconds (s), interests, s);
+  Clock::time_point start = Clock::now ();
+  Simulator::Run ();
+  Report (name, nodes, std::chrono::duration<double> (Clock::now () - start).count ());
+  Simulator::Destroy ();
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t ops = 400000;
+  uint32_t duration = 60;
+  uint32_t catalog = 20000;
+  double alpha = 0.8;
+  uint32_t csSize = 64;
+  double timeout = 4;
+  uint32_t maxNodes = 4000;
+
+  CommandLine cmd;
+  cmd.AddValue ("ops", "Interests over the whole run", ops);
+  cmd.AddValue ("duration", "Simulated seconds", duration);
+  cmd.AddValue ("catalog", "Distinct content names", catalog);
+  cmd.AddValue ("alpha", "Zipf exponent of name popularity", alpha);
+  cmd.AddValue ("csSize", "Content store entries per node", csSize);
+  cmd.AddValue ("timeout", "PIT entry timeout (s)", timeout);
+  cmd.AddValue ("maxNodes", "Largest swarm", maxNodes);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  g_names.clear ();
+  std::vector<double> cdf;
+  double sum = 0;
+  for (uint32_t i = 0; i < catalog; i++)
+    {
+      g_names.push_back ("/r" + std::to_string (rand->GetInteger (0, REGIONS - 1))
+                         + "/s" + std::to_string (rand->GetInteger (0, SENSORS - 1))
+                         + "/i" + std::to_string (i));
+      sum += 1.0 / std::pow (i + 1.0, alpha);
+      cdf.push_back (sum);
+    }
+
+  std::cout << std::left << std::setw (28) << "Benchmark" << std::right
+            << std::setw (13) << "Time/int" << std::setw (10) << "CS hit" << std::setw (10) << "FIB hit"
+            << std::setw (10) << "PIT hit" << std::setw (10) << "Peak PIT" << "\n"
+            << std::string (81, '-') << "\n";
+
+  for (uint32_t nodes = 1000; nodes <= maxNodes; nodes *= 4)
+    {
+      g_batches.assign (duration, std::vector<Interest> ());
+      for (uint32_t i = 0; i < ops; i++)
+        {
+          Interest in;
+          in.node = rand->GetInteger (0, nodes - 1);
+          in.name = std::lower_bound (cdf.begin (), cdf.end (), rand->GetValue (0, sum)) - cdf.begin ();
+          in.name = std::min (in.name, catalog - 1);
+          in.from = AquaSimAddress ((uint16_t) rand->GetInteger (1, nodes));
+          in.answered = rand->GetValue () < 0.9;
+          g_batches[rand->GetInteger (0, duration - 1)].push_back (in);
+        }
+
+      /* discovery: every node learns each region prefix from two neighbors */
+      std::vector<std::string> prefixes;
+      for (uint32_t r = 0; r < REGIONS; r++)
+        prefixes.push_back ("/r" + std::to_string (r));
+
+      g_interned.assign (nodes, InternedNode ());
+      for (uint32_t i = 0; i < nodes; i++)
+        {
+          InternedNode &n = g_interned[i];
+          n.fib = CreateObject<Fib> ();
+          n.pit = CreateObject<Pit> ();
+          n.pit->SetTimeout (Seconds (timeout));
+          n.cs = CreateObject<CSLru> ();
+          n.cs->SetCacheSize (csSize);
+          for (uint32_t r = 0; r < REGIONS; r++)
+            for (uint32_t h = 0; h < 2; h++)
+              n.fib->AddEntry (InternPayload (prefixes[r]), AquaSimAddress ((uint16_t) rand->GetInteger (1, nodes)));
+        }
+      Run ("BM_NdnInterned", nodes, &InternedInterests);
+      for (uint32_t i = 0; i < nodes; i++)
+        g_interned[i].pit->Dispose ();
+      g_interned.clear ();
+
+      for (int canonical = 0; canonical < 2; canonical++)
+        {
+          g_useCanonical = canonical;
+          g_legacy.assign (nodes, NULL);
+          for (uint32_t i = 0; i < nodes; i++)
+            {
+              g_legacy[i] = new LegacyNode (Seconds (timeout), csSize);
+              for (uint32_t r = 0; r < REGIONS; r++)
+                for (uint32_t h = 0; h < 2; h++)
+                  g_legacy[i]->FibAdd (LegacyPayload (prefixes[r]),
+                                       AquaSimAddress ((uint16_t) rand->GetInteger (1, nodes)));
+            }
+          Run (canonical ? "BM_NdnPointerCanonical" : "BM_NdnPointerKeyed", nodes, &LegacyInterests);
+          for (uint32_t i = 0; i < nodes; i++)
+            delete g_legacy[i];
+          for (size_t i = 0; i < g_buffers.size (); i++)
+            delete[] g_buffers[i];
+          g_buffers.clear ();
+        }
+      for (std::map<std::string, uint8_t*>::iterator it = g_canonical.begin (); it != g_canonical.end (); it++)
+        delete[] it->second;
+      g_canonical.clear ();
+    }
+  return 0;
+}
+
+}  // namespace ndn_tables_bench
+
+/*
+ * IDS detector benchmark.
+ *
+ * `sensors` nodes drift at 0.5-2 m/s through a 1000 x 1000 x 900 m box and
+ * report their position to a sink at (500, 500, 950) every `interval`
+ * seconds. From `attackStart` the first `attackers` lie: attack 1 adds
+ * 500 m to x and y, attack 2 drifts x away at 10 m/s (the uwsn-ids
+ * scenarios). Each report reaches the detector after a MAC backoff and
+ * the propagation delay, with the delay measured at a per-sender sound
+ * speed of 1480-1520 m/s and the RSSI off by up to `rssiNoise` dB, so
+ * honest reports carry realistic residuals.
+ *
+ * Every model is run at several batch sizes; labelled rows train the
+ * learned models online, as in a deployment fed by ground truth. Reported:
+ * receptions per wall-second, alert precision and recall, the simulated
+ * time from an attacker's first lie to its first alert, and the time rows
+ * wait for their batch.
+ *
+ *   ./ns3 run "AquaSimBench --bench=ids-detector --sensors=400 --simTime=20000"
+ */
+namespace ids_detector_bench {
+
+namespace {
+
+struct Sensor
+{
+  Vector start;
+  Vector velocity;
+  double soundSpeed;
+};
+
+std::vector<Sensor> g_sensors;
+Ptr<UniformRandomVariable> g_rand;
+Vector g_sink (500, 500, 950);
+double g_interval;
+double g_attackStart;
+uint32_t g_attackers;
+int g_attack;
+double g_rssiNoise;
+double g_simTime;
+
+Vector
+Position (const Sensor &s, double t)
+{
+  Vector p (s.start.x + s.velocity.x * t, s.start.y + s.velocity.y * t,
+            s.start.z + s.velocity.z * t);
+  return p;
+}
+
+void
+Arrive (Ptr<AquaSimIdsDetector> det, AquaSimIdsReception rx)
+{
+  det->Process (rx);
+}
+
+void
+Report (Ptr<AquaSimIdsDetector> det, uint32_t i)
+{
+  const Sensor &s = g_sensors[i];
+  double now = Simulator::Now ().GetSeconds ();
+  double backoff = g_rand->GetValue (0, 1.5);
+  Vector real = Position (s, now + backoff);
+
+  AquaSimIdsReception rx;
+  rx.nodeId = i;
+  rx.sendTime = Simulator::Now ();
+  rx.reportedPos = Position (s, now);
+  rx.label = 0;
+  if (i < g_attackers && now >= g_attackStart)
+    {
+      rx.label = 1;
+      if (g_attack == 1)
+        {
+          rx.reportedPos.x += 500;
+          rx.reportedPos.y += 500;
+        }
+      else
+        rx.reportedPos.x += 10 * (now - g_attackStart);
+    }
+
+  double d = CalculateDistance (real, g_sink);
+  double f2 = 25.0 * 25.0;
+  double thorp = 0.11 * f2 / (1 + f2) + 44 * f2 / (4100 + f2) + 0.000275 * f2 + 0.0003;
+  double pr = 20 / (d * d * std::exp (thorp * M_LN10 / 10000.0 * d));
+  rx.rssi = pr * std::pow (10, g_rand->GetValue (-g_rssiNoise, g_rssiNoise) / 10);
+  rx.propDelay = Seconds (d / s.soundSpeed);
+  Simulator::Schedule (Seconds (backoff) + rx.propDelay, &Arrive, det, rx);
+
+  if (now + g_interval < g_simTime)
+    Simulator::Schedule (Seconds (g_interval), &Report, det, i);
+}
+
+void
+Run (const std::string &name, Ptr<AquaSimIdsModel> model, uint32_t batch)
+{
+  typedef std::chrono::steady_clock Clock;
+  // every run replays the same reports
+  g_rand = CreateObject<UniformRandomVariable> ();
+  g_rand->SetStream (1);
+
+  Ptr<ConstantPositionMobilityModel> sink = CreateObject<ConstantPositionMobilityModel> ();
+  sink->SetPosition (g_sink);
+  Ptr<AquaSimIdsDetector> det = CreateObject<AquaSimIdsDetector> ();
+  det->SetSinkMobility (sink);
+  det->SetModel (model);
+  det->SetAttribute ("BatchSize", UintegerValue (batch));
+  for (uint32_t i = 0; i < g_sensors.size (); i++)
+    Simulator::Schedule (Seconds (g_rand->GetValue (0, g_interval)), &Report, det, i);
+  Clock::time_point start = Clock::now ();
+  Simulator::Run ();
+  det->Flush ();
+  double wall = std::chrono::duration<double> (Clock::now () - start).count ();
+
+  double tp = det->GetTruePositives ();
+  double fp = det->GetFalsePositives ();
+  double fn = det->GetFalseNegatives ();
+  uint32_t detected;
+  Time latency = det->GetMeanDetectionLatency (detected);
+  std::cout << std::left << std::setw (24) << (name + "/" + std::to_string (batch)) << std::right
+            << std::setw (12) << std::fixed << std::setprecision (0) << det->GetNReceptions () / wall
+            << std::setw (10) << std::setprecision (3) << (tp + fp > 0 ? tp / (tp + fp) : 0.0)
+            << std::setw (10) << (tp + fn > 0 ? tp / (tp + fn) : 0.0)
+            << std::setw (6) << detected
+            << std::setw (12) << std::setprecision (1) << latency.GetSeconds ()
+            << std::setw (12) << std::setprecision (3) << det->GetMeanQueueDelay ().GetSeconds ()
+            << "\n";
+  det->Dispose ();
+  Simulator::Destroy ();
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t sensors = 2000;
+  g_simTime = 3000;
+  g_interval = 30;
+  g_attackStart = 500;
+  g_attackers = 5;
+  g_attack = 1;
+  g_rssiNoise = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("sensors", "Reporting sensors", sensors);
+  cmd.AddValue ("simTime", "Simulated seconds", g_simTime);
+  cmd.AddValue ("interval", "Report interval (s)", g_interval);
+  cmd.AddValue ("attackStart", "Time the attackers start lying (s)", g_attackStart);
+  cmd.AddValue ("attackers", "Lying sensors", g_attackers);
+  cmd.AddValue ("attack", "1: position jump, 2: position drift", g_attack);
+  cmd.AddValue ("rssiNoise", "RSSI error bound (dB)", g_rssiNoise);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < sensors; i++)
+    {
+      Sensor s;
+      s.start = Vector (rand->GetValue (0, 1000), rand->GetValue (0, 1000), rand->GetValue (0, 900));
+      double speed = rand->GetValue (0.5, 2);
+      double heading = rand->GetValue (0, 2 * M_PI);
+      // wander slowly enough to stay near the box for the whole run
+      speed *= std::min (1.0, 1000 / (speed * g_simTime));
+      s.velocity = Vector (speed * std::cos (heading), speed * std::sin (heading), 0);
+      s.soundSpeed = rand->GetValue (1480, 1520);
+      g_sensors.push_back (s);
+    }
+
+  std::cout << std::left << std::setw (24) << "Benchmark" << std::right
+            << std::setw (12) << "Rx/wall-s" << std::setw (10) << "Precision"
+            << std::setw (10) << "Recall" << std::setw (6) << "Det"
+            << std::setw (12) << "Latency(s)" << std::setw (12) << "Queue(s)" << "\n"
+            << std::string (86, '-') << "\n";
+
+  const uint32_t batches[] = {1, 16, 128};
+  for (uint32_t b = 0; b < 3; b++)
+    Run ("BM_IdsThreshold", CreateObject<AquaSimIdsThresholdModel> (), batches[b]);
+  for (uint32_t b = 0; b < 3; b++)
+    Run ("BM_IdsLogistic", CreateObject<AquaSimIdsLogisticModel> (), batches[b]);
+  for (uint32_t b = 0; b < 3; b++)
+    Run ("BM_IdsSvm", CreateObject<AquaSimIdsSvmModel> (), batches[b]);
+  return 0;
+}
+
+}  // namespace ids_detector_bench
+
+/*
+ * Multilateration benchmark.
+ *
+ * `anchors` receivers at known positions (buoys at the surface plus moored
+ * nodes) measure ToA ranges, with `noise` metres of error, to a sensor
+ * drifting at 1.5 m/s; each packet reports the sensor position, and from
+ * `packets` / 2 on the report is spoofed by `spoof` metres. Per packet the
+ * engine either checks the reported position against the ranges
+ * (residual only), or solves for the sensor cold or warm-started from the
+ * previous packet, and for TDoA against the first anchor. Reported: CPU
+ * time per packet, Gauss-Newton iterations and the share of spoofed and
+ * honest reports whose residual exceeds `threshold` metres.
+ *
+ *   ./ns3 run "AquaSimBench --bench=multilateration --anchors=8 --packets=200000"
+ */
+namespace multilateration_bench {
+
+namespace {
+
+enum Mode { RESIDUAL, COLD, WARM, TDOA };
+
+struct Sample
+{
+  Vector real;
+  Vector reported;
+  std::vector<double> range;
+};
+
+void
+Run (const std::string &name, Mode mode, const std::vector<Vector> &anchors,
+     const std::vector<Sample> &packets, double threshold)
+{
+  typedef std::chrono::steady_clock Clock;
+  AquaSimMultilateration solver;
+  uint64_t iterations = 0;
+  uint32_t flagged[2] = {0, 0};
+  uint32_t n = packets.size ();
+  Clock::time_point start = Clock::now ();
+  for (uint32_t p = 0; p < n; p++)
+    {
+      const Sample &pkt = packets[p];
+      if (mode == COLD)
+        solver.Reset ();
+      else
+        solver.Clear ();
+      for (uint32_t i = 0; i < anchors.size (); i++)
+        {
+          if (mode == TDOA && i > 0)
+            solver.AddRangeDifference (anchors[i], anchors[0], pkt.range[i] - pkt.range[0]);
+          else if (mode != TDOA)
+            solver.AddRange (anchors[i], pkt.range[i]);
+        }
+      double residual;
+      if (mode == RESIDUAL)
+        residual = solver.Residual (pkt.reported);
+      else
+        {
+          solver.Solve ();
+          iterations += solver.GetIterations ();
+          residual = CalculateDistance (solver.GetEstimate (), pkt.reported);
+        }
+      flagged[p >= n / 2] += residual > threshold;
+    }
+  double wall = std::chrono::duration<double> (Clock::now () - start).count ();
+  std::cout << std::left << std::setw (28) << (name + "/" + std::to_string (anchors.size ()))
+            << std::right << std::setw (10) << std::fixed << std::setprecision (2)
+            << wall * 1e6 / n << " us"
+            << std::setw (10) << std::setprecision (2) << (double) iterations / n
+            << std::setw (10) << std::setprecision (3) << (double) flagged[1] / (n - n / 2)
+            << std::setw (10) << (double) flagged[0] / (n / 2) << "\n";
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  uint32_t anchors = 6;
+  uint32_t packets = 100000;
+  double noise = 1;
+  double spoof = 500;
+  double threshold = 50;
+
+  CommandLine cmd;
+  cmd.AddValue ("anchors", "Receivers measuring each packet", anchors);
+  cmd.AddValue ("packets", "Packets checked", packets);
+  cmd.AddValue ("noise", "Range error bound (m)", noise);
+  cmd.AddValue ("spoof", "Offset of spoofed reports (m)", spoof);
+  cmd.AddValue ("threshold", "Residual flagging a report (m)", threshold);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  std::vector<Vector> pos;
+  for (uint32_t i = 0; i < anchors; i++)
+    pos.push_back (Vector (rand->GetValue (0, 2000), rand->GetValue (0, 2000),
+                           i % 2 ? 0 : rand->GetValue (-900, -100)));
+
+  std::vector<Sample> stream (packets);
+  Vector sensor (1000, 1000, -500);
+  Vector velocity (1.5, 0, 0);
+  for (uint32_t p = 0; p < packets; p++)
+    {
+      if (p % 200 == 0)
+        {
+          double heading = rand->GetValue (0, 2 * M_PI);
+          velocity = Vector (1.5 * std::cos (heading), 1.5 * std::sin (heading), 0);
+        }
+      // one packet a second, kept inside the anchor field
+      sensor = sensor + velocity;
+      sensor.x = std::min (std::max (sensor.x, 200.0), 1800.0);
+      sensor.y = std::min (std::max (sensor.y, 200.0), 1800.0);
+      Sample &pkt = stream[p];
+      pkt.real = sensor;
+      pkt.reported = sensor;
+      if (p >= packets / 2)
+        pkt.reported.x += spoof;
+      for (uint32_t i = 0; i < anchors; i++)
+        pkt.range.push_back (CalculateDistance (sensor, pos[i]) + rand->GetValue (-noise, noise));
+    }
+
+  std::cout << std::left << std::setw (28) << "Benchmark" << std::right
+            << std::setw (13) << "Time/pkt" << std::setw (10) << "Iters"
+            << std::setw (10) << "Spoofed" << std::setw (10) << "Honest" << "\n"
+            << std::string (71, '-') << "\n";
+  Run ("BM_MlatResidual", RESIDUAL, pos, stream, threshold);
+  Run ("BM_MlatToaCold", COLD, pos, stream, threshold);
+  Run ("BM_MlatToaWarm", WARM, pos, stream, threshold);
+  Run ("BM_MlatTdoaWarm", TDOA, pos, stream, threshold);
+  return 0;
+}
+
+}  // namespace multilateration_bench
+
+/*
+ * Scheduler benchmark.
+ *
+ * Replays recorded aqua-sim event streams against each scheduler and
+ * reports replay throughput; every scheduler must hand the events back in
+ * the recorded order, and AquaSimAdaptiveScheduler shows what it picked. Without --traces a broadcast-MAC grid is simulated
+ * and recorded first. Any scenario can be recorded with
+ *
+ *   --SchedulerType=ns3::AquaSimRecordingScheduler
+ *   --ns3::AquaSimRecordingScheduler::File=uwsn.bin
+ *
+ * and replayed here:
+ *
+ *   ./ns3 run "AquaSimBench --bench=scheduler --traces=uwsn.bin"
+ *   ./ns3 run "AquaSimBench --bench=scheduler --nodes=100 --simStop=200"
+ */
+namespace scheduler_bench {
+
+namespace {
+
+typedef AquaSimRecordingScheduler::Record Record;
+
+/// Record a grid of broadcasting nodes into \p fileName.
+void
+RecordGrid (const std::string &fileName, uint32_t nNodes, double simStop)
+{
+  GlobalValue::Bind ("SchedulerType", StringValue ("ns3::AquaSimRecordingScheduler"));
+  Config::SetDefault ("ns3::AquaSimRecordingScheduler::File", StringValue (fileName));
+
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  PacketSocketHelper socketHelper;
+  socketHelper.Install (nodes);
+
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  asHelper.SetMac ("ns3::AquaSimBroadcastMac");
+  asHelper.SetRouting ("ns3::AquaSimRoutingDummy");
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (200), "DeltaY", DoubleValue (200),
+                                 "GridWidth", UintegerValue (10));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  NetDeviceContainer devices;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      devices.Add (asHelper.Create (*i, dev));
+    }
+
+  PacketSocketAddress socket;
+  socket.SetAllDevices ();
+  socket.SetPhysicalAddress (devices.Get (0)->GetAddress ());
+  socket.SetProtocol (0);
+  OnOffHelper app ("ns3::PacketSocketFactory", Address (socket));
+  app.SetAttribute ("OnTime", StringValue ("ns3::ExponentialRandomVariable[Mean=2]"));
+  app.SetAttribute ("OffTime", StringValue ("ns3::ExponentialRandomVariable[Mean=20]"));
+  app.SetAttribute ("DataRate", DataRateValue (DataRate (128)));
+  app.SetAttribute ("PacketSize", UintegerValue (40));
+  ApplicationContainer apps = app.Install (nodes);
+  apps.Start (Seconds (0.5));
+  apps.Stop (Seconds (simStop));
+
+  Simulator::Stop (Seconds (simStop + 1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SchedulerType", StringValue ("ns3::MapScheduler"));
+}
+
+/**
+ * Replay \p ops on a new scheduler from \p factory; returns the wall time,
+ * counts the events not handed back in the recorded order and, for
+ * AquaSimAdaptiveScheduler, reports what it chose.
+ */
+double
+Replay (const std::vector<Record> &ops, ObjectFactory factory, uint64_t &misordered,
+        std::string &choice)
+{
+  Ptr<Scheduler> events = factory.Create<Scheduler> ();
+  Scheduler::Event ev;
+  ev.impl = nullptr;   //never dereferenced by a scheduler
+  ev.key.m_context = 0;
+  misordered = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (const Record &op : ops)
+    {
+      switch (op.op)
+        {
+        case AquaSimRecordingScheduler::INSERT:
+          ev.key.m_ts = op.ts;
+          ev.key.m_uid = op.uid;
+          events->Insert (ev);
+          break;
+        case AquaSimRecordingScheduler::REMOVE_NEXT:
+          if (events->RemoveNext ().key.m_uid != op.uid)
+            misordered++;
+          break;
+        default:
+          ev.key.m_ts = op.ts;
+          ev.key.m_uid = op.uid;
+          events->Remove (ev);
+        }
+    }
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  Ptr<AquaSimAdaptiveScheduler> adaptive = DynamicCast<AquaSimAdaptiveScheduler> (events);
+  if (adaptive)
+    choice = adaptive->GetChoice ();
+  return wall;
+}
+
+std::vector<std::string>
+Split (const std::string &list)
+{
+  std::vector<std::string> items;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      if (!item.empty ())
+        items.push_back (item);
+    }
+  return items;
+}
+
+}  // namespace
+
+int
+Main (int argc, char *argv[])
+{
+  std::string traces;
+  std::string schedulers = "ns3::MapScheduler,ns3::HeapScheduler,ns3::ListScheduler,"
+                           "ns3::CalendarScheduler,ns3::PriorityQueueScheduler,"
+                           "ns3::AquaSimLadderScheduler,ns3::AquaSimAdaptiveScheduler";
+  uint32_t nNodes = 50;
+  double simStop = 100;
+  uint32_t repeat = 3;
+  uint64_t listLimit = 20000;
+
+  CommandLine cmd;
+  cmd.AddValue ("traces", "Comma separated event traces to replay (default: record a grid)", traces);
+  cmd.AddValue ("schedulers", "Comma separated scheduler TypeIds", schedulers);
+  cmd.AddValue ("nodes", "Nodes of the recorded grid", nNodes);
+  cmd.AddValue ("simStop", "Length of the recorded grid run (s)", simStop);
+  cmd.AddValue ("repeat", "Replays per scheduler; the fastest is reported", repeat);
+  cmd.AddValue ("listLimit", "Skip ListScheduler (O(n) inserts) above this queue length", listLimit);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> files = Split (traces);
+  if (files.empty ())
+    {
+      std::ostringstream name;
+      name << "scheduler-bench-grid-" << nNodes << ".bin";
+      files.push_back (name.str ());
+      std::cout << "recording " << files[0] << "\n";
+      RecordGrid (files[0], nNodes, simStop);
+    }
+
+  for (const std::string &file : files)
+    {
+      std::vector<Record> ops = AquaSimRecordingScheduler::Load (file);
+      uint64_t inserts = 0;
+      uint64_t queued = 0;
+      uint64_t sumQueued = 0;
+      uint64_t maxQueued = 0;
+      for (const Record &op : ops)
+        {
+          if (op.op == AquaSimRecordingScheduler::INSERT)
+            {
+              inserts++;
+              sumQueued += queued++;
+              maxQueued = std::max (maxQueued, queued);
+            }
+          else
+            queued--;
+        }
+      std::cout << file << ": " << ops.size () << " operations, " << inserts << " inserts, "
+                << "mean queue " << (inserts ? sumQueued / inserts : 0)
+                << ", max queue " << maxQueued << "\n";
+      std::cout << std::setw (34) << "scheduler" << std::setw (10) << "wall(s)"
+                << std::setw (10) << "Mops/s" << std::setw (10) << "vs first"
+                << std::setw (12) << "misordered" << "\n";
+
+      double first = 0;
+      for (const std::string &type : Split (schedulers))
+        {
+          if (type == "ns3::ListScheduler" && maxQueued > listLimit)
+            {
+              std::cout << std::setw (34) << type << "  skipped, queue over --listLimit\n";
+              continue;
+            }
+          ObjectFactory factory (type);
+          double best = 0;
+          uint64_t misordered = 0;
+          std::string choice;
+          for (uint32_t r = 0; r < std::max<uint32_t> (repeat, 1); r++)
+            {
+              double wall = Replay (ops, factory, misordered, choice);
+              best = (r == 0) ? wall : std::min (best, wall);
+            }
+          if (first == 0)
+            first = best;
+          std::cout << std::setw (34) << type
+                    << std::setw (10) << std::fixed << std::setprecision (3) << best
+                    << std::setw (10) << std::setprecision (2) << ops.size () / best / 1e6
+                    << std::setw (10) << first / best
+                    << std::setw (12) << misordered;
+          if (!choice.empty ())
+            std::cout << "  -> " << choice;
+          std::cout << "\n";
+        }
+    }
+  return 0;
+}
+
+}  // namespace scheduler_bench
+
+namespace {
+
+struct Bench
+{
+  const char *name;
+  int (*run) (int argc, char *argv[]);
+  const char *summary;
+};
+
+const Bench g_benches[] = {
+  { "spatial-index", &spatial_index_bench::Main, "Receiver lookup benchmark: full device-list scan vs AquaSimSpatialIndex" },
+  { "fanout", &fanout_bench::Main, "Channel fan-out benchmark" },
+  { "acoustic-batch", &acoustic_batch_bench::Main, "Microbenchmark of the scalar acoustic models against their batch forms" },
+  { "energy", &energy_bench::Main, "Idle energy accounting benchmark" },
+  { "pkt-table", &pkt_table_bench::Main, "Benchmark of the VBF and VBVA duplicate-suppression tables" },
+  { "dbr-queue", &dbr_queue_bench::Main, "Flooding-storm benchmark of the DBR sending queue" },
+  { "trumac-schedule", &trumac_schedule_bench::Main, "TR-MAC schedule rebuild benchmark" },
+  { "libra-table", &libra_table_bench::Main, "LIBRA forwarding-table microbenchmark" },
+  { "ndn-tables", &ndn_tables_bench::Main, "NDN forwarding-table benchmark" },
+  { "ids-detector", &ids_detector_bench::Main, "IDS detector benchmark" },
+  { "multilateration", &multilateration_bench::Main, "Multilateration benchmark" },
+  { "scheduler", &scheduler_bench::Main, "Scheduler benchmark" },
+};
+
+}  // namespace
+
+int
+main (int argc, char *argv[])
+{
+  /* --bench is taken out here; the benchmark parses everything else */
+  std::string bench;
+  std::vector<char *> args (argv, argv + argc);
+  for (std::vector<char *>::iterator it = args.begin () + 1; it != args.end (); ++it)
+    {
+      if (std::string (*it).compare (0, 8, "--bench=") == 0)
+        {
+          bench = *it + 8;
+          args.erase (it);
+          break;
+        }
+    }
+
+  for (const Bench &b : g_benches)
+    {
+      if (bench == b.name)
+        return b.run ((int) args.size (), args.data ());
+    }
+
+  if (!bench.empty ())
+    std::cerr << "unknown benchmark " << bench << "\n";
+  std::cout << "Usage: AquaSimBench --bench=<name> [options]\n\nBenchmarks:\n";
+  for (const Bench &b : g_benches)
+    std::cout << "  " << std::left << std::setw (18) << b.name << b.summary << "\n";
+  return bench.empty () ? 0 : 1;
+}
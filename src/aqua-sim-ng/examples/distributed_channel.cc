@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/aqua-sim-ng-module.h"
+
+#include <mpi.h>
+
+#include <iostream>
+#include <vector>
+
+/*
+ * Distributed channel example.
+ *
+ * A side x side grid (100 m spacing) split into one spatial shard per MPI
+ * rank; every node broadcasts a few times and each rank counts what its own
+ * nodes decode. The totals, reduced over all ranks, must not depend on the
+ * number of ranks:
+ *
+ *   mpirun -np 1 ./ns3.40-DistributedChannel-default
+ *   mpirun -np 4 ./ns3.40-DistributedChannel-default
+ *
+ * Receptions whose sender and receiver fall on different sides of a
+ * two-way split are counted apart ("crossing"): on two ranks these are
+ * exactly the remote deliveries, on one rank what the serial channel
+ * delivers across the same boundary, so the two runs must agree.
+ *
+ * With --test only the totals are printed, prefixed with TEST.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DistributedChannel");
+
+namespace {
+
+uint64_t g_received = 0;
+uint64_t g_checksum = 0;   //order independent digest of every reception
+uint64_t g_crossing = 0;   //receptions across the two-way split
+uint32_t g_side = 0;
+std::vector<uint32_t> g_half;   //two-way split of the grid, by node
+
+void
+Received (uint32_t node, Ptr<const Packet> p, double pr, Vector sender, Time delay)
+{
+  g_received++;
+  g_checksum += Simulator::Now ().GetTimeStep () + static_cast<uint64_t> (sender.x * 7 + sender.y * 13);
+  uint32_t from = static_cast<uint32_t> (sender.y / 100 + 0.5) * g_side
+    + static_cast<uint32_t> (sender.x / 100 + 0.5);
+  if (g_half[from] != g_half[node])
+    g_crossing++;
+}
+
+void
+Transmit (Ptr<AquaSimChannel> channel, Ptr<AquaSimNetDevice> dev, double range)
+{
+  Ptr<Packet> p = Create<Packet> (40);
+  MacHeader mach;
+  AquaSimHeader ash;
+  ash.SetSize (40);
+  ash.SetDirection (AquaSimHeader::DOWN);
+  AquaSimPacketStamp pstamp;
+  pstamp.SetPt (dev->GetPhy ()->GetPt ());
+  pstamp.SetFreq (dev->GetPhy ()->GetFrequency ());
+  pstamp.SetTxRange (range);
+  p->AddHeader (mach);
+  p->AddHeader (ash);
+  p->AddHeader (pstamp);
+  channel->Recv (p, dev->GetPhy ());
+}
+
+}  // namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t side = 16;
+  uint32_t packets = 5;
+  double range = 250;
+  bool testing = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("side", "Nodes per grid side", side);
+  cmd.AddValue ("packets", "Broadcasts per node", packets);
+  cmd.AddValue ("range", "Transmission range (m)", range);
+  cmd.AddValue ("test", "Print only the regression totals", testing);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (&argc, &argv);
+  uint32_t rank = MpiInterface::GetSystemId ();
+  uint32_t ranks = MpiInterface::GetSize ();
+
+  /* every rank builds the whole grid; the shard decides who owns a node */
+  std::vector<Vector> positions;
+  for (uint32_t i = 0; i < side * side; i++)
+    positions.push_back (Vector (100.0 * (i % side), 100.0 * (i / side), 0));
+  std::vector<uint32_t> shard = AquaSimMpiChannel::AssignShards (positions, ranks);
+  g_side = side;
+  g_half = AquaSimMpiChannel::AssignShards (positions, 2);
+
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < positions.size (); i++)
+    nodes.Add (CreateObject<Node> (shard[i]));
+
+  AquaSimChannelHelper channelHelper = AquaSimChannelHelper::Default ();
+  channelHelper.SetPropagation ("ns3::AquaSimRangePropagation");
+  channelHelper.SetChannel ("ns3::AquaSimMpiChannel");
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channelHelper.Create ());
+  Ptr<AquaSimMpiChannel> channel = DynamicCast<AquaSimMpiChannel> (asHelper.GetChannel ());
+
+  uint32_t local = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (positions[i]);
+      node->AggregateObject (mobility);
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      asHelper.Create (node, dev);
+      dev->MacEnabled (false);
+      if (node->GetSystemId () != rank)
+        continue;
+      local++;
+      dev->GetPhy ()->TraceConnectWithoutContext ("RxEnd", MakeBoundCallback (&Received, i));
+      for (uint32_t k = 0; k < packets; k++)
+        Simulator::ScheduleWithContext (node->GetId (), MilliSeconds (137 * i + 20011 * k),
+                                        &Transmit, channel, dev, range);
+    }
+  channel->UpdateShards ();
+
+  Simulator::Stop (Seconds (200));
+  Simulator::Run ();
+
+  if (!testing && ranks > 1)
+    std::cout << "rank " << rank << ": nodes " << local << " received " << g_received
+              << " lookahead " << channel->GetLookahead ().GetSeconds () * 1000 << " ms"
+              << " forwarded " << channel->GetForwardCount ()
+              << " pruned " << channel->GetPrunedCount ()
+              << " relayed-in " << channel->GetRemoteCount ()
+              << " late " << channel->GetLateCount () << std::endl;
+
+  uint64_t localTotals[3] = {g_received, g_checksum, g_crossing};
+  uint64_t totals[3];
+  MPI_Reduce (localTotals, totals, 3, MPI_UINT64_T, MPI_SUM, 0, MpiInterface::GetCommunicator ());
+  if (rank == 0)
+    std::cout << (testing ? "TEST " : "") << "received " << totals[0]
+              << " checksum " << totals[1] << " crossing " << totals[2] << std::endl;
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+}
@@ -0,0 +1,327 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+#include "aqua-sim-dataset-writer.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimDatasetWriter");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimDatasetWriter);
+
+namespace {
+
+/* the binary layout is little-endian whatever the host byte order */
+void
+PutLe (char *p, uint64_t v, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    p[i] = (char) (v >> (8 * i));
+}
+
+void
+AppendLe (std::string &out, uint64_t v, int bytes)
+{
+  size_t off = out.size ();
+  out.resize (off + bytes);
+  PutLe (&out[off], v, bytes);
+}
+
+uint64_t
+Bits (double v)
+{
+  uint64_t u;
+  std::memcpy (&u, &v, sizeof (u));
+  return u;
+}
+
+}  // namespace
+
+TypeId
+AquaSimDatasetWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimDatasetWriter")
+    .SetParent<Object> ()
+    .AddConstructor<AquaSimDatasetWriter> ()
+    .AddAttribute ("Format", "Output format.",
+      EnumValue (AquaSimDatasetWriter::CSV),
+      MakeEnumAccessor (&AquaSimDatasetWriter::m_format),
+      MakeEnumChecker (AquaSimDatasetWriter::CSV, "Csv",
+                       AquaSimDatasetWriter::BINARY, "Binary"))
+    .AddAttribute ("BufferRows", "Rows held in memory before a flush (one row group in Binary).",
+      UintegerValue (4096),
+      MakeUintegerAccessor (&AquaSimDatasetWriter::m_capacity),
+      MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FlushInterval", "Flush once this much simulation time has passed since the last flush. 0 disables.",
+      TimeValue (Seconds (0)),
+      MakeTimeAccessor (&AquaSimDatasetWriter::m_flushInterval),
+      MakeTimeChecker ())
+    .AddTraceSource ("Committed", "A row was committed; the argument is the row count.",
+      MakeTraceSourceAccessor (&AquaSimDatasetWriter::m_commitTrace),
+      "ns3::AquaSimDatasetWriter::CommitTracedCallback")
+  ;
+  return tid;
+}
+
+AquaSimDatasetWriter::AquaSimDatasetWriter () :
+  m_format (CSV),
+  m_capacity (4096),
+  m_flushInterval (Seconds (0)),
+  m_rows (0),
+  m_total (0),
+  m_flushes (0),
+  m_lastFlush (Seconds (0)),
+  m_closeScheduled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimDatasetWriter::~AquaSimDatasetWriter ()
+{
+}
+
+void
+AquaSimDatasetWriter::AddColumn (const std::string &name, ColumnType type)
+{
+  NS_LOG_FUNCTION (this << name << type);
+  NS_ASSERT_MSG (!m_out.is_open (), "columns must be declared before Open");
+  NS_ASSERT_MSG (name.size () < 256, "column name too long");
+  m_names.push_back (name);
+  m_types.push_back (type);
+}
+
+uint32_t
+AquaSimDatasetWriter::GetNColumns (void) const
+{
+  return m_names.size ();
+}
+
+void
+AquaSimDatasetWriter::Open (const std::string &fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  NS_ASSERT_MSG (!m_out.is_open (), "writer already open");
+  NS_ASSERT_MSG (!m_names.empty (), "no columns declared");
+
+  m_out.open (fileName.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_out.is_open (), "cannot open dataset file " << fileName);
+  m_fileName = fileName;
+
+  m_buffer.assign ((size_t) m_capacity * m_names.size (), 0);
+  m_row.assign (m_names.size (), 0);
+  m_rows = 0;
+  m_total = 0;
+  m_flushes = 0;
+  m_lastFlush = Simulator::Now ();
+  WriteHeader ();
+
+  /* a writer reopened before Simulator::Destroy is closed by the first registration */
+  if (!m_closeScheduled)
+    {
+      Simulator::ScheduleDestroy (&AquaSimDatasetWriter::DestroyClose, Ptr<AquaSimDatasetWriter> (this));
+      m_closeScheduled = true;
+    }
+}
+
+bool
+AquaSimDatasetWriter::IsOpen (void) const
+{
+  return m_out.is_open ();
+}
+
+void
+AquaSimDatasetWriter::WriteHeader (void)
+{
+  if (m_format == CSV)
+    {
+      for (uint32_t c = 0; c < m_names.size (); c++)
+        {
+          m_out << (c ? "," : "") << m_names[c];
+        }
+      m_out << "\n";
+      return;
+    }
+
+  m_text.assign ("ASDS", 4);
+  AppendLe (m_text, 1, 4);
+  AppendLe (m_text, m_names.size (), 4);
+  AppendLe (m_text, 0, 4);
+  for (uint32_t c = 0; c < m_names.size (); c++)
+    {
+      AppendLe (m_text, m_types[c], 1);
+      AppendLe (m_text, m_names[c].size (), 1);
+      m_text.append (m_names[c]);
+    }
+  m_text.resize ((m_text.size () + 7) / 8 * 8, 0);
+  m_out.write (m_text.data (), m_text.size ());
+}
+
+void
+AquaSimDatasetWriter::Set (uint32_t col, double value)
+{
+  NS_ASSERT (col < m_row.size ());
+  m_row[col] = value;
+}
+
+void
+AquaSimDatasetWriter::Commit (void)
+{
+  NS_ASSERT_MSG (m_out.is_open (), "writer not open");
+  for (uint32_t c = 0; c < m_row.size (); c++)
+    {
+      m_buffer[(size_t) c * m_capacity + m_rows] = m_row[c];
+    }
+  m_rows++;
+  m_total++;
+
+  if (m_rows == m_capacity
+      || (m_flushInterval.IsStrictlyPositive ()
+          && Simulator::Now () - m_lastFlush >= m_flushInterval))
+    {
+      Flush ();
+    }
+  m_commitTrace (m_total);
+}
+
+void
+AquaSimDatasetWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this << m_rows);
+  m_lastFlush = Simulator::Now ();
+  if (!m_out.is_open ())
+    return;
+
+  if (m_rows > 0)
+    {
+      if (m_format == CSV)
+        WriteCsv ();
+      else
+        WriteRowGroup ();
+      m_rows = 0;
+      m_flushes++;
+    }
+  m_out.flush ();   //header included, nothing left for a forked child
+}
+
+void
+AquaSimDatasetWriter::Branch (const std::string &fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  NS_ASSERT_MSG (m_out.is_open (), "writer not open");
+  Flush ();
+  m_out.close ();
+
+  std::ifstream prefix (m_fileName.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (prefix.is_open (), "cannot read dataset file " << m_fileName);
+  m_out.open (fileName.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_out.is_open (), "cannot open dataset file " << fileName);
+  m_out << prefix.rdbuf ();   //never empty: the header is always there
+  m_fileName = fileName;
+}
+
+void
+AquaSimDatasetWriter::WriteCsv (void)
+{
+  char num[32];
+  m_text.clear ();
+  for (uint32_t r = 0; r < m_rows; r++)
+    {
+      for (uint32_t c = 0; c < m_names.size (); c++)
+        {
+          double v = m_buffer[(size_t) c * m_capacity + r];
+          int len = (m_types[c] == INT64)
+            ? std::snprintf (num, sizeof (num), "%lld", (long long) v)
+            : std::snprintf (num, sizeof (num), "%.17g", v);
+          if (c)
+            m_text.push_back (',');
+          m_text.append (num, len);
+        }
+      m_text.push_back ('\n');
+    }
+  m_out.write (m_text.data (), m_text.size ());
+}
+
+void
+AquaSimDatasetWriter::WriteRowGroup (void)
+{
+  m_text.resize (8 * (1 + (size_t) m_rows * m_names.size ()));
+  char *p = &m_text[0];
+  PutLe (p, m_rows, 8);
+  p += 8;
+  for (uint32_t c = 0; c < m_names.size (); c++)
+    {
+      const double *col = &m_buffer[(size_t) c * m_capacity];
+      if (m_types[c] == FLOAT64)
+        for (uint32_t r = 0; r < m_rows; r++, p += 8)
+          PutLe (p, Bits (col[r]), 8);
+      else
+        for (uint32_t r = 0; r < m_rows; r++, p += 8)
+          PutLe (p, (uint64_t) (int64_t) col[r], 8);
+    }
+  m_out.write (m_text.data (), m_text.size ());
+}
+
+void
+AquaSimDatasetWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_out.is_open ())
+    return;
+  Flush ();
+  m_out.close ();
+}
+
+void
+AquaSimDatasetWriter::DestroyClose (void)
+{
+  m_closeScheduled = false;
+  Close ();
+}
+
+uint64_t
+AquaSimDatasetWriter::GetRowCount (void) const
+{
+  return m_total;
+}
+
+uint32_t
+AquaSimDatasetWriter::GetFlushCount (void) const
+{
+  return m_flushes;
+}
+
+void
+AquaSimDatasetWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  m_buffer.clear ();
+  m_text.clear ();
+  Object::DoDispose ();
+}
+
+}  // namespace ns3
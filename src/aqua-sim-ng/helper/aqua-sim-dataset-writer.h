@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_DATASET_WRITER_H
+#define AQUA_SIM_DATASET_WRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Buffered writer for per-event datasets (e.g. one row per "RxEnd").
+ *
+ * Rows are appended into a fixed-capacity, column-major buffer of
+ * BufferRows rows. The buffer is written out when it is full, when a row is
+ * committed FlushInterval or more after the previous flush, and when the
+ * writer is closed. Close is scheduled automatically on Simulator::Destroy.
+ * No simulator events are scheduled, so attaching a writer does not change
+ * the event trace.
+ *
+ * Two formats are supported:
+ *  - Csv: a header line with the column names, then one line per row.
+ *  - Binary: a little-endian row-group file:
+ *
+ *      magic "ASDS" | u32 version (1) | u32 ncols | u32 reserved
+ *      ncols x { u8 type (0 = float64, 1 = int64) | u8 name length | name }
+ *      zero padding to a multiple of 8 bytes
+ *      row groups until EOF:
+ *        u64 nrows | ncols x { nrows x 8-byte values }
+ *
+ *    Every value is 8-byte aligned, so each column of a row group can be
+ *    mapped without copying, e.g. numpy.frombuffer(mm, '<f8', nrows, off).
+ */
+class AquaSimDatasetWriter : public Object
+{
+public:
+  enum Format
+  {
+    CSV,
+    BINARY
+  };
+  enum ColumnType
+  {
+    FLOAT64 = 0,
+    INT64 = 1
+  };
+
+  /// Signature of the Committed trace: the rows committed so far.
+  typedef void (* CommitTracedCallback) (uint64_t rows);
+
+  static TypeId GetTypeId (void);
+  AquaSimDatasetWriter ();
+  virtual ~AquaSimDatasetWriter ();
+
+  /// Declare a column; all columns must be added before Open.
+  void AddColumn (const std::string &name, ColumnType type = FLOAT64);
+  uint32_t GetNColumns (void) const;
+
+  /// Create \p fileName (truncating it) and write the header.
+  void Open (const std::string &fileName);
+  /// Flush the buffered rows and close the file. Safe to call twice.
+  void Close (void);
+  bool IsOpen (void) const;
+
+  /**
+   * Set column \p col of the row being built. Integer columns are stored
+   * as doubles until written, so they are exact up to 2^53.
+   */
+  void Set (uint32_t col, double value);
+  /// Append the row being built and start a new one.
+  void Commit (void);
+  /// Write all buffered rows out now.
+  void Flush (void);
+  /**
+   * Continue in \p fileName, which starts as a copy of everything written
+   * so far; the current file is left as it is. Meant for a child after
+   * fork(): the parent must Flush() before forking so that no buffered
+   * output is inherited by several processes.
+   */
+  void Branch (const std::string &fileName);
+
+  uint64_t GetRowCount (void) const;
+  uint32_t GetFlushCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void WriteHeader (void);
+  void WriteCsv (void);
+  void WriteRowGroup (void);
+  void DestroyClose (void);
+
+  Format m_format;
+  uint32_t m_capacity;
+  Time m_flushInterval;
+
+  std::ofstream m_out;
+  std::string m_fileName;
+  std::vector<std::string> m_names;
+  std::vector<ColumnType> m_types;
+  std::vector<double> m_buffer;  // column-major, m_capacity rows per column
+  std::vector<double> m_row;
+  std::string m_text;    // encoded output of one flush
+  uint32_t m_rows;
+  uint64_t m_total;
+  uint32_t m_flushes;
+  Time m_lastFlush;
+  bool m_closeScheduled;  // Close registered with Simulator::ScheduleDestroy
+
+  /// Fired at the end of every Commit with the row count.
+  TracedCallback<uint64_t> m_commitTrace;
+};  // class AquaSimDatasetWriter
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_DATASET_WRITER_H */
@@ -30,9 +30,11 @@
 #include "ns3/aqua-sim-address.h"
 #include "ns3/application.h"
 #include "ns3/aqua-sim-sinr-checker.h"
+#include "ns3/aqua-sim-signal-cache.h"
 
 #include "aqua-sim-helper.h"
 
+#include <set>
 #include <sstream>
 #include <string>
 
@@ -376,6 +378,30 @@ AquaSimHelper::SetAttackModel (std::string type,
   m_attackM = factory;
 }
 
+void
+AquaSimHelper::SetSignalCache (std::string type,
+                                              std::string n0, const AttributeValue &v0,
+                                              std::string n1, const AttributeValue &v1,
+                                              std::string n2, const AttributeValue &v2,
+                                              std::string n3, const AttributeValue &v3,
+                                              std::string n4, const AttributeValue &v4,
+                                              std::string n5, const AttributeValue &v5,
+                                              std::string n6, const AttributeValue &v6,
+                                              std::string n7, const AttributeValue &v7)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  factory.Set (n0,v0);
+  factory.Set (n1,v1);
+  factory.Set (n2,v2);
+  factory.Set (n3,v3);
+  factory.Set (n4,v4);
+  factory.Set (n5,v5);
+  factory.Set (n6,v6);
+  factory.Set (n7,v7);
+  m_signalCache = factory;
+}
+
 void
 AquaSimHelper::SetMacAttribute (std::string name, const AttributeValue &value)
 {
@@ -395,6 +421,8 @@ AquaSimHelper::Create(Ptr<Node> node, Ptr<AquaSimNetDevice> device)
   Ptr<AquaSimThresholdSinrChecker> sinr = m_sinrChecker.Create<AquaSimThresholdSinrChecker>();
 
   device->SetPhy(phy);
+  if (m_signalCache.IsTypeIdSet())
+    phy->SetSignalCache(m_signalCache.Create<AquaSimSignalCache>());
   device->SetMac(mac);
   //device->SetMac(mac,sync,loc);
   device->SetRouting(routing);
@@ -433,6 +461,8 @@ AquaSimHelper::CreateWithoutRouting(Ptr<Node> node, Ptr<AquaSimNetDevice> device
   Ptr<AquaSimThresholdSinrChecker> sinr = m_sinrChecker.Create<AquaSimThresholdSinrChecker>();
 
   device->SetPhy(phy);
+  if (m_signalCache.IsTypeIdSet())
+    phy->SetSignalCache(m_signalCache.Create<AquaSimSignalCache>());
   device->SetMac(mac);
   //device->SetMac(mac,sync,loc);
   device->ConnectLayers();
@@ -499,19 +529,27 @@ AquaSimHelper::EnableAsciiAll (std::ostream &os)
   EnableAscii(os, NodeContainer::GetGlobal());
 }
 
-uint64_t AssignStreams (NetDeviceContainer c, int64_t stream)
+uint64_t
+AquaSimHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
 {
   int64_t currentStream = stream;
-    Ptr<NetDevice> device;
-    for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+  std::set<Ptr<AquaSimChannel> > channels;
+  Ptr<NetDevice> device;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
       device = (*i);
       Ptr<AquaSimNetDevice> asDevice = DynamicCast<AquaSimNetDevice> (device);
       if (asDevice)
-      {
-        currentStream += asDevice->GetPhy ()->AssignStreams (currentStream);
-        currentStream += asDevice->GetMac ()->AssignStreams (currentStream);
-      }
+        {
+          currentStream += asDevice->GetPhy ()->AssignStreams (currentStream);
+          currentStream += asDevice->GetMac ()->AssignStreams (currentStream);
+          if (asDevice->GetRouting ())
+            currentStream += asDevice->GetRouting ()->AssignStreams (currentStream);
+          Ptr<AquaSimChannel> channel = asDevice->DoGetChannel ();
+          /* a channel is shared by its devices, fix its streams once */
+          if (channel && channels.insert (channel).second)
+            currentStream += channel->AssignStreams (currentStream);
+        }
     }
   return (currentStream - stream);
 }
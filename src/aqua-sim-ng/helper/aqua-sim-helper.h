@@ -150,6 +150,16 @@ public:
  			     std::string n5 = "", const AttributeValue &v5 = EmptyAttributeValue (),
  			     std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
  			     std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
+   /* Phy keeps its own AquaSimSignalCache unless this is called */
+   void SetSignalCache (std::string name,
+ 			     std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+ 			     std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+ 			     std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+ 			     std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
+ 			     std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue (),
+ 			     std::string n5 = "", const AttributeValue &v5 = EmptyAttributeValue (),
+ 			     std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
+ 			     std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
     Ptr<AquaSimNetDevice> Create (Ptr<Node> node, Ptr<AquaSimNetDevice> device);
     Ptr<AquaSimNetDevice> CreateWithoutRouting (Ptr<Node> node, Ptr<AquaSimNetDevice> device);
     void SetMacAttribute (std::string name, const AttributeValue &value);
@@ -160,6 +170,7 @@ public:
     static void EnableAscii (std::ostream &os, NodeContainer n);
     static void EnableAsciiAll (std::ostream &os);
 
+    /// Fix the random streams of the phy, mac, routing and channel of \p c.
     uint64_t AssignStreams (NetDeviceContainer c, int64_t stream);
 
 private:
@@ -173,6 +184,7 @@ private:
   ObjectFactory m_attackM;
   bool m_attacker;  //default is false
   ObjectFactory m_sinrChecker;
+  ObjectFactory m_signalCache;
 };  //class AquaSimHelper
 
 }
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/map-scheduler.h"
+
+#include "aqua-sim-adaptive-scheduler.h"
+#include "aqua-sim-ladder-scheduler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimAdaptiveScheduler");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimAdaptiveScheduler);
+
+TypeId
+AquaSimAdaptiveScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimAdaptiveScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("AquaSimNG")
+    .AddConstructor<AquaSimAdaptiveScheduler> ()
+    .AddAttribute ("Observe", "Scheduler operations observed, from the first event executed, before choosing.",
+      UintegerValue (10000),
+      MakeUintegerAccessor (&AquaSimAdaptiveScheduler::m_observe),
+      MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RemoveShare", "Removals per insert from which a large queue stays on MapScheduler.",
+      DoubleValue (0.05),
+      MakeDoubleAccessor (&AquaSimAdaptiveScheduler::m_removeShare),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("LargeQueue", "Mean queue length from which removals decide the choice.",
+      DoubleValue (256),
+      MakeDoubleAccessor (&AquaSimAdaptiveScheduler::m_largeQueue),
+      MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+AquaSimAdaptiveScheduler::AquaSimAdaptiveScheduler () :
+  m_events (CreateObject<MapScheduler> ()),
+  m_observe (10000),
+  m_removeShare (0.05),
+  m_largeQueue (256),
+  m_running (false),
+  m_ops (0),
+  m_inserts (0),
+  m_removes (0),
+  m_queued (0),
+  m_sumQueued (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimAdaptiveScheduler::~AquaSimAdaptiveScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+AquaSimAdaptiveScheduler::Insert (const Scheduler::Event &ev)
+{
+  if (m_choice.empty ())
+    {
+      if (m_running)
+        {
+          m_inserts++;
+          m_sumQueued += m_queued;
+        }
+      m_queued++;
+      Count ();
+    }
+  m_events->Insert (ev);
+}
+
+bool
+AquaSimAdaptiveScheduler::IsEmpty (void) const
+{
+  return m_events->IsEmpty ();
+}
+
+Scheduler::Event
+AquaSimAdaptiveScheduler::PeekNext (void) const
+{
+  return m_events->PeekNext ();
+}
+
+Scheduler::Event
+AquaSimAdaptiveScheduler::RemoveNext (void)
+{
+  if (m_choice.empty ())
+    {
+      m_running = true;
+      m_queued--;
+      Count ();
+    }
+  return m_events->RemoveNext ();
+}
+
+void
+AquaSimAdaptiveScheduler::Remove (const Scheduler::Event &ev)
+{
+  if (m_choice.empty ())
+    {
+      m_removes += m_running;
+      m_queued--;
+      Count ();
+    }
+  m_events->Remove (ev);
+}
+
+void
+AquaSimAdaptiveScheduler::Count (void)
+{
+  // set-up inserts say little about the run: count from the first event
+  // on. Chosen before the operation is applied, so it lands on the new list.
+  if (m_running && ++m_ops >= m_observe)
+    Choose ();
+}
+
+void
+AquaSimAdaptiveScheduler::Choose (void)
+{
+  Ptr<Scheduler> chosen;
+  if (GetRemoveShare () >= m_removeShare && GetMeanQueue () >= m_largeQueue)
+    {
+      m_choice = "ns3::MapScheduler";
+    }
+  else
+    {
+      m_choice = "ns3::AquaSimLadderScheduler";
+      chosen = CreateObject<AquaSimLadderScheduler> ();
+    }
+  NS_LOG_INFO ("mean queue " << GetMeanQueue () << ", removals per insert " << GetRemoveShare ()
+               << " over " << m_ops << " operations: " << m_choice);
+  if (chosen == nullptr)
+    return;
+
+  while (!m_events->IsEmpty ())
+    {
+      chosen->Insert (m_events->RemoveNext ());
+    }
+  m_events = chosen;
+}
+
+std::string
+AquaSimAdaptiveScheduler::GetChoice (void) const
+{
+  return m_choice;
+}
+
+double
+AquaSimAdaptiveScheduler::GetMeanQueue (void) const
+{
+  return m_inserts ? (double) m_sumQueued / m_inserts : 0;
+}
+
+double
+AquaSimAdaptiveScheduler::GetRemoveShare (void) const
+{
+  return m_inserts ? (double) m_removes / m_inserts : 0;
+}
+
+}  // namespace ns3
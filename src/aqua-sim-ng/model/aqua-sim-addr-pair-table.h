@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_ADDR_PAIR_TABLE_H
+#define AQUA_SIM_ADDR_PAIR_TABLE_H
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+#include "aqua-sim-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Flat hash table keyed by an ordered pair of addresses.
+ *
+ * Both 16-bit addresses are packed into one 32-bit key and stored with the
+ * value in a single open-addressing array (linear probing, at most half
+ * full, backward-shift deletion), so a lookup is a hash and a short probe
+ * over contiguous slots with no allocation. Pointers returned by Find and
+ * Insert stay valid until the next Insert or Erase.
+ */
+template <typename T>
+class AquaSimAddrPairTable
+{
+public:
+  AquaSimAddrPairTable (void);
+
+  /// Value of (\p a, \p b), or 0 if none is held.
+  T *Find (AquaSimAddress a, AquaSimAddress b);
+  /// Value of (\p a, \p b), default-constructed if new (\p created is set).
+  T *Insert (AquaSimAddress a, AquaSimAddress b, bool &created);
+  bool Erase (AquaSimAddress a, AquaSimAddress b);
+  void Clear (void);
+
+  uint32_t GetN (void) const { return m_n; }
+
+private:
+  struct Slot {
+    uint32_t key;
+    bool used;
+    T value;
+  };
+
+  static uint32_t Pack (AquaSimAddress a, AquaSimAddress b)
+  {
+    return ((uint32_t) a.GetAsInt () << 16) | b.GetAsInt ();
+  }
+  uint32_t Home (uint32_t key) const
+  {
+    return (key * 2654435769u) >> m_shift;
+  }
+  void Grow (void);
+
+  std::vector<Slot> m_slots;
+  uint32_t m_mask;
+  uint32_t m_shift;
+  uint32_t m_n;
+};
+
+template <typename T>
+AquaSimAddrPairTable<T>::AquaSimAddrPairTable (void)
+  : m_slots (16),
+    m_mask (15),
+    m_shift (28),
+    m_n (0)
+{
+}
+
+template <typename T>
+T *
+AquaSimAddrPairTable<T>::Find (AquaSimAddress a, AquaSimAddress b)
+{
+  uint32_t key = Pack (a, b);
+  for (uint32_t i = Home (key); m_slots[i].used; i = (i + 1) & m_mask)
+    {
+      if (m_slots[i].key == key)
+        {
+          return &m_slots[i].value;
+        }
+    }
+  return 0;
+}
+
+template <typename T>
+T *
+AquaSimAddrPairTable<T>::Insert (AquaSimAddress a, AquaSimAddress b, bool &created)
+{
+  created = false;
+  uint32_t key = Pack (a, b);
+  uint32_t i = Home (key);
+  for (; m_slots[i].used; i = (i + 1) & m_mask)
+    {
+      if (m_slots[i].key == key)
+        {
+          return &m_slots[i].value;
+        }
+    }
+  if (2 * (m_n + 1) > m_slots.size ())
+    {
+      Grow ();
+      for (i = Home (key); m_slots[i].used; i = (i + 1) & m_mask)
+        {
+        }
+    }
+  m_slots[i].key = key;
+  m_slots[i].used = true;
+  m_slots[i].value = T ();
+  m_n++;
+  created = true;
+  return &m_slots[i].value;
+}
+
+template <typename T>
+bool
+AquaSimAddrPairTable<T>::Erase (AquaSimAddress a, AquaSimAddress b)
+{
+  uint32_t key = Pack (a, b);
+  uint32_t i = Home (key);
+  for (; m_slots[i].used && m_slots[i].key != key; i = (i + 1) & m_mask)
+    {
+    }
+  if (!m_slots[i].used)
+    {
+      return false;
+    }
+
+  /* shift later members of the probe run back over the hole */
+  uint32_t j = i;
+  for (;;)
+    {
+      j = (j + 1) & m_mask;
+      if (!m_slots[j].used)
+        {
+          break;
+        }
+      uint32_t home = Home (m_slots[j].key);
+      /* j may fill i only if its home is not cyclically in (i, j] */
+      if (((j - home) & m_mask) >= ((j - i) & m_mask))
+        {
+          m_slots[i] = m_slots[j];
+          i = j;
+        }
+    }
+  m_slots[i].used = false;
+  m_slots[i].value = T ();
+  m_n--;
+  return true;
+}
+
+template <typename T>
+void
+AquaSimAddrPairTable<T>::Clear (void)
+{
+  m_slots.assign (16, Slot ());
+  m_mask = 15;
+  m_shift = 28;
+  m_n = 0;
+}
+
+template <typename T>
+void
+AquaSimAddrPairTable<T>::Grow (void)
+{
+  std::vector<Slot> old (2 * m_slots.size ());
+  old.swap (m_slots);
+  m_mask = m_slots.size () - 1;
+  m_shift--;
+  for (uint32_t k = 0; k < old.size (); k++)
+    {
+      if (!old[k].used)
+        {
+          continue;
+        }
+      uint32_t i = Home (old[k].key);
+      for (; m_slots[i].used; i = (i + 1) & m_mask)
+        {
+        }
+      m_slots[i] = old[k];
+    }
+}
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Next-hop weights of one forwarding entry, sorted by address.
+ *
+ * The first few weights are stored inline and only larger sets spill to
+ * the heap, so a table slot holding a typical entry is self-contained.
+ */
+class AquaSimNextHopWeights
+{
+public:
+  AquaSimNextHopWeights (void) : m_n (0) {}
+
+  uint32_t GetN (void) const { return m_n; }
+  AquaSimAddress GetAddress (uint32_t i) const { return AquaSimAddress (Data ()[i].addr); }
+  double GetWeight (uint32_t i) const { return Data ()[i].weight; }
+
+  /// Weight of \p addr, or 0 if it is not a next hop.
+  double *Find (AquaSimAddress addr)
+  {
+    Entry *e = LowerBound (addr.GetAsInt ());
+    return (e != Data () + m_n && e->addr == addr.GetAsInt ()) ? &e->weight : 0;
+  }
+  /// Add \p addr with weight \p w; returns false, leaving it as is, if present.
+  bool Add (AquaSimAddress addr, double w)
+  {
+    uint16_t a = addr.GetAsInt ();
+    uint32_t pos = LowerBound (a) - Data ();
+    if (pos < m_n && Data ()[pos].addr == a)
+      {
+        return false;
+      }
+    Entry e = {a, w};
+    if (m_n < INLINE)
+      {
+        std::copy_backward (m_inline + pos, m_inline + m_n, m_inline + m_n + 1);
+        m_inline[pos] = e;
+      }
+    else
+      {
+        if (m_n == INLINE)
+          {
+            m_heap.assign (m_inline, m_inline + INLINE);
+          }
+        m_heap.insert (m_heap.begin () + pos, e);
+      }
+    m_n++;
+    return true;
+  }
+
+private:
+  enum { INLINE = 4 };
+  struct Entry {
+    uint16_t addr;
+    double weight;
+  };
+  static bool AddrLess (const Entry &e, uint16_t a) { return e.addr < a; }
+
+  Entry *Data (void) { return m_n <= INLINE ? m_inline : &m_heap[0]; }
+  const Entry *Data (void) const { return m_n <= INLINE ? m_inline : &m_heap[0]; }
+  Entry *LowerBound (uint16_t a)
+  {
+    return std::lower_bound (Data (), Data () + m_n, a, AddrLess);
+  }
+
+  uint32_t m_n;
+  Entry m_inline[INLINE];
+  std::vector<Entry> m_heap;
+};
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_ADDR_PAIR_TABLE_H */
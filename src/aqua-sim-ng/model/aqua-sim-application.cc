@@ -122,7 +122,8 @@ AquaSimApplication::AssignStreams (int64_t stream)
   NS_LOG_FUNCTION (this << stream);
   m_onTime->SetStream (stream);
   m_offTime->SetStream (stream + 1);
-  return 2;
+  m_rand->SetStream (stream + 2);
+  return 3;
 }
 
 void
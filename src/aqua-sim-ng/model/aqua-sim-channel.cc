@@ -23,10 +23,12 @@
 #include "ns3/pointer.h"
 #include "ns3/simulator.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 
 #include "aqua-sim-channel.h"
 #include "aqua-sim-header.h"
 #include "aqua-sim-header-routing.h"
+#include "aqua-sim-rx-info-tag.h"
 
 #include <cstdio>
 #include <fstream>
@@ -38,7 +40,10 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("AquaSimChannel");
 NS_OBJECT_ENSURE_REGISTERED (AquaSimChannel);
 
-AquaSimChannel::AquaSimChannel ()
+AquaSimChannel::AquaSimChannel () :
+  m_useSpatialIndex(false),
+  m_usePositionSnapshot(false),
+  m_lateCount(0)
 {
   NS_LOG_FUNCTION(this);
   m_deviceList.clear();
@@ -51,6 +56,24 @@ AquaSimChannel::~AquaSimChannel ()
 {
 }
 
+uint64_t
+AquaSimChannel::GetLateCount (void) const
+{
+  return m_lateCount;
+}
+
+int64_t
+AquaSimChannel::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  int64_t currentStream = stream;
+  if (m_noiseGen)
+    currentStream += m_noiseGen->AssignStreams (currentStream);
+  if (m_prop)
+    currentStream += m_prop->AssignStreams (currentStream);
+  return (currentStream - stream);
+}
+
 TypeId
 AquaSimChannel::GetTypeId ()
 {
@@ -65,6 +88,14 @@ AquaSimChannel::GetTypeId ()
        PointerValue (0),
        MakePointerAccessor (&AquaSimChannel::m_noiseGen),
        MakePointerChecker<AquaSimNoiseGen> ())
+    .AddAttribute ("SpatialIndex", "Pre-filter receivers with a 3-D grid when the propagation model is range limited.",
+       BooleanValue (false),
+       MakeBooleanAccessor (&AquaSimChannel::m_useSpatialIndex),
+       MakeBooleanChecker ())
+    .AddAttribute ("PositionSnapshot", "Sample all node positions once per timestamp and share them across transmissions.",
+       BooleanValue (false),
+       MakeBooleanAccessor (&AquaSimChannel::m_usePositionSnapshot),
+       MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -83,6 +114,8 @@ AquaSimChannel::SetPropagation (Ptr<AquaSimPropagation> prop)
   NS_LOG_FUNCTION(this);
   NS_ASSERT (prop);
   m_prop = prop;
+  if (m_snapshot)
+    m_prop->SetPositionSnapshot(m_snapshot);
 }
 
 Ptr<NetDevice>
@@ -109,6 +142,10 @@ AquaSimChannel::AddDevice (Ptr<AquaSimNetDevice> device)
 {
   NS_LOG_FUNCTION(this);
   m_deviceList.push_back(device);
+  if (m_spatialIndex)
+    m_spatialIndex->Invalidate();
+  if (m_snapshot)
+    m_snapshot->Invalidate();
 }
 
 void
@@ -128,6 +165,10 @@ AquaSimChannel::RemoveDevice(Ptr<AquaSimNetDevice> device)
           }
       }
   }
+  if (m_spatialIndex)
+    m_spatialIndex->Invalidate();
+  if (m_snapshot)
+    m_snapshot->Invalidate();
 }
 
 bool
@@ -139,16 +180,15 @@ AquaSimChannel::Recv(Ptr<Packet> p, Ptr<AquaSimPhy> phy)
 
   NS_LOG_FUNCTION(this << p << phy);
   NS_ASSERT(p != NULL || phy != NULL);
-  return SendUp(p,phy);
+  return SendUp(p, phy->GetNetDevice(), Seconds(0));
 }
 
 bool
-AquaSimChannel::SendUp (Ptr<Packet> p, Ptr<AquaSimPhy> tifp)
+AquaSimChannel::SendUp (Ptr<Packet> p, Ptr<AquaSimNetDevice> sender, Time elapsed)
 {
   NS_LOG_FUNCTION(this);
-  NS_LOG_DEBUG("Packet:" << p << " Phy:" << tifp << " Channel:" << this);
+  NS_LOG_DEBUG("Packet:" << p << " Sender:" << sender << " Channel:" << this);
 
-  Ptr<AquaSimNetDevice> sender = Ptr<AquaSimNetDevice>(tifp->GetNetDevice());
   Ptr<AquaSimNetDevice> recver;
   //std::vector<Ptr<AquaSimPhy> > rifp;	//must support multiple recv phy in future
   Ptr<AquaSimPhy> rifp;
@@ -160,52 +200,98 @@ AquaSimChannel::SendUp (Ptr<Packet> p, Ptr<AquaSimPhy> tifp)
   }
   */
 
-  std::vector<PktRecvUnit> * recvUnits = m_prop->ReceivedCopies(sender, p, m_deviceList);
+  if (m_usePositionSnapshot)
+    {
+      if (!m_snapshot)
+        {
+          m_snapshot = CreateObject<AquaSimPositionSnapshot>();
+          m_prop->SetPositionSnapshot(m_snapshot);
+        }
+      m_snapshot->Update(m_deviceList);
+    }
+
+  AquaSimPacketStamp pstamp;
+  p->PeekHeader(pstamp);
+  if (m_useSpatialIndex && m_prop->IsRangeLimited() && pstamp.GetTxRange() > 0)
+    {
+      if (!m_spatialIndex)
+        m_spatialIndex = CreateObject<AquaSimSpatialIndex>();
+      m_spatialIndex->GetCandidates(GetPosition(sender),
+                                    pstamp.GetTxRange(), m_deviceList, m_candidates);
+      m_prop->ReceivedCopies(sender, p, m_candidates, m_recvUnits);
+    }
+  else
+    m_prop->ReceivedCopies(sender, p, m_deviceList, m_recvUnits);
+
+  /*
+   * Strip the stamp and header once from a (copy-on-write) duplicate, so the
+   * sender's packet is left untouched and each receiver's copy only has its
+   * own per-link values added on top.
+   */
+  Ptr<Packet> bare = p->Copy();
+  AquaSimHeader asHeader;
+  bare->RemoveHeader(pstamp);
+  bare->RemoveHeader(asHeader);
+  asHeader.SetDirection(AquaSimHeader::UP);
+  AquaSimRxInfoTag rxInfo;
+  bare->RemovePacketTag(rxInfo);  //stale tag of a forwarded packet
+  rxInfo.SetSenderPosition(GetPosition(sender));
 
   allPktCounter++;  //Debug... remove
-  for (std::vector<PktRecvUnit>::size_type i = 0; i < recvUnits->size(); i++) {
+  for (std::vector<PktRecvUnit>::const_iterator it = m_recvUnits.begin(); it != m_recvUnits.end(); ++it) {
     allRecvPktCounter++;  //Debug .. remove
-    if (sender == (*recvUnits)[i].recver)
+    if (sender == it->recver)
     {
       continue;
     }
 
     //TODO remove ... this is a local addition for flooding_test.
-    if (FLOODING_TEST && (Distance(sender, (*recvUnits)[i].recver) > Distance((*recvUnits)[0].recver,(*recvUnits)[1].recver)*1.25/*arbitrary*/))
+    if (FLOODING_TEST && (Distance(sender, it->recver) > Distance(m_recvUnits[0].recver,m_recvUnits[1].recver)*1.25/*arbitrary*/))
       {
-        NS_LOG_DEBUG("Channel:SendUp: FloodTest(OutOfRange): sender(" << sender->GetAddress() << ") recver:(" <<  (*recvUnits)[i].recver->GetAddress() << ") dist(" << Distance(sender, (*recvUnits)[i].recver) << ")");
+        NS_LOG_DEBUG("Channel:SendUp: FloodTest(OutOfRange): sender(" << sender->GetAddress() << ") recver:(" <<  it->recver->GetAddress() << ") dist(" << Distance(sender, it->recver) << ")");
         continue;
       }
 
     sentPktCounter++; //Debug... remove
 
-    recver = (*recvUnits)[i].recver;
-    pDelay = GetPropDelay(sender, (*recvUnits)[i].recver);
-    //pDelay = (*recvUnits)[i].pDelay;
+    recver = it->recver;
+    pDelay = it->pDelay;  //the model's own (link-cached) delay, not the nominal-speed one
+    Time delay = pDelay - elapsed;
+    if (delay.IsStrictlyNegative())
+      {
+        /* the receiver strayed out of its shard region; deliver now rather
+         * than in the past and let the caller see how often it happened */
+        NS_LOG_WARN("relayed packet reached node " << recver->GetNode()->GetId()
+                    << " " << (elapsed - pDelay) << " before it was delivered; a node left its shard region");
+        m_lateCount++;
+        delay = Seconds(0);
+      }
     rifp = recver->GetPhy();
     //rifp = recver->ifhead().lh_first;
 
-    AquaSimPacketStamp pstamp;
-    AquaSimHeader asHeader;
-    p->RemoveHeader(pstamp);
-    p->RemoveHeader(asHeader);
-
-    pstamp.SetPr((*recvUnits)[i].pR);
-    pstamp.SetNoise(m_noiseGen->Noise((Simulator::Now() + pDelay), (GetMobilityModel(recver)->GetPosition())));
-    asHeader.SetDirection(AquaSimHeader::UP);
+    pstamp.SetPr(it->pR);
+    pstamp.SetNoise(m_noiseGen->Noise((Simulator::Now() - elapsed + pDelay), GetPosition(recver)));
     asHeader.SetTxTime(pDelay);
 
-    p->AddHeader(asHeader);
-    p->AddHeader(pstamp);
-
     /**
      * Send to each interface a copy, and we will filter the packet
      * in physical layer according to freq and modulation
      */
-    NS_LOG_DEBUG ("Channel. NodeS:" << sender->GetAddress() << " NodeR:" << recver->GetAddress() << " S.Phy:" << sender->GetPhy() << " R.Phy:" << recver->GetPhy() << " packet:" << p
+    Ptr<Packet> copy = bare->Copy();
+    copy->AddHeader(asHeader);
+    copy->AddHeader(pstamp);
+    rxInfo.SetPr(it->pR);
+    rxInfo.SetPropDelay(pDelay);
+    copy->AddPacketTag(rxInfo);
+
+    NS_LOG_DEBUG ("Channel. NodeS:" << sender->GetAddress() << " NodeR:" << recver->GetAddress() << " S.Phy:" << sender->GetPhy() << " R.Phy:" << recver->GetPhy() << " packet:" << copy
 		  << " TxTime:" << asHeader.GetTxTime() << pDelay);
 
-    Simulator::Schedule(pDelay, &AquaSimPhy::Recv, rifp, p->Copy());
+    if (elapsed.IsStrictlyPositive())
+      Simulator::ScheduleWithContext(recver->GetNode()->GetId(), delay,
+                                     &AquaSimPhy::Recv, rifp, copy);
+    else
+      Simulator::Schedule(pDelay, &AquaSimPhy::Recv, rifp, copy);
 
     /* TODO in future support multiple phy with below code.
      *
@@ -217,8 +303,8 @@ AquaSimChannel::SendUp (Ptr<Packet> p, Ptr<AquaSimPhy> tifp)
      */
   }
 
+  m_recvUnits.clear();  //keeps capacity, drops the receiver refs
   p = 0; //smart pointer will unref automatically once out of scope
-  delete recvUnits;
   return true;
 }
 
@@ -315,6 +401,22 @@ AquaSimChannel::GetMobilityModel(Ptr<AquaSimNetDevice> device)
   return model;
 }
 
+Vector
+AquaSimChannel::GetPosition(Ptr<AquaSimNetDevice> device)
+{
+  Ptr<MobilityModel> model = GetMobilityModel(device);
+  Vector pos;
+  if (m_snapshot && m_snapshot->GetPosition(PeekPointer(model), pos))
+    return pos;
+  return model->GetPosition();
+}
+
+Ptr<AquaSimPositionSnapshot>
+AquaSimChannel::GetPositionSnapshot (void) const
+{
+  return m_snapshot;
+}
+
 Ptr<AquaSimNoiseGen>
 AquaSimChannel::GetNoiseGen()
 {
@@ -330,6 +432,18 @@ AquaSimChannel::DoDispose()
       *iter = 0;
     }
   m_deviceList.clear();
+  m_candidates.clear();
+  m_recvUnits.clear();
+  if (m_spatialIndex)
+    {
+      m_spatialIndex->Dispose();
+      m_spatialIndex=0;
+    }
+  if (m_snapshot)
+    {
+      m_snapshot->Dispose();
+      m_snapshot=0;
+    }
   m_noiseGen=0;
   m_prop=0;
 }
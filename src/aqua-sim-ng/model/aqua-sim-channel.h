@@ -28,6 +28,8 @@
 #include "aqua-sim-net-device.h"
 #include "aqua-sim-propagation.h"
 #include "aqua-sim-noise-generator.h"
+#include "aqua-sim-spatial-index.h"
+#include "aqua-sim-position-snapshot.h"
 
 namespace ns3 {
 
@@ -35,6 +37,7 @@ class AquaSimNetDevice;
 class AquaSimPhy;
 class Packet;
 class AquaSimPropagation;
+struct PktRecvUnit;
 
 /**
  * \ingroup aqua-sim-ng
@@ -67,19 +70,30 @@ public:
   uint32_t GetId (void) const;
   virtual size_t GetNDevices (void) const;
   Ptr<AquaSimNoiseGen> GetNoiseGen();
+  /// Node positions at the last transmission, null unless PositionSnapshot is set.
+  Ptr<AquaSimPositionSnapshot> GetPositionSnapshot (void) const;
+  /// Relayed receptions whose propagation delay had already passed on arrival.
+  uint64_t GetLateCount (void) const;
+  /// Fix the random streams of the noise generator and propagation model.
+  int64_t AssignStreams (int64_t stream);
 
   /// Incoming packet from specified phy layer (device)
-  bool Recv(Ptr<Packet>, Ptr<AquaSimPhy>);
+  virtual bool Recv(Ptr<Packet>, Ptr<AquaSimPhy>);
 
   void PrintCounters();
   void FilePrintCounters(double,int);
 
-private:
-  /// Outgoing packet to speicified phy layer (device)
-  bool SendUp (Ptr<Packet> p, Ptr<AquaSimPhy> tifp);
+protected:
+  /**
+   * Outgoing packet to every listening phy layer (device). \p elapsed is how
+   * long ago \p sender started the transmission; it is nonzero only for
+   * transmissions relayed from another process (see AquaSimMpiChannel).
+   */
+  bool SendUp (Ptr<Packet> p, Ptr<AquaSimNetDevice> sender, Time elapsed);
 
   Time GetPropDelay (Ptr<AquaSimNetDevice> tdevice, Ptr<AquaSimNetDevice> rdevice);
   Ptr<MobilityModel> GetMobilityModel(Ptr<AquaSimNetDevice> device);
+  Vector GetPosition(Ptr<AquaSimNetDevice> device);
   double Distance(Ptr<AquaSimNetDevice> tdevice, Ptr<AquaSimNetDevice> rdevice);
 	/* For list-keeper, channel keeps list of mobilenodes
 	   listening on to it */
@@ -104,6 +118,15 @@ protected:
   Ptr<AquaSimPropagation> m_prop;
   Ptr<AquaSimNoiseGen> m_noiseGen;
   std::vector<Ptr<AquaSimNetDevice> > m_deviceList;
+
+  bool m_useSpatialIndex;
+  Ptr<AquaSimSpatialIndex> m_spatialIndex;
+  std::vector<Ptr<AquaSimNetDevice> > m_candidates;  //receivers handed to m_prop
+  std::vector<PktRecvUnit> m_recvUnits;  //reused by every SendUp
+
+  bool m_usePositionSnapshot;
+  Ptr<AquaSimPositionSnapshot> m_snapshot;
+  uint64_t m_lateCount;
 };  // class AquaSimChannel
 
 } // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aqua-sim-ddos-model.h"
+
+#include "ns3/log.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimDdosModel");
+
+AquaSimDdosModel::AquaSimDdosModel (double lambda, uint32_t minSamples)
+  : m_lambda (lambda),
+    m_minSamples (minSamples),
+    m_samples (0),
+    m_positives (0),
+    m_snapshotAt (0)
+{
+  m_w[0] = m_w[1] = m_w[2] = 0;
+}
+
+AquaSimDdosModel::~AquaSimDdosModel ()
+{
+  WaitSnapshot ();
+}
+
+std::shared_ptr<AquaSimDdosModel>
+AquaSimDdosModel::GetShared (double lambda, uint32_t minSamples)
+{
+  static std::weak_ptr<AquaSimDdosModel> shared;
+  std::shared_ptr<AquaSimDdosModel> model = shared.lock ();
+  if (!model)
+    {
+      model = std::make_shared<AquaSimDdosModel> (lambda, minSamples);
+      shared = model;
+    }
+  return model;
+}
+
+void
+AquaSimDdosModel::Learn (const SvmInput &sample)
+{
+  double x[3] = {sample.timeoutR, sample.maxR, 1};
+  double y = sample.compromised ? 1 : -1;
+  m_samples++;
+  m_positives += sample.compromised;
+
+  double eta = 1 / (m_lambda * m_samples);
+  double margin = y * (m_w[0] * x[0] + m_w[1] * x[1] + m_w[2] * x[2]);
+  double norm = 0;
+  for (int i = 0; i < 3; i++)
+    {
+      m_w[i] *= 1 - eta * m_lambda;
+      if (margin < 1)
+        m_w[i] += eta * y * x[i];
+      norm += m_w[i] * m_w[i];
+    }
+  // project back onto the ball holding the optimum
+  double radius = 1 / std::sqrt (m_lambda);
+  if (norm > radius * radius)
+    {
+      double scale = radius / std::sqrt (norm);
+      for (int i = 0; i < 3; i++)
+        m_w[i] *= scale;
+    }
+}
+
+bool
+AquaSimDdosModel::IsTrained (void) const
+{
+  return m_samples >= m_minSamples && m_positives > 0 && m_positives < m_samples;
+}
+
+double
+AquaSimDdosModel::Decision (double timeoutR, double maxR) const
+{
+  return m_w[0] * timeoutR + m_w[1] * maxR + m_w[2];
+}
+
+void
+AquaSimDdosModel::Classify (const std::vector<SvmInput> &batch, std::vector<double> &labels) const
+{
+  labels.resize (batch.size ());
+  const double w0 = m_w[0], w1 = m_w[1], b = m_w[2];
+  for (size_t i = 0; i < batch.size (); i++)
+    labels[i] = (w0 * batch[i].timeoutR + w1 * batch[i].maxR + b > 0) ? 1 : 0;
+}
+
+bool
+AquaSimDdosModel::Write (std::string file, double w0, double w1, double b)
+{
+  FILE *fp = fopen (file.c_str (), "w");
+  if (fp == NULL)
+    return false;
+  /* decision of libsvm: coef * K(sv, x) - rho, positive votes for the first label */
+  fprintf (fp, "svm_type c_svc\nkernel_type linear\nnr_class 2\ntotal_sv 1\n"
+           "rho %.17g\nlabel 1 0\nnr_sv 1 0\nSV\n1 0:%.17g 1:%.17g \n", -b, w0, w1);
+  return fclose (fp) == 0;
+}
+
+bool
+AquaSimDdosModel::Snapshot (const std::string &file)
+{
+  if (m_samples == m_snapshotAt)
+    return false;
+  if (!WaitSnapshot ())
+    NS_LOG_WARN ("Not able to save SVM model to file");
+  m_snapshotAt = m_samples;
+  m_snapshot = std::async (std::launch::async, &AquaSimDdosModel::Write, file, m_w[0], m_w[1], m_w[2]);
+  return true;
+}
+
+bool
+AquaSimDdosModel::WaitSnapshot (void)
+{
+  if (!m_snapshot.valid ())
+    return true;
+  return m_snapshot.get ();
+}
+
+}  // namespace ns3
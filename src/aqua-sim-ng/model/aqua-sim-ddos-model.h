@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_DDOS_MODEL_H
+#define AQUA_SIM_DDOS_MODEL_H
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct SvmInput{
+  double timeoutR;
+  double maxR;  //largest ratio of pushback and throttle
+  bool compromised;
+  SvmInput(double t_, double m_, bool c_) : timeoutR(t_), maxR(m_), compromised(c_) {}
+};
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Linear SVM for AquaSimDDOS, trained online.
+ *
+ * Each labelled sample takes one Pegasos step (stochastic sub-gradient
+ * descent on the hinge loss with L2 weight lambda; the bias is a constant
+ * feature), so training costs O(1) per sample instead of a libsvm retrain
+ * over the whole table. The model counts as trained once it has seen
+ * minSamples samples of both classes.
+ *
+ * Detectors in one simulation share a model through GetShared(); it is
+ * released with the last holder. Snapshot() writes the model in libsvm
+ * format (one support vector holding the weights) on a worker thread.
+ */
+class AquaSimDdosModel
+{
+public:
+  AquaSimDdosModel (double lambda, uint32_t minSamples);
+  ~AquaSimDdosModel ();
+
+  static std::shared_ptr<AquaSimDdosModel> GetShared (double lambda, uint32_t minSamples);
+
+  void Learn (const SvmInput &sample);
+  bool IsTrained (void) const;
+  double Decision (double timeoutR, double maxR) const;
+  /// Label (1 compromised, 0 not) of every entry of batch, into labels.
+  void Classify (const std::vector<SvmInput> &batch, std::vector<double> &labels) const;
+
+  /// Start writing the model to file unless it is unchanged since the last
+  /// snapshot; returns true if a write was started.
+  bool Snapshot (const std::string &file);
+  /// Block until the last snapshot is on disk; false if it failed.
+  bool WaitSnapshot (void);
+
+  uint64_t GetNSamples (void) const { return m_samples; }
+  double GetWeight (uint32_t i) const { return m_w[i]; }
+  double GetBias (void) const { return m_w[2]; }
+
+private:
+  static bool Write (std::string file, double w0, double w1, double b);
+
+  double m_lambda;
+  uint32_t m_minSamples;
+  double m_w[3];          // timeoutR, maxR, bias
+  uint64_t m_samples;
+  uint64_t m_positives;
+  uint64_t m_snapshotAt;  // m_samples at the last snapshot
+  std::future<bool> m_snapshot;
+};  // class AquaSimDdosModel
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_DDOS_MODEL_H */
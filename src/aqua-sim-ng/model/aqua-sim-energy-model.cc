@@ -18,6 +18,8 @@
  * Author: Robert Martin <robert.martin@engr.uconn.edu>
  */
 
+#include <algorithm>
+
 #include "ns3/energy-source.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
@@ -190,9 +192,16 @@ AquaSimEnergyModel::GetIdlePower()
   return m_idleP;
 }
 double
-AquaSimEnergyModel::GetEnergy()
+AquaSimEnergyModel::GetEnergy() const
 {
-  return m_energy;
+  /* idle drain since the last state change is only settled on state
+   * changes; a query projects it without touching the model */
+  double idle = 0;
+  if (m_device && m_device->GetPhy())
+    idle = m_device->GetPhy()->GetUnsettledIdleTime();
+  if (idle <= 0 || m_energy <= 0)
+    return m_energy;
+  return std::max(0.0, m_energy - idle * m_idleP);
 }
 double
 AquaSimEnergyModel::GetInitialEnergy()
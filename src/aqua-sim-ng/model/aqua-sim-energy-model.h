@@ -75,7 +75,7 @@ public:
   double GetRxPower(void);
   double GetTxPower(void);
   double GetIdlePower(void);
-  double GetEnergy(void);
+  double GetEnergy(void) const;
   double GetInitialEnergy(void);
   ///To be called after an event occurs
   void DecrIdleEnergy(double t);
@@ -24,6 +24,7 @@
 
 #include "ns3/log.h"
 #include "ns3/buffer.h"
+#include <cmath>
 
 using namespace ns3;
 
@@ -840,18 +841,19 @@ void
 LocalizationHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
-  i.WriteU32 ((uint32_t)(m_nodePosition.x*1000.0));
-  i.WriteU32 ((uint32_t)(m_nodePosition.y*1000.0));
-  i.WriteU32 ((uint32_t)(m_nodePosition.z*1000.0));
+  //signed: depths are usually negative
+  i.WriteU32 ((uint32_t)(int32_t)std::lround(m_nodePosition.x*1000.0));
+  i.WriteU32 ((uint32_t)(int32_t)std::lround(m_nodePosition.y*1000.0));
+  i.WriteU32 ((uint32_t)(int32_t)std::lround(m_nodePosition.z*1000.0));
   i.WriteU32 ((uint32_t)(m_confidence*1000.0));
 }
 uint32_t
 LocalizationHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_nodePosition.x = ( (double) i.ReadU32() ) / 1000.0;
-  m_nodePosition.y = ( (double) i.ReadU32() ) / 1000.0;
-  m_nodePosition.z = ( (double) i.ReadU32() ) / 1000.0;
+  m_nodePosition.x = ( (double)(int32_t) i.ReadU32() ) / 1000.0;
+  m_nodePosition.y = ( (double)(int32_t) i.ReadU32() ) / 1000.0;
+  m_nodePosition.z = ( (double)(int32_t) i.ReadU32() ) / 1000.0;
   m_confidence = ((double) i.ReadU32())/1000.0;
 
   return GetSerializedSize();
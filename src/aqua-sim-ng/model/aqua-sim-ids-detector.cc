@@ -0,0 +1,412 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/trace-source-accessor.h"
+
+#include "aqua-sim-ids-detector.h"
+#include "aqua-sim-net-device.h"
+#include "aqua-sim-phy.h"
+#include "aqua-sim-mac.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimIdsDetector");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimIdsDetector);
+
+AquaSimIdsReception::AquaSimIdsReception ()
+  : nodeId (0),
+    label (-1),
+    rssi (0),
+    score (0),
+    alert (false)
+{
+  std::fill (features, features + AquaSimIdsModel::N_FEATURES, 0.0);
+}
+
+AquaSimIdsDetector::Sender::Sender ()
+  : last (Seconds (-1)),
+    gapMean (0),
+    gapVar (0),
+    gaps (0),
+    firstAnomaly (Seconds (-1)),
+    firstAlert (Seconds (-1))
+{
+}
+
+TypeId
+AquaSimIdsDetector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimIdsDetector")
+    .SetParent<Object> ()
+    .AddConstructor<AquaSimIdsDetector> ()
+    .AddAttribute ("Model", "Model scoring the feature batches.",
+      PointerValue (),
+      MakePointerAccessor (&AquaSimIdsDetector::m_model),
+      MakePointerChecker<AquaSimIdsModel> ())
+    .AddAttribute ("TxPower", "Transmit power of the senders (PHY PT).",
+      DoubleValue (20),
+      MakeDoubleAccessor (&AquaSimIdsDetector::m_pT),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("Frequency", "Carrier frequency of the senders (kHz).",
+      DoubleValue (25),
+      MakeDoubleAccessor (&AquaSimIdsDetector::m_freq),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("SoundSpeed", "Sound speed assumed for delay ranging (m/s).",
+      DoubleValue (1500),
+      MakeDoubleAccessor (&AquaSimIdsDetector::m_speed),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("GapWeight", "Weight of a new gap in the per-sender inter-arrival averages.",
+      DoubleValue (0.1),
+      MakeDoubleAccessor (&AquaSimIdsDetector::m_gapWeight),
+      MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("BatchSize", "Rows scored together.",
+      UintegerValue (32),
+      MakeUintegerAccessor (&AquaSimIdsDetector::m_batchSize),
+      MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BatchInterval", "Longest a row waits for its batch to fill.",
+      TimeValue (Seconds (1)),
+      MakeTimeAccessor (&AquaSimIdsDetector::m_batchInterval),
+      MakeTimeChecker ())
+    .AddAttribute ("Threshold", "Scores above this raise an alert.",
+      DoubleValue (0),
+      MakeDoubleAccessor (&AquaSimIdsDetector::m_threshold),
+      MakeDoubleChecker<double> ())
+    .AddAttribute ("Learn", "Train the model on labelled rows after scoring them.",
+      BooleanValue (true),
+      MakeBooleanAccessor (&AquaSimIdsDetector::m_learn),
+      MakeBooleanChecker ())
+    .AddTraceSource ("Scored", "A reception was scored.",
+      MakeTraceSourceAccessor (&AquaSimIdsDetector::m_scoredTrace),
+      "ns3::AquaSimIdsDetector::ReceptionTracedCallback")
+    .AddTraceSource ("Alert", "A reception scored above the threshold.",
+      MakeTraceSourceAccessor (&AquaSimIdsDetector::m_alertTrace),
+      "ns3::AquaSimIdsDetector::ReceptionTracedCallback")
+  ;
+  return tid;
+}
+
+AquaSimIdsDetector::AquaSimIdsDetector ()
+  : m_pT (20),
+    m_freq (25),
+    m_speed (1500),
+    m_gapWeight (0.1),
+    m_batchSize (32),
+    m_batchInterval (Seconds (1)),
+    m_threshold (0),
+    m_learn (true),
+    m_macConfirm (false),
+    m_pendingUid (0),
+    m_pendingRssi (0),
+    m_pending (false),
+    m_receptions (0),
+    m_batches (0),
+    m_alerts (0),
+    m_tp (0),
+    m_fp (0),
+    m_fn (0),
+    m_queueDelay (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimIdsDetector::~AquaSimIdsDetector ()
+{
+}
+
+void
+AquaSimIdsDetector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_flushEvent);
+  m_queue.clear ();
+  m_senders.clear ();
+  m_model = 0;
+  m_sink = 0;
+  m_report = MakeNullCallback<bool, Ptr<const Packet>, AquaSimIdsReception &> ();
+  Object::DoDispose ();
+}
+
+void
+AquaSimIdsDetector::SetModel (Ptr<AquaSimIdsModel> model)
+{
+  m_model = model;
+}
+
+Ptr<AquaSimIdsModel>
+AquaSimIdsDetector::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+AquaSimIdsDetector::SetReportCallback (ReportCallback report)
+{
+  m_report = report;
+}
+
+void
+AquaSimIdsDetector::SetSinkMobility (Ptr<MobilityModel> sink)
+{
+  m_sink = sink;
+}
+
+void
+AquaSimIdsDetector::Attach (Ptr<AquaSimNetDevice> sink)
+{
+  NS_LOG_FUNCTION (this << sink);
+  NS_ABORT_MSG_IF (m_report.IsNull (), "AquaSimIdsDetector needs a report callback");
+  SetSinkMobility (sink->GetNode ()->GetObject<MobilityModel> ());
+  bool connected = sink->GetPhy ()->TraceConnectWithoutContext ("RxEnd",
+      MakeCallback (&AquaSimIdsDetector::RxEnd, this));
+  NS_ABORT_MSG_UNLESS (connected, "sink PHY has no RxEnd trace source");
+  m_macConfirm = sink->MacEnabled () && sink->GetMac ()
+      && sink->GetMac ()->TraceConnectWithoutContext ("RoutingRx",
+          MakeCallback (&AquaSimIdsDetector::MacRx, this));
+}
+
+void
+AquaSimIdsDetector::RxEnd (Ptr<const Packet> p, double rssi, Vector senderPos, Time propDelay)
+{
+  if (!m_macConfirm)
+    {
+      Receive (p, rssi, propDelay);
+      return;
+    }
+  m_pending = true;
+  m_pendingUid = p->GetUid ();
+  m_pendingRssi = rssi;
+  m_pendingDelay = propDelay;
+}
+
+void
+AquaSimIdsDetector::MacRx (Ptr<const Packet> p)
+{
+  if (!m_pending || p->GetUid () != m_pendingUid)
+    return;
+  m_pending = false;
+  Receive (p, m_pendingRssi, m_pendingDelay);
+}
+
+void
+AquaSimIdsDetector::Receive (Ptr<const Packet> p, double rssi, Time propDelay)
+{
+  AquaSimIdsReception rx;
+  if (!m_report (p, rx))
+    return;
+  rx.rssi = rssi;
+  rx.propDelay = propDelay;
+  Process (rx);
+}
+
+double
+AquaSimIdsDetector::RssiRange (double rssi) const
+{
+  if (rssi <= 0 || rssi >= m_pT)
+    return 0;
+  double f2 = m_freq * m_freq;
+  double thorp = 0.11 * f2 / (1 + f2) + 44 * f2 / (4100 + f2) + 0.000275 * f2 + 0.0003;
+  double c = thorp * M_LN10 / 10000.0;
+  // solve 2u + c e^u = ln(pT/pR) for u = ln d; convex and increasing, so
+  // Newton from the absorption-free root (to the right) never overshoots
+  double l = std::log (m_pT / rssi);
+  double u = l / 2;
+  for (int i = 0; i < 20; i++)
+    {
+      double e = c * std::exp (u);
+      double step = (2 * u + e - l) / (2 + e);
+      u -= step;
+      if (std::fabs (step) < 1e-9)
+        break;
+    }
+  return std::exp (u);
+}
+
+void
+AquaSimIdsDetector::Features (AquaSimIdsReception &rx)
+{
+  double *x = rx.features;
+  Vector sink = m_sink ? m_sink->GetPosition () : Vector ();
+  double range = CalculateDistance (rx.reportedPos, sink);
+  x[AquaSimIdsModel::DELAY_RESIDUAL] = std::fabs (range - m_speed * rx.propDelay.GetSeconds ());
+  x[AquaSimIdsModel::RSSI_RESIDUAL] = std::fabs (range - RssiRange (rx.rssi));
+
+  Sender &s = m_senders[rx.nodeId];
+  x[AquaSimIdsModel::INTER_ARRIVAL_Z] = 0;
+  x[AquaSimIdsModel::REPORTED_SPEED] = 0;
+  if (!s.last.IsNegative ())
+    {
+      double gap = (rx.recvTime - s.last).GetSeconds ();
+      if (s.gaps > 1)
+        x[AquaSimIdsModel::INTER_ARRIVAL_Z] =
+            std::fabs (gap - s.gapMean) / std::sqrt (s.gapVar + 1e-6);
+      if (gap > 0)
+        x[AquaSimIdsModel::REPORTED_SPEED] = CalculateDistance (rx.reportedPos, s.lastPos) / gap;
+
+      // exponentially weighted mean and variance of the gaps
+      if (s.gaps++ == 0)
+        s.gapMean = gap;
+      else
+        {
+          double diff = gap - s.gapMean;
+          double incr = m_gapWeight * diff;
+          s.gapMean += incr;
+          s.gapVar = (1 - m_gapWeight) * (s.gapVar + diff * incr);
+        }
+    }
+  s.last = rx.recvTime;
+  s.lastPos = rx.reportedPos;
+  if (rx.label == 1 && s.firstAnomaly.IsNegative ())
+    s.firstAnomaly = rx.sendTime;
+}
+
+void
+AquaSimIdsDetector::Process (const AquaSimIdsReception &rx)
+{
+  NS_LOG_FUNCTION (this << rx.nodeId);
+  m_queue.push_back (rx);
+  AquaSimIdsReception &q = m_queue.back ();
+  q.recvTime = Simulator::Now ();
+  Features (q);
+  m_x.insert (m_x.end (), q.features, q.features + AquaSimIdsModel::N_FEATURES);
+  m_receptions++;
+
+  if (m_queue.size () >= m_batchSize)
+    Flush ();
+  else if (!m_flushEvent.IsRunning ())
+    m_flushEvent = Simulator::Schedule (m_batchInterval, &AquaSimIdsDetector::Flush, this);
+}
+
+void
+AquaSimIdsDetector::Flush (void)
+{
+  Simulator::Cancel (m_flushEvent);
+  uint32_t n = m_queue.size ();
+  if (n == 0)
+    return;
+  NS_ASSERT_MSG (m_model, "AquaSimIdsDetector has no model");
+  NS_LOG_FUNCTION (this << n);
+
+  m_scores.resize (n);
+  m_model->Score (&m_x[0], n, &m_scores[0]);
+  m_batches++;
+
+  Time now = Simulator::Now ();
+  m_trainX.clear ();
+  m_trainY.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      AquaSimIdsReception &rx = m_queue[i];
+      rx.score = m_scores[i];
+      rx.alert = rx.score > m_threshold;
+      m_queueDelay += now - rx.recvTime;
+      if (rx.label >= 0)
+        {
+          m_tp += rx.alert && rx.label == 1;
+          m_fp += rx.alert && rx.label == 0;
+          m_fn += !rx.alert && rx.label == 1;
+          m_trainX.insert (m_trainX.end (), rx.features,
+                           rx.features + AquaSimIdsModel::N_FEATURES);
+          m_trainY.push_back (rx.label);
+        }
+      m_scoredTrace (rx);
+      if (rx.alert)
+        {
+          m_alerts++;
+          Sender &s = m_senders[rx.nodeId];
+          if (s.firstAlert.IsNegative () && !s.firstAnomaly.IsNegative ())
+            s.firstAlert = now;
+          m_alertTrace (rx);
+        }
+    }
+  m_queue.clear ();
+  m_x.clear ();
+
+  if (m_learn && !m_trainY.empty ())
+    m_model->Learn (&m_trainX[0], &m_trainY[0], m_trainY.size ());
+}
+
+uint64_t
+AquaSimIdsDetector::GetNReceptions (void) const
+{
+  return m_receptions;
+}
+
+uint64_t
+AquaSimIdsDetector::GetNBatches (void) const
+{
+  return m_batches;
+}
+
+uint64_t
+AquaSimIdsDetector::GetNAlerts (void) const
+{
+  return m_alerts;
+}
+
+uint64_t
+AquaSimIdsDetector::GetTruePositives (void) const
+{
+  return m_tp;
+}
+
+uint64_t
+AquaSimIdsDetector::GetFalsePositives (void) const
+{
+  return m_fp;
+}
+
+uint64_t
+AquaSimIdsDetector::GetFalseNegatives (void) const
+{
+  return m_fn;
+}
+
+Time
+AquaSimIdsDetector::GetMeanQueueDelay (void) const
+{
+  uint64_t scored = m_receptions - m_queue.size ();
+  return scored ? m_queueDelay / scored : Seconds (0);
+}
+
+Time
+AquaSimIdsDetector::GetMeanDetectionLatency (uint32_t &detected) const
+{
+  detected = 0;
+  Time sum = Seconds (0);
+  for (std::unordered_map<uint32_t, Sender>::const_iterator it = m_senders.begin ();
+       it != m_senders.end (); ++it)
+    {
+      if (it->second.firstAlert.IsNegative ())
+        continue;
+      sum += it->second.firstAlert - it->second.firstAnomaly;
+      detected++;
+    }
+  return detected ? sum / detected : Seconds (0);
+}
+
+}  // namespace ns3
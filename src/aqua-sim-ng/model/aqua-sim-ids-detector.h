@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_IDS_DETECTOR_H
+#define AQUA_SIM_IDS_DETECTOR_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+#include "ns3/mobility-model.h"
+
+#include "aqua-sim-ids-model.h"
+
+namespace ns3 {
+
+class AquaSimNetDevice;
+
+/**
+ * \brief One report seen by the sink. The report callback fills the
+ * application fields; the detector fills the rest.
+ */
+struct AquaSimIdsReception
+{
+  uint32_t nodeId;
+  Vector reportedPos;
+  Time sendTime;
+  int label;          ///< 1 anomalous, 0 normal, -1 unknown
+  double rssi;
+  Time propDelay;
+  Time recvTime;
+  double features[AquaSimIdsModel::N_FEATURES];
+  double score;
+  bool alert;
+
+  AquaSimIdsReception ();
+};
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Online intrusion detection at a sink.
+ *
+ * Attach() hooks the sink PHY "RxEnd" trace, which carries the received
+ * power and propagation delay of every decoded frame, and the MAC
+ * "RoutingRx" trace, which confirms the frame was accepted by the MAC; the
+ * two fire in the same event, so one pending measurement is enough. The
+ * report callback pulls the sender, reported position and (optional) label
+ * out of the packet.
+ *
+ * Features are computed per reception: how far the reported position is
+ * from the range implied by the delay and by the RSSI (inverting
+ * pT / (d^2 10^(a(f) d / 10000)) with Newton steps), the inter-arrival
+ * z-score of the sender and the speed its reports imply. Rows are queued
+ * and scored by the model in micro-batches of BatchSize rows, or after
+ * BatchInterval, whichever comes first; labelled rows then train the model.
+ */
+class AquaSimIdsDetector : public Object
+{
+public:
+  typedef Callback<bool, Ptr<const Packet>, AquaSimIdsReception &> ReportCallback;
+  typedef void (* ReceptionTracedCallback) (const AquaSimIdsReception &rx);
+
+  static TypeId GetTypeId (void);
+  AquaSimIdsDetector ();
+  virtual ~AquaSimIdsDetector ();
+
+  void SetModel (Ptr<AquaSimIdsModel> model);
+  Ptr<AquaSimIdsModel> GetModel (void) const;
+  void SetReportCallback (ReportCallback report);
+  /// Listen to the PHY and MAC of sink; needs the report callback.
+  void Attach (Ptr<AquaSimNetDevice> sink);
+  void SetSinkMobility (Ptr<MobilityModel> sink);
+
+  /// Feed one reception (recvTime is set to now) into the next batch.
+  void Process (const AquaSimIdsReception &rx);
+  /// Score whatever is queued.
+  void Flush (void);
+
+  /// Range from received power, inverting the propagation model.
+  double RssiRange (double rssi) const;
+
+  uint64_t GetNReceptions (void) const;
+  uint64_t GetNBatches (void) const;
+  uint64_t GetNAlerts (void) const;
+  uint64_t GetTruePositives (void) const;
+  uint64_t GetFalsePositives (void) const;
+  uint64_t GetFalseNegatives (void) const;
+  /// Mean time from scheduling to scoring of a reception.
+  Time GetMeanQueueDelay (void) const;
+  /// Mean, over senders with anomalous reports, of the time from sending
+  /// the first one to the first alert on the sender; count in detected.
+  Time GetMeanDetectionLatency (uint32_t &detected) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct Sender
+  {
+    Time last;
+    Vector lastPos;
+    double gapMean;
+    double gapVar;
+    uint32_t gaps;
+    Time firstAnomaly;
+    Time firstAlert;
+
+    Sender ();
+  };
+
+  void RxEnd (Ptr<const Packet> p, double rssi, Vector senderPos, Time propDelay);
+  void MacRx (Ptr<const Packet> p);
+  void Receive (Ptr<const Packet> p, double rssi, Time propDelay);
+  void Features (AquaSimIdsReception &rx);
+
+  Ptr<AquaSimIdsModel> m_model;
+  ReportCallback m_report;
+  Ptr<MobilityModel> m_sink;
+
+  double m_pT;
+  double m_freq;
+  double m_speed;
+  double m_gapWeight;
+  uint32_t m_batchSize;
+  Time m_batchInterval;
+  double m_threshold;
+  bool m_learn;
+
+  bool m_macConfirm;
+  uint64_t m_pendingUid;
+  double m_pendingRssi;
+  Time m_pendingDelay;
+  bool m_pending;
+
+  std::vector<AquaSimIdsReception> m_queue;
+  std::vector<double> m_x;
+  std::vector<double> m_scores;
+  std::vector<double> m_trainX;
+  std::vector<int> m_trainY;
+  EventId m_flushEvent;
+  std::unordered_map<uint32_t, Sender> m_senders;
+
+  uint64_t m_receptions;
+  uint64_t m_batches;
+  uint64_t m_alerts;
+  uint64_t m_tp;
+  uint64_t m_fp;
+  uint64_t m_fn;
+  Time m_queueDelay;
+
+  TracedCallback<const AquaSimIdsReception &> m_scoredTrace;
+  TracedCallback<const AquaSimIdsReception &> m_alertTrace;
+};  // class AquaSimIdsDetector
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_IDS_DETECTOR_H */
@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+#include "aqua-sim-ids-model.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimIdsModel");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimIdsModel);
+NS_OBJECT_ENSURE_REGISTERED (AquaSimIdsThresholdModel);
+NS_OBJECT_ENSURE_REGISTERED (AquaSimIdsLinearModel);
+NS_OBJECT_ENSURE_REGISTERED (AquaSimIdsLogisticModel);
+NS_OBJECT_ENSURE_REGISTERED (AquaSimIdsSvmModel);
+
+TypeId
+AquaSimIdsModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimIdsModel")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+AquaSimIdsModel::~AquaSimIdsModel ()
+{
+}
+
+void
+AquaSimIdsModel::Learn (const double *x, const int *label, uint32_t n)
+{
+}
+
+TypeId
+AquaSimIdsThresholdModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimIdsThresholdModel")
+    .SetParent<AquaSimIdsModel> ()
+    .AddConstructor<AquaSimIdsThresholdModel> ()
+    .AddAttribute ("DelayResidual", "Limit on the delay range residual (m), 0 to ignore.",
+      DoubleValue (50),
+      MakeDoubleAccessor (&AquaSimIdsThresholdModel::m_delayLimit),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("RssiResidual", "Limit on the RSSI range residual (m), 0 to ignore.",
+      DoubleValue (200),
+      MakeDoubleAccessor (&AquaSimIdsThresholdModel::m_rssiLimit),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("InterArrivalZ", "Limit on the inter-arrival z-score, 0 to ignore.",
+      DoubleValue (0),
+      MakeDoubleAccessor (&AquaSimIdsThresholdModel::m_gapLimit),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("ReportedSpeed", "Limit on the reported speed (m/s), 0 to ignore.",
+      DoubleValue (5),
+      MakeDoubleAccessor (&AquaSimIdsThresholdModel::m_speedLimit),
+      MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+AquaSimIdsThresholdModel::AquaSimIdsThresholdModel ()
+  : m_delayLimit (50),
+    m_rssiLimit (200),
+    m_gapLimit (0),
+    m_speedLimit (5)
+{
+}
+
+void
+AquaSimIdsThresholdModel::Score (const double *x, uint32_t n, double *score)
+{
+  const double limit[N_FEATURES] = {m_delayLimit, m_rssiLimit, m_gapLimit, m_speedLimit};
+  for (uint32_t i = 0; i < n; i++, x += N_FEATURES)
+    {
+      double worst = 0;
+      for (int f = 0; f < N_FEATURES; f++)
+        {
+          if (limit[f] > 0)
+            worst = std::max (worst, x[f] / limit[f]);
+        }
+      score[i] = worst - 1;
+    }
+}
+
+TypeId
+AquaSimIdsLinearModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimIdsLinearModel")
+    .SetParent<AquaSimIdsModel> ()
+  ;
+  return tid;
+}
+
+AquaSimIdsLinearModel::AquaSimIdsLinearModel ()
+  : m_b (0),
+    m_samples (0),
+    m_positives (0)
+{
+  for (int f = 0; f < N_FEATURES; f++)
+    m_w[f] = m_mean[f] = m_m2[f] = 0;
+}
+
+uint64_t
+AquaSimIdsLinearModel::GetNSamples (void) const
+{
+  return m_samples;
+}
+
+double
+AquaSimIdsLinearModel::GetWeight (uint32_t i) const
+{
+  NS_ASSERT (i < N_FEATURES);
+  return m_w[i];
+}
+
+double
+AquaSimIdsLinearModel::GetBias (void) const
+{
+  return m_b;
+}
+
+bool
+AquaSimIdsLinearModel::IsTrained (void) const
+{
+  return true;
+}
+
+void
+AquaSimIdsLinearModel::Transform (const double *x, double *z, bool learn)
+{
+  // call with learn set once per training row, before m_samples moves on
+  for (int f = 0; f < N_FEATURES; f++)
+    {
+      double v = std::log1p (std::max (x[f], 0.0));
+      if (learn)
+        {
+          double delta = v - m_mean[f];
+          m_mean[f] += delta / (m_samples + 1);
+          m_m2[f] += delta * (v - m_mean[f]);
+        }
+      double var = m_samples > 0 ? m_m2[f] / (m_samples + learn) : 0;
+      z[f] = (v - m_mean[f]) / std::sqrt (var + 1e-6);
+    }
+}
+
+double
+AquaSimIdsLinearModel::Decision (const double *z) const
+{
+  double d = m_b;
+  for (int f = 0; f < N_FEATURES; f++)
+    d += m_w[f] * z[f];
+  return d;
+}
+
+void
+AquaSimIdsLinearModel::Score (const double *x, uint32_t n, double *score)
+{
+  if (!IsTrained ())
+    {
+      std::fill (score, score + n, -1.0);
+      return;
+    }
+  double z[N_FEATURES];
+  for (uint32_t i = 0; i < n; i++, x += N_FEATURES)
+    {
+      Transform (x, z, false);
+      score[i] = Decision (z);
+    }
+}
+
+TypeId
+AquaSimIdsLogisticModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimIdsLogisticModel")
+    .SetParent<AquaSimIdsLinearModel> ()
+    .AddConstructor<AquaSimIdsLogisticModel> ()
+    .AddAttribute ("LearningRate", "SGD step size.",
+      DoubleValue (0.05),
+      MakeDoubleAccessor (&AquaSimIdsLogisticModel::m_rate),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("L2", "L2 penalty on the weights.",
+      DoubleValue (1e-4),
+      MakeDoubleAccessor (&AquaSimIdsLogisticModel::m_l2),
+      MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+AquaSimIdsLogisticModel::AquaSimIdsLogisticModel ()
+  : m_rate (0.05),
+    m_l2 (1e-4)
+{
+}
+
+void
+AquaSimIdsLogisticModel::Learn (const double *x, const int *label, uint32_t n)
+{
+  double z[N_FEATURES];
+  for (uint32_t i = 0; i < n; i++, x += N_FEATURES)
+    {
+      Transform (x, z, true);
+      m_samples++;
+      m_positives += label[i] != 0;
+      double p = 1 / (1 + std::exp (-Decision (z)));
+      double g = p - (label[i] != 0);
+      for (int f = 0; f < N_FEATURES; f++)
+        m_w[f] -= m_rate * (g * z[f] + m_l2 * m_w[f]);
+      m_b -= m_rate * g;
+    }
+}
+
+TypeId
+AquaSimIdsSvmModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimIdsSvmModel")
+    .SetParent<AquaSimIdsLinearModel> ()
+    .AddConstructor<AquaSimIdsSvmModel> ()
+    .AddAttribute ("Lambda", "Pegasos regularisation weight.",
+      DoubleValue (0.001),
+      MakeDoubleAccessor (&AquaSimIdsSvmModel::m_lambda),
+      MakeDoubleChecker<double> (0))
+    .AddAttribute ("MinSamples", "Training rows needed before the model scores.",
+      UintegerValue (100),
+      MakeUintegerAccessor (&AquaSimIdsSvmModel::m_minSamples),
+      MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+AquaSimIdsSvmModel::AquaSimIdsSvmModel ()
+  : m_lambda (0.001),
+    m_minSamples (100)
+{
+}
+
+bool
+AquaSimIdsSvmModel::IsTrained (void) const
+{
+  return m_samples >= m_minSamples && m_positives > 0 && m_positives < m_samples;
+}
+
+void
+AquaSimIdsSvmModel::Learn (const double *x, const int *label, uint32_t n)
+{
+  double z[N_FEATURES];
+  for (uint32_t i = 0; i < n; i++, x += N_FEATURES)
+    {
+      Transform (x, z, true);
+      m_samples++;
+      m_positives += label[i] != 0;
+      double y = label[i] ? 1 : -1;
+      double eta = 1 / (m_lambda * m_samples);
+      bool violated = y * Decision (z) < 1;
+      double norm = 0;
+      for (int f = 0; f < N_FEATURES; f++)
+        {
+          m_w[f] *= 1 - eta * m_lambda;
+          if (violated)
+            m_w[f] += eta * y * z[f];
+          norm += m_w[f] * m_w[f];
+        }
+      // the bias is a constant feature, as in AquaSimDdosModel
+      m_b *= 1 - eta * m_lambda;
+      if (violated)
+        m_b += eta * y;
+      norm += m_b * m_b;
+      double radius = 1 / std::sqrt (m_lambda);
+      if (norm > radius * radius)
+        {
+          double scale = radius / std::sqrt (norm);
+          for (int f = 0; f < N_FEATURES; f++)
+            m_w[f] *= scale;
+          m_b *= scale;
+        }
+    }
+}
+
+}  // namespace ns3
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_IDS_MODEL_H
+#define AQUA_SIM_IDS_MODEL_H
+
+#include <stdint.h>
+
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Scoring stage of AquaSimIdsDetector.
+ *
+ * Models see micro-batches of feature rows (row-major, N_FEATURES columns)
+ * and write one score per row; a score above the detector's threshold
+ * (0 by default) raises an alert. Models that train online also receive the
+ * labelled rows of every batch once it has been scored.
+ */
+class AquaSimIdsModel : public Object
+{
+public:
+  enum Feature {
+    DELAY_RESIDUAL,   ///< |reported range - sound speed * delay| (m)
+    RSSI_RESIDUAL,    ///< |reported range - range implied by RSSI| (m)
+    INTER_ARRIVAL_Z,  ///< |gap - mean gap| / gap deviation of the sender
+    REPORTED_SPEED,   ///< reported displacement over the gap (m/s)
+    N_FEATURES
+  };
+
+  static TypeId GetTypeId (void);
+  virtual ~AquaSimIdsModel ();
+
+  virtual void Score (const double *x, uint32_t n, double *score) = 0;
+  /// Labels are 1 (anomalous) or 0; the default ignores them.
+  virtual void Learn (const double *x, const int *label, uint32_t n);
+};  // class AquaSimIdsModel
+
+/**
+ * \brief Fixed per-feature limits; the score is the largest ratio of a
+ * feature to its limit, minus one. A limit of 0 disables the feature.
+ */
+class AquaSimIdsThresholdModel : public AquaSimIdsModel
+{
+public:
+  static TypeId GetTypeId (void);
+  AquaSimIdsThresholdModel ();
+
+  virtual void Score (const double *x, uint32_t n, double *score);
+
+private:
+  double m_delayLimit;
+  double m_rssiLimit;
+  double m_gapLimit;
+  double m_speedLimit;
+};  // class AquaSimIdsThresholdModel
+
+/**
+ * \brief Base of the learned models: standardises log(1 + x) of every
+ * feature with running means and deviations of the training rows, so
+ * residuals in metres and z-scores share a scale.
+ */
+class AquaSimIdsLinearModel : public AquaSimIdsModel
+{
+public:
+  static TypeId GetTypeId (void);
+  AquaSimIdsLinearModel ();
+
+  virtual void Score (const double *x, uint32_t n, double *score);
+
+  uint64_t GetNSamples (void) const;
+  double GetWeight (uint32_t i) const;
+  double GetBias (void) const;
+
+protected:
+  /// Standardised features of row x into z; updates the scaling if learn.
+  void Transform (const double *x, double *z, bool learn);
+  double Decision (const double *z) const;
+  /// Score returns -1 for every row until this holds.
+  virtual bool IsTrained (void) const;
+
+  double m_w[N_FEATURES];
+  double m_b;
+  uint64_t m_samples;
+  uint64_t m_positives;
+
+private:
+  double m_mean[N_FEATURES];
+  double m_m2[N_FEATURES];
+};  // class AquaSimIdsLinearModel
+
+/**
+ * \brief Logistic regression trained by SGD on the log loss; the score is
+ * the log-odds of an anomaly.
+ */
+class AquaSimIdsLogisticModel : public AquaSimIdsLinearModel
+{
+public:
+  static TypeId GetTypeId (void);
+  AquaSimIdsLogisticModel ();
+
+  virtual void Learn (const double *x, const int *label, uint32_t n);
+
+private:
+  double m_rate;
+  double m_l2;
+};  // class AquaSimIdsLogisticModel
+
+/**
+ * \brief Linear SVM trained online with Pegasos steps (as AquaSimDdosModel);
+ * scores are margins, and -1 until MinSamples rows of both classes were seen.
+ */
+class AquaSimIdsSvmModel : public AquaSimIdsLinearModel
+{
+public:
+  static TypeId GetTypeId (void);
+  AquaSimIdsSvmModel ();
+
+  virtual void Learn (const double *x, const int *label, uint32_t n);
+
+protected:
+  virtual bool IsTrained (void) const;
+
+private:
+  double m_lambda;
+  uint32_t m_minSamples;
+};  // class AquaSimIdsSvmModel
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_IDS_MODEL_H */
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "aqua-sim-ladder-scheduler.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimLadderScheduler");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimLadderScheduler);
+
+TypeId
+AquaSimLadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimLadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("AquaSimNG")
+    .AddConstructor<AquaSimLadderScheduler> ()
+  ;
+  return tid;
+}
+
+AquaSimLadderScheduler::AquaSimLadderScheduler () :
+  m_topStart (0),
+  m_nRungs (0),
+  m_bottomHead (0),
+  m_bottomLimit (4 * SPAWN_THRESHOLD),
+  m_spawns (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimLadderScheduler::~AquaSimLadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+AquaSimLadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_nRungs; i++)
+        {
+          Rung &r = m_rungs[i];
+          if (ts >= r.m_start + r.m_cur * r.m_width)
+            {
+              r.m_buckets[(ts - r.m_start) / r.m_width].push_back (ev);
+              return;
+            }
+        }
+      InsertBottom (ev);
+    }
+  if (m_bottomHead == m_bottom.size ())
+    Refill ();
+}
+
+bool
+AquaSimLadderScheduler::IsEmpty (void) const
+{
+  return m_bottomHead == m_bottom.size ();
+}
+
+Scheduler::Event
+AquaSimLadderScheduler::PeekNext (void) const
+{
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+AquaSimLadderScheduler::RemoveNext (void)
+{
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev = m_bottom[m_bottomHead++];
+  if (m_bottomHead == m_bottom.size ())
+    Refill ();
+  return ev;
+}
+
+void
+AquaSimLadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  bool found = false;
+  if (ts >= m_topStart)
+    {
+      found = EraseUid (m_top, ev.key.m_uid);
+    }
+  else
+    {
+      uint32_t i = 0;
+      for (; i < m_nRungs; i++)
+        {
+          Rung &r = m_rungs[i];
+          if (ts >= r.m_start + r.m_cur * r.m_width)
+            {
+              found = EraseUid (r.m_buckets[(ts - r.m_start) / r.m_width], ev.key.m_uid);
+              break;
+            }
+        }
+      if (i == m_nRungs)
+        {
+          Bucket::iterator it = std::lower_bound (m_bottom.begin () + m_bottomHead,
+                                                  m_bottom.end (), ev);
+          found = it != m_bottom.end () && it->key.m_uid == ev.key.m_uid;
+          if (found)
+            m_bottom.erase (it);
+        }
+    }
+  NS_ASSERT_MSG (found, "event " << ev.key.m_uid << " is not scheduled");
+  if (m_bottomHead == m_bottom.size ())
+    Refill ();
+}
+
+uint32_t
+AquaSimLadderScheduler::GetNRungs (void) const
+{
+  return m_nRungs;
+}
+
+uint64_t
+AquaSimLadderScheduler::GetSpawnCount (void) const
+{
+  return m_spawns;
+}
+
+bool
+AquaSimLadderScheduler::EraseUid (Bucket &bucket, uint32_t uid)
+{
+  for (size_t k = 0; k < bucket.size (); k++)
+    {
+      if (bucket[k].key.m_uid == uid)
+        {
+          bucket[k] = bucket.back ();   //buckets are unsorted
+          bucket.pop_back ();
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+AquaSimLadderScheduler::Spawn (Bucket &events, uint64_t start, uint64_t end)
+{
+  NS_ASSERT (m_nRungs < MAX_RUNGS && end > start && !events.empty ());
+  Rung &r = m_rungs[m_nRungs++];
+  uint64_t span = end - start;
+  r.m_start = start;
+  r.m_width = std::max<uint64_t> (1, (span + events.size () - 1) / events.size ());
+  r.m_cur = 0;
+  r.m_nBuckets = (span + r.m_width - 1) / r.m_width;
+  if (r.m_buckets.size () < r.m_nBuckets)
+    r.m_buckets.resize (r.m_nBuckets);
+  for (size_t k = 0; k < events.size (); k++)
+    {
+      r.m_buckets[(events[k].key.m_ts - start) / r.m_width].push_back (events[k]);
+    }
+  events.clear ();
+  m_spawns++;
+  NS_LOG_LOGIC ("rung " << m_nRungs - 1 << ": " << r.m_nBuckets << " buckets of " << r.m_width);
+}
+
+void
+AquaSimLadderScheduler::SortIntoBottom (Bucket &events)
+{
+  std::sort (events.begin (), events.end ());
+  m_bottom.swap (events);
+  m_bottomHead = 0;
+  events.clear ();
+}
+
+void
+AquaSimLadderScheduler::InsertBottom (const Scheduler::Event &ev)
+{
+  if (m_bottomHead == m_bottom.size ())
+    {
+      m_bottom.clear ();
+      m_bottomHead = 0;
+    }
+  else if (m_bottomHead > 1024 && 2 * m_bottomHead > m_bottom.size ())
+    {
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+    }
+  // later uids of one time stamp append, the usual case for a burst
+  m_bottom.insert (std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev), ev);
+
+  if (m_bottom.size () - m_bottomHead > m_bottomLimit && m_nRungs < MAX_RUNGS
+      && m_bottom.back ().key.m_ts > m_bottom[m_bottomHead].key.m_ts)
+    {
+      // it fills below the ladder: becomes the lowest rung
+      uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+      uint64_t end = m_nRungs ? m_rungs[m_nRungs - 1].m_start
+                                + m_rungs[m_nRungs - 1].m_cur * m_rungs[m_nRungs - 1].m_width
+                              : m_topStart;
+      Bucket events (m_bottom.begin () + m_bottomHead, m_bottom.end ());
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      Spawn (events, start, end);
+      Refill ();
+    }
+}
+
+void
+AquaSimLadderScheduler::Refill (void)
+{
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            break;
+          uint64_t lo = m_top[0].key.m_ts;
+          uint64_t hi = lo;
+          for (size_t k = 1; k < m_top.size (); k++)
+            {
+              lo = std::min (lo, m_top[k].key.m_ts);
+              hi = std::max (hi, m_top[k].key.m_ts);
+            }
+          m_topStart = hi + 1;
+          if (m_top.size () <= SPAWN_THRESHOLD || lo == hi)
+            SortIntoBottom (m_top);
+          else
+            Spawn (m_top, lo, m_topStart);
+          continue;
+        }
+
+      Rung &r = m_rungs[m_nRungs - 1];
+      while (r.m_cur < r.m_nBuckets && r.m_buckets[r.m_cur].empty ())
+        {
+          r.m_cur++;
+        }
+      if (r.m_cur == r.m_nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      Bucket &bucket = r.m_buckets[r.m_cur];
+      uint64_t start = r.m_start + r.m_cur * r.m_width;
+      r.m_cur++;
+      if (bucket.size () > SPAWN_THRESHOLD && r.m_width > 1 && m_nRungs < MAX_RUNGS)
+        Spawn (bucket, start, start + r.m_width);
+      else
+        SortIntoBottom (bucket);
+    }
+  m_bottomLimit = std::max<size_t> (4 * SPAWN_THRESHOLD, 2 * m_bottom.size ());
+}
+
+}  // namespace ns3
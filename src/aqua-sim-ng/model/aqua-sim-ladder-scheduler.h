@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_LADDER_SCHEDULER_H
+#define AQUA_SIM_LADDER_SCHEDULER_H
+
+#include <vector>
+
+#include "ns3/scheduler.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Ladder queue event scheduler (Tang, Goh and Thng, 2005).
+ *
+ * Select it with
+ * GlobalValue::Bind ("SchedulerType", StringValue ("ns3::AquaSimLadderScheduler"))
+ * or --SchedulerType=ns3::AquaSimLadderScheduler.
+ *
+ * Events go to one of three tiers:
+ *  - Top: an unsorted list of the far future, at or after TopStart;
+ *  - rungs: up to MAX_RUNGS levels of time buckets, each finer than the one
+ *    above, the last one covering the most imminent events. Buckets are
+ *    unsorted; a rung is cut from Top, or from a bucket of the rung above,
+ *    when that becomes the next to be consumed;
+ *  - Bottom: the next events in order, a sorted array.
+ *
+ * Inserting into Top or a bucket is an append. A bucket holding more than
+ * SPAWN_THRESHOLD events is not sorted but split into a finer rung, so only
+ * small runs are ever sorted. A Bottom that outgrows twice its size at the
+ * last refill is turned back into a rung, so a long queue that arrived in
+ * order cannot degrade into sorted-array inserts. That suits aqua-sim's bursts of per-receiver
+ * receptions scheduled at nearly the same delay. Bottom is kept non-empty
+ * whenever the queue is not, so PeekNext is a plain read. Events with
+ * equal time stamps keep the (time stamp, uid) order of every other ns-3
+ * scheduler, so swapping schedulers never changes results.
+ *
+ * Remove searches one bucket or Top linearly; Simulator::Cancel never
+ * removes, so this is only paid by Simulator::Remove.
+ */
+class AquaSimLadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  AquaSimLadderScheduler ();
+  virtual ~AquaSimLadderScheduler ();
+
+  // Inherited from Scheduler
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+  /// Rungs currently in use.
+  uint32_t GetNRungs (void) const;
+  /// Rungs cut so far.
+  uint64_t GetSpawnCount (void) const;
+
+  static const uint32_t MAX_RUNGS = 8;
+  static const uint32_t SPAWN_THRESHOLD = 50;
+
+private:
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /// One level of the ladder: buckets [m_start + k m_width, + m_width).
+  struct Rung
+  {
+    uint64_t m_start;
+    uint64_t m_width;
+    uint32_t m_cur;       //first bucket not yet consumed
+    uint32_t m_nBuckets;
+    std::vector<Bucket> m_buckets;   //kept across uses, capacity reused
+  };
+
+  void Spawn (Bucket &events, uint64_t start, uint64_t end);
+  void Refill (void);
+  void SortIntoBottom (Bucket &events);
+  void InsertBottom (const Scheduler::Event &ev);
+  static bool EraseUid (Bucket &bucket, uint32_t uid);
+
+  Bucket m_top;
+  uint64_t m_topStart;
+  Rung m_rungs[MAX_RUNGS];
+  uint32_t m_nRungs;
+  Bucket m_bottom;         //ascending, consumed from m_bottomHead
+  size_t m_bottomHead;
+  size_t m_bottomLimit;    //live Bottom size that turns it into a rung
+  uint64_t m_spawns;
+};  // class AquaSimLadderScheduler
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_LADDER_SCHEDULER_H */
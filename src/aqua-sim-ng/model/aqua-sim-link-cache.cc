@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include "aqua-sim-link-cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimLinkCache");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimLinkCache);
+
+TypeId
+AquaSimLinkCache::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimLinkCache")
+    .SetParent<Object> ()
+    .AddConstructor<AquaSimLinkCache> ()
+    .AddAttribute ("MaxAge", "Longest time a link is reused without a course change. 0 recomputes links with a moving endpoint on every lookup.",
+      TimeValue (Seconds (0)),
+      MakeTimeAccessor (&AquaSimLinkCache::m_maxAge),
+      MakeTimeChecker ())
+    .AddAttribute ("MaxLinks", "Links held before stale and idle ones are evicted. 0 keeps every link.",
+      UintegerValue (1 << 18),
+      MakeUintegerAccessor (&AquaSimLinkCache::m_maxLinks),
+      MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+AquaSimLinkCache::AquaSimLinkCache () :
+  m_maxAge (Seconds (0)),
+  m_maxLinks (1 << 18),
+  m_evictAt (0),
+  m_hits (0),
+  m_misses (0),
+  m_evictions (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimLinkCache::~AquaSimLinkCache ()
+{
+}
+
+AquaSimLinkCache::NodeState &
+AquaSimLinkCache::GetNode (Ptr<MobilityModel> model)
+{
+  std::unordered_map<const MobilityModel*, NodeState>::iterator it = m_nodes.find (PeekPointer (model));
+  if (it != m_nodes.end ())
+    return it->second;
+
+  NodeState &state = m_nodes[PeekPointer (model)];
+  state.model = model;
+  state.version = 0;
+  state.moving = model->GetVelocity ().GetLength () > 0;
+  model->TraceConnectWithoutContext ("CourseChange",
+      MakeCallback (&AquaSimLinkCache::CourseChanged, this));
+  return state;
+}
+
+void
+AquaSimLinkCache::CourseChanged (Ptr<const MobilityModel> model)
+{
+  std::unordered_map<const MobilityModel*, NodeState>::iterator it = m_nodes.find (PeekPointer (model));
+  if (it == m_nodes.end ())
+    return;
+  it->second.version++;
+  it->second.moving = model->GetVelocity ().GetLength () > 0;
+}
+
+bool
+AquaSimLinkCache::IsValid (const Entry &e, const NodeState &na, const NodeState &nb, Time now) const
+{
+  return e.versionA == na.version && e.versionB == nb.version
+    && (m_maxAge.IsStrictlyPositive () ? now - e.stamp <= m_maxAge : !(na.moving || nb.moving));
+}
+
+/*
+ * Drop the stale entries, then, if that frees less than a quarter of the
+ * table, every entry not used at this time stamp. Entries used now may be
+ * referenced by the caller and are always kept.
+ */
+void
+AquaSimLinkCache::Evict (void)
+{
+  NS_LOG_FUNCTION (this << m_links.size ());
+  Time now = Simulator::Now ();
+  size_t before = m_links.size ();
+  for (int pass = 0; pass < 2 && m_links.size () > m_maxLinks / 4 * 3; pass++)
+    {
+      for (std::unordered_map<Key, Entry, KeyHash>::iterator it = m_links.begin (); it != m_links.end (); )
+        {
+          const Entry &e = it->second;
+          bool drop = e.used < now
+            && (pass == 1 || !IsValid (e, m_nodes.find (it->first.first)->second,
+                                       m_nodes.find (it->first.second)->second, now));
+          it = drop ? m_links.erase (it) : std::next (it);
+        }
+    }
+  m_evictions += before - m_links.size ();
+  /* what is left is in use now; grow rather than rescan on every insert */
+  m_evictAt = std::max<size_t> (m_maxLinks, m_links.size () + m_maxLinks / 4);
+}
+
+AquaSimLinkCache::Link &
+AquaSimLinkCache::Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b)
+{
+  if (PeekPointer (b) < PeekPointer (a))
+    std::swap (a, b);
+  const NodeState &na = GetNode (a);
+  const NodeState &nb = GetNode (b);
+
+  if (m_maxLinks > 0 && m_links.size () >= std::max (m_evictAt, m_maxLinks))
+    Evict ();
+  std::pair<std::unordered_map<Key, Entry, KeyHash>::iterator, bool> ins =
+    m_links.insert (std::make_pair (Key (PeekPointer (a), PeekPointer (b)), Entry ()));
+  Entry &e = ins.first->second;
+  Time now = Simulator::Now ();
+  e.used = now;
+  if (!ins.second && IsValid (e, na, nb, now))
+    {
+      m_hits++;
+      return e.link;
+    }
+
+  m_misses++;
+  e.link.dist = a->GetDistanceFrom (b);
+  e.link.delay = Time (-1);
+  e.link.nominalDelay = Time (-1);
+  e.link.att = 0;
+  e.link.attFreq = std::numeric_limits<double>::quiet_NaN ();
+  e.versionA = na.version;
+  e.versionB = nb.version;
+  e.stamp = now;
+  return e.link;
+}
+
+uint64_t
+AquaSimLinkCache::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+AquaSimLinkCache::GetMisses (void) const
+{
+  return m_misses;
+}
+
+uint32_t
+AquaSimLinkCache::GetNLinks (void) const
+{
+  return m_links.size ();
+}
+
+uint64_t
+AquaSimLinkCache::GetEvictions (void) const
+{
+  return m_evictions;
+}
+
+void
+AquaSimLinkCache::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::unordered_map<const MobilityModel*, NodeState>::iterator it = m_nodes.begin ();
+       it != m_nodes.end (); ++it)
+    {
+      it->second.model->TraceDisconnectWithoutContext ("CourseChange",
+          MakeCallback (&AquaSimLinkCache::CourseChanged, this));
+    }
+  m_nodes.clear ();
+  m_links.clear ();
+  Object::DoDispose ();
+}
+
+}  // namespace ns3
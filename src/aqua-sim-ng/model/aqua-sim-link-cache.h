@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_LINK_CACHE_H
+#define AQUA_SIM_LINK_CACHE_H
+
+#include <unordered_map>
+#include <utility>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Per-link distance/delay/attenuation table used by AquaSimPropagation.
+ *
+ * Links are unordered node pairs. An entry stays valid until either
+ * endpoint reports a course change. Links with a moving endpoint are
+ * recomputed on every lookup unless MaxAge is set, in which case they (and
+ * static links) are reused for at most MaxAge, trading accuracy for speed
+ * on slow deployments. With MaxAge at 0 every cached value is exactly what
+ * a direct computation would give.
+ *
+ * The delay and attenuation slots are filled by the propagation model on
+ * first use and cleared whenever the distance is refreshed.
+ *
+ * The table holds up to MaxLinks entries. When it is full, entries a
+ * course change or MaxAge has made stale are evicted first, then any
+ * entry not looked up at the current time stamp; references returned by
+ * Lookup therefore stay valid until simulation time advances.
+ */
+class AquaSimLinkCache : public Object
+{
+public:
+  struct Link {
+    double dist;
+    Time delay;         // model delay (ReceivedCopies), negative if unset
+    Time nominalDelay;  // PDelay at SOUND_SPEED_IN_WATER, negative if unset
+    double att;
+    double attFreq;     // frequency att was computed for, NaN if unset
+  };
+
+  static TypeId GetTypeId (void);
+  AquaSimLinkCache ();
+  virtual ~AquaSimLinkCache ();
+
+  /// Fresh state of the link between \p a and \p b.
+  Link &Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b);
+
+  uint64_t GetHits (void) const;
+  uint64_t GetMisses (void) const;
+  uint32_t GetNLinks (void) const;
+  uint64_t GetEvictions (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct NodeState {
+    Ptr<MobilityModel> model;
+    uint32_t version;
+    bool moving;
+  };
+  struct Entry {
+    Link link;
+    uint32_t versionA;
+    uint32_t versionB;
+    Time stamp;   // when link was computed
+    Time used;    // last Lookup
+  };
+  typedef std::pair<const MobilityModel*, const MobilityModel*> Key;
+  struct KeyHash {
+    size_t operator() (const Key &k) const
+    {
+      return std::hash<const void*> () (k.first) * 31 + std::hash<const void*> () (k.second);
+    }
+  };
+
+  NodeState &GetNode (Ptr<MobilityModel> model);
+  void CourseChanged (Ptr<const MobilityModel> model);
+  bool IsValid (const Entry &e, const NodeState &na, const NodeState &nb, Time now) const;
+  void Evict (void);
+
+  Time m_maxAge;
+  uint32_t m_maxLinks;
+  uint32_t m_evictAt;   // table size that triggers the next Evict
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint64_t m_evictions;
+  std::unordered_map<const MobilityModel*, NodeState> m_nodes;
+  std::unordered_map<Key, Entry, KeyHash> m_links;
+};  // class AquaSimLinkCache
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_LINK_CACHE_H */
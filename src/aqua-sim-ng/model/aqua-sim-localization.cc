@@ -30,8 +30,10 @@
 #include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/integer.h"
+#include "ns3/trace-source-accessor.h"
 
 #include "math.h"
+#include <vector>
 
 
 using namespace ns3;
@@ -121,7 +123,11 @@ AquaSimLocalization::DoDispose()
 NS_OBJECT_ENSURE_REGISTERED(AquaSimRBLocalization);
 
 AquaSimRBLocalization::AquaSimRBLocalization() :
-  m_localizationThreshold(4)
+  m_confidence(0),
+  m_localizationThreshold(4),
+  m_soundSpeed(1500),
+  m_spoofThreshold(50),
+  m_hasFix(false)
 {
 }
 
@@ -143,6 +149,17 @@ AquaSimRBLocalization::GetTypeId(void)
     IntegerValue (4),
     MakeIntegerAccessor (&AquaSimRBLocalization::m_localizationThreshold),
     MakeIntegerChecker<int> ())
+  .AddAttribute ("SoundSpeed", "Sound speed used to turn ToA into range (m/s)",
+    DoubleValue (1500),
+    MakeDoubleAccessor (&AquaSimRBLocalization::m_soundSpeed),
+    MakeDoubleChecker<double> (0))
+  .AddAttribute ("SpoofThreshold", "Range residual (m) above which a claimed position is spoofed",
+    DoubleValue (50),
+    MakeDoubleAccessor (&AquaSimRBLocalization::m_spoofThreshold),
+    MakeDoubleChecker<double> (0))
+  .AddTraceSource ("Residual", "Range residual of the position claimed in a beacon",
+    MakeTraceSourceAccessor (&AquaSimRBLocalization::m_residualTrace),
+    "ns3::AquaSimRBLocalization::ResidualTracedCallback")
   ;
   return tid;
 }
@@ -172,6 +189,12 @@ AquaSimRBLocalization::Recv(Ptr<Packet> p)
   ls.m_nodeConfidence = loch.GetConfidence();
 
   m_localizationList.push_back(ls);
+  m_solver.AddRange(ls.m_knownLocation, Range(ls));
+
+  if (m_referenceNode || m_hasFix) {
+    double residual = std::abs(EuclideanDistance3D(ls.m_knownLocation, m_nodePosition) - Range(ls));
+    m_residualTrace(ls.m_nodeID, ls.m_knownLocation, residual, residual > m_spoofThreshold);
+  }
 
   if(m_localizationList.size() >= (unsigned)m_localizationThreshold) {
     Lateration();
@@ -226,32 +249,85 @@ AquaSimRBLocalization::SetLocalizationThreshold(double locThreshold)
   m_localizationThreshold = locThreshold;
 }
 
+double
+AquaSimRBLocalization::GetConfidence()
+{
+  return m_confidence;
+}
+
+double
+AquaSimRBLocalization::VerifyPosition(const Vector &pos)
+{
+  return m_solver.Residual(pos);
+}
+
+double
+AquaSimRBLocalization::Range(const LocalizationStructure &ls)
+{
+  return (ls.m_ToA - ls.m_TDoA).GetSeconds() * m_soundSpeed;
+}
+
 void
 AquaSimRBLocalization::Lateration()
 {
   NS_LOG_FUNCTION(this);
-  if (m_referenceNode) return;
-
-  double errorTotal=0;
-  double estRange=0;
-  double locationTotal=0;
+  // reference nodes know where they are and checked each beacon in Recv
+  if (m_referenceNode || !m_solver.Solve()) {
+    ClearLocalizationList();
+    m_solver.Clear();
+    return;
+  }
 
+  // solver rows in the same order; Remove() moves the last row into the gap
+  std::vector<LocalizationStructure*> rows;
   std::list<LocalizationStructure>::iterator it=m_localizationList.begin();
   for (; it != m_localizationList.end(); ++it)
+    rows.push_back(&(*it));
+
+  // drop the worst beacon while it does not fit, keeping enough to solve
+  while (rows.size() > 4)
+  {
+    Vector est = m_solver.GetEstimate();
+    uint32_t worst = 0;
+    double worstResidual = 0;
+    for (uint32_t i = 0; i < rows.size(); i++)
+    {
+      double r = std::abs(m_solver.Residual(i, est));
+      if (r > worstResidual) {
+        worstResidual = r;
+        worst = i;
+      }
+    }
+    if (worstResidual <= m_spoofThreshold)
+      break;
+    m_residualTrace(rows[worst]->m_nodeID, rows[worst]->m_knownLocation, worstResidual, true);
+    m_solver.Remove(worst);
+    rows[worst] = rows.back();
+    rows.pop_back();
+    m_solver.Solve();
+  }
+
+  Vector est = m_solver.GetEstimate();
+  double errorTotal=0;
+  double locationTotal=0;
+  for (uint32_t i = 0; i < rows.size(); i++)
   {
-    estRange = ((*it).m_ToA.GetMilliSeconds()  - (*it).m_TDoA.GetMilliSeconds()) * 1500;
-    errorTotal += LocationError((*it).m_knownLocation, m_nodePosition, estRange);
-    locationTotal += EuclideanDistance3D((*it).m_knownLocation, m_nodePosition);
-    estRange=0;
+    double r = std::abs(m_solver.Residual(i, est));
+    m_residualTrace(rows[i]->m_nodeID, rows[i]->m_knownLocation, r, r > m_spoofThreshold);
+    errorTotal += r;
+    locationTotal += EuclideanDistance3D(rows[i]->m_knownLocation, est);
   }
 
-  m_confidence = 1 - errorTotal / locationTotal;
+  m_nodePosition = est;
+  m_hasFix = true;
+  m_confidence = locationTotal > 0 ? 1 - errorTotal / locationTotal : 0;
   if (m_confidence > m_confidenceThreshold)
   {
     m_referenceNode = 1;
   }
 
   ClearLocalizationList();
+  m_solver.Clear();
 }
 
 Vector
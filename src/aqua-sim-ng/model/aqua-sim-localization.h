@@ -24,7 +24,9 @@
 #include "ns3/vector.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
 #include "aqua-sim-net-device.h"
+#include "aqua-sim-multilateration.h"
 #include <list>
 
 namespace ns3 {
@@ -80,6 +82,13 @@ protected:
  * Z. Zhou, Z. Peng, J. H. Cui, Z. Shi and A. Bagtzoglou, "Scalable Localization with
  *  Mobility Prediction for Underwater Sensor Networks," in IEEE Transactions on
  *  Mobile Computing, vol. 10, no. 3, pp. 335-348, March 2011.
+ *
+ * Every beacon gives a ToA range to the position its sender claims. Once
+ * LocThreshold beacons are in, a non-reference node multilaterates itself
+ * (AquaSimMultilateration, warm-started from its last fix) and drops the
+ * worst beacon while its residual exceeds SpoofThreshold. Nodes with a
+ * position (reference nodes, or any node after its first fix) also check
+ * each beacon as it arrives; both checks fire the "Residual" trace.
  */
 class AquaSimRBLocalization : public AquaSimLocalization {
 public:
@@ -92,16 +101,30 @@ public:
   void SetReferenceNode(bool ref);
   void SetConfidenceThreshold(double confidence);
   void SetLocalizationThreshold(double locThreshold);
+  double GetConfidence();
+
+  /// RMS misfit (m) of pos against the beacons collected so far.
+  double VerifyPosition(const Vector &pos);
+
+  typedef void (* ResidualTracedCallback)
+    (int nodeId, Vector claimed, double residual, bool spoofed);
 
 protected:
   void Lateration();
   Vector GetAngleOfArrival(Ptr<Packet> p);
 
 private:
+  double Range(const LocalizationStructure &ls);
+
   bool m_referenceNode;
   double m_confidence;  //estimated location confidence
   double m_confidenceThreshold;
   int m_localizationThreshold;
+  double m_soundSpeed;
+  double m_spoofThreshold;
+  bool m_hasFix;
+  AquaSimMultilateration m_solver;
+  TracedCallback<int, Vector, double, bool> m_residualTrace;
 }; // class AquaSimRBLocalization
 
 } // namespace ns3
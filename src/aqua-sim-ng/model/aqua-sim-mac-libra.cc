@@ -485,26 +485,24 @@ AquaSimMacLibra::ForwardPacket(Ptr<Packet> p, AquaSimAddress sender_addr)
 	}
 
 	// Update the forwarding table according to the known distances
-	std::map<AquaSimAddress, AquaSimAddress> src_dst_map;
-	src_dst_map.insert(std::make_pair(mach.GetSA(), dst_addr));
+	bool created;
+	AquaSimNextHopWeights *m = m_forwarding_table.Insert(mach.GetSA(), dst_addr, created); // {next_hop : weight}
 
-	if (m_forwarding_table.count(src_dst_map) == 0)
+	if (created)
 	{
 		// Create new entry with initial weight
-		std::map<AquaSimAddress, double> m; // {next_hop : weight}
 
 		// For each possible destination / distance - calculate the initial weight based on the optimal distance metric
 //			std::cout << "DISTANCES SIZE: " << m_distances.size() << "\n";
 		for (auto const& x : m_distances)
 		{
 			// Calculate initial weight (reward)
-			m.insert(std::make_pair(x.first, CalculateReward(mac_libra_h.GetOptimalDistance(), x.second, 0)));
+			double weight = CalculateReward(mac_libra_h.GetOptimalDistance(), x.second, 0);
+			m->Add(x.first, weight);
 //				std::cout << "Creating new table entry with REWARD: " << reward / 2 << "\n";
-			NS_LOG_DEBUG("Creating new table entry with WEIGHT: " << CalculateReward(mac_libra_h.GetOptimalDistance(), x.second, 0));
+			NS_LOG_DEBUG("Creating new table entry with WEIGHT: " << weight);
 		}
-
-		m_forwarding_table.insert(std::make_pair(src_dst_map, m));
-//			std::cout << "TABLE SIZE: " << m_forwarding_table.size() << "\n";
+//			std::cout << "TABLE SIZE: " << m_forwarding_table.GetN() << "\n";
 	}
 
 	// Select next_hop neighbor and send down the packet
@@ -600,34 +598,29 @@ AquaSimMacLibra::SelectNextHop(AquaSimAddress src_addr, AquaSimAddress dst_addr)
 	double max_value = 0;
 	AquaSimAddress next_hop_addr = 0;
 
-	std::map<AquaSimAddress, AquaSimAddress> src_dst_map;
-	src_dst_map.insert(std::make_pair(src_addr, dst_addr));
+	AquaSimNextHopWeights *m = m_forwarding_table.Find(src_addr, dst_addr);
+	NS_ASSERT(m && m->GetN() > 0);
 
 	// Store the next-hop address and the corresponding selection probability, based on current weights
-	std::vector<AquaSimAddress> next_hop_addresses;
-	std::vector<double> selection_probabilities;
-	
+	std::vector<double> selection_probabilities(m->GetN());
+
 	// Calculate selection probabilities
 	// Find weight sum
 	double weight_sum = 0;
-	for (auto const& x : m_forwarding_table.find(src_dst_map)->second)
+	for (uint32_t i = 0; i < m->GetN(); i++)
 	{
-		weight_sum += exp(x.second);
+		selection_probabilities[i] = exp(m->GetWeight(i));
+		weight_sum += selection_probabilities[i];
 	}
 
 	// Store selection probabilities
-	// int i = 0;
-	for (auto const& x : m_forwarding_table.find(src_dst_map)->second)
+	for (uint32_t i = 0; i < m->GetN(); i++)
 	{
-		selection_probabilities.push_back(exp(x.second) / weight_sum);
-		next_hop_addresses.push_back(x.first);
-		// std::cout << "Next hop: " << x.first << "\n";
-		// std::cout << "Selection probability: " << selection_probabilities.at(i) << "\n";
-		// i++;
+		selection_probabilities[i] /= weight_sum;
 	}
 
     // Select next-hop neighbor based on the softmax probabilities
-	uint32_t next_hop_index;
+	uint32_t next_hop_index = m->GetN() - 1;
 	double point = m_rand->GetValue();
     double cur_cutoff = 0;
 
@@ -641,14 +634,13 @@ AquaSimMacLibra::SelectNextHop(AquaSimAddress src_addr, AquaSimAddress dst_addr)
 			next_hop_index = i;
 			break;
 		}
-      next_hop_index = selection_probabilities.size()-1;
     }
     
-	next_hop_addr = next_hop_addresses[next_hop_index];
+	next_hop_addr = m->GetAddress(next_hop_index);
 
 // 	// Old greedy method:
 // 	// Iterate through the weights to find the max value
-// 	for (auto const& x : m_forwarding_table.find(src_dst_map)->second)
+// 	for (auto const& x : forwarding_entry)
 // 	{
 // 		if (max_value <= x.second)
 // 		{
@@ -674,36 +666,31 @@ AquaSimMacLibra::UpdateWeight(AquaSimAddress src_addr, AquaSimAddress dst_addr,
 //	std::cout << "UPDATED REWARD: " << reward << "\n";
 	NS_LOG_DEBUG("UPDATED REWARD: " << reward);
 
-	std::map<AquaSimAddress, AquaSimAddress> src_dst_map;
-	src_dst_map.insert(std::make_pair(src_addr, dst_addr));
-
-	if (m_forwarding_table.count(src_dst_map) == 0)
+	bool created;
+	AquaSimNextHopWeights *m = m_forwarding_table.Insert(src_addr, dst_addr, created); // {next_hop : weight}
+	if (created)
 	{
 		// Create new entry with initial weight according to given reward
-		std::map<AquaSimAddress, double> m; // {next_hop : weight}
-
-		m.insert(std::make_pair(next_hop_addr, reward));
+		m->Add(next_hop_addr, reward);
 //		std::cout << "Creating new table entry with REWARD: " << reward << "\n";
 //		NS_LOG_DEBUG("Creating new table entry with REWARD: " << reward / 2);
-
-		m_forwarding_table.insert(std::make_pair(src_dst_map, m));
 	}
 	else
 	{
 		// Check if the next_hop_entry exist, if not - create one and return
-		if (m_forwarding_table.find(src_dst_map)->second.count(next_hop_addr) == 0)
+		double *current_weight = m->Find(next_hop_addr);
+		if (current_weight == 0)
 		{
-			m_forwarding_table.find(src_dst_map)->second.insert(std::make_pair(next_hop_addr, reward));
+			m->Add(next_hop_addr, reward);
 			return 0;
 		}
 
-		double current_weight = m_forwarding_table.find(src_dst_map)->second.find(next_hop_addr)->second;
-//		NS_LOG_DEBUG("CURRENT WEIGHT: " << current_weight << " Node Address: " << AquaSimAddress::ConvertFrom(m_device->GetAddress()));
+//		NS_LOG_DEBUG("CURRENT WEIGHT: " << *current_weight << " Node Address: " << AquaSimAddress::ConvertFrom(m_device->GetAddress()));
 //		NS_LOG_DEBUG("REWARD: " << reward);
-//		NS_LOG_DEBUG("TABLE SIZE: " << m_forwarding_table.size());
+//		NS_LOG_DEBUG("TABLE SIZE: " << m_forwarding_table.GetN());
 
 		// Calculate sample average and update the weight
-		m_forwarding_table.find(src_dst_map)->second.at(next_hop_addr) = (current_weight + reward) / 2;
+		*current_weight = (*current_weight + reward) / 2;
 	}
 	return 0;
 }
@@ -8,6 +8,7 @@
 #define AQUA_SIM_MAC_LIBRA_H
 
 #include "aqua-sim-mac.h"
+#include "aqua-sim-addr-pair-table.h"
 #include <math.h>
 
 
@@ -105,9 +106,6 @@ public:
 
 protected:
   virtual void DoDispose();
-  // Expiration handlers. Not used for now.
-  void RewardExpirationHandler(std::map<AquaSimAddress, AquaSimAddress> dst_to_next_hop_map);
-
 
 private:
   Ptr<UniformRandomVariable> m_rand;
@@ -115,7 +113,7 @@ private:
   // Forwarding table to select next-hop nodes, in a format: {dst_addr : [next_hop_addr: weight]}
 //  std::map<AquaSimAddress, std::map<AquaSimAddress, double>> m_forwarding_table;
   // Map of (src, dst) pair and the corresponding weight
-  std::map<std::map<AquaSimAddress, AquaSimAddress>, std::map<AquaSimAddress, double>> m_forwarding_table;
+  AquaSimAddrPairTable<AquaSimNextHopWeights> m_forwarding_table;
 
   // Store the packets in send_queue until path discovery procedure is successful or failed, in a format:
   // {dst_addr: packet_queue}
@@ -124,11 +122,6 @@ private:
   // Store the packets which have been already triggered to be sent, but failed due to device not idle status
   std::queue<Ptr<Packet>> m_send_buffer;
 
-  // Store reward expiration timestamps, needed when the expire event is triggered by the scheduler,
-  // or when the reward message is received,
-  // in a format: {{dst_addr : next_hop_addr} : last_recevied_reward_timestamp}
-  std::map<std::map<AquaSimAddress, AquaSimAddress>, Time> m_reward_expirations;
-
   // Store INIT expiration timestamps, needed when the expire event is triggered by the scheduler,
   // or when the INIT message is received,
   // in a format: {dst_addr: last_recevied_init_timestamp}
@@ -138,7 +131,7 @@ private:
   std::map<AquaSimAddress, Time> m_init_list;
 
   // Store list of {dst_addr, sender_addr} pairs to periodically generate the reward packets back to sender
-  std::map<std::map<AquaSimAddress, AquaSimAddress>, Time> m_reward_delays;
+  AquaSimAddrPairTable<Time> m_reward_delays;
 
   // ACK / Reward delay on receiver side
   Time m_reward_delay = Seconds(1);
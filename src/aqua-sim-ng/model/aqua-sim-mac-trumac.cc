@@ -26,6 +26,7 @@
 
 #include "ns3/log.h"
 #include "ns3/integer.h"
+#include "ns3/uinteger.h"
 #include "ns3/simulator.h"
 
 #include <algorithm>
@@ -82,6 +83,10 @@ AquaSimTrumac::GetTypeId()
         UintegerValue(0), // 0 - random; 1 - optimal (nearest-neighbor)
         MakeUintegerAccessor(&AquaSimTrumac::m_algo_id),
         MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("TwoOptBudget", "Number of 2-opt moves evaluated to refine the nearest-neighbor schedule (0 disables)",
+        UintegerValue(5000000),
+        MakeUintegerAccessor(&AquaSimTrumac::m_two_opt_budget),
+        MakeUintegerChecker<uint64_t> ())
     ;
   return tid;
 }
@@ -108,26 +113,10 @@ AquaSimTrumac::initCycle()
   //   std::cout << senderModel->GetPosition().x << "\n";
   // }
 
-  // populate the global list of nodes' coordinates
-  if (m_graph.size() == 0)
+  // compute the schedule once, from the global list of nodes' coordinates
+  if (!m_schedule)
   {
-    double dist = 0;
-    for (uint32_t i = 0; i < m_total_nodes; i++)
-    {
-      for (uint32_t j = 0; j < m_total_nodes; j++)
-      {
-        // if (i < j)
-        if (i != j)
-        {
-          Ptr<MobilityModel> senderModel = m_device->GetChannel()->GetDevice(i)->GetNode()->GetObject<MobilityModel>();
-          Ptr<MobilityModel> recvModel = m_device->GetChannel()->GetDevice(j)->GetNode()->GetObject<MobilityModel>();
-          dist = senderModel->GetDistanceFrom(recvModel);
-          m_graph.insert(std::make_pair(std::make_pair(i,j), dist));
-        }
-      }
-    }
-    // store the sub-optimal greedy (nearest neighbor) schedule
-    m_schedule = runNearestNeighborTSP();
+    runNearestNeighborTSP();
   }
   // else
   // {
@@ -175,49 +164,15 @@ AquaSimTrumac::initDataContention()
 std::vector<uint32_t>
 AquaSimTrumac::runNearestNeighborTSP()
 {
-  std::vector<uint32_t> optimalSchedule;
-  std::vector<uint32_t> currentSchedule;
-  double optimalSum = 100000000;
-  double currentSum = 0;
-  
-  for (uint32_t n=0; n<m_total_nodes; n++)
+  std::vector<Vector> positions;
+  positions.reserve(m_total_nodes);
+  for (uint32_t i = 0; i < m_total_nodes; i++)
   {
-    currentSchedule.clear();
-    currentSchedule.push_back(n);
-    currentSum = 0;
-
-    uint32_t nextNode = n;
-    while (currentSchedule.size() < m_total_nodes)
-    {
-      double w = 1000000000;
-      uint32_t currentBestNode = 0;
-      for (auto it = m_graph.begin(); it != m_graph.end(); it++)
-      {
-        if (it->first.first == nextNode)
-        {
-          if (std::find(currentSchedule.begin(), currentSchedule.end(), it->first.second) == currentSchedule.end())
-          {
-            if (it->second < w)
-            {
-              w = it->second;
-              currentBestNode = it->first.second;
-            }
-          }
-        }
-      }
-      nextNode = currentBestNode;
-      currentSchedule.push_back(nextNode);
-      currentSum += w;
-    }
-    // check if this starting node is the best one
-    if (currentSum < optimalSum)
-    {
-      optimalSum = currentSum;
-      optimalSchedule.clear();
-      optimalSchedule = currentSchedule;
-    }
+    positions.push_back(m_device->GetChannel()->GetDevice(i)->GetNode()->GetObject<MobilityModel>()->GetPosition());
   }
-  return optimalSchedule;
+  // nodes with the same view of the swarm share one schedule
+  m_schedule = AquaSimTrumacSchedule::Get(positions, m_two_opt_budget);
+  return m_schedule->GetTour();
 }
 
 void
@@ -307,22 +262,12 @@ AquaSimTrumac::selectNextNode()
   }
   else if (m_algo_id == 1)
   {
-    // sub-optimal TSP (greedy/nearest-neighbor selection TSP)
-    for (uint32_t i=0; i<m_schedule.size(); i++)
+    // sub-optimal TSP (greedy/nearest-neighbor selection TSP, refined by 2-opt)
+    uint32_t id = m_device->GetNode()->GetId();
+    if (m_schedule && id < m_schedule->GetTour().size())
     {
-      if (m_schedule.at(i) == m_device->GetNode()->GetId())
-      {
-        if (i != m_schedule.size()-1)
-        {
-          next_node = m_schedule.at(i+1);
-        }
-        else
-        {
-          // the last node in the schedule --> go to the first node
-          next_node = m_schedule.at(0);
-        }
-        break;
-      }
+      // successor in the cycle; the last node in the schedule --> the first node
+      next_node = m_schedule->GetNext(id);
     }
     return next_node;
   }
@@ -454,5 +399,6 @@ AquaSimTrumac::TxProcess(Ptr<Packet> pkt)
 void AquaSimTrumac::DoDispose()
 {
   NS_LOG_FUNCTION(this);
+  m_schedule.reset();
   AquaSimMac::DoDispose();
 }
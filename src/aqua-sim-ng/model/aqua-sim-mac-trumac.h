@@ -24,6 +24,9 @@
 #include "aqua-sim-mac.h"
 #include "aqua-sim-header.h"
 #include "aqua-sim-header-mac.h"
+#include "aqua-sim-trumac-schedule.h"
+
+#include <memory>
 
 namespace ns3 {
 
@@ -55,7 +58,7 @@ public:
 
   uint32_t getIdbyAddress(AquaSimAddress address);
 
-  // run nearest-neightbor TSP algorithm, return sub-optimal sequence of nodes (schedule)
+  // run nearest-neightbor TSP algorithm (plus 2-opt), return sub-optimal sequence of nodes (schedule)
   std::vector<uint32_t> runNearestNeighborTSP();
 
   // periodically initiate a contention-based data transmission, if no transmissions have been heard within a certain time interval
@@ -83,9 +86,11 @@ private:
 
   uint32_t m_algo_id;
 
-  // store list of all nodes' coordinates
-  std::map<std::pair<uint32_t, uint32_t>, double> m_graph;
-  std::vector<uint32_t> m_schedule;
+  // 2-opt moves evaluated when refining the schedule, 0 for nearest-neighbor only
+  uint64_t m_two_opt_budget;
+
+  // schedule over all nodes' coordinates, shared with nodes holding the same view
+  std::shared_ptr<const AquaSimTrumacSchedule> m_schedule;
 
   // keep track of all the node ids, overheard during the TR-cycle
   std::vector<uint8_t> m_heard_node_ids;
@@ -354,6 +354,7 @@ AquaSimMobilityPattern::DoSetPosition (const Vector &position)
   //e.m_sp = m_lc->GetLastLoc().m_sp;
   RestrictLocByBound(e);
   m_lc->AddNewLoc(e);
+  NotifyCourseChange();
 }
 
 Vector
@@ -0,0 +1,498 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aqua-sim-mpi-channel.h"
+#include "aqua-sim-header.h"
+#include "aqua-sim-phy.h"
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/mobility-model.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/distributed-simulator-impl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimMpiChannel");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimMpiTxRecord);
+NS_OBJECT_ENSURE_REGISTERED (AquaSimMpiChannel);
+
+namespace {
+
+void
+WriteDouble (Buffer::Iterator &i, double v)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &v, sizeof (bits));
+  i.WriteHtonU64 (bits);
+}
+
+double
+ReadDouble (Buffer::Iterator &i)
+{
+  uint64_t bits = i.ReadNtohU64 ();
+  double v;
+  std::memcpy (&v, &bits, sizeof (v));
+  return v;
+}
+
+}  // namespace
+
+AquaSimMpiTxRecord::AquaSimMpiTxRecord ()
+  : m_node (0),
+    m_ifIndex (0)
+{
+}
+
+TypeId
+AquaSimMpiTxRecord::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimMpiTxRecord")
+    .SetParent<Header> ()
+    .AddConstructor<AquaSimMpiTxRecord> ()
+  ;
+  return tid;
+}
+
+TypeId
+AquaSimMpiTxRecord::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+AquaSimMpiTxRecord::SetSender (uint32_t nodeId, uint32_t ifIndex)
+{
+  m_node = nodeId;
+  m_ifIndex = ifIndex;
+}
+
+void
+AquaSimMpiTxRecord::SetPosition (Vector position)
+{
+  m_position = position;
+}
+
+void
+AquaSimMpiTxRecord::SetTxStart (Time txStart)
+{
+  m_txStart = txStart;
+}
+
+uint32_t
+AquaSimMpiTxRecord::GetSenderNode (void) const
+{
+  return m_node;
+}
+
+uint32_t
+AquaSimMpiTxRecord::GetSenderIfIndex (void) const
+{
+  return m_ifIndex;
+}
+
+Vector
+AquaSimMpiTxRecord::GetPosition (void) const
+{
+  return m_position;
+}
+
+Time
+AquaSimMpiTxRecord::GetTxStart (void) const
+{
+  return m_txStart;
+}
+
+uint32_t
+AquaSimMpiTxRecord::GetSerializedSize (void) const
+{
+  return 4 + 4 + 3 * 8 + 8;
+}
+
+void
+AquaSimMpiTxRecord::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_node);
+  i.WriteHtonU32 (m_ifIndex);
+  /* exact coordinates, so both sides compute the same delays */
+  WriteDouble (i, m_position.x);
+  WriteDouble (i, m_position.y);
+  WriteDouble (i, m_position.z);
+  i.WriteHtonU64 (m_txStart.GetTimeStep ());
+}
+
+uint32_t
+AquaSimMpiTxRecord::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_node = i.ReadNtohU32 ();
+  m_ifIndex = i.ReadNtohU32 ();
+  m_position.x = ReadDouble (i);
+  m_position.y = ReadDouble (i);
+  m_position.z = ReadDouble (i);
+  m_txStart = TimeStep (i.ReadNtohU64 ());
+  return GetSerializedSize ();
+}
+
+void
+AquaSimMpiTxRecord::Print (std::ostream &os) const
+{
+  os << "MpiTxRecord: Node(" << m_node << ") IfIndex(" << m_ifIndex << ") Position("
+     << m_position << ") TxStart(" << m_txStart.GetSeconds () << ")";
+}
+
+
+TypeId
+AquaSimMpiChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimMpiChannel")
+    .SetParent<AquaSimChannel> ()
+    .AddConstructor<AquaSimMpiChannel> ()
+    .AddAttribute ("MaxSoundSpeed", "Upper bound of the sound speed (m/s) used for the lookahead.",
+       DoubleValue (1600),
+       MakeDoubleAccessor (&AquaSimMpiChannel::m_maxSoundSpeed),
+       MakeDoubleChecker<double> (0))
+    .AddAttribute ("MobilityMargin", "How far (m) a node may move out of its rank's region.",
+       DoubleValue (0),
+       MakeDoubleAccessor (&AquaSimMpiChannel::m_mobilityMargin),
+       MakeDoubleChecker<double> (0))
+    ;
+  return tid;
+}
+
+AquaSimMpiChannel::AquaSimMpiChannel ()
+  : m_maxSoundSpeed (1600),
+    m_mobilityMargin (0),
+    m_distributed (false),
+    m_rank (0),
+    m_lookahead (Time::Max ()),
+    m_forwarded (0),
+    m_pruned (0),
+    m_remote (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimMpiChannel::~AquaSimMpiChannel ()
+{
+}
+
+void
+AquaSimMpiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_remoteDevices.clear ();
+  AquaSimChannel::DoDispose ();
+}
+
+std::vector<uint32_t>
+AquaSimMpiChannel::AssignShards (const std::vector<Vector> &positions, uint32_t nShards)
+{
+  NS_ASSERT (nShards > 0);
+  std::vector<uint32_t> shard (positions.size (), 0);
+  std::vector<uint32_t> order (positions.size ());
+  for (uint32_t i = 0; i < order.size (); i++)
+    order[i] = i;
+  Bisect (order.begin (), order.end (), 0, nShards, positions, shard);
+  return shard;
+}
+
+void
+AquaSimMpiChannel::Bisect (std::vector<uint32_t>::iterator begin,
+                           std::vector<uint32_t>::iterator end,
+                           uint32_t first, uint32_t count,
+                           const std::vector<Vector> &pos, std::vector<uint32_t> &shard)
+{
+  if (count == 1 || begin == end)
+    {
+      for (std::vector<uint32_t>::iterator it = begin; it != end; ++it)
+        shard[*it] = first;
+      return;
+    }
+
+  /* split across the widest extent, sizes proportional to the shards on
+     either side */
+  Vector lo = pos[*begin], hi = pos[*begin];
+  for (std::vector<uint32_t>::iterator it = begin; it != end; ++it)
+    {
+      const Vector &p = pos[*it];
+      lo = Vector (std::min (lo.x, p.x), std::min (lo.y, p.y), std::min (lo.z, p.z));
+      hi = Vector (std::max (hi.x, p.x), std::max (hi.y, p.y), std::max (hi.z, p.z));
+    }
+  int axis = 0;
+  if (hi.y - lo.y > hi.x - lo.x)
+    axis = 1;
+  if (hi.z - lo.z > std::max (hi.x - lo.x, hi.y - lo.y))
+    axis = 2;
+
+  auto coord = [&pos, axis] (uint32_t n) {
+    return axis == 0 ? pos[n].x : axis == 1 ? pos[n].y : pos[n].z;
+  };
+  std::sort (begin, end, [&coord] (uint32_t a, uint32_t b) {
+    return coord (a) < coord (b) || (coord (a) == coord (b) && a < b);
+  });
+
+  /* cut where the coordinate changes, nearest to the proportional split, so
+     the two halves' regions stay apart */
+  uint32_t left = count / 2;
+  std::ptrdiff_t n = end - begin;
+  std::ptrdiff_t target = n * left / count;
+  std::ptrdiff_t cut = target;
+  for (std::ptrdiff_t d = 0; d < n; d++)
+    {
+      if (target - d > 0 && coord (begin[target - d - 1]) < coord (begin[target - d]))
+        {
+          cut = target - d;
+          break;
+        }
+      if (target + d < n && target + d > 0
+          && coord (begin[target + d - 1]) < coord (begin[target + d]))
+        {
+          cut = target + d;
+          break;
+        }
+    }
+  std::vector<uint32_t>::iterator mid = begin + cut;
+  Bisect (begin, mid, first, left, pos, shard);
+  Bisect (mid, end, first + left, count - left, pos, shard);
+}
+
+double
+AquaSimMpiChannel::Distance (const Region &region, const Vector &p)
+{
+  double dx = std::max (0.0, std::max (region.lo.x - p.x, p.x - region.hi.x));
+  double dy = std::max (0.0, std::max (region.lo.y - p.y, p.y - region.hi.y));
+  double dz = std::max (0.0, std::max (region.lo.z - p.z, p.z - region.hi.z));
+  return std::sqrt (dx * dx + dy * dy + dz * dz);
+}
+
+double
+AquaSimMpiChannel::Distance (const Region &a, const Region &b)
+{
+  double dx = std::max (0.0, std::max (a.lo.x - b.hi.x, b.lo.x - a.hi.x));
+  double dy = std::max (0.0, std::max (a.lo.y - b.hi.y, b.lo.y - a.hi.y));
+  double dz = std::max (0.0, std::max (a.lo.z - b.hi.z, b.lo.z - a.hi.z));
+  return std::sqrt (dx * dx + dy * dy + dz * dz);
+}
+
+Time
+AquaSimMpiChannel::Delay (double distance) const
+{
+  double seconds = distance / m_maxSoundSpeed;
+  Time delay = Seconds (seconds);
+  if (delay.GetSeconds () > seconds)
+    delay -= TimeStep (1);   //round down, never up
+  return delay;
+}
+
+void
+AquaSimMpiChannel::UpdateShards (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_distributed = MpiInterface::IsEnabled () && MpiInterface::GetSize () > 1;
+  if (!m_distributed)
+    return;
+  m_rank = MpiInterface::GetSystemId ();
+  uint32_t nRanks = MpiInterface::GetSize ();
+
+  /* the channel keeps every device seen so far, local or not */
+  std::vector<Ptr<AquaSimNetDevice> > all (m_deviceList);
+  all.insert (all.end (), m_remoteDevices.begin (), m_remoteDevices.end ());
+  std::sort (all.begin (), all.end (), [] (Ptr<AquaSimNetDevice> a, Ptr<AquaSimNetDevice> b) {
+    return a->GetNode ()->GetId () < b->GetNode ()->GetId ();
+  });
+  m_deviceList.clear ();
+  m_remoteDevices.clear ();
+
+  Region none;
+  none.empty = true;
+  m_regions.assign (nRanks, none);
+  for (std::vector<Ptr<AquaSimNetDevice> >::iterator it = all.begin (); it != all.end (); ++it)
+    {
+      Ptr<Node> node = (*it)->GetNode ();
+      uint32_t rank = node->GetSystemId ();
+      NS_ABORT_MSG_UNLESS (rank < nRanks, "node " << node->GetId () << " owned by rank " << rank
+                           << " of " << nRanks);
+      if (rank == m_rank)
+        m_deviceList.push_back (*it);
+      else
+        m_remoteDevices.push_back (*it);
+
+      Vector p = GetPosition (*it);
+      Region &r = m_regions[rank];
+      if (r.empty)
+        {
+          r.empty = false;
+          r.lo = r.hi = p;
+          r.gatewayNode = node->GetId ();
+          r.gatewayIfIndex = (*it)->GetIfIndex ();
+        }
+      r.lo = Vector (std::min (r.lo.x, p.x), std::min (r.lo.y, p.y), std::min (r.lo.z, p.z));
+      r.hi = Vector (std::max (r.hi.x, p.x), std::max (r.hi.y, p.y), std::max (r.hi.z, p.z));
+    }
+  for (std::vector<Region>::iterator r = m_regions.begin (); r != m_regions.end (); ++r)
+    {
+      r->lo = r->lo - Vector (m_mobilityMargin, m_mobilityMargin, m_mobilityMargin);
+      r->hi = r->hi + Vector (m_mobilityMargin, m_mobilityMargin, m_mobilityMargin);
+    }
+  if (m_spatialIndex)
+    m_spatialIndex->Invalidate ();
+  if (m_snapshot)
+    m_snapshot->Invalidate ();
+
+  /* shortest crossing between this rank's region and every other one */
+  m_pairDelay.assign (nRanks, Time::Max ());
+  m_lookahead = Time::Max ();
+  const Region &mine = m_regions[m_rank];
+  for (uint32_t r = 0; r < nRanks; r++)
+    {
+      if (r == m_rank || mine.empty || m_regions[r].empty)
+        continue;
+      m_pairDelay[r] = Delay (Distance (mine, m_regions[r]));
+      NS_ABORT_MSG_UNLESS (m_pairDelay[r].IsStrictlyPositive (),
+                           "regions of ranks " << m_rank << " and " << r
+                           << " touch; no lookahead (use AssignShards or a smaller MobilityMargin)");
+      m_lookahead = Min (m_lookahead, m_pairDelay[r]);
+    }
+
+  Ptr<DistributedSimulatorImpl> impl =
+      DynamicCast<DistributedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_ABORT_MSG_UNLESS (impl, "AquaSimMpiChannel needs ns3::DistributedSimulatorImpl");
+  if (m_lookahead != Time::Max ())
+    impl->BoundLookAhead (m_lookahead);
+
+  if (!mine.empty)
+    {
+      Ptr<NetDevice> gateway = NodeList::GetNode (mine.gatewayNode)->GetDevice (mine.gatewayIfIndex);
+      Ptr<MpiReceiver> receiver = gateway->GetObject<MpiReceiver> ();
+      if (!receiver)
+        {
+          receiver = CreateObject<MpiReceiver> ();
+          gateway->AggregateObject (receiver);
+        }
+      receiver->SetReceiveCallback (MakeCallback (&AquaSimMpiChannel::RemoteRecv, this));
+    }
+  NS_LOG_INFO ("rank " << m_rank << ": " << m_deviceList.size () << " local and "
+               << m_remoteDevices.size () << " remote devices, lookahead " << m_lookahead);
+}
+
+bool
+AquaSimMpiChannel::Recv (Ptr<Packet> p, Ptr<AquaSimPhy> phy)
+{
+  NS_LOG_FUNCTION (this << p << phy);
+  Ptr<AquaSimNetDevice> sender = phy->GetNetDevice ();
+  if (!m_distributed)
+    {
+      NS_ABORT_MSG_IF (MpiInterface::IsEnabled () && MpiInterface::GetSize () > 1,
+                       "AquaSimMpiChannel::UpdateShards() was not called before Run()");
+      return SendUp (p, sender, Seconds (0));
+    }
+
+  NS_ABORT_MSG_UNLESS (sender->GetNode ()->GetSystemId () == m_rank,
+                       "node " << sender->GetNode ()->GetId () << " transmits on rank " << m_rank
+                       << " but is owned by rank " << sender->GetNode ()->GetSystemId ());
+
+  AquaSimPacketStamp pstamp;
+  p->PeekHeader (pstamp);
+  Vector pos = GetPosition (sender);
+  bool bounded = m_prop->IsRangeLimited () && pstamp.GetTxRange () > 0;
+
+  AquaSimMpiTxRecord record;
+  record.SetSender (sender->GetNode ()->GetId (), sender->GetIfIndex ());
+  record.SetPosition (pos);
+  record.SetTxStart (Simulator::Now ());
+  for (uint32_t r = 0; r < m_regions.size (); r++)
+    {
+      const Region &region = m_regions[r];
+      if (r == m_rank || region.empty)
+        continue;
+      double distance = Distance (region, pos);
+      if (bounded && distance > pstamp.GetTxRange ())
+        {
+          m_pruned++;
+          continue;
+        }
+      /* the sound needs at least this long to reach any node of rank r,
+         and it is never shorter than r's lookahead */
+      Time delay = Max (Delay (distance), m_pairDelay[r]);
+      Ptr<Packet> relay = p->Copy ();
+      relay->AddHeader (record);
+      MpiInterface::SendPacket (relay, Simulator::Now () + delay, region.gatewayNode,
+                                region.gatewayIfIndex);
+      m_forwarded++;
+    }
+  return SendUp (p, sender, Seconds (0));
+}
+
+void
+AquaSimMpiChannel::RemoteRecv (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  AquaSimMpiTxRecord record;
+  p->RemoveHeader (record);
+  m_remote++;
+
+  Ptr<Node> node = NodeList::GetNode (record.GetSenderNode ());
+  Ptr<AquaSimNetDevice> sender =
+      DynamicCast<AquaSimNetDevice> (node->GetDevice (record.GetSenderIfIndex ()));
+  NS_ASSERT (sender);
+  /* the local copy of a remote node is only a ghost: place it where the
+     owner saw it transmit */
+  GetMobilityModel (sender)->SetPosition (record.GetPosition ());
+  if (m_snapshot)
+    m_snapshot->Invalidate ();
+
+  SendUp (p, sender, Simulator::Now () - record.GetTxStart ());
+}
+
+Time
+AquaSimMpiChannel::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+uint64_t
+AquaSimMpiChannel::GetForwardCount (void) const
+{
+  return m_forwarded;
+}
+
+uint64_t
+AquaSimMpiChannel::GetPrunedCount (void) const
+{
+  return m_pruned;
+}
+
+uint64_t
+AquaSimMpiChannel::GetRemoteCount (void) const
+{
+  return m_remote;
+}
+
+}  // namespace ns3
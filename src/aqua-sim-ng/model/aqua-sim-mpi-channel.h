@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_MPI_CHANNEL_H
+#define AQUA_SIM_MPI_CHANNEL_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+#include <vector>
+
+#include "aqua-sim-channel.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief What a process needs to replay a remote transmission: who sent it,
+ * from where and when. Travels in front of the sender's packet, which keeps
+ * its AquaSimPacketStamp and AquaSimHeader.
+ */
+class AquaSimMpiTxRecord : public Header
+{
+public:
+  AquaSimMpiTxRecord ();
+  static TypeId GetTypeId (void);
+
+  void SetSender (uint32_t nodeId, uint32_t ifIndex);
+  void SetPosition (Vector position);
+  void SetTxStart (Time txStart);
+
+  uint32_t GetSenderNode (void) const;
+  uint32_t GetSenderIfIndex (void) const;
+  Vector GetPosition (void) const;
+  Time GetTxStart (void) const;
+
+  // Inherited methods
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+  virtual TypeId GetInstanceTypeId (void) const;
+
+private:
+  uint32_t m_node;
+  uint32_t m_ifIndex;
+  Vector m_position;
+  Time m_txStart;
+};  // class AquaSimMpiTxRecord
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief AquaSimChannel split across MPI processes.
+ *
+ * Follows the ns-3 distributed convention: every rank builds the whole
+ * topology and each node's system id names the rank that owns it.
+ * AssignShards() gives spatially compact ownership (recursive bisection of
+ * the node positions), so nodes create with Create<Node> (shard[i]).
+ *
+ * Once the devices are installed, every rank calls UpdateShards() before
+ * Simulator::Run(). The channel then keeps only its own rank's devices and
+ * the bounding box of every rank's nodes. A local transmission is delivered
+ * to local receivers as usual and, once per remote rank whose box lies
+ * within the sender's TxRange (every rank for unbounded or non range-limited
+ * propagation), an AquaSimMpiTxRecord with the packet goes to that rank's
+ * gateway device through MpiInterface. The receiving rank moves its ghost of
+ * the sender to the recorded position and runs the propagation over its own
+ * devices, scheduling each reception at the propagation delay less the time
+ * already spent in transit.
+ *
+ * A record for rank r is stamped to arrive after the sound needs to cross
+ * from the sender to r's box at MaxSoundSpeed, which is never less than the
+ * shard-boundary delay each rank hands to DistributedSimulatorImpl as its
+ * lookahead. Nodes may move MobilityMargin meters beyond their box; a
+ * record for a node that strays further can arrive after its propagation
+ * delay has passed. Such a reception is delivered on arrival with a warning
+ * and counted by GetLateCount(). Only the granted-time window simulator
+ * (ns3::DistributedSimulatorImpl) is supported.
+ *
+ * Without MPI, or on a single rank, it is a plain AquaSimChannel.
+ */
+class AquaSimMpiChannel : public AquaSimChannel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  AquaSimMpiChannel ();
+  virtual ~AquaSimMpiChannel ();
+
+  /// Owning rank of each position, \p nShards spatially compact groups.
+  static std::vector<uint32_t> AssignShards (const std::vector<Vector> &positions,
+                                             uint32_t nShards);
+
+  /**
+   * Split the devices by owning rank, record every rank's region and bound
+   * the simulator lookahead by the shortest crossing between regions.
+   * Call on every rank after the topology is built and before Run().
+   */
+  void UpdateShards (void);
+
+  /// Shortest propagation delay into this rank's region.
+  Time GetLookahead (void) const;
+  /// Records sent to other ranks.
+  uint64_t GetForwardCount (void) const;
+  /// Records that went nowhere because a rank's region was out of range.
+  uint64_t GetPrunedCount (void) const;
+  /// Records received from other ranks.
+  uint64_t GetRemoteCount (void) const;
+
+  // Inherited from AquaSimChannel
+  virtual bool Recv (Ptr<Packet> p, Ptr<AquaSimPhy> phy);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Axis-aligned bounds of one rank's nodes, grown by MobilityMargin.
+  struct Region
+  {
+    bool empty;
+    Vector lo;
+    Vector hi;
+    uint32_t gatewayNode;
+    uint32_t gatewayIfIndex;
+  };
+
+  static void Bisect (std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end,
+                      uint32_t first, uint32_t count, const std::vector<Vector> &positions,
+                      std::vector<uint32_t> &shard);
+  static double Distance (const Region &region, const Vector &p);
+  static double Distance (const Region &a, const Region &b);
+  Time Delay (double distance) const;
+  void RemoteRecv (Ptr<Packet> p);
+
+  double m_maxSoundSpeed;
+  double m_mobilityMargin;
+
+  bool m_distributed;
+  uint32_t m_rank;
+  std::vector<Region> m_regions;   //by rank
+  std::vector<Time> m_pairDelay;   //shard-boundary delay from this rank, by rank
+  std::vector<Ptr<AquaSimNetDevice> > m_remoteDevices;
+  Time m_lookahead;
+
+  uint64_t m_forwarded;
+  uint64_t m_pruned;
+  uint64_t m_remote;
+};  // class AquaSimMpiChannel
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_MPI_CHANNEL_H */
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+
+#include "aqua-sim-multilateration.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimMultilateration");
+
+namespace {
+
+/*
+ * Solve the symmetric 3x3 system a x = b by Cholesky; a holds the upper
+ * triangle (xx xy xz yy yz zz). Fails on pivots below eps * trace.
+ */
+bool
+Cholesky3 (const double *a, const double *b, double *x, double eps)
+{
+  double tr = std::max (a[0] + a[3] + a[5], 1e-300);
+  double l00 = a[0];
+  if (l00 <= eps * tr)
+    return false;
+  l00 = std::sqrt (l00);
+  double l10 = a[1] / l00;
+  double l20 = a[2] / l00;
+  double l11 = a[3] - l10 * l10;
+  if (l11 <= eps * tr)
+    return false;
+  l11 = std::sqrt (l11);
+  double l21 = (a[4] - l20 * l10) / l11;
+  double l22 = a[5] - l20 * l20 - l21 * l21;
+  if (l22 <= eps * tr)
+    return false;
+  l22 = std::sqrt (l22);
+
+  double y0 = b[0] / l00;
+  double y1 = (b[1] - l10 * y0) / l11;
+  double y2 = (b[2] - l20 * y0 - l21 * y1) / l22;
+  x[2] = y2 / l22;
+  x[1] = (y1 - l21 * x[2]) / l11;
+  x[0] = (y0 - l10 * x[1] - l20 * x[2]) / l00;
+  return true;
+}
+
+}  // namespace
+
+AquaSimMultilateration::AquaSimMultilateration ()
+  : m_maxIterations (20),
+    m_tolerance (1e-3),
+    m_hasEstimate (false),
+    m_rms (0),
+    m_iterations (0)
+{
+}
+
+void
+AquaSimMultilateration::SetMaxIterations (uint32_t n)
+{
+  m_maxIterations = n;
+}
+
+void
+AquaSimMultilateration::SetTolerance (double metres)
+{
+  m_tolerance = metres;
+}
+
+void
+AquaSimMultilateration::Clear (void)
+{
+  m_rows.clear ();
+}
+
+void
+AquaSimMultilateration::Reset (void)
+{
+  m_rows.clear ();
+  m_hasEstimate = false;
+  m_rms = 0;
+  m_iterations = 0;
+}
+
+void
+AquaSimMultilateration::AddRange (const Vector &anchor, double range)
+{
+  Measurement m;
+  m.anchor = anchor;
+  m.value = range;
+  m.difference = false;
+  m_rows.push_back (m);
+}
+
+void
+AquaSimMultilateration::AddRangeDifference (const Vector &anchor, const Vector &reference,
+                                            double difference)
+{
+  Measurement m;
+  m.anchor = anchor;
+  m.reference = reference;
+  m.value = difference;
+  m.difference = true;
+  m_rows.push_back (m);
+}
+
+void
+AquaSimMultilateration::Remove (uint32_t i)
+{
+  NS_ASSERT (i < m_rows.size ());
+  m_rows[i] = m_rows.back ();
+  m_rows.pop_back ();
+}
+
+uint32_t
+AquaSimMultilateration::GetN (void) const
+{
+  return m_rows.size ();
+}
+
+Vector
+AquaSimMultilateration::GetEstimate (void) const
+{
+  return m_estimate;
+}
+
+double
+AquaSimMultilateration::GetRms (void) const
+{
+  return m_rms;
+}
+
+uint32_t
+AquaSimMultilateration::GetIterations (void) const
+{
+  return m_iterations;
+}
+
+double
+AquaSimMultilateration::Residual (uint32_t i, const Vector &pos) const
+{
+  const Measurement &m = m_rows[i];
+  double f = CalculateDistance (pos, m.anchor) - m.value;
+  if (m.difference)
+    f -= CalculateDistance (pos, m.reference);
+  return f;
+}
+
+double
+AquaSimMultilateration::Cost (const Vector &pos) const
+{
+  double cost = 0;
+  for (uint32_t i = 0; i < m_rows.size (); i++)
+    {
+      double f = Residual (i, pos);
+      cost += f * f;
+    }
+  return cost;
+}
+
+double
+AquaSimMultilateration::Residual (const Vector &pos) const
+{
+  return m_rows.empty () ? 0 : std::sqrt (Cost (pos) / m_rows.size ());
+}
+
+void
+AquaSimMultilateration::ColdStart (Vector &pos) const
+{
+  // linearised ToA: 2 (a_i - a_0).(p - a_0) = r_0^2 - r_i^2 + |a_i - a_0|^2
+  const Measurement *first = 0;
+  double a[6] = {0, 0, 0, 0, 0, 0};
+  double b[3] = {0, 0, 0};
+  Vector centroid;
+  double spread = 0;
+  for (uint32_t i = 0; i < m_rows.size (); i++)
+    {
+      const Measurement &m = m_rows[i];
+      centroid = centroid + m.anchor;
+      spread += std::fabs (m.value);
+      if (m.difference)
+        continue;
+      if (!first)
+        {
+          first = &m;
+          continue;
+        }
+      Vector v = m.anchor - first->anchor;
+      double c = first->value * first->value - m.value * m.value + v.GetLengthSquared ();
+      double u[3] = {2 * v.x, 2 * v.y, 2 * v.z};
+      a[0] += u[0] * u[0]; a[1] += u[0] * u[1]; a[2] += u[0] * u[2];
+      a[3] += u[1] * u[1]; a[4] += u[1] * u[2]; a[5] += u[2] * u[2];
+      b[0] += u[0] * c; b[1] += u[1] * c; b[2] += u[2] * c;
+    }
+  double x[3];
+  if (first && Cholesky3 (a, b, x, 1e-9))
+    {
+      pos = Vector (first->anchor.x + x[0], first->anchor.y + x[1], first->anchor.z + x[2]);
+      return;
+    }
+  double n = m_rows.size ();
+  pos = Vector (centroid.x / n, centroid.y / n, centroid.z / n - spread / n / 2);
+}
+
+bool
+AquaSimMultilateration::Solve (void)
+{
+  Vector start;
+  if (m_hasEstimate)
+    start = m_estimate;
+  else
+    ColdStart (start);
+  return Solve (start);
+}
+
+bool
+AquaSimMultilateration::Solve (const Vector &start)
+{
+  m_iterations = 0;
+  if (m_rows.size () < 3)
+    return false;
+
+  Vector p = start;
+  double cost = Cost (p);
+  double mu = 1e-3;
+  while (m_iterations < m_maxIterations)
+    {
+      m_iterations++;
+      double a[6] = {0, 0, 0, 0, 0, 0};
+      double g[3] = {0, 0, 0};
+      for (uint32_t i = 0; i < m_rows.size (); i++)
+        {
+          const Measurement &m = m_rows[i];
+          Vector d = p - m.anchor;
+          double len = std::max (d.GetLength (), 1e-9);
+          double u[3] = {d.x / len, d.y / len, d.z / len};
+          double f = len - m.value;
+          if (m.difference)
+            {
+              Vector e = p - m.reference;
+              double elen = std::max (e.GetLength (), 1e-9);
+              u[0] -= e.x / elen; u[1] -= e.y / elen; u[2] -= e.z / elen;
+              f -= elen;
+            }
+          a[0] += u[0] * u[0]; a[1] += u[0] * u[1]; a[2] += u[0] * u[2];
+          a[3] += u[1] * u[1]; a[4] += u[1] * u[2]; a[5] += u[2] * u[2];
+          g[0] += u[0] * f; g[1] += u[1] * f; g[2] += u[2] * f;
+        }
+      // Marquardt damping scales the diagonal; the floor keeps flat
+      // directions (coplanar anchors) solvable
+      double damped[6] = {a[0], a[1], a[2], a[3], a[4], a[5]};
+      damped[0] += mu * (a[0] + 1e-6);
+      damped[3] += mu * (a[3] + 1e-6);
+      damped[5] += mu * (a[5] + 1e-6);
+      double step[3];
+      if (!Cholesky3 (damped, g, step, 1e-12))
+        {
+          mu *= 10;
+          continue;
+        }
+      Vector q (p.x - step[0], p.y - step[1], p.z - step[2]);
+      double next = Cost (q);
+      if (next <= cost)
+        {
+          p = q;
+          cost = next;
+          mu = std::max (mu / 10, 1e-9);
+          if (std::sqrt (step[0] * step[0] + step[1] * step[1] + step[2] * step[2]) < m_tolerance)
+            break;
+        }
+      else if ((mu *= 10) > 1e8)
+        break;
+    }
+
+  if (!std::isfinite (p.x) || !std::isfinite (p.y) || !std::isfinite (p.z))
+    return false;
+  m_estimate = p;
+  m_hasEstimate = true;
+  m_rms = std::sqrt (cost / m_rows.size ());
+  NS_LOG_DEBUG ("estimate " << p << " rms " << m_rms << " after " << m_iterations);
+  return true;
+}
+
+}  // namespace ns3
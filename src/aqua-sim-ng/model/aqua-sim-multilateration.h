@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_MULTILATERATION_H
+#define AQUA_SIM_MULTILATERATION_H
+
+#include <vector>
+
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Least-squares position from ranges (ToA) and range differences
+ * (TDoA) to anchors at known positions.
+ *
+ * Solve() runs damped Gauss-Newton (Levenberg-Marquardt) steps on the
+ * 3x3 normal equations, which are accumulated in place, so a solve costs
+ * O(measurements) per iteration and allocates nothing once the measurement
+ * buffer has grown. It starts from the previous estimate, or from the
+ * linearised ToA system (first range subtracted from the others) when
+ * there is none; if the anchors are coplanar that system is singular and
+ * the start is their centroid, nudged below them. Ranges and differences
+ * are in metres: callers scale times by their sound speed.
+ *
+ * Residual() gives the RMS misfit of any position, e.g. a reported one,
+ * against the measurements without solving.
+ */
+class AquaSimMultilateration
+{
+public:
+  AquaSimMultilateration ();
+
+  void SetMaxIterations (uint32_t n);
+  void SetTolerance (double metres);
+
+  /// Drop the measurements; the estimate stays as the next warm start.
+  void Clear (void);
+  /// Clear and forget the estimate.
+  void Reset (void);
+  void AddRange (const Vector &anchor, double range);
+  /// |p - anchor| - |p - reference| = difference.
+  void AddRangeDifference (const Vector &anchor, const Vector &reference, double difference);
+  void Remove (uint32_t i);
+  uint32_t GetN (void) const;
+
+  bool Solve (void);
+  bool Solve (const Vector &start);
+  Vector GetEstimate (void) const;
+  /// RMS residual at the estimate (m).
+  double GetRms (void) const;
+  uint32_t GetIterations (void) const;
+
+  /// RMS misfit of pos against all measurements (m).
+  double Residual (const Vector &pos) const;
+  /// Signed misfit of pos against measurement i (m).
+  double Residual (uint32_t i, const Vector &pos) const;
+
+private:
+  struct Measurement
+  {
+    Vector anchor;
+    Vector reference;
+    double value;
+    bool difference;
+  };
+
+  double Cost (const Vector &pos) const;
+  void ColdStart (Vector &pos) const;
+
+  std::vector<Measurement> m_rows;
+  uint32_t m_maxIterations;
+  double m_tolerance;
+  Vector m_estimate;
+  bool m_hasEstimate;
+  double m_rms;
+  uint32_t m_iterations;
+};  // class AquaSimMultilateration
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_MULTILATERATION_H */
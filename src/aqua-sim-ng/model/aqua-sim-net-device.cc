@@ -143,7 +143,8 @@ void
 AquaSimNetDevice::DoDispose (void)
 {
   NS_LOG_FUNCTION(this);
-  m_phy->Dispose();
+  if (m_phy)
+    m_phy->Dispose();
   /* Used to call phy layer Dispose() due to reference cycle restricting typical Object disposal.
       Leading to false memory leak reports in tools such as valgrind. */
   m_phy=0;
@@ -164,7 +165,8 @@ AquaSimNetDevice::DoDispose (void)
 void
 AquaSimNetDevice::DoInitialize (void)
 {
-  //m_phy->Initialize ();
+  if (m_phy)
+    m_phy->Initialize ();
   //m_mac->Initialize ();
   //m_app->Initialize ();
   //channel?
@@ -78,6 +78,13 @@ AquaSimNoiseGen::Noise(double frequency) {
   return (10 * std::log10 (turbulence + ship + wind + thermal) );
 }
 
+int64_t
+AquaSimNoiseGen::AssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+
 /* AquaSimConstNoiseGen */
 AquaSimConstNoiseGen::AquaSimConstNoiseGen() :
     m_noise(0)
@@ -129,6 +136,7 @@ AquaSimConstNoiseGen::Initialize()
 AquaSimRandNoiseGen::AquaSimRandNoiseGen() :
     m_noise(0)
 {
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 AquaSimRandNoiseGen::~AquaSimRandNoiseGen()
@@ -161,11 +169,18 @@ AquaSimRandNoiseGen::Noise(Time t, Vector vector) {
 
 double
 AquaSimRandNoiseGen::Noise() {
-  Ptr<UniformRandomVariable> m_rand = CreateObject<UniformRandomVariable> ();
   m_noise = m_rand->GetValue(m_min,m_max);
   return m_noise;
 }
 
+int64_t
+AquaSimRandNoiseGen::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream(stream);
+  return 1;
+}
+
 void
 AquaSimRandNoiseGen::SetBounds(double min, double max) {
   m_min = min;
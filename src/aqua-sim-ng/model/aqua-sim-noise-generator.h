@@ -23,6 +23,7 @@
 
 #include "ns3/object.h"
 #include "ns3/vector.h"
+#include "ns3/random-variable-stream.h"
 
 namespace ns3 {
 
@@ -42,6 +43,8 @@ public:
   virtual double Noise (void) = 0;
   double Noise(double frequency);
   virtual void SetNoise(double noise)=0;
+  /// Fix the random streams of this generator, none for deterministic noise.
+  virtual int64_t AssignStreams (int64_t stream);
 
 private:
   double m_windNoise;
@@ -80,11 +83,13 @@ public:
   virtual double Noise (void);
   void SetBounds(double min, double max);
   virtual void SetNoise(double noise);
+  virtual int64_t AssignStreams (int64_t stream);
 
 private:
   double m_noise;
   double m_min;
   double m_max;
+  Ptr<UniformRandomVariable> m_rand;
 };	// class AquaSimRandNoiseGen
 
 /**
@@ -33,6 +33,7 @@
 #include "aqua-sim-header-mac.h"
 #include "aqua-sim-energy-model.h"
 #include "aqua-sim-phy-cmn.h"
+#include "aqua-sim-rx-info-tag.h"
 
 //Aqua Sim Phy Cmn
 
@@ -80,8 +81,6 @@ AquaSimPhyCmn::AquaSimPhyCmn(void) :
   incPktCounter = 0;	//debugging purposes only
   outPktCounter = 0;
   pktRecvCounter = 0;
-
-  Simulator::Schedule(Seconds(1), &AquaSimPhyCmn::UpdateIdleEnergy, this); //start energy drain
 }
 
 AquaSimPhyCmn::~AquaSimPhyCmn(void)
@@ -147,6 +146,12 @@ AquaSimPhyCmn::GetTypeId(void)
       PointerValue(),
       MakePointerAccessor (&AquaSimPhyCmn::m_sC),
       MakePointerChecker<AquaSimSignalCache>())
+    .AddAttribute("EnergyUpdateInterval", "Period of idle energy settlement. Zero settles "
+      "only on state changes, projects the idle drain on energy queries and "
+      "schedules only the predicted depletion.",
+      TimeValue(Seconds(0)),
+      MakeTimeAccessor(&AquaSimPhyCmn::m_energyInterval),
+      MakeTimeChecker(Seconds(0)))
     .AddTraceSource("Rx", "A packet was receieved.",
       MakeTraceSourceAccessor (&AquaSimPhyCmn::m_rxLogger),
       "ns3::AquaSimPhy::TracedCallback")
@@ -156,6 +161,9 @@ AquaSimPhyCmn::GetTypeId(void)
     .AddTraceSource("RxColl", "Count collision on Rx",
       MakeTraceSourceAccessor (&AquaSimPhyCmn::m_rxCollTrace),
       "ns3::AquaSimPhy::TracedCallback")
+    .AddTraceSource("RxEnd", "A packet was received successfully, with its received power, sender position and propagation delay.",
+      MakeTraceSourceAccessor (&AquaSimPhyCmn::m_rxEndTrace),
+      "ns3::AquaSimPhyCmn::RxEndTracedCallback")
     ;
   return tid;
 }
@@ -233,6 +241,7 @@ AquaSimPhyCmn::UpdateTxEnergy(Time txTime) {
 	}
 	else
 		NS_LOG_FUNCTION(this << " No EnergyModel set.");
+	ScheduleDepletion();
 }
 
 
@@ -248,7 +257,10 @@ AquaSimPhyCmn::UpdateRxEnergy(Time txTime, bool errorFlag) {
     return;
   }
 
-  if (startTime > m_updateEnergyTime) {
+  /* settle the idle drain first, which leaves the clock at exactly now
+   * for a device that was not receiving */
+  UpdateIdleEnergy();
+  if (startTime >= m_updateEnergyTime) {
     EM()->DecrIdleEnergy(startTime - m_updateEnergyTime);
     EM()->DecrRcvEnergy(txTime.GetSeconds());
     m_updateEnergyTime = endTime;
@@ -269,6 +281,7 @@ AquaSimPhyCmn::UpdateRxEnergy(Time txTime, bool errorFlag) {
     //NS_LOG_INFO("AquaSimPhyCmn::UpdateRxEnergy: -t " << Simulator::Now().GetSeconds() <<
       //" -n " << GetNetDevice()->GetAddress() << " -e 0");
   }
+  ScheduleDepletion();
 }
 
 void
@@ -277,24 +290,90 @@ AquaSimPhyCmn::UpdateIdleEnergy()
   if (!m_PoweredOn || EM() == NULL )
     return;
 
-  if (Simulator::Now().GetSeconds() > m_updateEnergyTime && m_PoweredOn) {
-    EM()->DecrIdleEnergy(Simulator::Now().GetSeconds() - m_updateEnergyTime);
+  if (Simulator::Now().GetSeconds() > m_updateEnergyTime) {
+    /* advance first: DecrIdleEnergy may end up querying the energy again */
+    double idle = Simulator::Now().GetSeconds() - m_updateEnergyTime;
     m_updateEnergyTime = Simulator::Now().GetSeconds();
+    EM()->DecrIdleEnergy(idle);
   }
+}
 
-  // log device energy
-  if (EM()->GetEnergy() > 0) {
-    //GetNetDevice()->LogEnergy(1);
-    //NS_LOG_INFO("AquaSimPhyCmn::UpdateRxEnergy: -t " << Simulator::Now().GetSeconds() <<
-      //" -n " << GetNetDevice()->GetAddress() << " -e " << EM()->GetEnergy());
-  }
-  else {
-    //GetNetDevice()->LogEnergy(0);
-    //NS_LOG_INFO("AquaSimPhyCmn::UpdateRxEnergy: -t " << Simulator::Now().GetSeconds() <<
-      //" -n " << GetNetDevice()->GetAddress() << " -e 0");
-  }
+double
+AquaSimPhyCmn::GetUnsettledIdleTime() const
+{
+  if (!m_PoweredOn)
+    return 0;
+  return std::max(0.0, Simulator::Now().GetSeconds() - m_updateEnergyTime);
+}
+
+void
+AquaSimPhyCmn::EnergyTimer()
+{
+  UpdateIdleEnergy();
+  if (m_energyInterval.IsZero())
+    ScheduleDepletion();
+  else
+    m_energyEvent = Simulator::Schedule(m_energyInterval, &AquaSimPhyCmn::EnergyTimer, this);
+}
+
+void
+AquaSimPhyCmn::DoInitialize()
+{
+  NS_LOG_FUNCTION(this);
+  /* start the energy drain once the device is configured */
+  if (m_energyInterval.IsZero())
+    ScheduleDepletion();
+  else
+    m_energyEvent = Simulator::Schedule(m_energyInterval, &AquaSimPhyCmn::EnergyTimer, this);
+  AquaSimPhy::DoInitialize();
+}
+
+/*
+ * Between state changes only idle power is drawn, so the time energy runs
+ * out is known in advance. Tx and rx intervals are charged up front by
+ * UpdateTxEnergy/UpdateRxEnergy and deplete the model there.
+ */
+void
+AquaSimPhyCmn::ScheduleDepletion()
+{
+  if (!m_energyInterval.IsZero())
+    return;
+  if (!m_PoweredOn || EM() == NULL || EM()->GetIdlePower() <= 0)
+    {
+      Simulator::Remove(m_energyEvent);
+      return;
+    }
+
+  double energy = EM()->GetEnergy();
+  if (energy <= 0)
+    {
+      Simulator::Remove(m_energyEvent);
+      return;
+    }
+  double now = Simulator::Now().GetSeconds();
+  Time at = Seconds(std::max(now, m_updateEnergyTime) + energy / EM()->GetIdlePower());
+  /* tx and rx only bring depletion closer: a pending check that is not
+   * later than the new estimate re-predicts when it fires */
+  if (m_energyEvent.IsRunning() && TimeStep(m_energyEvent.GetTs()) <= at)
+    return;
+  /* remove rather than cancel, so replaced predictions do not pile up in
+   * the event queue */
+  Simulator::Remove(m_energyEvent);
+  m_energyEvent = Simulator::Schedule(at - Simulator::Now(), &AquaSimPhyCmn::EnergyDepletionCheck, this);
+}
 
-  Simulator::Schedule(Seconds(1), &AquaSimPhyCmn::UpdateIdleEnergy, this);
+void
+AquaSimPhyCmn::EnergyDepletionCheck()
+{
+  UpdateIdleEnergy();
+  if (EM() == NULL)
+    return;
+  double energy = EM()->GetEnergy();
+  /* what rounding of the event time left over is less than 1ns of idle drain */
+  if (energy > 0 && energy <= EM()->GetIdlePower() * 1e-9)
+    EM()->DecrEnergy(1, energy);
+  else
+    ScheduleDepletion();
 }
 
 bool
@@ -609,6 +688,11 @@ AquaSimPhyCmn::SendPktUp(Ptr<Packet> p)
   NotifyRx(p);
   m_rxLogger(p, m_sC->GetNoise());
 
+  AquaSimRxInfoTag rxInfo;
+  if (p->RemovePacketTag(rxInfo)) {
+    m_rxEndTrace(p, rxInfo.GetPr(), rxInfo.GetSenderPosition(), rxInfo.GetPropDelay());
+  }
+
   //This can be shifted to within the switch to target specific packet types.
   if (GetNetDevice()->IsAttacker()){
     GetNetDevice()->GetAttackModel()->Recv(p);
@@ -674,13 +758,17 @@ AquaSimPhyCmn::PowerOn() {
     NS_LOG_FUNCTION(this << " Node " << GetNetDevice()->GetNode() << " is disabled.");
   else
   {
+    /* already on (e.g. woken by the MAC): drain idle up to now first */
+    UpdateIdleEnergy();
     m_PoweredOn = true;
     GetNetDevice()->SetTransmissionStatus(NIDLE);
     //SetPhyStatus(PHY_IDLE);
     if (EM() != NULL) {
+	    /* no idle drain while powered off */
+	    m_updateEnergyTime = std::max(Simulator::Now().GetSeconds(), m_updateEnergyTime);
 	    //minus the energy consumed by power on
 	    EM()->SetEnergy(std::max(0.0, EM()->GetEnergy() - m_EnergyTurnOn));
-	    m_updateEnergyTime = std::max(Simulator::Now().GetSeconds(), m_updateEnergyTime);
+	    ScheduleDepletion();
     }
   }
 }
@@ -689,10 +777,17 @@ void
 AquaSimPhyCmn::PowerOff() {
   NS_LOG_FUNCTION(this);
 
+  /* already off: SetTransmissionStatus() calls back into PowerOff() while
+   * the device sleeps, and the turn-off energy must only be charged once */
+  if (!m_PoweredOn)
+    return;
+
   if (GetNetDevice()->GetTransmissionStatus() == DISABLE)
     NS_LOG_FUNCTION(this << " Node " << GetNetDevice()->GetNode() << " is disabled.");
   else
   {
+    /* no idle drain is charged while off, so settle it before switching */
+    UpdateIdleEnergy();
     m_PoweredOn = false;
     GetNetDevice()->SetTransmissionStatus(SLEEP);
     //SetPhyStatus(PHY_SLEEP);
@@ -702,11 +797,7 @@ AquaSimPhyCmn::PowerOff() {
 
     //minus the energy consumed by power off
     EM()->SetEnergy(std::max(0.0, EM()->GetEnergy() - m_EnergyTurnOff));
-
-    if (Simulator::Now().GetSeconds() > m_updateEnergyTime) {
-      EM()->DecrIdleEnergy(Simulator::Now().GetSeconds() - m_updateEnergyTime);
-      m_updateEnergyTime = Simulator::Now().GetSeconds();
-    }
+    ScheduleDepletion();
   }
 }
 
@@ -746,6 +837,7 @@ AquaSimPhyCmn::StatusShift(double txTime) {
     double overlapTime = txTime;
     EM()->DecrEnergy(overlapTime, EM()->GetTxPower() - EM()->GetRxPower());
   }
+  ScheduleDepletion();
 }
 
 /**
@@ -808,6 +900,7 @@ AquaSimPhyCmn::PktRecvCount()
 void AquaSimPhyCmn::DoDispose()
 {
   NS_LOG_FUNCTION(this);
+  m_energyEvent.Cancel();
   m_sC->Dispose();
   m_sC=0;
   m_sinrChecker=0;
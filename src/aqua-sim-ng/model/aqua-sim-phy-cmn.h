@@ -28,10 +28,11 @@
 
 #include "ns3/nstime.h"
 //#include "ns3/timer.h"
-//#include "ns3/event-id.h"
+#include "ns3/event-id.h"
 //#include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/vector.h"
 
 #include "aqua-sim-phy.h"
 #include "aqua-sim-sinr-checker.h"
@@ -57,6 +58,17 @@ public:
   virtual ~AquaSimPhyCmn(void);
   static TypeId GetTypeId(void);
 
+  /**
+   * TracedCallback signature for the end of a successful reception.
+   *
+   * \param pkt received packet, as handed to the MAC.
+   * \param rssi received power computed by the propagation model.
+   * \param senderPos sender position at transmission time.
+   * \param propDelay propagation delay of the link.
+   */
+  typedef void (* RxEndTracedCallback) (Ptr<const Packet> pkt, double rssi,
+                                        Vector senderPos, Time propDelay);
+
   virtual void SetSinrChecker(Ptr<AquaSimSinrChecker> sinrChecker);
   virtual void SetSignalCache(Ptr<AquaSimSignalCache> sC);
   virtual void AddModulation(Ptr<AquaSimModulation> modulation, std::string modulationName);
@@ -69,7 +81,10 @@ public:
      * PktTransmit defaults to single channel if not specified
     */
 
+  /// Settle idle energy up to now; called on every state change.
   virtual void UpdateIdleEnergy(void);
+  /// Idle time not yet charged to the energy model.
+  virtual double GetUnsettledIdleTime(void) const;
 
   virtual void PowerOn();
   virtual void PowerOff();
@@ -181,6 +196,7 @@ protected:
 
   friend class AquaSimEnergyModel;
 
+  virtual void DoInitialize();
   virtual void DoDispose();
 
 private:
@@ -194,11 +210,19 @@ private:
   ns3::TracedCallback<Ptr<Packet>, double > m_rxLogger;
   ns3::TracedCallback<Ptr<Packet>, double > m_txLogger;
   ns3::TracedCallback<> m_rxCollTrace;
+  ns3::TracedCallback<Ptr<const Packet>, double, Vector, Time> m_rxEndTrace;
 
   // Collision flag in order to monitor whether there have been incoming packets wihtin the TxTime delay of the original packet.
   // If yes, then mark the original packet as collided as well.
   bool m_collision_flag = false;
 
+  void EnergyTimer(void);
+  void ScheduleDepletion(void);
+  void EnergyDepletionCheck(void);
+
+  Time m_energyInterval;  // periodic idle settlement, zero for lazy accounting
+  EventId m_energyEvent;  // next periodic settlement or predicted depletion
+
 }; //AquaSimPhyCmn
 
 } //namespace ns3
@@ -88,6 +88,7 @@ namespace ns3 {
     //virtual void PktTransmit(Ptr<Packet> p, Ptr<AquaSimPhy> src) = 0;
 
     virtual void UpdateIdleEnergy() = 0;
+    virtual double GetUnsettledIdleTime() const = 0;
     /***************
     * could this just be handled by energy model instead??? AquaSimEnergyModel()
     **************/
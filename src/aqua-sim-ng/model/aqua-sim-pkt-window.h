@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_PKT_WINDOW_H
+#define AQUA_SIM_PKT_WINDOW_H
+
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "aqua-sim-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Per-source sliding window of packet records.
+ *
+ * Holds one T per (source, sequence number) for the last windowSize+1
+ * sequence numbers of each source, in a fixed ring allocated once per
+ * source. Inserting sequence number n drops every record of that source
+ * below n - windowSize, as the old map-based packet tables did, but in
+ * amortized O(1): only the ring slots the window slid over are visited.
+ *
+ * A late packet that has already fallen out of the window is kept only
+ * while its ring slot is not needed by a packet inside the window.
+ */
+template <typename T>
+class AquaSimPktWindow
+{
+public:
+  AquaSimPktWindow (uint32_t windowSize);
+
+  /// Record of \p seq from \p src, or 0 if none is held.
+  T *Find (AquaSimAddress src, uint32_t seq);
+  /**
+   * Record of \p seq from \p src, default-constructed if new (\p created is
+   * set). Returns 0 if the packet is too old to be given a slot.
+   */
+  T *Insert (AquaSimAddress src, uint32_t seq, bool &created);
+  bool Erase (AquaSimAddress src, uint32_t seq);
+  void Clear (void);
+
+  uint32_t GetWindowSize (void) const;
+  /// Number of records currently held, over all sources.
+  uint32_t GetN (void) const;
+
+private:
+  struct Slot {
+    uint32_t seq;
+    bool valid;
+    T value;
+  };
+  struct Window {
+    std::vector<Slot> slots;
+    uint32_t horizon;   // records below this sequence number are evicted
+  };
+
+  Slot *Locate (AquaSimAddress src, uint32_t seq);
+  void Slide (Window &w, uint32_t horizon);
+
+  std::unordered_map<uint16_t, Window> m_windows;
+  uint32_t m_windowSize;
+  uint32_t m_mask;
+  uint32_t m_n;
+};
+
+template <typename T>
+AquaSimPktWindow<T>::AquaSimPktWindow (uint32_t windowSize)
+  : m_windowSize (windowSize),
+    m_n (0)
+{
+  uint32_t ring = 1;
+  while (ring < windowSize + 1)
+    {
+      ring <<= 1;
+    }
+  m_mask = ring - 1;
+}
+
+template <typename T>
+typename AquaSimPktWindow<T>::Slot *
+AquaSimPktWindow<T>::Locate (AquaSimAddress src, uint32_t seq)
+{
+  typename std::unordered_map<uint16_t, Window>::iterator it =
+    m_windows.find (src.GetAsInt ());
+  if (it == m_windows.end ())
+    {
+      return 0;
+    }
+  Slot &s = it->second.slots[seq & m_mask];
+  return (s.valid && s.seq == seq) ? &s : 0;
+}
+
+template <typename T>
+T *
+AquaSimPktWindow<T>::Find (AquaSimAddress src, uint32_t seq)
+{
+  Slot *s = Locate (src, seq);
+  return s ? &s->value : 0;
+}
+
+template <typename T>
+void
+AquaSimPktWindow<T>::Slide (Window &w, uint32_t horizon)
+{
+  if (horizon <= w.horizon)
+    {
+      return;
+    }
+  uint32_t span = horizon - w.horizon;
+  uint32_t first = w.horizon;
+  if (span > m_mask)
+    {
+      first = 0;
+      span = m_mask + 1;
+    }
+  for (uint32_t i = 0; i < span; i++)
+    {
+      Slot &s = w.slots[(first + i) & m_mask];
+      if (s.valid && s.seq < horizon)
+        {
+          s.valid = false;
+          m_n--;
+        }
+    }
+  w.horizon = horizon;
+}
+
+template <typename T>
+T *
+AquaSimPktWindow<T>::Insert (AquaSimAddress src, uint32_t seq, bool &created)
+{
+  created = false;
+  Window &w = m_windows[src.GetAsInt ()];
+  if (w.slots.empty ())
+    {
+      w.slots.resize (m_mask + 1);
+      w.horizon = 0;
+    }
+  if (seq > m_windowSize)
+    {
+      Slide (w, seq - m_windowSize);
+    }
+
+  Slot &s = w.slots[seq & m_mask];
+  if (s.valid)
+    {
+      if (s.seq == seq)
+        {
+          return &s.value;
+        }
+      if (seq < w.horizon && s.seq >= w.horizon)
+        {
+          return 0;
+        }
+      m_n--;
+    }
+  s.seq = seq;
+  s.valid = true;
+  s.value = T ();
+  m_n++;
+  created = true;
+  return &s.value;
+}
+
+template <typename T>
+bool
+AquaSimPktWindow<T>::Erase (AquaSimAddress src, uint32_t seq)
+{
+  Slot *s = Locate (src, seq);
+  if (s == 0)
+    {
+      return false;
+    }
+  s->valid = false;
+  m_n--;
+  return true;
+}
+
+template <typename T>
+void
+AquaSimPktWindow<T>::Clear (void)
+{
+  m_windows.clear ();
+  m_n = 0;
+}
+
+template <typename T>
+uint32_t
+AquaSimPktWindow<T>::GetWindowSize (void) const
+{
+  return m_windowSize;
+}
+
+template <typename T>
+uint32_t
+AquaSimPktWindow<T>::GetN (void) const
+{
+  return m_n;
+}
+
+} // namespace ns3
+
+#endif /* AQUA_SIM_PKT_WINDOW_H */
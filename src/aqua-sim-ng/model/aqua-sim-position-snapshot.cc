@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+
+#include "aqua-sim-position-snapshot.h"
+#include "aqua-sim-net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimPositionSnapshot");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimPositionSnapshot);
+
+TypeId
+AquaSimPositionSnapshot::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimPositionSnapshot")
+    .SetParent<Object> ()
+    .AddConstructor<AquaSimPositionSnapshot> ()
+  ;
+  return tid;
+}
+
+AquaSimPositionSnapshot::AquaSimPositionSnapshot () :
+  m_valid (false),
+  m_fresh (false),
+  m_stamp (Seconds (0)),
+  m_devices (0),
+  m_refreshes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimPositionSnapshot::~AquaSimPositionSnapshot ()
+{
+}
+
+void
+AquaSimPositionSnapshot::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_valid = false;
+  m_fresh = false;
+}
+
+bool
+AquaSimPositionSnapshot::IsCurrent (void) const
+{
+  return m_fresh && m_stamp == Simulator::Now ();
+}
+
+uint32_t
+AquaSimPositionSnapshot::GetN (void) const
+{
+  return m_models.size ();
+}
+
+const double *
+AquaSimPositionSnapshot::GetX (void) const
+{
+  return m_x.empty () ? 0 : &m_x[0];
+}
+
+const double *
+AquaSimPositionSnapshot::GetY (void) const
+{
+  return m_y.empty () ? 0 : &m_y[0];
+}
+
+const double *
+AquaSimPositionSnapshot::GetZ (void) const
+{
+  return m_z.empty () ? 0 : &m_z[0];
+}
+
+Ptr<MobilityModel>
+AquaSimPositionSnapshot::GetModel (uint32_t i) const
+{
+  return m_models[i];
+}
+
+uint32_t
+AquaSimPositionSnapshot::GetRefreshCount (void) const
+{
+  return m_refreshes;
+}
+
+bool
+AquaSimPositionSnapshot::GetPosition (const MobilityModel *model, Vector &pos) const
+{
+  if (!IsCurrent ())
+    return false;
+  std::unordered_map<const MobilityModel*, uint32_t>::const_iterator it = m_index.find (model);
+  if (it == m_index.end ())
+    return false;
+  pos = Vector (m_x[it->second], m_y[it->second], m_z[it->second]);
+  return true;
+}
+
+void
+AquaSimPositionSnapshot::Detach (void)
+{
+  for (std::vector<Ptr<MobilityModel> >::iterator it = m_models.begin (); it != m_models.end (); ++it)
+    {
+      (*it)->TraceDisconnectWithoutContext ("CourseChange",
+          MakeCallback (&AquaSimPositionSnapshot::CourseChanged, this));
+    }
+}
+
+void
+AquaSimPositionSnapshot::Rebuild (const std::vector<Ptr<AquaSimNetDevice> > &dList)
+{
+  NS_LOG_FUNCTION (this << dList.size ());
+  Detach ();
+  m_models.clear ();
+  m_index.clear ();
+
+  /* several devices may share one node, hence one mobility model */
+  for (uint32_t i = 0; i < dList.size (); i++)
+    {
+      Ptr<MobilityModel> model = dList[i]->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (model, "AquaSimPositionSnapshot requires a MobilityModel on every node");
+      if (m_index.insert (std::make_pair (PeekPointer (model), (uint32_t) m_models.size ())).second)
+        {
+          m_models.push_back (model);
+          model->TraceConnectWithoutContext ("CourseChange",
+              MakeCallback (&AquaSimPositionSnapshot::CourseChanged, this));
+        }
+    }
+  m_x.resize (m_models.size ());
+  m_y.resize (m_models.size ());
+  m_z.resize (m_models.size ());
+  m_devices = dList.size ();
+  m_valid = true;
+  m_fresh = false;
+}
+
+void
+AquaSimPositionSnapshot::Refresh (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_models.size (); i++)
+    {
+      Vector pos = m_models[i]->GetPosition ();
+      m_x[i] = pos.x;
+      m_y[i] = pos.y;
+      m_z[i] = pos.z;
+    }
+  m_stamp = Simulator::Now ();
+  m_fresh = true;
+  m_refreshes++;
+}
+
+void
+AquaSimPositionSnapshot::CourseChanged (Ptr<const MobilityModel> model)
+{
+  /* earlier timestamps are stale anyway; this catches same-time moves */
+  m_fresh = false;
+}
+
+void
+AquaSimPositionSnapshot::Update (const std::vector<Ptr<AquaSimNetDevice> > &dList)
+{
+  if (!m_valid || m_devices != dList.size ())
+    Rebuild (dList);
+  if (!IsCurrent ())
+    Refresh ();
+}
+
+void
+AquaSimPositionSnapshot::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Detach ();
+  m_models.clear ();
+  m_index.clear ();
+  m_valid = false;
+  m_fresh = false;
+  Object::DoDispose ();
+}
+
+}  // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_POSITION_SNAPSHOT_H
+#define AQUA_SIM_POSITION_SNAPSHOT_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+class AquaSimNetDevice;
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Positions of all nodes on a channel at the current time.
+ *
+ * Coordinates are kept as three contiguous arrays (structure of arrays),
+ * one slot per distinct mobility model in device-list order. Update() samples
+ * every model once per simulation timestamp; later transmissions at the same
+ * time reuse the arrays. A course change at the snapshot time (e.g. an
+ * explicit SetPosition) forces a resample, so readers always see what
+ * GetPosition() would return.
+ *
+ * Refreshing costs one GetPosition() per node, so the snapshot pays off
+ * when receivers are scanned network-wide or several transmissions share
+ * a timestamp, less so next to a spatial index with sparse traffic.
+ *
+ * GetPosition() fails for unknown models and whenever the snapshot is not
+ * current; callers then fall back to querying the model directly.
+ */
+class AquaSimPositionSnapshot : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  AquaSimPositionSnapshot ();
+  virtual ~AquaSimPositionSnapshot ();
+
+  /// Make the snapshot current for the nodes of \p dList.
+  void Update (const std::vector<Ptr<AquaSimNetDevice> > &dList);
+  /// Force a full rebuild (device added/removed) on the next Update.
+  void Invalidate (void);
+  /// True if the arrays hold the positions at the current time.
+  bool IsCurrent (void) const;
+
+  bool GetPosition (const MobilityModel *model, Vector &pos) const;
+
+  uint32_t GetN (void) const;
+  const double *GetX (void) const;
+  const double *GetY (void) const;
+  const double *GetZ (void) const;
+  Ptr<MobilityModel> GetModel (uint32_t i) const;
+
+  uint32_t GetRefreshCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void Rebuild (const std::vector<Ptr<AquaSimNetDevice> > &dList);
+  void Refresh (void);
+  void Detach (void);
+  void CourseChanged (Ptr<const MobilityModel> model);
+
+  bool m_valid;
+  bool m_fresh;
+  Time m_stamp;
+  uint32_t m_devices;
+  uint32_t m_refreshes;
+
+  std::vector<Ptr<MobilityModel> > m_models;
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<double> m_z;
+  std::unordered_map<const MobilityModel*, uint32_t> m_index;
+};  // class AquaSimPositionSnapshot
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_POSITION_SNAPSHOT_H */
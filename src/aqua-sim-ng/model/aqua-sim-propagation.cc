@@ -22,9 +22,13 @@
 #include "ns3/nstime.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 #include "aqua-sim-propagation.h"
 
+#include <cmath>
+
 namespace ns3 {
 
 const double SOUND_SPEED_IN_WATER = 1500;
@@ -37,15 +41,120 @@ AquaSimPropagation::GetTypeId ()
 {
   static TypeId tid = TypeId ("ns3::AquaSimPropagation")
     .SetParent<Object>()
+    .AddAttribute ("LinkCache", "Cache per-link distance, delay and attenuation (see AquaSimLinkCache).",
+      BooleanValue (false),
+      MakeBooleanAccessor (&AquaSimPropagation::m_useLinkCache),
+      MakeBooleanChecker ())
+    .AddAttribute ("LinkCacheMaxAge", "MaxAge of the link cache.",
+      TimeValue (Seconds (0)),
+      MakeTimeAccessor (&AquaSimPropagation::m_linkMaxAge),
+      MakeTimeChecker ())
+    .AddAttribute ("LinkCacheMaxLinks", "MaxLinks of the link cache.",
+      UintegerValue (1 << 18),
+      MakeUintegerAccessor (&AquaSimPropagation::m_linkMaxLinks),
+      MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BatchKernels", "Evaluate attenuation and sound speed with the closed-form batch kernels. "
+                   "These agree with the scalar models only to rounding error, so results are not bit-identical.",
+      BooleanValue (false),
+      MakeBooleanAccessor (&AquaSimPropagation::m_batchKernels),
+      MakeBooleanChecker ())
   ;
   return tid;
 }
 
+AquaSimPropagation::AquaSimPropagation () :
+  m_useLinkCache (false),
+  m_linkMaxAge (Seconds (0)),
+  m_linkMaxLinks (1 << 18),
+  m_batchKernels (false)
+{
+  m_rand = CreateObject<UniformRandomVariable> ();
+}
+
 Time
 AquaSimPropagation::PDelay (Ptr<MobilityModel> s, Ptr<MobilityModel> r)
 {
   NS_LOG_FUNCTION(this);
-  return Time::FromDouble((s->GetDistanceFrom(r) / ns3::SOUND_SPEED_IN_WATER), Time::S);
+  AquaSimLinkCache::Link *link = GetLink(s, r);
+  if (link)
+    {
+      if (link->nominalDelay.IsNegative())
+        link->nominalDelay = Time::FromDouble((link->dist / ns3::SOUND_SPEED_IN_WATER), Time::S);
+      return link->nominalDelay;
+    }
+  return Time::FromDouble((GetDistance(s, r) / ns3::SOUND_SPEED_IN_WATER), Time::S);
+}
+
+void
+AquaSimPropagation::SetPositionSnapshot (Ptr<AquaSimPositionSnapshot> snapshot)
+{
+  m_snapshot = snapshot;
+}
+
+int64_t
+AquaSimPropagation::AssignStreams (int64_t stream)
+{
+  m_rand->SetStream (stream);
+  return 1;
+}
+
+Vector
+AquaSimPropagation::GetPosition (Ptr<MobilityModel> m) const
+{
+  Vector pos;
+  if (m_snapshot && m_snapshot->GetPosition (PeekPointer (m), pos))
+    return pos;
+  return m->GetPosition ();
+}
+
+double
+AquaSimPropagation::GetDistance (Ptr<MobilityModel> s, Ptr<MobilityModel> r) const
+{
+  /* same expression as MobilityModel::GetDistanceFrom */
+  return CalculateDistance (GetPosition (s), GetPosition (r));
+}
+
+bool
+AquaSimPropagation::UseBatchKernels (void) const
+{
+  return m_batchKernels;
+}
+
+Ptr<AquaSimLinkCache>
+AquaSimPropagation::GetLinkCache (void) const
+{
+  return m_linkCache;
+}
+
+AquaSimLinkCache::Link *
+AquaSimPropagation::GetLink (Ptr<MobilityModel> s, Ptr<MobilityModel> r)
+{
+  if (!m_useLinkCache)
+    return NULL;
+  if (!m_linkCache)
+    {
+      m_linkCache = CreateObject<AquaSimLinkCache> ();
+      m_linkCache->SetAttribute ("MaxAge", TimeValue (m_linkMaxAge));
+      m_linkCache->SetAttribute ("MaxLinks", UintegerValue (m_linkMaxLinks));
+    }
+  return &m_linkCache->Lookup (s, r);
+}
+
+void
+AquaSimPropagation::DoDispose (void)
+{
+  if (m_linkCache)
+    m_linkCache->Dispose ();
+  m_linkCache = 0;
+  m_snapshot = 0;
+  m_rand = 0;
+  Object::DoDispose ();
+}
+
+bool
+AquaSimPropagation::IsRangeLimited (void) const
+{
+  return false;
 }
 
 /*
@@ -97,8 +206,6 @@ AquaSimPropagation::Rayleigh (double SL)
   double mPr = std::pow(10, SL/20 - 6);  //signal strength (pressure in Pa)
   double segma = pow(mPr, 2) * 2 / M_PI;
 
-  Ptr<UniformRandomVariable> m_rand = CreateObject<UniformRandomVariable> ();
-
   return -2 * segma * std::log(m_rand->GetValue());
 }
 
@@ -135,6 +242,30 @@ AquaSimPropagation::Thorp (double dist, double freq)
       + 0.000275 * pow(freq,2) + 0.0003 );
 }
 
+void
+AquaSimPropagation::ThorpBatch (const double *freq, double *alpha, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double f2 = freq[i] * freq[i];
+      alpha[i] = 0.11 * f2 / (1 + f2) + 44 * f2 / (4100 + f2) + 0.000275 * f2 + 0.0003;
+    }
+}
+
+/*
+ * d^k * (10^(a(f)/10))^(d/1000) with k=2, folded into d*d*exp(c*d) where
+ * c = a(f)*ln(10)/10000 is constant for the whole batch.
+ */
+void
+AquaSimPropagation::RayleighBatch (const double *dist, double freq, double *att, uint32_t n)
+{
+  double alpha_f;
+  ThorpBatch (&freq, &alpha_f, 1);
+  const double c = alpha_f * M_LN10 / 10000.0;
+  for (uint32_t i = 0; i < n; i++)
+    att[i] = dist[i] * dist[i] * std::exp (c * dist[i]);
+}
+
 //2.0 verison below:
 
 /**
@@ -147,8 +278,6 @@ AquaSimPropagation::Rayleigh2( double SL )
 	double MPr = std::pow(10, SL/20 - 6); //signal strength (pressure in Pa)
 	double segma = pow(MPr, 2) * 2 / M_PI;
 
-  Ptr<UniformRandomVariable> m_rand = CreateObject<UniformRandomVariable> ();
-
 	return -2 * segma * std::log(m_rand->GetValue());
 }
 
@@ -25,7 +25,10 @@
 
 #include "ns3/nstime.h"
 #include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
 #include "aqua-sim-net-device.h"
+#include "aqua-sim-link-cache.h"
+#include "aqua-sim-position-snapshot.h"
 
 namespace ns3 {
 
@@ -56,21 +59,65 @@ class AquaSimPropagation : public Object
 {
 public:
   static TypeId GetTypeId (void);
+  AquaSimPropagation ();
 
-  virtual std::vector<PktRecvUnit> * ReceivedCopies (Ptr<AquaSimNetDevice> s,
-                                                     Ptr<Packet> p,
-						     std::vector<Ptr<AquaSimNetDevice> > dList) = 0;
+  /**
+   * Fill \p res with one unit per device of \p dList that receives a copy
+   * of \p p. \p res is cleared first; callers reuse it across transmissions.
+   */
+  virtual void ReceivedCopies (Ptr<AquaSimNetDevice> s,
+                               Ptr<Packet> p,
+                               const std::vector<Ptr<AquaSimNetDevice> > &dList,
+                               std::vector<PktRecvUnit> &res) = 0;
   virtual Time PDelay (Ptr<MobilityModel> s, Ptr<MobilityModel> r);
+  /// True if receivers beyond the packet's TxRange never get a copy.
+  virtual bool IsRangeLimited (void) const;
 
   virtual void SetTraceValues(double,double,double)=0;
   virtual void SetTraceValues(double,double,double,double,double)=0;
+
+  /**
+   * Batch forms of Thorp and Rayleigh(d, f). Inputs and outputs are plain
+   * arrays of \p n elements (distances in m, frequencies in kHz) so one
+   * transmission's receivers are evaluated in a single branch-free loop.
+   * ThorpBatch is exact; RayleighBatch agrees with Rayleigh to rounding
+   * error and is only used by ReceivedCopies when BatchKernels is set.
+   */
+  void ThorpBatch (const double *freq, double *alpha, uint32_t n);
+  void RayleighBatch (const double *dist, double freq, double *att, uint32_t n);
+
+  /// Link table in use, null unless the LinkCache attribute is set.
+  Ptr<AquaSimLinkCache> GetLinkCache (void) const;
+  /// Read node positions from \p snapshot while it is current.
+  void SetPositionSnapshot (Ptr<AquaSimPositionSnapshot> snapshot);
+  /// Fix the stream of the Rayleigh fading draws; returns 1.
+  int64_t AssignStreams (int64_t stream);
+
 protected:
+  virtual void DoDispose (void);
+  /// Cached state of link s-r, or null if the link cache is disabled.
+  AquaSimLinkCache::Link *GetLink (Ptr<MobilityModel> s, Ptr<MobilityModel> r);
+  /// Position of \p m, from the snapshot if one is set and current.
+  Vector GetPosition (Ptr<MobilityModel> m) const;
+  double GetDistance (Ptr<MobilityModel> s, Ptr<MobilityModel> r) const;
+  /// True if the BatchKernels attribute is set.
+  bool UseBatchKernels (void) const;
+
   double Rayleigh (double SL);
   double Rayleigh (double d, double f);
   double Thorp (double range, double freq);
   //2.0 version below:
   double Rayleigh2 (double SL);
   double Thorp2 (double range, double freq);
+
+private:
+  bool m_useLinkCache;
+  Time m_linkMaxAge;
+  uint32_t m_linkMaxLinks;
+  bool m_batchKernels;
+  Ptr<AquaSimLinkCache> m_linkCache;
+  Ptr<AquaSimPositionSnapshot> m_snapshot;
+  Ptr<UniformRandomVariable> m_rand;
 };  //class AquaSimPropagation
 
 }  // namespace ns3
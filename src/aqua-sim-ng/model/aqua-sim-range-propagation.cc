@@ -73,49 +73,83 @@ AquaSimRangePropagation::Initialize()
 /**
 * only nodes within range will receive a copy
 */
-std::vector<PktRecvUnit> *
+void
 AquaSimRangePropagation::ReceivedCopies (Ptr<AquaSimNetDevice> s,
                Ptr<Packet> p,
-               std::vector<Ptr<AquaSimNetDevice> > dList)
+               const std::vector<Ptr<AquaSimNetDevice> > &dList,
+               std::vector<PktRecvUnit> &res)
 {
   NS_LOG_FUNCTION(this << dList.size());
   NS_ASSERT(dList.size());
 
-	std::vector<PktRecvUnit> * res = new std::vector<PktRecvUnit>;
+	res.clear();
 	//find all nodes which will receive a copy
 	PktRecvUnit pru;
-	double dist = 0;
 
   AquaSimPacketStamp pstamp;
   p->PeekHeader(pstamp);
 
   Ptr<Object> sObject = s->GetNode();
   Ptr<MobilityModel> senderModel = sObject->GetObject<MobilityModel> ();
-
-  unsigned i = 0;
-  std::vector<Ptr<AquaSimNetDevice> >::iterator it = dList.begin();
-  for(; it != dList.end(); it++, i++)
+  Vector senderPos = GetPosition(senderModel);
+
+  /* gather the receivers within range, then evaluate the physics in batch */
+  m_recv.clear();
+  m_links.clear();
+  m_dist.clear();
+  m_depth.clear();
+  for (uint32_t i = 0; i < dList.size(); i++)
   {
     Ptr<Object> rObject = dList[i]->GetNode();
     Ptr<MobilityModel> recvModel = rObject->GetObject<MobilityModel> ();
-    /*
-    if (std::fabs(recvModel->GetPosition().x - senderModel->GetPosition().x) > pstamp.GetTxRange())
-      break;
-    */
-    if ( (dist = senderModel->GetDistanceFrom(recvModel)) > pstamp.GetTxRange() && pstamp.GetTxRange() != -1)
+    AquaSimLinkCache::Link *link = GetLink(senderModel, recvModel);
+    /* a link with its delay cached needs no position at all */
+    bool needPos = !link || link->delay.IsNegative();
+    Vector recvPos = needPos ? GetPosition(recvModel) : senderPos;
+    double dist = link ? link->dist : CalculateDistance(senderPos, recvPos);
+    if (dist > pstamp.GetTxRange() && pstamp.GetTxRange() != -1)
       continue;
+    m_recv.push_back(i);
+    m_links.push_back(link);
+    m_dist.push_back(dist);
+    m_depth.push_back(std::fabs(recvPos.z - senderPos.z));
+  }
 
-		pru.recver = dList[i];
-		pru.pDelay = Time::FromDouble(dist / AcousticSpeed(std::fabs(recvModel->GetPosition().z - senderModel->GetPosition().z)),Time::S);
-		pru.pR = RayleighAtt(dist, pstamp.GetFreq(), pstamp.GetPt());
-		res->push_back(pru);
+  uint32_t n = m_recv.size();
+  m_speed.resize(n);
+  if (n && UseBatchKernels())
+    AcousticSpeedBatch(&m_depth[0], &m_speed[0], n);
+  else
+    for (uint32_t j = 0; j < n; j++)
+      m_speed[j] = AcousticSpeed(m_depth[j]);
+  RayleighAttBatch(pstamp.GetFreq(), pstamp.GetPt());
+
+  res.reserve(n);
+  for (uint32_t j = 0; j < n; j++)
+  {
+		AquaSimLinkCache::Link *link = m_links[j];
+		pru.recver = dList[m_recv[j]];
+		if (link && !link->delay.IsNegative())
+		  pru.pDelay = link->delay;
+		else {
+		  pru.pDelay = Time::FromDouble(m_dist[j] / m_speed[j],Time::S);
+		  if (link)
+		    link->delay = pru.pDelay;
+		}
+		pru.pR = m_pR[j];
+		res.push_back(pru);
 
     NS_LOG_DEBUG("AquaSimRangePropagation::ReceivedCopies: Sender("
     << s->GetAddress() << ") Recv(" << (pru.recver)->GetAddress()
-    << ") dist(" << dist << ") pDelay(" << pru.pDelay.GetMilliSeconds()
-    << ") pR(" << pru.pR << ")" << " Pt(" << pstamp.GetPt() << ")" << senderModel->GetPosition() << " & " << recvModel->GetPosition());
+    << ") dist(" << m_dist[j] << ") pDelay(" << pru.pDelay.GetMilliSeconds()
+    << ") pR(" << pru.pR << ")" << " Pt(" << pstamp.GetPt() << ")");
 	}
-	return res;
+}
+
+bool
+AquaSimRangePropagation::IsRangeLimited (void) const
+{
+  return true;
 }
 
 /*
@@ -137,6 +171,26 @@ AquaSimRangePropagation::AcousticSpeed(double depth)
     0.0000000000007139 * m_temp * pow(d,3) );
 }
 
+/*
+ * Mackenzie's equation is a cubic in depth once temperature and salinity
+ * are fixed; evaluate it in Horner form with the coefficients hoisted.
+ */
+void
+AquaSimRangePropagation::AcousticSpeedBatch(const double *depth, double *speed, uint32_t n)
+{
+  double s = m_salinity - 35;
+  double t = m_temp;
+  double c0 = 1448.96 + 4.591 * t - 0.05304 * t * t + 0.0002374 * t * t * t +
+    1.34 * s - 0.01025 * t * s;
+  double c3 = -0.0000000000007139 * t;
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    double d = depth[i] / 2;
+    speed[i] = c0 + d * (0.0163 + d * (0.0000001675 + d * c3));
+  }
+}
+
 /*
  * Identical to AcousticSpeed function but uses the current depth to figure out the channel layer's temp.
  */
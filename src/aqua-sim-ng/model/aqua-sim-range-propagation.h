@@ -56,12 +56,16 @@ class AquaSimRangePropagation : public AquaSimSimplePropagation {
 public:
   static TypeId GetTypeId (void);
   AquaSimRangePropagation();
-  virtual std::vector<PktRecvUnit> * ReceivedCopies (Ptr<AquaSimNetDevice> s,
-                 Ptr<Packet> p,
-                 std::vector<Ptr<AquaSimNetDevice> > dList);
+  virtual void ReceivedCopies (Ptr<AquaSimNetDevice> s,
+                               Ptr<Packet> p,
+                               const std::vector<Ptr<AquaSimNetDevice> > &dList,
+                               std::vector<PktRecvUnit> &res);
+  virtual bool IsRangeLimited (void) const;
   double AcousticSpeed(double depth);
   double AcousticSpeedVaryingTemp(double depth);
   double Urick(Ptr<AquaSimNetDevice> sender, Ptr<AquaSimNetDevice> recver);
+  /// AcousticSpeed over \p n depths, as a cubic in depth fixed by temp/salinity.
+  void AcousticSpeedBatch(const double *depth, double *speed, uint32_t n);
 
   void SetBandwidth(double bandwidth);
   void SetTemp(double temp);
@@ -82,6 +86,9 @@ private:
   double m_salinity;
   double m_noiseLvl;
   std::list<layerBasedTemp> m_layerTemp;
+
+  std::vector<double> m_depth;
+  std::vector<double> m_speed;
 };  // class AquaSimRangePropagation
 
 }  // namespace ns3
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
+
+#include "aqua-sim-recording-scheduler.h"
+
+#include <cstring>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimRecordingScheduler");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimRecordingScheduler);
+
+namespace {
+
+const uint32_t EVENT_TRACE_VERSION = 1;
+const size_t RECORD_BUFFER = 4096;
+
+}  // namespace
+
+TypeId
+AquaSimRecordingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimRecordingScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("AquaSimNG")
+    .AddConstructor<AquaSimRecordingScheduler> ()
+    .AddAttribute ("File", "Event trace written by the scheduler.",
+      StringValue ("aqua-sim-events.bin"),
+      MakeStringAccessor (&AquaSimRecordingScheduler::m_fileName),
+      MakeStringChecker ())
+    .AddAttribute ("Scheduler", "Scheduler that holds the events.",
+      ObjectFactoryValue (ObjectFactory ("ns3::MapScheduler")),
+      MakeObjectFactoryAccessor (&AquaSimRecordingScheduler::m_factory),
+      MakeObjectFactoryChecker ())
+  ;
+  return tid;
+}
+
+AquaSimRecordingScheduler::AquaSimRecordingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimRecordingScheduler::~AquaSimRecordingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+}
+
+void
+AquaSimRecordingScheduler::Append (const Scheduler::Event &ev, Operation op)
+{
+  if (m_events == nullptr)
+    {
+      // attributes are only known once constructed
+      m_events = m_factory.Create<Scheduler> ();
+      m_out.open (m_fileName.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+      NS_ABORT_MSG_UNLESS (m_out.is_open (), "cannot open event trace " << m_fileName);
+      m_out.write ("ASEV", 4);
+      m_out.write ((const char *) &EVENT_TRACE_VERSION, sizeof (EVENT_TRACE_VERSION));
+      m_records.reserve (RECORD_BUFFER);
+    }
+  Record r = {ev.key.m_ts, ev.key.m_uid, (uint32_t) op};
+  m_records.push_back (r);
+  if (m_records.size () == RECORD_BUFFER)
+    Flush ();
+}
+
+void
+AquaSimRecordingScheduler::Flush (void)
+{
+  if (!m_out.is_open () || m_records.empty ())
+    return;
+  m_out.write ((const char *) m_records.data (), m_records.size () * sizeof (Record));
+  m_out.flush ();
+  m_records.clear ();
+}
+
+void
+AquaSimRecordingScheduler::Insert (const Scheduler::Event &ev)
+{
+  Append (ev, INSERT);
+  m_events->Insert (ev);
+}
+
+bool
+AquaSimRecordingScheduler::IsEmpty (void) const
+{
+  return m_events == nullptr || m_events->IsEmpty ();
+}
+
+Scheduler::Event
+AquaSimRecordingScheduler::PeekNext (void) const
+{
+  return m_events->PeekNext ();
+}
+
+Scheduler::Event
+AquaSimRecordingScheduler::RemoveNext (void)
+{
+  Scheduler::Event ev = m_events->RemoveNext ();
+  Append (ev, REMOVE_NEXT);
+  return ev;
+}
+
+void
+AquaSimRecordingScheduler::Remove (const Scheduler::Event &ev)
+{
+  Append (ev, REMOVE);
+  m_events->Remove (ev);
+}
+
+std::vector<AquaSimRecordingScheduler::Record>
+AquaSimRecordingScheduler::Load (const std::string &fileName)
+{
+  std::ifstream in (fileName.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (in.is_open (), "cannot read event trace " << fileName);
+  char magic[4];
+  uint32_t version = 0;
+  in.read (magic, 4);
+  in.read ((char *) &version, sizeof (version));
+  NS_ABORT_MSG_UNLESS (in && std::memcmp (magic, "ASEV", 4) == 0 && version == EVENT_TRACE_VERSION,
+                       fileName << " is not an event trace");
+
+  std::ostringstream data;
+  data << in.rdbuf ();
+  std::string bytes = data.str ();
+  NS_ABORT_MSG_UNLESS (bytes.size () % sizeof (Record) == 0, "truncated event trace " << fileName);
+  std::vector<Record> records (bytes.size () / sizeof (Record));
+  if (!records.empty ())
+    std::memcpy (records.data (), bytes.data (), bytes.size ());
+  return records;
+}
+
+}  // namespace ns3
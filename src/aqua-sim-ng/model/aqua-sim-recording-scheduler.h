@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_RECORDING_SCHEDULER_H
+#define AQUA_SIM_RECORDING_SCHEDULER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ns3/scheduler.h"
+#include "ns3/object-factory.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Scheduler that records the operations of the event list.
+ *
+ * Every call is forwarded to a scheduler of type Scheduler and appended to
+ * File, so an aqua-sim event stream can later be replayed against other
+ * schedulers ("AquaSimBench --bench=scheduler"). Record a scenario with
+ *
+ *   --SchedulerType=ns3::AquaSimRecordingScheduler
+ *   --ns3::AquaSimRecordingScheduler::File=events.bin
+ *
+ * The file is little-endian:
+ *
+ *   magic "ASEV" | u32 version (1)
+ *   records until EOF: u64 time stamp | u32 uid | u32 operation
+ *
+ * with operation 0 = Insert, 1 = RemoveNext, 2 = Remove. PeekNext and
+ * IsEmpty are not recorded.
+ */
+class AquaSimRecordingScheduler : public Scheduler
+{
+public:
+  enum Operation
+  {
+    INSERT = 0,
+    REMOVE_NEXT = 1,
+    REMOVE = 2
+  };
+
+  /// One recorded operation, as laid out in the file.
+  struct Record
+  {
+    uint64_t ts;
+    uint32_t uid;
+    uint32_t op;
+  };
+
+  static TypeId GetTypeId (void);
+
+  AquaSimRecordingScheduler ();
+  virtual ~AquaSimRecordingScheduler ();
+
+  // Inherited from Scheduler
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+  /// Read the records of \p fileName; aborts on a malformed file.
+  static std::vector<Record> Load (const std::string &fileName);
+
+private:
+  void Append (const Scheduler::Event &ev, Operation op);
+  void Flush (void);
+
+  std::string m_fileName;
+  ObjectFactory m_factory;
+  Ptr<Scheduler> m_events;
+  std::ofstream m_out;
+  std::vector<Record> m_records;   //written out 4096 at a time
+};  // class AquaSimRecordingScheduler
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_RECORDING_SCHEDULER_H */
@@ -26,6 +26,8 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("AquaSimDBR");
@@ -81,154 +83,161 @@ QueueItemDbr::~QueueItemDbr()
 	m_p=0;
 }
 
-// Insert the item into queue.
-// The queue is sorted by the expected sending time
-// of the packet.
-void MyPacketQueue::insert(QueueItemDbr *q)
+bool
+MyPacketQueue::Before(const QueueItemDbr *a, const QueueItemDbr *b) const
+{
+	if (a->m_sendTime != b->m_sendTime)
+		return a->m_sendTime < b->m_sendTime;
+	return a->m_seq < b->m_seq;
+}
+
+void
+MyPacketQueue::Place(QueueItemDbr *q, uint32_t pos)
 {
-	QueueItemDbr *tmp;
-	std::deque<QueueItemDbr*>::iterator iter;
+	m_heap[pos] = q;
+	q->m_pos = pos;
+}
 
-	// find the insert point
-	iter = m_dq.begin();
-	while (iter != m_dq.end())
+void
+MyPacketQueue::SiftUp(uint32_t pos)
+{
+	QueueItemDbr *q = m_heap[pos];
+	while (pos > 0)
 	{
-		tmp = *iter;
-		if (tmp->m_sendTime > q->m_sendTime)
-		{
-			m_dq.insert(iter, q);
-			return;
-		}
-		iter++;
+		uint32_t parent = (pos - 1) / 2;
+		if (!Before(q, m_heap[parent]))
+			break;
+		Place(m_heap[parent], pos);
+		pos = parent;
 	}
+	Place(q, pos);
+}
 
-	// insert at the end of the queue
-	m_dq.push_back(q);
+void
+MyPacketQueue::SiftDown(uint32_t pos)
+{
+	QueueItemDbr *q = m_heap[pos];
+	uint32_t n = m_heap.size();
+	while (2 * pos + 1 < n)
+	{
+		uint32_t child = 2 * pos + 1;
+		if (child + 1 < n && Before(m_heap[child + 1], m_heap[child]))
+			child++;
+		if (!Before(m_heap[child], q))
+			break;
+		Place(m_heap[child], pos);
+		pos = child;
+	}
+	Place(q, pos);
 }
 
-// Check if packet p in queue needs to be updated.
-// If packet is not found, or previous sending time
-// is larger than current one, return true.
-// Otherwise return false.
-bool
-MyPacketQueue::update(Ptr<Packet> p, double t)
+// Unlink q from the heap and the index; q is not freed.
+void
+MyPacketQueue::Remove(QueueItemDbr *q)
 {
-	Ptr<Packet> pkt;
-	uint32_t curID;
-	std::deque<QueueItemDbr*>::iterator iter;
-  DBRHeader dbrh;
-	AquaSimHeader ash;
-	p->RemoveHeader(ash);
-  p->PeekHeader(dbrh);
-	p->AddHeader(ash);
+	uint32_t pos = q->m_pos;
+	QueueItemDbr *last = m_heap.back();
+	m_heap.pop_back();
+	m_index.erase(q->m_packetId);
+	if (last == q)
+		return;
+	Place(last, pos);
+	if (pos > 0 && Before(last, m_heap[(pos - 1) / 2]))
+		SiftUp(pos);
+	else
+		SiftDown(pos);
+}
 
-	// get current packet ID
-	curID = dbrh.GetPacketID();
+void
+MyPacketQueue::pop()
+{
+	Remove(m_heap.front());
+}
 
-	// search the queue
-	iter = m_dq.begin();
-	while (iter != m_dq.end())
+// Insert the item into queue, ordered by the
+// expected sending time of the packet.
+// An item already queued for the same packet
+// ID is dropped.
+void MyPacketQueue::insert(QueueItemDbr *q)
+{
+	std::unordered_map<uint32_t, QueueItemDbr*>::iterator it =
+    m_index.find(q->m_packetId);
+	if (it != m_index.end())
 	{
-		((*iter)->m_p)->RemoveHeader(ash);
-    ((*iter)->m_p)->PeekHeader(dbrh);
-		((*iter)->m_p)->AddHeader(ash);
-		if (dbrh.GetPacketID() == curID)
-		{ // entry found
-			if ((*iter)->m_sendTime > t)
-			{
-				m_dq.erase(iter);
-				return true;
-			}
-			else
-				return false;
-		}
+		QueueItemDbr *old = it->second;
+		Remove(old);
+		delete old;
 	}
 
-	// not found
-	return true;
+	q->m_seq = m_seq++;
+	m_heap.push_back(q);
+	m_index[q->m_packetId] = q;
+	SiftUp(m_heap.size() - 1);
 }
 
-// Find the item in queue which has the same packet ID
-// as p, and remove it.
-// If such a item is found, return true, otherwise
-// return false.
+// Check if packet packetId in queue needs to be updated.
+// If packet is not found, or previous sending time
+// is larger than current one, return true (and drop
+// the queued item). Otherwise return false.
 bool
-MyPacketQueue::purge(Ptr<Packet> p)
+MyPacketQueue::update(uint32_t packetId, double t)
 {
-	Ptr<Packet> pkt;
-	uint32_t curID;
-	std::deque<QueueItemDbr*>::iterator iter;
-  DBRHeader dbrh;
-	AquaSimHeader ash;
-	p->RemoveHeader(ash);
-  p->PeekHeader(dbrh);
-	p->AddHeader(ash);
-
-	// get current packet ID
-	curID = dbrh.GetPacketID();
+	std::unordered_map<uint32_t, QueueItemDbr*>::iterator it =
+    m_index.find(packetId);
+	if (it == m_index.end())
+		return true;
 
-	// search the queue
-	iter = m_dq.begin();
-	while (iter != m_dq.end())
+	QueueItemDbr *q = it->second;
+	if (q->m_sendTime > t)
 	{
-		((*iter)->m_p)->RemoveHeader(ash);
-    ((*iter)->m_p)->PeekHeader(dbrh);
-		((*iter)->m_p)->AddHeader(ash);
-		if (dbrh.GetPacketID() == curID)
-		{
-			m_dq.erase(iter);
-			return true;
-		}
-		iter++;
+		Remove(q);
+		delete q;
+		return true;
 	}
-
 	return false;
 }
 
+// Find the item in queue which has the same packet ID
+// and remove it.
+// If such a item is found, return true, otherwise
+// return false.
+bool
+MyPacketQueue::purge(uint32_t packetId)
+{
+	std::unordered_map<uint32_t, QueueItemDbr*>::iterator it =
+    m_index.find(packetId);
+	if (it == m_index.end())
+		return false;
+
+	QueueItemDbr *q = it->second;
+	Remove(q);
+	delete q;
+	return true;
+}
+
 // Dump all the items in queue for debug
 void MyPacketQueue::dump()
 {
-	std::deque<QueueItemDbr*>::iterator iter;
-  DBRHeader dbrh;
-	AquaSimHeader ash;
-	int i = 0;
-
-	iter = m_dq.begin();
-	while (iter != m_dq.end())
+	std::vector<QueueItemDbr*> items(m_heap);
+	std::sort(items.begin(), items.end(),
+            [this](const QueueItemDbr *a, const QueueItemDbr *b) { return Before(a, b); });
+	for (uint32_t i = 0; i < items.size(); i++)
 	{
-		((*iter)->m_p)->RemoveHeader(ash);
-    ((*iter)->m_p)->PeekHeader(dbrh);
-		((*iter)->m_p)->AddHeader(ash);
     NS_LOG_INFO("MyPacketQueue::dump:[" << i << "] packetID " <<
-      dbrh.GetPacketID() << ", send time " << (*iter)->m_sendTime);
-		iter++;
-		i++;
+      items[i]->m_packetId << ", send time " << items[i]->m_sendTime);
 	}
 }
 
 NeighbTable::NeighbTable(/*AquaSimDBR* a*/)
 {
-    int i;
-
-    m_numEnts = 0;
-    m_maxEnts = 100;
-
-    // create the default table with size 100
-    m_tab = new NeighbEnt* [100];
-    //m_a = a;
-
-    for (i = 0; i < 100; i++)
-        m_tab[i] = new NeighbEnt();
+	//m_a = a;
 }
 
 NeighbTable::~NeighbTable()
 {
-    int i;
-
-    for (i = 0; i < m_maxEnts; i++)
-        delete m_tab[i];
-
-    delete[] m_tab;
+	std::unordered_map<uint16_t, NeighbEnt*>::iterator it;
+	for (it = m_ents.begin(); it != m_ents.end(); it++)
+		delete it->second;
 }
 
 TypeId
@@ -239,219 +248,58 @@ NeighbTable::GetTypeId()
   return tid;
 }
 
-/*
-static int neighbEntCmp(const void *a, const void *b)
-{
-	nsaddr_t ia = ((const NeighbEnt*)a)->net_id;
-	nsaddr_t ib = ((const NeighbEnt*)b)->net_id;
-
-	if (ia > ib) return 1;
-	if (ia < ib) return -1;
-	return 0;
-}
-*/
-
 void NeighbTable::Dump(void)
 {
-	int i;
+	std::set<NeighbEnt*, DepthOrder>::iterator it;
+	int i = 0;
 
-	for (i = 0; i < m_numEnts; i++)
+	for (it = m_byDepth.begin(); it != m_byDepth.end(); it++, i++)
   {
-    NS_LOG_INFO("NeighbTable::dump: m_tab[" << i << "]: " << m_tab[i]->m_netID
-      << " position(" << m_tab[i]->m_location.x << "," << m_tab[i]->m_location.y
-      << "," << m_tab[i]->m_location.z << ")");
+    NS_LOG_INFO("NeighbTable::dump: [" << i << "]: " << (*it)->m_netID
+      << " position(" << (*it)->m_location.x << "," << (*it)->m_location.y
+      << "," << (*it)->m_location.z << ")");
   }
 }
 
 void
 NeighbTable::EntDelete(const NeighbEnt *ne)
 {
-	int l, r, m;
-	int i;
-	NeighbEnt *owslot;
-
-	// binary search
-	l = 0; r = m_numEnts - 1;
-	while (l <= r)
-	{
-		m = l + (r - l)/2;
-		if (m_tab[m]->m_netID < ne->m_netID)
-			l = m + 1;
-		else if  (ne->m_netID < m_tab[m]->m_netID)
-			r = m - 1;
-		else
-			// m is the entry to be deleted
-			break;
-	}
-
-	if (l > r)
+	std::unordered_map<uint16_t, NeighbEnt*>::iterator it =
+		m_ents.find(ne->m_netID.GetAsInt());
+	if (it == m_ents.end())
 		// no found!
 		return;
 
-	owslot = m_tab[m];
-
-	// slide the entries
-	i = m + 1;
-	while (i < m_numEnts)
-		m_tab[i - 1] = m_tab[i+1];
-
-	m_tab[m_numEnts-1] = owslot;
-	m_numEnts--;
+	NeighbEnt *e = it->second;
+	m_byDepth.erase(e);
+	m_routed.erase(e->m_netID);
+	m_ents.erase(it);
+	delete e;
 }
 
-#if 0
 /**
- * Add a neighbor entry ne into the table.
- * The table is sorted by node address.
+ * Add a neighbor entry ne into the table, or refresh the location of an
+ * existing one. The depth order is kept by re-inserting the entry.
  */
-
-NeighbEnt*
-NeighbTable::EntAdd(const NeighbEnt *ne)
-{
-	int l, r, m;
-	int i;
-	NeighbEnt *owslot;
-
-	if (m_numEnts >= m_maxEnts)
-	{
-		fprintf(stderr, "Neighbor table is full!\n");
-		return 0;
-	}
-
-	// binary search
-	l = 0; r = m_numEnts - 1;
-	while (l <= r)
-	{
-		m = l + (r - l)/2;
-		if (m_tab[m]->m_netID < ne->m_netID)
-			l = m + 1;
-		else if (m_tab[m]->m_netID > ne->m_netID)
-			r = m - 1;
-		else
-		{
-			// the entry is existing
-			// update the info
-			m_tab[m]->m_location.x = ne->m_location.x;
-			m_tab[m]->m_location.y = ne->m_location.y;
-			m_tab[m]->m_location.z = ne->m_location.z;
-
-			return m_tab[m];
-		}
-	}
-
-	// the entry should go to l
-	owslot = m_tab[m_numEnts];
-
-	// slide the entries after l
-	i = m_numEnts - 1;
-	while (i >= l)
-		m_tab[i+1] = m_tab[i--];
-
-	m_tab[l] = owslot;
-	m_tab[l]->m_netID = ne->m_netID;
-	m_tab[l]->m_location.x = ne->m_location.x;
-	m_tab[l]->m_location.y = ne->m_location.y;
-	m_tab[l]->m_location.z = ne->m_location.z;
-	m_numEnts++;
-
-	return m_tab[l];
-}
-#else
 NeighbEnt*
 NeighbTable::EntAdd(const NeighbEnt *ne)
 {
-	//NeighbEnt **pte;
-	NeighbEnt *pe;
-	int i, j;
-	int l, r, m;
-
-	// find if the neighbor is already existing
-	for (i = 0; i < m_numEnts; i++)
-		if (m_tab[i]->m_netID == ne->m_netID)
-		{
-			m_tab[i]->m_location.x = ne->m_location.x;
-			m_tab[i]->m_location.y = ne->m_location.y;
-			m_tab[i]->m_location.z = ne->m_location.z;
-
-			return m_tab[i];
-		}
-
-	/*
-	if (pte = (NeighbEnt**)bsearch(ne, m_tab, m_numEnts,
-				sizeof(NeighbEnt *), neighbEntCmp))
-	{
-		(*pte)->m_netID = ne->m_netID;	// it doesn't hurt to rewrite it!
-		(*pte)->m_location.x = ne->m_location.x;
-		(*pte)->m_location.y = ne->m_location.y;
-		(*pte)->m_location.z = ne->m_location.z;
-
-		return (*pte);
-	}
-	*/
-
-	// need we increase the size of table
-	if (m_numEnts == m_maxEnts)
-	{
-		NeighbEnt **tmp = m_tab;
-		m_maxEnts *= 2;			// double the space
-		m_tab = new NeighbEnt* [m_maxEnts];
-		bcopy(tmp, m_tab, m_numEnts*sizeof(NeighbEnt *));
-
-		for (i = m_numEnts; i < m_maxEnts; i++)
-			m_tab[i] = new NeighbEnt();
-
-		delete[] tmp;
-	}
-
-	// get the insert point
-	if (m_numEnts == 0)
-		i = 0;
+	NeighbEnt *&e = m_ents[ne->m_netID.GetAsInt()];
+	if (e)
+		m_byDepth.erase(e);
 	else
 	{
-		l = 0;
-		r = m_numEnts - 1;
-
-		while (r > l)
-		{
-			m = l + (r - l) / 2;
-			if (ne->m_netID < m_tab[m]->m_netID)
-				r = m - 1;
-			else
-				l = m + 1;
-		}
-
-		if (r < l)
-			i = r + 1;
-		else
-			if (ne->m_netID < m_tab[r]->m_netID)
-				i = r;
-			else
-				i = r + 1;
+		e = new NeighbEnt();
+		e->m_netID = ne->m_netID;
 	}
 
-	// assign an unused slot to i
-	if (i <= (m_numEnts - 1))
-		pe = m_tab[m_numEnts];
+	e->m_location.x = ne->m_location.x;
+	e->m_location.y = ne->m_location.y;
+	e->m_location.z = ne->m_location.z;
+	m_byDepth.insert(e);
 
-	// adjust the entries after insert point i
-	j = m_numEnts - 1;
-	while (j >= i)
-	{
-		m_tab[j+1] = m_tab[j];
-		j--;
-	}
-
-	if (i <= (m_numEnts - 1))
-		m_tab[i] = pe;
-	m_tab[i]->m_netID = ne->m_netID;
-	m_tab[i]->m_location.x = ne->m_location.x;
-	m_tab[i]->m_location.y = ne->m_location.y;
-	m_tab[i]->m_location.z = ne->m_location.z;
-	m_numEnts++;
-
-	return m_tab[i];
+	return e;
 }
-#endif	// 0
 
 /*
  * update the neighbor entry's routeFlag field with va
@@ -459,76 +307,41 @@ NeighbTable::EntAdd(const NeighbEnt *ne)
 
 void NeighbTable::UpdateRouteFlag(AquaSimAddress addr, int val)
 {
-	int i;
+	std::unordered_map<uint16_t, NeighbEnt*>::iterator it =
+		m_ents.find(addr.GetAsInt());
+	if (it == m_ents.end())
+		return;
 
-	for (i = 0; i < m_numEnts; i++)
-	{
-		if (m_tab[i]->m_netID == addr)
-		{
-			m_tab[i]->m_routeFlag = val;
-			return;
-		}
-	}
+	it->second->m_routeFlag = val;
+	if (val == 1)
+		m_routed.insert(addr);
+	else
+		m_routed.erase(addr);
 }
 
 #ifdef	DBR_USE_ROUTEFLAG
 NeighbEnt *
 NeighbTable::EntFindShadowest(Vector location)
 {
-	NeighbEnt *ne = 0;
-	int i;
-	double t;
-
-  t = location.z;
-
   NS_LOG_DEBUG("NeighbTable::EntFindShadowest: location=(" <<
       location.x << "," << location.y << "," << location.z <<
-			") has " << m_numEnts << " neighbors");
-
-	for (i = 0; i < m_numEnts; i++)
-	{
-    NS_LOG_DEBUG("NeighbTable::EntFindShadowest: [" << m_tab[i]->m_netID <<
-			"] position(" << m_tab[i]->m_location.x << "," <<
-      m_tab[i]->m_location.y << "," << m_tab[i]->m_location.z << ")");
+			") has " << m_ents.size() << " neighbors");
 
-		if (m_tab[i]->m_routeFlag == 1)
-		{
-			ne = m_tab[i];
-			return ne;
-		}
+	// a neighbor on a known route wins, lowest address first
+	if (!m_routed.empty())
+		return m_ents[m_routed.begin()->GetAsInt()];
 
-		if (m_tab[i]->m_location.z > t)
-		{
-		    t = m_tab[i]->m_location.z;
-		    ne = m_tab[i];
-		}
-	}
-	return ne;
+	if (m_byDepth.empty() || (*m_byDepth.begin())->m_location.z <= location.z)
+		return 0;
+	return *m_byDepth.begin();
 }
 #else
 NeighbEnt *
 NeighbTable::EntFindShadowest(Vector location)
 {
-    NeighbEnt *ne = 0;
-    int i;
-    double t;
-
-    t = location.z;
-
-    for (i = 0; i < m_numEnts; i++)
-    {
-  NS_LOG_DEBUG("NeighbTable::EntFindShadowest: " << m_a->GetAddress() <<
-    "[" << m_tab[i]->m_netID << "] position(" << m_tab[i]->m_location.x << "," <<
-    m_tab[i]->m_location.y << "," << m_tab[i]->m_location.z << ")");
-
-        if (m_tab[i]->m_location.z > t)
-        {
-            t = m_tab[i]->m_location.z;
-            ne = m_tab[i];
-        }
-    }
-
-    return ne;
+	if (m_byDepth.empty() || (*m_byDepth.begin())->m_location.z <= location.z)
+		return 0;
+	return *m_byDepth.begin();
 }
 #endif	// DBR_USE_ROUTEFLAG
 
@@ -537,27 +350,15 @@ NeighbTable::EntFindShadowest(Vector location)
  */
 NS_OBJECT_ENSURE_REGISTERED(ASPktCache);
 
-ASPktCache::ASPktCache()
+ASPktCache::ASPktCache(int maxSize)
+  : m_maxSize(maxSize)
 {
-	//int i;
-
-	m_maxSize = 1500;
-	m_size = 0;
-
-	m_pCache = new int[1500];
-
-	//for (i = 0; i < 100; i++)
-	//	m_pCache[i] = new Packet;
+	NS_ASSERT(m_maxSize > 0);
+	m_index.reserve(m_maxSize);
 }
 
 ASPktCache::~ASPktCache()
 {
-	//int i;
-
-	//for (i = 0; i < m_maxSize; i++)
-	//	delete m_pCache[i];
-
-	delete[] m_pCache;
 }
 
 TypeId
@@ -571,52 +372,52 @@ ASPktCache::GetTypeId()
 int
 ASPktCache::AccessPacket(int p)
 {
-	int i, j;
-	int tmp;
-
-	for (i = 0; i < m_size; i++) {
-		if (m_pCache[i] == p) {
-			// if the pkt is existing
-			// put it to the tail
-			tmp = p;
-			for (j = i; j < m_size - 1; j++)
-				m_pCache[j] = m_pCache[j+1];
-			m_pCache[m_size-1] = tmp;
-
-			return 1;
-		}
-	}
+	std::unordered_map<int, std::list<int>::iterator>::iterator it = m_index.find(p);
+	if (it == m_index.end())
+		return 0;
 
-	return 0;
+	// if the pkt is existing
+	// put it to the tail
+	m_lru.splice(m_lru.end(), m_lru, it->second);
+	return 1;
 }
 
 void
 ASPktCache::AddPacket(int p)
 {
-	if (m_size == m_maxSize) {
-    NS_LOG_WARN("Cache is full!");
+	if (AccessPacket(p))
 		return;
-	}
 
-	m_pCache[m_size] = p;
-	m_size++;
+	if ((int)m_index.size() == m_maxSize) {
+		// evict the least recently used packet
+		m_index.erase(m_lru.front());
+		m_lru.pop_front();
+	}
 
-	return;
+	m_lru.push_back(p);
+	m_index[p] = --m_lru.end();
 }
 
 void
 ASPktCache::DeletePacket(int p)
 {
+	std::unordered_map<int, std::list<int>::iterator>::iterator it = m_index.find(p);
+	if (it == m_index.end())
+		return;
+
+	m_lru.erase(it->second);
+	m_index.erase(it);
 }
 
 void
 ASPktCache::Dump(void)
 {
-	int i;
+	std::list<int>::iterator it;
+	int i = 0;
 
-	for (i = 0; i < m_size; i++)
+	for (it = m_lru.begin(); it != m_lru.end(); it++, i++)
   {
-    NS_LOG_INFO("[" << i << "]: " << m_pCache[i]);
+    NS_LOG_INFO("[" << i << "]: " << *it);
   }
 }
 
@@ -760,8 +561,6 @@ void
 AquaSimDBR::Send_Callback(void)
 {
 	QueueItemDbr *q;
-  DBRHeader dbrh;
-	AquaSimHeader ash;
 
 	// we're done if there is no packet in queue
 	if (m_pq.empty())
@@ -774,10 +573,8 @@ AquaSimDBR::Send_Callback(void)
                         q->m_p,AquaSimAddress::GetBroadcast(),Seconds(0));
 
 	// put the packet into cache
-	(q->m_p)->RemoveHeader(ash);
-  (q->m_p)->PeekHeader(dbrh);
-	(q->m_p)->AddHeader(ash);
-	m_pc->AddPacket(dbrh.GetPacketID());
+	m_pc->AddPacket(q->m_packetId);
+	delete q;
 
 	// reschedule the timer if there are
 	// other packets in the queue
@@ -1217,7 +1014,7 @@ AquaSimDBR::HandlePktForward(Ptr<Packet> p)
 
 #if 0
 	// search sending queue for p
-	if (m_pq.purge(p))
+	if (m_pq.purge(dbrh.GetPacketID()))
 	{
 		drop(p, DROP_RTR_TTL);
 		return;
@@ -1246,7 +1043,7 @@ AquaSimDBR::HandlePktForward(Ptr<Packet> p)
 			//p->AddHeader(dbrh);
       p->AddHeader(ash);
       p->AddPacketTag(ptag);
-			m_pq.purge(p);
+			m_pq.purge(dbrh.GetPacketID());
       p=0;
       //drop(p, DROP_RTR_TTL);
 			return;
@@ -1313,7 +1110,7 @@ AquaSimDBR::HandlePktForward(Ptr<Packet> p)
 	p->AddHeader(dbrh);
   p->AddHeader(ash);
   p->AddPacketTag(ptag);
-	QueueItemDbr *q = new QueueItemDbr(p, expected_send_time);
+	QueueItemDbr *q = new QueueItemDbr(p, dbrh.GetPacketID(), expected_send_time);
 
 	/*
 	m_pq.insert(q);
@@ -1330,7 +1127,7 @@ AquaSimDBR::HandlePktForward(Ptr<Packet> p)
 	}
 	else
 	{
-		if (m_pq.update(p, expected_send_time))
+		if (m_pq.update(dbrh.GetPacketID(), expected_send_time))
 		{
 			m_pq.insert(q);
 
@@ -1341,6 +1138,8 @@ AquaSimDBR::HandlePktForward(Ptr<Packet> p)
         m_sendTimer->Schedule(Seconds(delay));
 			}
 		}
+		else
+			delete q;
 	}
 }
 #endif	// end of USE_FLOODING_ALG
@@ -36,7 +36,10 @@
 #include "ns3/vector.h"
 #include "ns3/timer.h"
 
-#include <deque>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #define	DBR_PORT		0xFF
 
@@ -87,39 +90,58 @@ private:
 
 class QueueItemDbr : public Object {
 public:
-	QueueItemDbr() : /*m_p(0),*/ m_sendTime(0) {}
-	QueueItemDbr(Ptr<Packet> p, double t) : m_p(p), m_sendTime(t) {}
+	QueueItemDbr() : /*m_p(0),*/ m_packetId(0), m_sendTime(0), m_seq(0), m_pos(0) {}
+	QueueItemDbr(Ptr<Packet> p, uint32_t id, double t) :
+    m_p(p), m_packetId(id), m_sendTime(t), m_seq(0), m_pos(0) {}
 	~QueueItemDbr();
 
 	Ptr<Packet> m_p;		// pointer to the packet
+	uint32_t m_packetId;	// DBR packet ID of m_p
 	double m_sendTime;	// time to send the packet
+
+private:
+  friend class MyPacketQueue;
+  uint64_t m_seq;     // insertion order, breaks send time ties
+  uint32_t m_pos;     // position in the heap
 };  // class QueueItemDbr
 
+/**
+ * \brief Sending queue ordered by expected send time.
+ *
+ * Binary min-heap of items with an index from packet ID to item, holding at
+ * most one item per packet ID. Items with equal send times leave in the
+ * order they were inserted.
+ */
 class MyPacketQueue : public Object {
 public:
-	MyPacketQueue() : m_dq() {}
+	MyPacketQueue() : m_seq(0) {}
 	~MyPacketQueue() {
-		QueueItemDbr* tmp;
-		while(!m_dq.empty()) {
-			tmp = m_dq.back();
-			m_dq.pop_back();
-			delete tmp;
-		}
-		m_dq.clear();
+		for (uint32_t i = 0; i < m_heap.size(); i++)
+			delete m_heap[i];
+		m_heap.clear();
+		m_index.clear();
 	}
 
-	bool empty() { return m_dq.empty(); }
-	int size() { return m_dq.size(); }
+	bool empty() { return m_heap.empty(); }
+	int size() { return m_heap.size(); }
 	void dump();
 
-	void pop() { m_dq.pop_front(); };
-	QueueItemDbr* front() { return m_dq.front(); };
+	void pop();     // removes front() without freeing it
+	QueueItemDbr* front() { return m_heap.front(); };
 	void insert(QueueItemDbr* q);
-	bool update(Ptr<Packet> p, double t);
-	bool purge(Ptr<Packet> p);
+	bool update(uint32_t packetId, double t);
+	bool purge(uint32_t packetId);
 
 private:
-	std::deque<QueueItemDbr*> m_dq;
+	bool Before(const QueueItemDbr *a, const QueueItemDbr *b) const;
+	void Place(QueueItemDbr *q, uint32_t pos);
+	void SiftUp(uint32_t pos);
+	void SiftDown(uint32_t pos);
+	void Remove(QueueItemDbr *q);
+
+	std::vector<QueueItemDbr*> m_heap;
+	std::unordered_map<uint32_t, QueueItemDbr*> m_index;
+	uint64_t m_seq;
 };  // class MyPacketQueue
 
 class NeighbEnt{
@@ -138,6 +160,13 @@ public:
 	//DBR_DeadNeighbTimer dnt;	// timer for expiration of neighbor
 };  // class NeighbEnt
 
+/**
+ * \brief Neighbor table ordered by depth.
+ *
+ * Entries are indexed by address and kept in a set ordered by z (shallowest
+ * first, ties broken by address), so EntFindShadowest does not scan the
+ * table. Neighbors with a known route are kept apart in address order.
+ */
 class NeighbTable : public Object {
 public:
 	NeighbTable(/*Ptr<AquaSimDBR> a*/);
@@ -149,23 +178,41 @@ public:
 	NeighbEnt *EntAdd(const NeighbEnt *e);     	// add an neighbor
 	NeighbEnt *EntFindShadowest(Vector location);  // find the neighbor with minimal depth
 	void UpdateRouteFlag(AquaSimAddress, int);
+	int GetN(void) const { return m_ents.size(); }
 
 private:
-	int m_numEnts;       // number of entries in use
-	int m_maxEnts;       // capacity of the table
+	struct DepthOrder {
+		bool operator()(const NeighbEnt *a, const NeighbEnt *b) const
+		{
+			if (a->m_location.z != b->m_location.z)
+				return a->m_location.z > b->m_location.z;
+			return a->m_netID < b->m_netID;
+		}
+	};
+
 	//Ptr<AquaSimDBR> m_a;       // agent owns the table
-	NeighbEnt **m_tab;    // neighbor table
+	std::unordered_map<uint16_t, NeighbEnt*> m_ents;	// entries by address
+	std::set<NeighbEnt*, DepthOrder> m_byDepth;		// shallowest first
+	std::set<AquaSimAddress> m_routed;		// entries with m_routeFlag == 1
 };  // class NeighbTable
 
 
+/**
+ * \brief Bounded LRU cache of DBR packet IDs.
+ *
+ * A hash index into a recency list: lookups, insertions and evictions are
+ * O(1). Once full, adding a packet evicts the least recently used one.
+ */
 class ASPktCache {
 public:
-	ASPktCache();
+	ASPktCache(int maxSize = 1500);
 	~ASPktCache();
   static TypeId GetTypeId(void);
 
-	int& Size(void)
-	{ return m_size; }
+	int Size(void) const
+	{ return m_index.size(); }
+	int MaxSize(void) const
+	{ return m_maxSize; }
 
 	int AccessPacket(int pid);
 	void AddPacket(int pid);
@@ -173,8 +220,8 @@ public:
 	void Dump(void);
 
 private:
-	int *m_pCache;			// packet cache
-	int	m_size;					// cache size
+	std::list<int> m_lru;			// packet IDs, least recently used first
+	std::unordered_map<int, std::list<int>::iterator> m_index;
 	int m_maxSize;				// max cache size
 };  // class ASPktCache
 
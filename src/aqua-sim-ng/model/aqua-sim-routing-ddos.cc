@@ -27,6 +27,8 @@
 #include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
 #include "ns3/log.h"
 
 #include <vector>
@@ -36,15 +38,76 @@
 
 using namespace ns3;
 
-#define Malloc(type,n) (type *)malloc((n)*sizeof(type))
-
 NS_LOG_COMPONENT_DEFINE("AquaSimDDOS");
 NS_OBJECT_ENSURE_REGISTERED(AquaSimDDOS);
 
+DdosNodeStats::DdosNodeStats() :
+  pending(0), samples(0), hasPrevious(false), pendingCompromised(0),
+  transactions(0), compromised(0)
+{
+  std::fill(pendingMasks, pendingMasks + RULE_MASKS, 0);
+  std::fill(masks, masks + RULE_MASKS, 0);
+}
+
+/*current rule sets, one bit each:
+    mobility & pushback & timeout
+    mobility & throttle & timeout
+    pushback & timeout
+    throttle & timeout
+*/
+int
+DdosNodeStats::RuleMask(const MachineLearningStruct &t, const std::vector<double> &rules)
+{
+  return ((t.mobility + t.pushback + t.timeout) > rules[0]*3) |
+         ((t.mobility + t.throttle + t.timeout) > rules[1]*3) << 1 |
+         ((t.pushback + t.timeout) > rules[2]*2) << 2 |
+         ((t.throttle + t.timeout) > rules[3]*2) << 3;
+}
+
+void
+DdosNodeStats::Add(const MachineLearningStruct &sample, const std::vector<double> &rules, double weight)
+{
+  pending++;
+  samples++;
+  double w = (weight > 0 && samples > 1) ? weight : 1.0 / pending;
+  mean.mobility += w * (sample.mobility - mean.mobility);
+  mean.pushback += w * (sample.pushback - mean.pushback);
+  mean.throttle += w * (sample.throttle - mean.throttle);
+  mean.timeout += w * (sample.timeout - mean.timeout);
+
+  //compromised if compromised >= uncompromised rule sets
+  int mask = RuleMask(sample, rules);
+  int hits = (mask & 1) + (mask >> 1 & 1) + (mask >> 2 & 1) + (mask >> 3 & 1);
+  if (hits >= RULE_SETS/2) {
+    pendingCompromised++;
+    pendingMasks[mask]++;
+  }
+}
+
+MachineLearningStruct
+DdosNodeStats::ReadDistribution()
+{
+  transactions += pending;
+  compromised += pendingCompromised;
+  for (int m = 0; m < RULE_MASKS; m++) {
+    masks[m] += pendingMasks[m];
+    pendingMasks[m] = 0;
+  }
+  pending = pendingCompromised = 0;
+
+  //rounding
+  MachineLearningStruct dist;
+  dist.mobility = floor(mean.mobility * 1e4) / 1e4;
+  dist.pushback = floor(mean.pushback * 1e4) / 1e4;
+  dist.throttle = floor(mean.throttle * 1e4) / 1e4;
+  dist.timeout = floor(mean.timeout * 1e4) / 1e4;
+  return dist;
+}
+
 AquaSimDDOS::AquaSimDDOS() :
   m_totalPktSent(0), m_totalPktRecv(0), //m_dataCacheSize(10),
   isAttacker(false), m_pushbackReduction(0.01), m_throttleReduction(0.015),
-  m_statisticalIteration(0)
+  m_statWeight(0), m_statisticalIteration(0)
 {
   m_pitEntryTimeout = Seconds(60);
   m_ddosCheckFrequency = Minutes(2);//Minutes(10);
@@ -88,26 +151,8 @@ AquaSimDDOS::AquaSimDDOS() :
 
   sinkCounter=attackCounter=0;
 
-  #if LIBSVM
-  //default svm settings
-  m_param.svm_type = C_SVC;
-  m_param.kernel_type = LINEAR;
-  m_param.degree = 3;	/* for poly */
-	m_param.gamma = 0.01;	/* for poly/rbf/sigmoid */
-	m_param.coef0 = 0;	/* for poly/sigmoid */
-  m_param.nu = 0.01;
-  m_param.cache_size = 100;
-  m_param.C = 0.5;
-  m_param.eps = 0.01;
-  m_param.p = 0.1;
-  m_param.shrinking = 0;
-  m_param.probability = 0;
-  m_param.nr_weight = 0;
-  m_param.weight_label = NULL;
-  m_param.weight = NULL;
-  #endif
-
-  m_modelTrained=false;
+  m_svmLambda = 0.01;
+  m_svmMinSamples = 100;
 }
 
 TypeId
@@ -132,6 +177,22 @@ AquaSimDDOS::GetTypeId()
       IntegerValue(20),
       MakeIntegerAccessor(&AquaSimDDOS::m_minCompTrans),
       MakeIntegerChecker<int>())
+    .AddAttribute ("StatisticalWeight", "Weight of the newest sample in the running statistical means. 0 averages all samples since the last Analysis evenly.",
+      DoubleValue(0),
+      MakeDoubleAccessor(&AquaSimDDOS::m_statWeight),
+      MakeDoubleChecker<double>(0,1))
+    .AddAttribute ("SvmLambda", "Regularization weight of the online linear SVM.",
+      DoubleValue(0.01),
+      MakeDoubleAccessor(&AquaSimDDOS::m_svmLambda),
+      MakeDoubleChecker<double>(0))
+    .AddAttribute ("SvmMinSamples", "Samples the shared SVM must have learned before it classifies.",
+      UintegerValue(100),
+      MakeUintegerAccessor(&AquaSimDDOS::m_svmMinSamples),
+      MakeUintegerChecker<uint32_t>())
+    .AddAttribute ("SvmSnapshotFile", "File the shared SVM model is written to after it changes. Empty disables snapshots.",
+      StringValue(""),
+      MakeStringAccessor(&AquaSimDDOS::m_svmSnapshot),
+      MakeStringChecker())
   ;
   return tid;
 }
@@ -616,23 +677,14 @@ AquaSimDDOS::DdosAttackCheck()
               attackee fully throttles the attacker.) */
       }
 
-    //collect for SVM
-    SvmTable.push(SvmInput(timeoutRatio,std::max(transDominance,pitUsage),potentialAttack));
-    //svm classification
-    if (m_modelTrained) {
-      m_space = Malloc(struct svm_node,3);
-      m_space[0].index=0;
-      m_space[0].value=timeoutRatio;
-      m_space[1].index=1;
-      m_space[1].value=std::max(transDominance,pitUsage);
-      m_space[2].index=-1;
-
-
-      std::cout << "Predicted(" << GetNetDevice()->GetAddress() << ") @" << Simulator::Now().ToDouble(Time::S) <<
-        ":" << localNodeId << "," << svm_predict(m_model,m_space) << "\n";
-
-      free(m_space);
-    }
+    //SVM learns from the threshold decision; classified in batch at next Analysis
+    #if LIBSVM
+    SvmInput svmInput(timeoutRatio,std::max(transDominance,pitUsage),potentialAttack);
+    if (!m_svm) m_svm = AquaSimDdosModel::GetShared(m_svmLambda, m_svmMinSamples);
+    m_svm->Learn(svmInput);
+    m_svmQueryNodes.push_back(localNodeId);
+    m_svmQueries.push_back(svmInput);
+    #endif
 
     // --- for mobility analysis ----
     Ptr<Object> object = GetNetDevice()->GetChannel()->GetDevice(localNodeId-1)->GetNode();
@@ -649,18 +701,7 @@ AquaSimDDOS::DdosAttackCheck()
     mlTable.throttle = Normalize(transDominance, (localDdosTable).throttleThreshold);
     mlTable.timeout = Normalize(((1+channelMeasurement)*timeoutRatio), (localDdosTable).timeoutThreshold);
 
-    std::map<int,ml>::iterator ml_it;
-    ml_it = StatLearningTable.find(localNodeId);
-    if(ml_it == StatLearningTable.end())
-      {
-        ml newML;
-        newML.push(mlTable);
-        StatLearningTable.insert( std::pair<int,ml>(localNodeId,newML));
-      }
-    else
-      {
-        (ml_it->second).push(mlTable);
-      }
+    m_nodeStats[localNodeId].Add(mlTable, m_rules, m_statWeight);
   }
   Time delay = m_ddosCheckFrequency + m_ddosCheckFrequency * m_rand->GetValue(); //add a slight variation
   Simulator::Schedule(delay, &AquaSimDDOS::DdosAttackCheck, this);
@@ -757,46 +798,18 @@ std::vector<StatisticalTable> AquaSimDDOS::Statistical()
 
   std::vector<StatisticalTable> scores;
 
-  std::map<int,ml>::iterator it=StatLearningTable.begin();
-  for (; it!=StatLearningTable.end(); it++) {
-    int qSize = (it->second).size();
-    if (qSize < 10) continue;
-    MachineLearningStruct currentDist, previousDist;
-    //for longterm history:
-    std::pair<std::map<int,ml>::iterator,bool> rulesLearning;
-    ml newML;
-    rulesLearning = RuleMiningTable.insert(std::pair<int,ml>(it->first,newML));
-
-    // finding node's (it->first) distribution
-    while(!(it->second).empty()) {
-      currentDist.mobility += (it->second).front().mobility;
-      currentDist.pushback += (it->second).front().pushback;
-      currentDist.throttle += (it->second).front().throttle;
-      currentDist.timeout += (it->second).front().timeout;
-      ((rulesLearning.first)->second).push((it->second).front());
-      (it->second).pop();
-    }
+  std::map<int,DdosNodeStats>::iterator it=m_nodeStats.begin();
+  for (; it!=m_nodeStats.end(); it++) {
+    DdosNodeStats &stats = it->second;
+    if (stats.pending < 10) continue;
+    // node's (it->first) distribution, also hands its rule hits to rules mining
+    MachineLearningStruct currentDist = stats.ReadDistribution();
 
-    currentDist.mobility /= qSize;
-    currentDist.pushback /= qSize;
-    currentDist.throttle /= qSize;
-    currentDist.timeout /= qSize;
-
-    //rounding
-    currentDist.mobility = floor(currentDist.mobility * pow(10,4)) / pow(10,4);
-    currentDist.pushback = floor(currentDist.pushback * pow(10,4)) / pow(10,4);
-    currentDist.throttle = floor(currentDist.throttle * pow(10,4)) / pow(10,4);
-    currentDist.timeout = floor(currentDist.timeout * pow(10,4)) / pow(10,4);
-
-    //get previous statistical distrubtion
-    std::map<int,MachineLearningStruct>::iterator prev_stat;
-    prev_stat = PreviousStatDistribution.find(it->first);
-    if (prev_stat == PreviousStatDistribution.end()) {
-      PreviousStatDistribution.insert(std::pair<int,MachineLearningStruct>(it->first,currentDist));
+    if (!stats.hasPrevious) {
       scores.push_back(StatisticalTable(it->first,1)); //report score of 1 for new entry
     }
     else {
-      previousDist = prev_stat->second;
+      const MachineLearningStruct &previousDist = stats.previous;
       MachineLearningStruct temp;
       //absolute subtration:
       temp.mobility = (currentDist.mobility <= previousDist.mobility) ? (previousDist.mobility - currentDist.mobility) : (currentDist.mobility - previousDist.mobility);
@@ -808,9 +821,9 @@ std::vector<StatisticalTable> AquaSimDDOS::Statistical()
       //normalize summation to scale of 0,1 & report score.
       double tempScore = Normalize((temp.mobility + temp.pushback + temp.throttle + temp.timeout),4);
       scores.push_back(StatisticalTable(it->first,tempScore));
-      previousDist = currentDist;
     }
-
+    stats.previous = currentDist;
+    stats.hasPrevious = true;
   }
   m_statisticalIteration++;
   return scores;
@@ -820,80 +833,18 @@ void AquaSimDDOS::SVM()
 {
   NS_LOG_FUNCTION(this);
 
-  //NOTE: this is for training model, classification should be separate.
-  if (SvmTable.size() < 100) return;
-  std::cout << GetNetDevice()->GetAddress() << " SVM table size:" << SvmTable.size() << "\n";
-
-  m_prob.l = SvmTable.size();
-  size_t elements, j;
-  elements = m_prob.l * 3;
-  j=0;
-
-  m_prob.y = Malloc(double,m_prob.l);
-  m_prob.x = Malloc(struct svm_node *,m_prob.l);
-  m_space = Malloc(struct svm_node,elements);
-
-  int i=0;
-  while(!SvmTable.empty()) {
-    //LIBSVM expected layout: <label> <index1>:<value1> <index2>:<value2> ...
-    SvmInput entry=SvmTable.front();
-    m_prob.x[i] = &m_space[j];
-    m_prob.y[i] = (entry.compromised)?1:0;
-
-    //boundry check.
-    NS_ASSERT((entry.timeoutR >= 0 && entry.timeoutR <= 1) || (entry.maxR >= 0 && entry.maxR <= 1));
-
-    m_space[j].index = 0;
-    m_space[j].value = entry.timeoutR;
-    ++j;
-    m_space[j].index = 1;
-    m_space[j].value = entry.maxR;
-    m_space[++j].index = -1;
-
-    SvmTable.pop();
-    i++;
-  }
-
-  const char *error_msg;
-  error_msg = svm_check_parameter(&m_prob,&m_param);
-  if(error_msg) {
-    NS_LOG_ERROR("SVM Error:" << error_msg);
-    return;
-  }
-
-  // -------------- cross validation ----------------------------
-  /*
-  int k, total_correct = 0, nr_fold = 2;
-  double *target = Malloc(double,m_prob.l);
-
-  svm_cross_validation(&m_prob,&m_param,nr_fold,target);
-
-  for(k=0;k<m_prob.l;k++)
-    if(target[k] == m_prob.y[k])
-      ++total_correct;
-  printf("Cross Validation Accuracy = %g%%\n",100.0*total_correct/m_prob.l);
-  free(target);
-  */
-
-  // ------------- training and saving model -------------------
-  struct svm_model *tmp_model;
-  tmp_model = svm_train(&m_prob,&m_param);
-  if (tmp_model->nr_class==1) {
-    //only one class from training data, therefore not saving model
-    //Do nothing.
-    free(tmp_model);
-  } else {
-    m_model = tmp_model;
-    if(svm_save_model("ddos_svm.model",m_model)) {
-      NS_LOG_WARN("Not able to save SVM model to file");
-      return;
-    }
-    m_modelTrained=true;
+  //training is online (see DdosAttackCheck), here only classification.
+  if (m_svmQueries.empty()) return;
+  if (m_svm->IsTrained()) {
+    m_svm->Classify(m_svmQueries, m_svmLabels);
+    for (size_t i=0; i<m_svmQueries.size(); i++)
+      std::cout << "Predicted(" << GetNetDevice()->GetAddress() << ") @" << Simulator::Now().ToDouble(Time::S) <<
+        ":" << m_svmQueryNodes[i] << "," << m_svmLabels[i] << "\n";
+    if (!m_svmSnapshot.empty())
+      m_svm->Snapshot(m_svmSnapshot);
   }
-
-  free(m_prob.y);
-  free(m_prob.x);
-  free(m_space);
+  m_svmQueryNodes.clear();
+  m_svmQueries.clear();
 }
 
 std::vector<StatisticalTable> AquaSimDDOS::RulesMining()
@@ -901,85 +852,49 @@ std::vector<StatisticalTable> AquaSimDDOS::RulesMining()
   NS_LOG_FUNCTION(this);
 
   std::vector<StatisticalTable> nodeScores;
-  std::queue<std::vector<bool> > compromisedTransQueue;
+  uint32_t masks[DdosNodeStats::RULE_MASKS] = {0};
+  int totalQueueSize = 0;
 
   //for each nodeID
-  std::map<int,ml>::iterator rm_it=RuleMiningTable.begin();
-  for (; rm_it!=RuleMiningTable.end(); rm_it++) {
-    int compromisedTransactions=0;
-    int totalTransactions= (rm_it->second).size();
-    if (totalTransactions < 10) continue;
-    //review entire MachineLearningStruct queue for current nodeID
-    for (int j=0;j<totalTransactions;j++) {
-      /* (1) finding amount of compromised vs uncompromised components for each transaction */
-      int compromisedRules=0;
-      int totalRules=4;
-      MachineLearningStruct currentTrans = (rm_it->second).front();
-      /* The rule sets we are looking at */
-      std::vector<double> transaction = {currentTrans.mobility,currentTrans.pushback,currentTrans.timeout,
-                                        currentTrans.mobility,currentTrans.throttle,currentTrans.timeout,
-                                        currentTrans.pushback,currentTrans.timeout,
-                                        currentTrans.throttle,currentTrans.timeout};
-      /*std::vector<bool> binaryTransaction;
-      for(unsigned i=0; i<m_rules.size(); i++) {
-        if(transaction[i]>m_rules[i]) {
-          compromisedRules++;
-          binaryTransaction.push_back(true);
-        } else  binaryTransaction.push_back(false);
-      }*/
-      std::vector<bool> binaryTransaction = {(transaction[0]+transaction[1]+transaction[2])>m_rules[0]*3,
-                                             (transaction[3]+transaction[4]+transaction[5])>m_rules[1]*3,
-                                             (transaction[6]+transaction[7])>m_rules[2]*2,
-                                             (transaction[8]+transaction[9])>m_rules[3]*2};
-      for (unsigned int c=0;c<binaryTransaction.size();c++) {
-        if (binaryTransaction[c]==true) compromisedRules++;
-      }
-
-      /* (2) if compromised >= uncompromised rule sets then set transaction to compromised */
-      if (compromisedRules>=totalRules/2) {
-        compromisedTransactions++;
-        compromisedTransQueue.push(binaryTransaction); //used for step 4
-      }
-    (rm_it->second).pop();
-    }
+  std::map<int,DdosNodeStats>::iterator rm_it=m_nodeStats.begin();
+  for (; rm_it!=m_nodeStats.end(); rm_it++) {
+    DdosNodeStats &stats = rm_it->second;
+    if (stats.transactions < 10) continue;
+    /* (1),(2) were done per sample: a transaction is compromised if at least
+       half of the rule sets hit, and its rule-hit mask was counted. */
     /* (3) compare compromised transactions vs uncompromised for all of node's transactions */
-    if (compromisedTransactions>totalTransactions/2) {
+    if (stats.compromised>stats.transactions/2) {
       nodeScores.push_back(StatisticalTable(rm_it->first,1));  //1 = comrpromised, 0 = not.
     } else {
       nodeScores.push_back(StatisticalTable(rm_it->first,0));
     }
+    for (int m=0; m<DdosNodeStats::RULE_MASKS; m++) {
+      masks[m] += stats.masks[m];
+      stats.masks[m] = 0;
+    }
+    totalQueueSize += stats.compromised;
+    stats.transactions = stats.compromised = 0;
   }
 
-  //(4) use above list of compromised transactions to adjust the set of rules for all neighboring nodes
+  //(4) use above compromised transactions to adjust the set of rules for all neighboring nodes
   //NOTE abbreviations: pushback = Pb, timeout = To, throttle = Th, Mobility = Mb
   int MbPbTo_sum=0, MbThTo_sum=0, PbTo_sum=0, ThTo_sum=0;  //support summations
-  int PbTo_conf=0, ThTo_conf=0, PbTo_mobility=0, ThTo_mobility=0; //confidence summations
-  int totalQueueSize = compromisedTransQueue.size();
-  std::vector<bool> compTransation;
-
-  while(!compromisedTransQueue.empty()) {
-    compTransation = compromisedTransQueue.front();
-
-    //support frequencies
-    if (compTransation[0] && compTransation[1] && compTransation[2]) MbPbTo_sum++;
-    if (compTransation[3] && compTransation[4] && compTransation[5]) MbThTo_sum++;
-    if (compTransation[6] && compTransation[7]) PbTo_sum++;
-    if (compTransation[8] && compTransation[9]) ThTo_sum++;
-
-    //confidence frequencies (between first two rules sets: mobility vs pushback/timeout and mobility vs throttle/timeout)
-    if (compTransation[1] && compTransation[2]) PbTo_conf++;
-    if (compTransation[4] && compTransation[5]) ThTo_conf++;
-    if (compTransation[0]) PbTo_mobility++;
-    if (compTransation[3]) ThTo_mobility++;
-
-    compromisedTransQueue.pop();
+  int MbPbTo_conf=0, MbThTo_conf=0; //confidence summations (mobility rule sets among their non-mobility ones)
+  for (int m=0; m<DdosNodeStats::RULE_MASKS; m++) {
+    bool MbPbTo = m & 1, MbThTo = m & 2, PbTo = m & 4, ThTo = m & 8;
+    if (MbPbTo) MbPbTo_sum += masks[m];
+    if (MbThTo) MbThTo_sum += masks[m];
+    if (PbTo) PbTo_sum += masks[m];
+    if (ThTo) ThTo_sum += masks[m];
+    if (MbPbTo && PbTo) MbPbTo_conf += masks[m];
+    if (MbThTo && ThTo) MbThTo_conf += masks[m];
   }
 
   /* Debug/printing purposes */
   if (1 && totalQueueSize>0) {
     std::cout << "Rules Mining on node(" << GetNetDevice()->GetAddress() << ") out of " << totalQueueSize << " compromised transactions.\n"
-              << "RuleSet#1: Support(" << MbPbTo_sum<<"/"<<totalQueueSize << ") Confidence(" << PbTo_conf<<"/"<<PbTo_mobility << ")\n"
-              << "RuleSet#2: Support(" << MbThTo_sum<<"/"<<totalQueueSize << ") Confidence(" << ThTo_conf<<"/"<<ThTo_mobility << ")\n"
+              << "RuleSet#1: Support(" << MbPbTo_sum<<"/"<<totalQueueSize << ") Confidence(" << MbPbTo_conf<<"/"<<PbTo_sum << ")\n"
+              << "RuleSet#2: Support(" << MbThTo_sum<<"/"<<totalQueueSize << ") Confidence(" << MbThTo_conf<<"/"<<ThTo_sum << ")\n"
               << "RuleSet#3: Support(" << PbTo_sum<<"/"<<totalQueueSize << ")\n"
               << "RuleSet#4: Support(" << ThTo_sum<<"/"<<totalQueueSize << ")\n";
   }
@@ -988,24 +903,14 @@ std::vector<StatisticalTable> AquaSimDDOS::RulesMining()
   if (totalQueueSize >= m_minCompTrans) {
     //short-circuit if zero denominator
     //TODO tweak rule adjustments below
-    if ( MbPbTo_sum/totalQueueSize >= m_minSupport && PbTo_mobility>0 && PbTo_conf/PbTo_mobility >= m_minConfidence) {
+    if ( (double)MbPbTo_sum/totalQueueSize >= m_minSupport && PbTo_sum>0 && (double)MbPbTo_conf/PbTo_sum >= m_minConfidence)
       m_rules[0] += 0.02;
-      m_rules[1] += 0.01;
-      m_rules[2] += 0.02;
-    }
-    if ( MbThTo_sum/totalQueueSize >= m_minSupport && ThTo_mobility>0 && ThTo_conf/ThTo_mobility >= m_minConfidence) {
-      m_rules[3] += 0.02;
-      m_rules[4] += 0.01;
-      m_rules[5] += 0.02;
-    }
-    if ( PbTo_sum/totalQueueSize >= m_minSupport) {
-      m_rules[6] += 0.015;
-      m_rules[7] += 0.015;
-    }
-    if ( ThTo_sum/totalQueueSize >= m_minSupport) {
-      m_rules[8] += 0.015;
-      m_rules[9] += 0.015;
-    }
+    if ( (double)MbThTo_sum/totalQueueSize >= m_minSupport && ThTo_sum>0 && (double)MbThTo_conf/ThTo_sum >= m_minConfidence)
+      m_rules[1] += 0.02;
+    if ( (double)PbTo_sum/totalQueueSize >= m_minSupport)
+      m_rules[2] += 0.015;
+    if ( (double)ThTo_sum/totalQueueSize >= m_minSupport)
+      m_rules[3] += 0.015;
   }
 
   m_statisticalIteration=0;
@@ -1071,13 +976,13 @@ AquaSimDDOS::ResetThrottle(int nodeID)
 void
 AquaSimDDOS::ResetStatDistribution(int nodeID)
 {
-  std::map<int,MachineLearningStruct>::iterator it_stat;
-  it_stat = PreviousStatDistribution.find(nodeID);
-  if (it_stat == PreviousStatDistribution.end()) {
+  std::map<int,DdosNodeStats>::iterator it_stat;
+  it_stat = m_nodeStats.find(nodeID);
+  if (it_stat == m_nodeStats.end() || !(it_stat->second).hasPrevious) {
     NS_LOG_WARN("No StatDistribution found for " << nodeID);
     return;
   }
-  PreviousStatDistribution.erase(it_stat);
+  (it_stat->second).hasPrevious = false;
 }
 
 
@@ -1113,10 +1018,7 @@ AquaSimDDOS::UpdateInterest()
 
 void AquaSimDDOS::DoDispose()
 {
-  #if LIBSVM
-  svm_free_and_destroy_model(&m_model);
-  svm_destroy_param(&m_param);
-  #endif
+  m_svm.reset();
   m_rand=0;
   AquaSimRouting::DoDispose();
 }
@@ -35,9 +35,11 @@
 #include <sstream>
 #include <string>
 #include <queue>
+#include <memory>
 #include <set>
+#include <vector>
 
-#include "ns3/svm.h"
+#include "aqua-sim-ddos-model.h"
 
 #define LIBSVM 1
 
@@ -82,6 +84,39 @@ struct MachineLearningStruct{
   double pushback;  //pushback percentage to threshold
   double throttle;  //throttle percentage to threshold
   double timeout;
+  MachineLearningStruct() : mobility(0), pushback(0), throttle(0), timeout(0) {}
+};
+
+/*
+ * Running per-neighbor learning state, updated once per DdosAttackCheck
+ * sample instead of queueing samples for the next Analysis. Rule hits are
+ * kept as a 4 bit mask per transaction (one bit per rule set) and only
+ * their histogram is stored, so the state has a fixed size.
+ */
+struct DdosNodeStats{
+  static const int RULE_SETS = 4;
+  static const int RULE_MASKS = 1 << RULE_SETS;
+
+  MachineLearningStruct mean;     //mean of the samples since the last read
+  uint32_t pending;               //samples since the last statistical read
+  uint32_t samples;               //samples ever recorded
+  MachineLearningStruct previous; //distribution of the last statistical read
+  bool hasPrevious;
+
+  //rule hits of the pending samples, moved to the mining counts on read
+  uint32_t pendingCompromised;
+  uint32_t pendingMasks[RULE_MASKS];
+  //rule hits awaiting RulesMining
+  uint32_t transactions;
+  uint32_t compromised;
+  uint32_t masks[RULE_MASKS];     //compromised transactions per rule-hit mask
+
+  DdosNodeStats();
+  static int RuleMask(const MachineLearningStruct &sample, const std::vector<double> &rules);
+  /* weight 0 averages the pending samples evenly, otherwise the newest
+   * sample gets that weight and the mean carries over between reads */
+  void Add(const MachineLearningStruct &sample, const std::vector<double> &rules, double weight);
+  MachineLearningStruct ReadDistribution();
 };
 
 struct StatisticalTable{
@@ -90,13 +125,6 @@ struct StatisticalTable{
   StatisticalTable(int nodeID_, double score_) : nodeID(nodeID_), score(score_) {}
 };
 
-struct SvmInput{
-  double timeoutR;
-  double maxR;  //largest ratio of pushback and throttle
-  bool compromised;
-  SvmInput(double t_, double m_, bool c_) : timeoutR(t_), maxR(m_), compromised(c_) {}
-};
-
 class Packet;
 class Address;
 
@@ -172,11 +200,9 @@ private:
   double m_throttleReduction;
 
   //machine learning componenents
-  typedef std::queue<MachineLearningStruct> ml;
-  std::map<int, ml> StatLearningTable;
-  std::map<int, MachineLearningStruct> PreviousStatDistribution;
-  std::map<int, ml> RuleMiningTable;
+  std::map<int, DdosNodeStats> m_nodeStats;
   std::vector<double> m_rules;       //rule sets for rule mining model
+  double m_statWeight;  //weight of newest sample in the running means, 0 for window means
   Time m_analysisFreq;  //frequency of stats and machine learning analysis
   int m_ruleMiningFreq;   //rules mining model frequency, based on statisticalFreq occurance
   int m_statisticalIteration;
@@ -185,13 +211,14 @@ private:
   int m_minCompTrans;   //minimum size of compromised transactions to adjust rules
 
   //SVM components
-  std::queue<SvmInput> SvmTable;
   Time m_svmLearningFreq;
-  bool m_modelTrained;
-  struct svm_parameter m_param;
-  struct svm_problem m_prob;
-  struct svm_model *m_model;
-  struct svm_node *m_space;
+  std::shared_ptr<AquaSimDdosModel> m_svm;  //shared by all detectors of the simulation
+  std::vector<int> m_svmQueryNodes;         //neighbors to classify at the next Analysis
+  std::vector<SvmInput> m_svmQueries;
+  std::vector<double> m_svmLabels;
+  double m_svmLambda;
+  uint32_t m_svmMinSamples;
+  std::string m_svmSnapshot;
 
   //TODO remove here, under constructor and on sink recv.
   int sinkCounter;
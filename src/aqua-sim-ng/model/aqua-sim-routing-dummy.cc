@@ -23,6 +23,7 @@
 #include "aqua-sim-header-routing.h"
 #include "aqua-sim-header.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 
 using namespace ns3;
 
@@ -35,184 +35,49 @@ using namespace ns3;
 NS_LOG_COMPONENT_DEFINE("AquaSimVBF");
 //NS_OBJECT_ENSURE_REGISTERED(AquaSimPktHashTable);
 
-AquaSimPktHashTable::AquaSimPktHashTable() {
+AquaSimPktHashTable::AquaSimPktHashTable()
+  : m_htable (WINDOW_SIZE)
+{
   NS_LOG_FUNCTION(this);
-  m_windowSize=WINDOW_SIZE;
-  //  lower_counter=0;
-  // 50 items in the hash table, however, because it begins by 0, so, minus 1
-  //Tcl_InitHashTable(&m_htable, 3);
 }
 
 AquaSimPktHashTable::~AquaSimPktHashTable()
 {
   NS_LOG_FUNCTION(this);
-  for (std::map<hash_entry,vbf_neighborhood*>::iterator it=m_htable.begin(); it!=m_htable.end(); ++it) {
-
-    delete it->second;
-  }
-  m_htable.clear();
 }
 
 void
 AquaSimPktHashTable::Reset()
 {
-  m_htable.clear();
-  /*
-	vbf_neighborhood *hashPtr;
-	Tcl_HashEntry *entryPtr;
-	Tcl_HashSearch searchPtr;
-
-	entryPtr = Tcl_FirstHashEntry(&m_htable, &searchPtr);
-	while (entryPtr != NULL) {
-		hashPtr = (vbf_neighborhood *)Tcl_GetHashValue(entryPtr);
-		delete hashPtr;
-		Tcl_DeleteHashEntry(entryPtr);
-		entryPtr = Tcl_NextHashEntry(&searchPtr);
-	}
-  */
+  m_htable.Clear();
 }
 
 vbf_neighborhood*
 AquaSimPktHashTable::GetHash(AquaSimAddress senderAddr, unsigned int pk_num)
 {
-  hash_entry entry = std::make_pair (senderAddr,pk_num);
-  std::map<hash_entry,vbf_neighborhood*>::iterator it;
-
-  it = m_htable.find(entry);
-
-  if (it == m_htable.end())
-    return NULL;
-
-  return it->second;
-  /*
-  unsigned int key[3];
-
-	key[0] = senderAddr;
-	key[1] = 0; //sender_id.port_;
-	key[2] = pk_num;
-
-	Tcl_HashEntry *entryPtr = Tcl_FindHashEntry(&m_htable, (char *)key);
-
-	if (entryPtr == NULL )
-		return NULL;
-
-	return (vbf_neighborhood *)Tcl_GetHashValue(entryPtr);
-  */
+  return m_htable.Find(senderAddr, pk_num);
 }
 
 void
 AquaSimPktHashTable::PutInHash(AquaSimAddress sAddr, unsigned int pkNum)
 {
-	//Tcl_HashEntry *entryPtr;
-	// Pkt_Hash_Entry    *hashPtr;
-	vbf_neighborhood* hashPtr;
-  //unsigned int key[3];
-	//bool newPtr = true;
-
-	//key[1]=0; //(vbh->sender_id).port_;
-  hash_entry entry = std::make_pair (sAddr,pkNum);
-  std::map<hash_entry,vbf_neighborhood*>::iterator it;
-
-	int k=pkNum-m_windowSize;
-	if(k>0)    //TODO verify this in future work
-	{
-		for (int i=0; i<k; i++)
-		{
-      entry.second = i;
-      it = m_htable.find(entry);
-      if(it != m_htable.end())
-      {
-        hashPtr = it->second;
-        delete hashPtr;
-        m_htable.erase(it);
-      }
-		}
-	}
-
-  entry.second = pkNum;
-  hashPtr = GetHash(sAddr,pkNum);
-  //entryPtr = Tcl_CreateHashEntry(&m_htable, (char *)key, &newPtr);
-	if (hashPtr != NULL) {
-		int m=hashPtr->number;
-		if (m<MAX_NEIGHBOR) {
-			hashPtr->number++;
-			hashPtr->neighbor[m].x=0;
-			hashPtr->neighbor[m].y=0;
-			hashPtr->neighbor[m].z=0;
-		}
-		return;
-	}
-	hashPtr=new vbf_neighborhood[1];
-	hashPtr[0].number=1;
-	hashPtr[0].neighbor[0].x=0;
-	hashPtr[0].neighbor[0].y=0;
-	hashPtr[0].neighbor[0].z=0;
-  std::pair<hash_entry,vbf_neighborhood*> newPair;
-  newPair.first=entry; newPair.second=hashPtr;
-  if (m_htable.insert(newPair).second == false)
-  {
-    delete newPair.second;
-  }
-	//Tcl_SetHashValue(entryPtr, hashPtr);
+  PutInHash(sAddr, pkNum, Vector(0,0,0));
 }
 
 void
 AquaSimPktHashTable::PutInHash(AquaSimAddress sAddr, unsigned int pkNum, Vector p)
 {
   NS_LOG_DEBUG("PutinHash begin:" << sAddr << "," << pkNum << ",(" << p.x << "," << p.y << "," << p.z << ")");
-	//Tcl_HashEntry *entryPtr;
-	// Pkt_Hash_Entry    *hashPtr;
-	vbf_neighborhood* hashPtr;
-	//unsigned int key[3];
-	//bool newPtr = true;
-
-	//key[1]=0; //(vbh->sender_id).port_;
-  hash_entry entry = std::make_pair (sAddr,pkNum);
-  std::map<hash_entry,vbf_neighborhood*>::iterator it;
-	int k=pkNum-m_windowSize;
-	if(k>0)
-	{
-		for (int i=0; i<k; i++)
-		{
-      entry.second = i;
-      it = m_htable.find(entry);
-      if(it != m_htable.end())
-      {
-        hashPtr = it->second;
-        delete hashPtr;
-        m_htable.erase(it);
-      }
-		}
-	}
-
-  entry.second = pkNum;
-  hashPtr = GetHash(sAddr,pkNum);
-  //entryPtr = Tcl_CreateHashEntry(&m_htable, (char *)key, &newPtr);
-	if (hashPtr != NULL)
-	{
-		int m=hashPtr->number;
-		// printf("hash_table: this is not old item, there are %d item inside\n",m);
-		if (m<MAX_NEIGHBOR) {
-			hashPtr->number++;
-			hashPtr->neighbor[m].x=p.x;
-			hashPtr->neighbor[m].y=p.y;
-			hashPtr->neighbor[m].z=p.z;
-		}
-		return;
-	}
-	hashPtr=new vbf_neighborhood[1];
-	hashPtr[0].number=1;
-	hashPtr[0].neighbor[0].x=p.x;
-	hashPtr[0].neighbor[0].y=p.y;
-	hashPtr[0].neighbor[0].z=p.z;
-
-  std::pair<hash_entry,vbf_neighborhood*> newPair;
-  newPair.first=entry; newPair.second=hashPtr;
-  if (m_htable.insert(newPair).second == false)
-  {
-    delete newPair.second;
+  bool created;
+  vbf_neighborhood* hashPtr = m_htable.Insert(sAddr, pkNum, created);
+  if (hashPtr == NULL)
+    return;   //fell out of the window before it arrived
+
+  int m = created ? 0 : hashPtr->number;
+  if (m<MAX_NEIGHBOR) {
+    hashPtr->number = m+1;
+    hashPtr->neighbor[m] = p;
   }
-	//Tcl_SetHashValue(entryPtr, hashPtr);
 }
 
 AquaSimDataHashTable::AquaSimDataHashTable() {
@@ -25,6 +25,7 @@
 #include "aqua-sim-address.h"
 #include "aqua-sim-datastructure.h"
 #include "aqua-sim-channel.h"
+#include "aqua-sim-pkt-window.h"
 #include "ns3/vector.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/packet.h"
@@ -49,13 +50,11 @@ typedef std::pair<AquaSimAddress, unsigned int> hash_entry;
  */
 class AquaSimPktHashTable {
 public:
-  std::map<hash_entry,vbf_neighborhood*> m_htable;
-  //std::map<hash_t, hash_entry> m_htable;
+  AquaSimPktWindow<vbf_neighborhood> m_htable;
 
   AquaSimPktHashTable();
   ~AquaSimPktHashTable();
 
-  int  m_windowSize;
   void Reset();
   void PutInHash(AquaSimAddress sAddr, unsigned int pkNum);
   void PutInHash(AquaSimAddress sAddr, unsigned int pkNum, Vector p);
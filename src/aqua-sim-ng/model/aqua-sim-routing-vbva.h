@@ -25,6 +25,7 @@
 #include "aqua-sim-address.h"
 #include "aqua-sim-datastructure.h"
 #include "aqua-sim-routing-buffer.h"
+#include "aqua-sim-pkt-window.h"
 #include "ns3/vector.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/packet.h"
@@ -59,15 +60,12 @@ class VBHeader;
  */
 class AquaSimVBVAPktHashTable {
 public:
-  std::map<hash_entry,neighborhood*> m_htable;
+  AquaSimPktWindow<neighborhood> m_htable;
 
-  AquaSimVBVAPktHashTable() {
-    m_windowSize=WINDOW_SIZE;
-    //Tcl_InitHashTable(&htable, 3);
+  AquaSimVBVAPktHashTable() : m_htable (WINDOW_SIZE) {
   }
   ~AquaSimVBVAPktHashTable();
 
-  int  m_windowSize;
   void Reset();
   void DeleteHash(VBHeader*); //delete the enrty that has the same key as the new packet
   void DeleteHash(AquaSimAddress, unsigned);
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aqua-sim-rx-info-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (AquaSimRxInfoTag);
+
+AquaSimRxInfoTag::AquaSimRxInfoTag () :
+  m_pr (0),
+  m_senderPos (Vector (0, 0, 0)),
+  m_propDelay (0)
+{
+}
+
+TypeId
+AquaSimRxInfoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimRxInfoTag")
+    .SetParent<Tag> ()
+    .AddConstructor<AquaSimRxInfoTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+AquaSimRxInfoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+AquaSimRxInfoTag::GetSerializedSize (void) const
+{
+  return 5 * 8;
+}
+
+void
+AquaSimRxInfoTag::Serialize (TagBuffer i) const
+{
+  i.WriteDouble (m_pr);
+  i.WriteDouble (m_senderPos.x);
+  i.WriteDouble (m_senderPos.y);
+  i.WriteDouble (m_senderPos.z);
+  i.WriteU64 ((uint64_t) m_propDelay);
+}
+
+void
+AquaSimRxInfoTag::Deserialize (TagBuffer i)
+{
+  m_pr = i.ReadDouble ();
+  m_senderPos.x = i.ReadDouble ();
+  m_senderPos.y = i.ReadDouble ();
+  m_senderPos.z = i.ReadDouble ();
+  m_propDelay = (int64_t) i.ReadU64 ();
+}
+
+void
+AquaSimRxInfoTag::Print (std::ostream &os) const
+{
+  os << "Pr=" << m_pr << " SenderPos=" << m_senderPos
+     << " PropDelay=" << NanoSeconds (m_propDelay);
+}
+
+void
+AquaSimRxInfoTag::SetPr (double pr)
+{
+  m_pr = pr;
+}
+
+double
+AquaSimRxInfoTag::GetPr (void) const
+{
+  return m_pr;
+}
+
+void
+AquaSimRxInfoTag::SetSenderPosition (const Vector &pos)
+{
+  m_senderPos = pos;
+}
+
+Vector
+AquaSimRxInfoTag::GetSenderPosition (void) const
+{
+  return m_senderPos;
+}
+
+void
+AquaSimRxInfoTag::SetPropDelay (Time delay)
+{
+  m_propDelay = delay.GetNanoSeconds ();
+}
+
+Time
+AquaSimRxInfoTag::GetPropDelay (void) const
+{
+  return NanoSeconds (m_propDelay);
+}
+
+}  // namespace ns3
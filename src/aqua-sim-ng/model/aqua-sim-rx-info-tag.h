@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_RX_INFO_TAG_H
+#define AQUA_SIM_RX_INFO_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Per-link reception info attached by AquaSimChannel to each receiver copy.
+ *
+ * Carries the received power, the sender position at transmission time and
+ * the propagation delay, so AquaSimPhyCmn can report them at the end of a
+ * reception ("RxEnd" trace) after the stamp headers have been consumed.
+ * The tag is removed again before the packet is handed to the MAC.
+ */
+class AquaSimRxInfoTag : public Tag
+{
+public:
+  AquaSimRxInfoTag ();
+
+  void SetPr (double pr);
+  double GetPr (void) const;
+  void SetSenderPosition (const Vector &pos);
+  Vector GetSenderPosition (void) const;
+  void SetPropDelay (Time delay);
+  Time GetPropDelay (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  double m_pr;
+  Vector m_senderPos;
+  int64_t m_propDelay;  // in nanoseconds
+};  // class AquaSimRxInfoTag
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_RX_INFO_TAG_H */
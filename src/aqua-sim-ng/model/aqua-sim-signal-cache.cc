@@ -21,6 +21,7 @@
 //#include ...
 #include "aqua-sim-signal-cache.h"
 #include "aqua-sim-header.h"
+#include "aqua-sim-rx-info-tag.h"
 
 #include <queue>
 
@@ -124,7 +125,8 @@ TypeId
 AquaSimSignalCache::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::AquaSimSignalCache")
-    .SetParent<Object> ();
+    .SetParent<Object> ()
+    .AddConstructor<AquaSimSignalCache> ()
   ;
   return tid;
 }
@@ -286,6 +288,129 @@ void AquaSimSignalCache::DoDispose()
   Object::DoDispose();
 }
 
+/****
+ * AquaSimSinrSignalCache class
+ ****/
+
+NS_OBJECT_ENSURE_REGISTERED(AquaSimSinrSignalCache);
+
+AquaSimSinrSignalCache::AquaSimSinrSignalCache()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+AquaSimSinrSignalCache::~AquaSimSinrSignalCache()
+{
+}
+
+TypeId
+AquaSimSinrSignalCache::GetTypeId()
+{
+  static TypeId tid = TypeId ("ns3::AquaSimSinrSignalCache")
+    .SetParent<AquaSimSignalCache> ()
+    .AddConstructor<AquaSimSinrSignalCache> ()
+  ;
+  return tid;
+}
+
+void
+AquaSimSinrSignalCache::AddNewPacket(Ptr<Packet> p)
+{
+  AquaSimHeader asHeader;
+  p->PeekHeader(asHeader);
+
+  // the stamp has been stripped by the PHY, so the received power comes
+  // from the tag AquaSimChannel::SendUp attaches to every copy
+  AquaSimRxInfoTag rxInfo;
+  bool tagged = p->PeekPacketTag(rxInfo);
+  NS_ASSERT_MSG(tagged, "AquaSimSinrSignalCache: packet " << p << " carries no AquaSimRxInfoTag");
+  double pr = rxInfo.GetPr();
+
+  Ptr<IncomingPacket> inPkt = CreateObject<IncomingPacket>(p,
+		  asHeader.GetErrorFlag() ? AquaSimPacketStamp::INVALID : AquaSimPacketStamp::RECEPTION);
+  NS_LOG_FUNCTION(this << p << pr << inPkt->status);
+
+  m_pktSubTimer->AddNewSubmission(inPkt);
+
+  ActiveSignal &sig = m_active[PeekPointer(p)];
+  sig.inPkt = inPkt;
+  sig.pr = pr;
+  sig.decodable = (inPkt->status == AquaSimPacketStamp::RECEPTION) ?
+    m_decodable.insert(std::make_pair(pr, PeekPointer(p))) : m_decodable.end();
+
+  m_pktNum++;
+  m_totalPS += pr;
+  UpdatePacketStatus();
+}
+
+void
+AquaSimSinrSignalCache::UpdatePacketStatus()
+{
+  NS_LOG_FUNCTION(this);
+  double ambient = m_noise->Noise();
+
+  /* same total for everyone, so the weakest signals fail first */
+  while (!m_decodable.empty()) {
+    PowerIndex::iterator weakest = m_decodable.begin();
+    double ps = weakest->first;
+    if (m_phy->Decodable(m_totalPS - ps + ambient, ps))
+      break;
+
+    ActiveSignal &sig = m_active[weakest->second];
+    NS_LOG_DEBUG("UpdatePacketStatus: " << sig.inPkt->packet << " corrupted, pr=" << ps
+                 << " interference=" << m_totalPS - ps);
+    sig.inPkt->status = AquaSimPacketStamp::INVALID;
+    sig.decodable = m_decodable.end();
+    m_decodable.erase(weakest);
+  }
+}
+
+bool
+AquaSimSinrSignalCache::DeleteIncomingPacket(Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION(this << p);
+  std::unordered_map<const Packet*, ActiveSignal>::iterator it = m_active.find(PeekPointer(p));
+  if (it == m_active.end())
+    return false;
+
+  if (it->second.decodable != m_decodable.end())
+    m_decodable.erase(it->second.decodable);
+  m_totalPS -= it->second.pr;
+  m_active.erase(it);
+  m_pktNum--;
+  if (m_active.empty())
+    m_totalPS = 0;  //drop accumulated rounding
+  return true;
+}
+
+void
+AquaSimSinrSignalCache::InvalidateIncomingPacket()
+{
+  NS_LOG_FUNCTION(this);
+  for (std::unordered_map<const Packet*, ActiveSignal>::iterator it = m_active.begin();
+       it != m_active.end(); ++it) {
+    it->second.inPkt->status = AquaSimPacketStamp::INVALID;
+    it->second.decodable = m_decodable.end();
+  }
+  m_decodable.clear();
+}
+
+Ptr<IncomingPacket>
+AquaSimSinrSignalCache::Lookup(Ptr<Packet> p)
+{
+  std::unordered_map<const Packet*, ActiveSignal>::iterator it = m_active.find(PeekPointer(p));
+  return it == m_active.end() ? Ptr<IncomingPacket>() : it->second.inPkt;
+}
+
+void
+AquaSimSinrSignalCache::DoDispose()
+{
+  NS_LOG_FUNCTION(this);
+  m_active.clear();
+  m_decodable.clear();
+  AquaSimSignalCache::DoDispose();
+}
+
 /****
  * AquaSimMultiPathSignalCache class
  ****/
@@ -22,7 +22,9 @@
 #ifndef AQUA_SIM_SIGNAL_CACHE_H
 #define AQUA_SIM_SIGNAL_CACHE_H
 
+#include <map>
 #include <queue>
+#include <unordered_map>
 #include <vector>
 
 #include "ns3/packet.h"
@@ -104,8 +106,8 @@ public:
 
   virtual void AddNewPacket(Ptr<Packet>);
   virtual bool DeleteIncomingPacket(Ptr<Packet>);
-  void InvalidateIncomingPacket(void);
-  Ptr<IncomingPacket> Lookup(Ptr<Packet>);
+  virtual void InvalidateIncomingPacket(void);
+  virtual Ptr<IncomingPacket> Lookup(Ptr<Packet>);
   AquaSimPacketStamp::PacketStatus status;
   AquaSimPacketStamp::PacketStatus Status(Ptr<Packet> p);
   void SubmitPkt(Ptr<IncomingPacket> inPkt);
@@ -141,6 +143,48 @@ private:
 };  //class AquaSimSignalCache
 
 
+/**
+ * \brief Signal cache deciding each reception on its own SINR.
+ *
+ * Interference for a packet is the running sum of the received power
+ * (AquaSimRxInfoTag Pr) of every other reception in progress, plus ambient
+ * noise. Packets that may still be decoded are kept ordered by received
+ * power; since they all see the same total, only the weakest ones can fail
+ * when a new signal arrives, so an arrival costs O(log n) plus O(log n) per
+ * packet it corrupts. A corrupted packet stays corrupted. Removal at the end
+ * of a reception is O(log n), and lookups go through a hash table.
+ *
+ * Assumes the PHY's Decodable() is monotone in SINR, as with
+ * AquaSimThresholdSinrChecker.
+ */
+class AquaSimSinrSignalCache : public AquaSimSignalCache {
+public:
+  AquaSimSinrSignalCache(void);
+  virtual ~AquaSimSinrSignalCache(void);
+  static TypeId GetTypeId(void);
+
+  virtual void AddNewPacket(Ptr<Packet>);
+  virtual bool DeleteIncomingPacket(Ptr<Packet>);
+  virtual void InvalidateIncomingPacket(void);
+  virtual Ptr<IncomingPacket> Lookup(Ptr<Packet>);
+
+protected:
+  virtual void UpdatePacketStatus(void);
+  void DoDispose();
+
+private:
+  typedef std::multimap<double, const Packet*> PowerIndex;
+  struct ActiveSignal {
+    Ptr<IncomingPacket> inPkt;
+    double pr;
+    PowerIndex::iterator decodable;  // m_decodable.end() once corrupted
+  };
+
+  std::unordered_map<const Packet*, ActiveSignal> m_active;
+  PowerIndex m_decodable;
+};  //class AquaSimSinrSignalCache
+
+
 
 /**
  * \brief Multi-path signal cache. Similar to regular signal cache but allows for more
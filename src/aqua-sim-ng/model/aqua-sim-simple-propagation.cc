@@ -58,18 +58,18 @@ AquaSimSimplePropagation::~AquaSimSimplePropagation()
 {
 }
 
-std::vector<PktRecvUnit> *
+void
 AquaSimSimplePropagation::ReceivedCopies (Ptr<AquaSimNetDevice> s,
 					  Ptr<Packet> p,
-					  std::vector<Ptr<AquaSimNetDevice> > dList)
+					  const std::vector<Ptr<AquaSimNetDevice> > &dList,
+					  std::vector<PktRecvUnit> &res)
 {
   NS_LOG_FUNCTION(this);
   NS_ASSERT(dList.size());
 
-  std::vector<PktRecvUnit>* res = new std::vector<PktRecvUnit>;
+  res.clear();
   //find all nodes which will receive a copy
   PktRecvUnit pru;
-  double dist = 0;
 
   AquaSimPacketStamp pstamp;
   p->PeekHeader(pstamp);
@@ -77,27 +77,42 @@ AquaSimSimplePropagation::ReceivedCopies (Ptr<AquaSimNetDevice> s,
   Ptr<Object> sObject = s->GetNode();
   Ptr<MobilityModel> senderModel = sObject->GetObject<MobilityModel> ();
 
-  unsigned i = 0;
-  std::vector<Ptr<AquaSimNetDevice> >::iterator it = dList.begin();
-  for(; it != dList.end(); it++, i++)
+  Vector senderPos = GetPosition(senderModel);
+
+  uint32_t n = dList.size();
+  m_links.resize(n);
+  m_dist.resize(n);
+  for (uint32_t i = 0; i < n; i++)
   {
     Ptr<Object> rObject = dList[i]->GetNode();
     Ptr<MobilityModel> recvModel = rObject->GetObject<MobilityModel> ();
+    m_links[i] = GetLink(senderModel, recvModel);
+    m_dist[i] = m_links[i] ? m_links[i]->dist : CalculateDistance(senderPos, GetPosition(recvModel));
+  }
+  RayleighAttBatch(pstamp.GetFreq(), pstamp.GetPt());
 
-    dist = senderModel->GetDistanceFrom(recvModel);
+  res.reserve(n);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    AquaSimLinkCache::Link *link = m_links[i];
     pru.recver = dList[i];
-    pru.pDelay = Time::FromDouble(dist / ns3::SOUND_SPEED_IN_WATER,Time::S);
-    pru.pR = RayleighAtt(dist, pstamp.GetFreq(), pstamp.GetPt());
-    res->push_back(pru);
-
-    NS_LOG_DEBUG("dist:" << dist
+    if (link && !link->delay.IsNegative())
+      pru.pDelay = link->delay;
+    else {
+      pru.pDelay = Time::FromDouble(m_dist[i] / ns3::SOUND_SPEED_IN_WATER,Time::S);
+      if (link)
+        link->delay = pru.pDelay;
+    }
+    pru.pR = m_pR[i];
+    res.push_back(pru);
+
+    NS_LOG_DEBUG("dist:" << m_dist[i]
 		 << " recver:" << pru.recver
 		 << " pDelay" << pru.pDelay.GetMilliSeconds()
 		 << " pR" << pru.pR
 		 << " freq" << pstamp.GetFreq()
 		 << " Pt" << pstamp.GetPt());
   }
-  return res;
 }
 
 double
@@ -114,6 +129,43 @@ AquaSimSimplePropagation::RayleighAtt (double dist, double freq, double pT)
    return pT/Rayleigh(dist,freq);
 }
 
+void
+AquaSimSimplePropagation::RayleighAttBatch (double freq, double pT)
+{
+  uint32_t n = m_dist.size();
+  m_pR.resize(n);
+  m_miss.clear();
+  m_missAtt.clear();
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (m_links[i] && m_links[i]->attFreq == freq)
+      m_pR[i] = m_links[i]->att;
+    else {
+      m_miss.push_back(i);
+      m_missAtt.push_back(m_dist[i]);
+    }
+  }
+
+  /* in place: element i is read before it is written */
+  if (!UseBatchKernels())
+    for (uint32_t j = 0; j < m_miss.size(); j++)
+      m_missAtt[j] = Rayleigh(m_missAtt[j], freq);
+  else if (!m_miss.empty())
+    RayleighBatch(&m_missAtt[0], freq, &m_missAtt[0], m_miss.size());
+  for (uint32_t j = 0; j < m_miss.size(); j++)
+  {
+    uint32_t i = m_miss[j];
+    m_pR[i] = m_missAtt[j];
+    if (m_links[i]) {
+      m_links[i]->att = m_missAtt[j];
+      m_links[i]->attFreq = freq;
+    }
+  }
+
+  for (uint32_t i = 0; i < n; i++)
+    m_pR[i] = m_dist[i] <= 0 ? 0 : pT / m_pR[i];
+}
+
 //2.0 version below:
 double
 AquaSimSimplePropagation::RayleighAtt2(double dist, double freq, double Pt)
@@ -41,18 +41,33 @@ public:
   AquaSimSimplePropagation (void);
   ~AquaSimSimplePropagation (void);
 
-  virtual std::vector<PktRecvUnit> * ReceivedCopies (Ptr<AquaSimNetDevice> s,
-						     Ptr<Packet> p,
-						     std::vector<Ptr<AquaSimNetDevice> > dList);
+  virtual void ReceivedCopies (Ptr<AquaSimNetDevice> s,
+                               Ptr<Packet> p,
+                               const std::vector<Ptr<AquaSimNetDevice> > &dList,
+                               std::vector<PktRecvUnit> &res);
 
   virtual void SetTraceValues(double t, double s, double n);
   virtual void SetTraceValues(double min, double max, double t, double s, double n);
 
 protected:
   double RayleighAtt (double dist, double freq, double pT);
+  /**
+   * Fill m_pR with the received power of every entry of m_dist/m_links.
+   * Attenuation still cached on a link is reused; the rest is evaluated
+   * with Rayleigh, or with one RayleighBatch call if BatchKernels is set.
+   */
+  void RayleighAttBatch (double freq, double pT);
   //2.0 version below:
   double RayleighAtt2 (double dist, double freq, double pT);
 
+  /* per-transmission scratch, one entry per receiver */
+  std::vector<uint32_t> m_recv;
+  std::vector<AquaSimLinkCache::Link *> m_links;
+  std::vector<double> m_dist;
+  std::vector<double> m_pR;
+  std::vector<uint32_t> m_miss;
+  std::vector<double> m_missAtt;
+
 };  //class AquaSimSimplePropagation
 
 }  // namespace ns3
@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+
+#include "aqua-sim-spatial-index.h"
+#include "aqua-sim-net-device.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimSpatialIndex");
+NS_OBJECT_ENSURE_REGISTERED (AquaSimSpatialIndex);
+
+TypeId
+AquaSimSpatialIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AquaSimSpatialIndex")
+    .SetParent<Object> ()
+    .AddConstructor<AquaSimSpatialIndex> ()
+    .AddAttribute ("CellSize", "Edge of a grid cell (m). 0 uses the TxRange of the first query.",
+      DoubleValue (0),
+      MakeDoubleAccessor (&AquaSimSpatialIndex::m_cellSize),
+      MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+AquaSimSpatialIndex::AquaSimSpatialIndex () :
+  m_cellSize (0),
+  m_valid (false),
+  m_buildTime (Seconds (0)),
+  m_maxSpeed (0),
+  m_rebuilds (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AquaSimSpatialIndex::~AquaSimSpatialIndex ()
+{
+}
+
+void
+AquaSimSpatialIndex::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_valid = false;
+}
+
+uint32_t
+AquaSimSpatialIndex::GetRebuildCount (void) const
+{
+  return m_rebuilds;
+}
+
+int64_t
+AquaSimSpatialIndex::Coord (double v) const
+{
+  return (int64_t) std::floor (v / m_cellSize);
+}
+
+uint64_t
+AquaSimSpatialIndex::Key (int64_t x, int64_t y, int64_t z)
+{
+  /* 21 bits per axis; aliasing of far-away cells only adds false candidates */
+  const uint64_t mask = 0x1FFFFF;
+  return (((uint64_t) x & mask) << 42) | (((uint64_t) y & mask) << 21) | ((uint64_t) z & mask);
+}
+
+double
+AquaSimSpatialIndex::Slack (void) const
+{
+  return m_maxSpeed * (Simulator::Now () - m_buildTime).GetSeconds ();
+}
+
+void
+AquaSimSpatialIndex::Insert (uint32_t idx, const Vector &pos)
+{
+  uint64_t cell = Key (Coord (pos.x), Coord (pos.y), Coord (pos.z));
+  m_entries[idx].cell = cell;
+  m_cells[cell].push_back (idx);
+}
+
+void
+AquaSimSpatialIndex::Remove (uint32_t idx)
+{
+  std::vector<uint32_t> &bucket = m_cells[m_entries[idx].cell];
+  std::vector<uint32_t>::iterator it = std::find (bucket.begin (), bucket.end (), idx);
+  NS_ASSERT (it != bucket.end ());
+  *it = bucket.back ();
+  bucket.pop_back ();
+}
+
+void
+AquaSimSpatialIndex::Detach (void)
+{
+  for (std::vector<IndexEntry>::iterator it = m_entries.begin (); it != m_entries.end (); ++it)
+    {
+      it->model->TraceDisconnectWithoutContext ("CourseChange",
+          MakeCallback (&AquaSimSpatialIndex::CourseChanged, this));
+    }
+}
+
+void
+AquaSimSpatialIndex::Rebuild (const std::vector<Ptr<AquaSimNetDevice> > &dList)
+{
+  NS_LOG_FUNCTION (this << dList.size ());
+  Detach ();
+  m_entries.clear ();
+  m_modelIndex.clear ();
+
+  m_entries.resize (dList.size ());
+  for (uint32_t i = 0; i < dList.size (); i++)
+    {
+      Ptr<MobilityModel> model = dList[i]->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (model, "AquaSimSpatialIndex requires a MobilityModel on every node");
+      m_entries[i].model = model;
+      m_entries[i].dirty = false;
+      if (m_modelIndex.find (PeekPointer (model)) == m_modelIndex.end ())
+        {
+          model->TraceConnectWithoutContext ("CourseChange",
+              MakeCallback (&AquaSimSpatialIndex::CourseChanged, this));
+        }
+      m_modelIndex.insert (std::make_pair (PeekPointer (model), i));
+    }
+  m_valid = true;
+  Rebucket ();
+}
+
+void
+AquaSimSpatialIndex::Rebucket (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cells.clear ();
+  m_dirty.clear ();
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_entries.size (); i++)
+    {
+      Insert (i, m_entries[i].model->GetPosition ());
+      m_entries[i].dirty = false;
+      m_maxSpeed = std::max (m_maxSpeed, m_entries[i].model->GetVelocity ().GetLength ());
+    }
+  m_buildTime = Simulator::Now ();
+  m_rebuilds++;
+}
+
+void
+AquaSimSpatialIndex::CourseChanged (Ptr<const MobilityModel> model)
+{
+  if (!m_valid)
+    return;
+
+  /* several devices may share one node, hence one mobility model */
+  auto range = m_modelIndex.equal_range (PeekPointer (model));
+  for (auto it = range.first; it != range.second; ++it)
+    {
+      if (!m_entries[it->second].dirty)
+        {
+          m_entries[it->second].dirty = true;
+          m_dirty.push_back (it->second);
+        }
+    }
+  m_maxSpeed = std::max (m_maxSpeed, model->GetVelocity ().GetLength ());
+}
+
+void
+AquaSimSpatialIndex::GetCandidates (const Vector &pos, double range,
+                                    const std::vector<Ptr<AquaSimNetDevice> > &dList,
+                                    std::vector<Ptr<AquaSimNetDevice> > &out)
+{
+  NS_LOG_FUNCTION (this << pos << range);
+  out.clear ();
+
+  if (m_cellSize <= 0)
+    m_cellSize = range;
+
+  if (!m_valid || m_entries.size () != dList.size ())
+    Rebuild (dList);
+  else if (Slack () > m_cellSize / 2)
+    Rebucket ();
+  else
+    {
+      for (std::vector<uint32_t>::iterator it = m_dirty.begin (); it != m_dirty.end (); ++it)
+        {
+          Remove (*it);
+          Insert (*it, m_entries[*it].model->GetPosition ());
+          m_entries[*it].dirty = false;
+        }
+      m_dirty.clear ();
+    }
+
+  /* pad by drift and a relative epsilon so rounding never drops a receiver */
+  double reach = (range + Slack ()) * (1 + 1e-9) + 1e-6;
+  int64_t x0 = Coord (pos.x - reach), x1 = Coord (pos.x + reach);
+  int64_t y0 = Coord (pos.y - reach), y1 = Coord (pos.y + reach);
+  int64_t z0 = Coord (pos.z - reach), z1 = Coord (pos.z + reach);
+
+  double boxCells = double (x1 - x0 + 1) * double (y1 - y0 + 1) * double (z1 - z0 + 1);
+  if (boxCells >= m_cells.size ())
+    {
+      /* the query box covers the whole deployment, walking cells is no gain */
+      out.assign (dList.begin (), dList.end ());
+      return;
+    }
+
+  m_scratch.clear ();
+  for (int64_t x = x0; x <= x1; x++)
+    for (int64_t y = y0; y <= y1; y++)
+      for (int64_t z = z0; z <= z1; z++)
+        {
+          std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator cell =
+            m_cells.find (Key (x, y, z));
+          if (cell != m_cells.end ())
+            m_scratch.insert (m_scratch.end (), cell->second.begin (), cell->second.end ());
+        }
+
+  /* device-list order keeps event scheduling identical to a full scan */
+  std::sort (m_scratch.begin (), m_scratch.end ());
+  out.reserve (m_scratch.size ());
+  for (std::vector<uint32_t>::iterator it = m_scratch.begin (); it != m_scratch.end (); ++it)
+    out.push_back (dList[*it]);
+}
+
+void
+AquaSimSpatialIndex::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Detach ();
+  m_entries.clear ();
+  m_modelIndex.clear ();
+  m_cells.clear ();
+  m_dirty.clear ();
+  m_valid = false;
+  Object::DoDispose ();
+}
+
+}  // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_SPATIAL_INDEX_H
+#define AQUA_SIM_SPATIAL_INDEX_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+class AquaSimNetDevice;
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Uniform 3-D grid over the devices attached to a channel.
+ *
+ * Used by AquaSimChannel to restrict fan-out to the receivers that may lie
+ * within a sender's TxRange. Cells are cubes of CellSize meters (by default
+ * the TxRange of the first indexed transmission). The grid is refreshed
+ * lazily: nodes reporting a course change are re-bucketed at the next query,
+ * and every query is padded by the distance any node may have drifted since
+ * the last full rebuild (max observed speed * elapsed time). A full rebuild
+ * happens once that padding exceeds half a cell.
+ *
+ * Candidates are returned in device-list order so the propagation model sees
+ * exactly the receivers, in exactly the order, of a brute-force scan. This
+ * relies on the mobility models reporting a course change whenever their
+ * velocity changes, as all piecewise-linear ns-3 models do; models with
+ * continuous acceleration should not be used with the index.
+ */
+class AquaSimSpatialIndex : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  AquaSimSpatialIndex ();
+  virtual ~AquaSimSpatialIndex ();
+
+  /// Force a full rebuild (device added/removed) on the next query.
+  void Invalidate (void);
+
+  /**
+   * Collect all devices of \p dList that may be within \p range of \p pos.
+   * \p out is cleared first and filled in \p dList order. The caller must
+   * still apply the exact distance check.
+   */
+  void GetCandidates (const Vector &pos, double range,
+                      const std::vector<Ptr<AquaSimNetDevice> > &dList,
+                      std::vector<Ptr<AquaSimNetDevice> > &out);
+
+  uint32_t GetRebuildCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct IndexEntry {
+    Ptr<MobilityModel> model;
+    uint64_t cell;
+    bool dirty;
+  };
+
+  void Rebuild (const std::vector<Ptr<AquaSimNetDevice> > &dList);
+  void Rebucket (void);
+  void Detach (void);
+  void CourseChanged (Ptr<const MobilityModel> model);
+  void Insert (uint32_t idx, const Vector &pos);
+  void Remove (uint32_t idx);
+  int64_t Coord (double v) const;
+  static uint64_t Key (int64_t x, int64_t y, int64_t z);
+  double Slack (void) const;
+
+  double m_cellSize;
+  bool m_valid;
+  Time m_buildTime;
+  double m_maxSpeed;
+  uint32_t m_rebuilds;
+
+  std::vector<IndexEntry> m_entries;
+  std::vector<uint32_t> m_dirty;
+  std::unordered_multimap<const MobilityModel*, uint32_t> m_modelIndex;
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells;
+  std::vector<uint32_t> m_scratch;
+};  // class AquaSimSpatialIndex
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_SPATIAL_INDEX_H */
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aqua-sim-trumac-schedule.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AquaSimTrumacSchedule");
+
+namespace {
+
+typedef std::unordered_map<uint64_t, std::weak_ptr<const AquaSimTrumacSchedule> > ScheduleMap;
+
+ScheduleMap &
+Shared (void)
+{
+  static ScheduleMap shared;
+  return shared;
+}
+
+uint64_t
+Fingerprint (const std::vector<Vector> &positions, uint64_t budget)
+{
+  /* FNV-1a over the raw coordinates */
+  uint64_t h = 14695981039346656037ULL ^ budget;
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      double c[3] = {positions[i].x, positions[i].y, positions[i].z};
+      unsigned char bytes[sizeof (c)];
+      std::memcpy (bytes, c, sizeof (c));
+      for (uint32_t b = 0; b < sizeof (bytes); b++)
+        h = (h ^ bytes[b]) * 1099511628211ULL;
+    }
+  return h;
+}
+
+bool
+SamePositions (const std::vector<Vector> &a, const std::vector<Vector> &b)
+{
+  if (a.size () != b.size ())
+    return false;
+  for (uint32_t i = 0; i < a.size (); i++)
+    {
+      if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z)
+        return false;
+    }
+  return true;
+}
+
+}  // namespace
+
+AquaSimTrumacSchedule::AquaSimTrumacSchedule (const std::vector<Vector> &positions,
+                                              uint64_t twoOptBudget)
+  : m_positions (positions),
+    m_budget (twoOptBudget),
+    m_dist (DistanceMatrix (positions)),
+    m_moves (0)
+{
+  uint32_t n = positions.size ();
+  m_tour = NearestNeighborTour (m_dist, n, 0);
+  if (twoOptBudget > 0)
+    m_moves = TwoOpt (m_dist, m_tour, twoOptBudget);
+
+  m_next.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    m_next[m_tour[i]] = m_tour[(i + 1) % n];
+  NS_LOG_DEBUG ("schedule over " << n << " nodes, length " << GetLength ()
+                << " after " << m_moves << " 2-opt moves");
+}
+
+std::shared_ptr<const AquaSimTrumacSchedule>
+AquaSimTrumacSchedule::Get (const std::vector<Vector> &positions, uint64_t twoOptBudget)
+{
+  ScheduleMap &shared = Shared ();
+  uint64_t key = Fingerprint (positions, twoOptBudget);
+  ScheduleMap::iterator it = shared.find (key);
+  if (it != shared.end ())
+    {
+      std::shared_ptr<const AquaSimTrumacSchedule> s = it->second.lock ();
+      if (s && s->m_budget == twoOptBudget && SamePositions (s->m_positions, positions))
+        return s;
+    }
+
+  /* drop schedules nobody holds any more before adding this one */
+  for (it = shared.begin (); it != shared.end ();)
+    {
+      if (it->second.expired ())
+        it = shared.erase (it);
+      else
+        it++;
+    }
+  std::shared_ptr<const AquaSimTrumacSchedule> s =
+    std::make_shared<const AquaSimTrumacSchedule> (positions, twoOptBudget);
+  shared[key] = s;
+  return s;
+}
+
+uint32_t
+AquaSimTrumacSchedule::GetNShared (void)
+{
+  uint32_t n = 0;
+  ScheduleMap &shared = Shared ();
+  for (ScheduleMap::iterator it = shared.begin (); it != shared.end (); it++)
+    {
+      if (!it->second.expired ())
+        n++;
+    }
+  return n;
+}
+
+std::vector<double>
+AquaSimTrumacSchedule::DistanceMatrix (const std::vector<Vector> &positions)
+{
+  uint32_t n = positions.size ();
+  std::vector<double> dist (n * n, 0);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (uint32_t j = i + 1; j < n; j++)
+        {
+          double d = CalculateDistance (positions[i], positions[j]);
+          dist[i * n + j] = d;
+          dist[j * n + i] = d;
+        }
+    }
+  return dist;
+}
+
+std::vector<uint32_t>
+AquaSimTrumacSchedule::NearestNeighborTour (const std::vector<double> &dist,
+                                            uint32_t n, uint32_t start)
+{
+  NS_ASSERT (dist.size () == (size_t) n * n);
+  std::vector<uint32_t> tour;
+  if (n == 0)
+    return tour;
+  tour.reserve (n);
+
+  /* nodes not yet visited are kept packed at the front of left */
+  std::vector<uint32_t> left (n);
+  for (uint32_t i = 0; i < n; i++)
+    left[i] = i;
+  std::swap (left[start], left[n - 1]);
+  uint32_t nLeft = n - 1;
+  uint32_t cur = start;
+  tour.push_back (cur);
+
+  while (nLeft > 0)
+    {
+      const double *row = &dist[(size_t) cur * n];
+      uint32_t best = 0;
+      for (uint32_t k = 1; k < nLeft; k++)
+        {
+          /* lowest node ID on ties, as the map scan did */
+          double dk = row[left[k]], db = row[left[best]];
+          if (dk < db || (dk == db && left[k] < left[best]))
+            best = k;
+        }
+      cur = left[best];
+      left[best] = left[--nLeft];
+      tour.push_back (cur);
+    }
+  return tour;
+}
+
+uint64_t
+AquaSimTrumacSchedule::TwoOpt (const std::vector<double> &dist, std::vector<uint32_t> &tour,
+                               uint64_t budget)
+{
+  uint32_t n = tour.size ();
+  uint64_t moves = 0;
+  if (n < 4)
+    return 0;
+
+  bool improved = true;
+  while (improved)
+    {
+      improved = false;
+      for (uint32_t i = 0; i + 2 < n; i++)
+        {
+          /* replace edges (a,b) and (c,d) by (a,c) and (b,d) */
+          uint32_t a = tour[i], b = tour[i + 1];
+          const double *rowA = &dist[(size_t) a * n];
+          /* with i at 0 the last edge shares node a */
+          uint32_t jEnd = i == 0 ? n - 1 : n;
+          for (uint32_t j = i + 2; j < jEnd; j++)
+            {
+              if (++moves > budget)
+                return budget;
+              uint32_t c = tour[j], d = tour[(j + 1) % n];
+              double delta = rowA[c] + dist[(size_t) b * n + d]
+                - rowA[b] - dist[(size_t) c * n + d];
+              if (delta < -1e-9)
+                {
+                  std::reverse (tour.begin () + i + 1, tour.begin () + j + 1);
+                  b = tour[i + 1];
+                  improved = true;
+                }
+            }
+        }
+    }
+  return moves;
+}
+
+double
+AquaSimTrumacSchedule::TourLength (const std::vector<double> &dist,
+                                   const std::vector<uint32_t> &tour)
+{
+  uint32_t n = tour.size ();
+  double len = 0;
+  for (uint32_t i = 0; i < n; i++)
+    len += dist[(size_t) tour[i] * n + tour[(i + 1) % n]];
+  return len;
+}
+
+}  // namespace ns3
@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AQUA_SIM_TRUMAC_SCHEDULE_H
+#define AQUA_SIM_TRUMAC_SCHEDULE_H
+
+#include <memory>
+#include <vector>
+
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aqua-sim-ng
+ *
+ * \brief Token-ring schedule (TR-MAC cycle) over a set of node positions.
+ *
+ * Distances are held as a dense n x n matrix. The tour is built with one
+ * O(n^2) nearest-neighbor pass from node 0 and then refined by 2-opt until
+ * no improving move is left or the budget of evaluated moves runs out. The
+ * budget is counted in moves rather than wall time so that a run is
+ * reproducible.
+ *
+ * Nodes holding the same topology view share one schedule through Get():
+ * schedules are looked up by position list and budget, and are released
+ * when the last holder drops them.
+ */
+class AquaSimTrumacSchedule
+{
+public:
+  AquaSimTrumacSchedule (const std::vector<Vector> &positions, uint64_t twoOptBudget);
+
+  static std::shared_ptr<const AquaSimTrumacSchedule>
+  Get (const std::vector<Vector> &positions, uint64_t twoOptBudget);
+  /// number of live schedules shared through Get
+  static uint32_t GetNShared (void);
+
+  const std::vector<uint32_t> &GetTour (void) const { return m_tour; }
+  /// successor of node in the cycle
+  uint32_t GetNext (uint32_t node) const { return m_next[node]; }
+  /// length of the closed tour
+  double GetLength (void) const { return TourLength (m_dist, m_tour); }
+  uint64_t GetTwoOptMoves (void) const { return m_moves; }
+
+  static std::vector<double> DistanceMatrix (const std::vector<Vector> &positions);
+  static std::vector<uint32_t> NearestNeighborTour (const std::vector<double> &dist,
+                                                    uint32_t n, uint32_t start);
+  /// Improve tour in place; returns the number of moves evaluated.
+  static uint64_t TwoOpt (const std::vector<double> &dist, std::vector<uint32_t> &tour,
+                          uint64_t budget);
+  static double TourLength (const std::vector<double> &dist, const std::vector<uint32_t> &tour);
+
+private:
+  std::vector<Vector> m_positions;
+  uint64_t m_budget;
+  std::vector<double> m_dist;   // row-major n x n
+  std::vector<uint32_t> m_tour;
+  std::vector<uint32_t> m_next;
+  uint64_t m_moves;
+};  // class AquaSimTrumacSchedule
+
+}  // namespace ns3
+
+#endif /* AQUA_SIM_TRUMAC_SCHEDULE_H */
@@ -23,6 +23,7 @@
 #define CONTENT_STORAGE_H
 
 #include "ns3/object.h"
+#include "name-table.h"
 
 namespace ns3 {
 enum CacheType {NO_CACHE, LRU, FIFO, RANDOM};
@@ -36,10 +37,10 @@ public:
   void SetCacheType(CacheType type);
   void SetCacheSize(size_t size);
 
-  virtual void AddEntry(uint8_t* key, uint8_t* data)=0;
+  virtual void AddEntry(NameId key, uint8_t* data)=0;
   virtual bool RemoveEntry()=0;
   virtual bool CacheFull()=0;
-  virtual uint8_t* GetEntry(uint8_t* key)=0;
+  virtual uint8_t* GetEntry(NameId key)=0;
 protected:
   CacheType m_cacheType;
   size_t m_cacheSize; //default(0) is unlimited
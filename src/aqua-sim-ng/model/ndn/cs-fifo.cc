@@ -42,7 +42,7 @@ CSFifo::CSFifo()
 }
 
 void
-CSFifo::AddEntry(uint8_t* key, uint8_t* data)
+CSFifo::AddEntry(NameId key, uint8_t* data)
 {
   NS_LOG_FUNCTION(this);
 
@@ -77,7 +77,7 @@ CSFifo::CacheFull()
 }
 
 uint8_t*
-CSFifo::GetEntry(uint8_t* key)
+CSFifo::GetEntry(NameId key)
 {
   NS_LOG_FUNCTION(this);
 
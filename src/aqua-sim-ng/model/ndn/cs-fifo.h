@@ -31,15 +31,15 @@ namespace ns3 {
 
 class CSFifo : public ContentStorage{
 public:
-  typedef std::deque<std::pair<uint8_t*,uint8_t*> > fifoCache;
+  typedef std::deque<std::pair<NameId,uint8_t*> > fifoCache;
 
   static TypeId GetTypeId (void);
   CSFifo();
 
-  virtual void AddEntry(uint8_t* key, uint8_t* data);
+  virtual void AddEntry(NameId key, uint8_t* data);
   virtual bool RemoveEntry();
   virtual bool CacheFull();
-  virtual uint8_t* GetEntry(uint8_t* key);
+  virtual uint8_t* GetEntry(NameId key);
 private:
    fifoCache m_cache;
 
@@ -36,22 +36,41 @@ CSLru::GetTypeId (void)
   return tid;
 }
 
-CSLru::CSLru()
+CSLru::CSLru() : m_head(-1), m_tail(-1), m_free(-1), m_n(0)
 {
 }
 
 void
-CSLru::AddEntry(uint8_t* key, uint8_t* data)
+CSLru::AddEntry(NameId key, uint8_t* data)
 {
   NS_LOG_FUNCTION(this);
 
-  auto it = item_map.find(key);
-  if(it != item_map.end()) {
-    item_list.erase(it->second);
-    item_map.erase(it);
+  int32_t slot = FindSlot(key);
+  if (slot >= 0) {
+    m_slots[slot].data = data;
+    Unlink(slot);
+    PushFront(slot);
+    return;
   }
-  item_list.push_front(std::make_pair(key,data));
-  item_map.insert(std::make_pair(key, item_list.begin()));
+
+  if (m_free >= 0) {
+    slot = m_free;
+    m_free = m_slots[slot].next;
+  }
+  else {
+    if (m_slots.empty() && m_cacheSize > 0)
+      m_slots.reserve(m_cacheSize + 1);
+    slot = m_slots.size();
+    m_slots.push_back(Slot());
+  }
+  m_slots[slot].key = key;
+  m_slots[slot].data = data;
+  PushFront(slot);
+  m_n++;
+  if ((m_n + 1) * 2 > m_index.size())
+    Grow();
+  else
+    IndexInsert(slot);
   Clean();
 }
 
@@ -65,35 +84,121 @@ CSLru::RemoveEntry()
 bool
 CSLru::CacheFull()
 {
-  return ((m_cacheSize==0) ? false : (item_map.size() > m_cacheSize) );
+  return ((m_cacheSize==0) ? false : (m_n > m_cacheSize) );
 }
 
 uint8_t*
-CSLru::GetEntry(uint8_t* key)
+CSLru::GetEntry(NameId key)
 {
   NS_LOG_FUNCTION(this);
 
-  if (!EntryExist(key)) {
+  int32_t slot = FindSlot(key);
+  if (slot < 0) {
     NS_LOG_DEBUG(this << "Could not find entry for key:" << key);
     return NULL;
   }
-  auto it = item_map.find(key);
-  item_list.splice(item_list.begin(), item_list, it->second);
-  return it->second->second;
+  Unlink(slot);
+  PushFront(slot);
+  return m_slots[slot].data;
 }
 
 bool
-CSLru::EntryExist(uint8_t* key)
+CSLru::EntryExist(NameId key)
 {
-  return (item_map.count(key)>0);
+  return (FindSlot(key) >= 0);
+}
+
+size_t
+CSLru::GetN() const
+{
+  return m_n;
 }
 
 void
 CSLru::Clean()
 {
   while(CacheFull()) {
-    auto last_it = item_list.end(); last_it--;
-    item_map.erase(last_it->first);
-    item_list.pop_back();
+    int32_t last = m_tail;
+    Unlink(last);
+    IndexErase(m_slots[last].key);
+    m_slots[last].data = NULL;
+    m_slots[last].next = m_free;
+    m_free = last;
+    m_n--;
+  }
+}
+
+uint32_t
+CSLru::Home(NameId key) const
+{
+  return (key * 2654435761u) & (m_index.size() - 1);
+}
+
+int32_t
+CSLru::FindSlot(NameId key) const
+{
+  if (m_index.empty()) return -1;
+  for (uint32_t i = Home(key); ; i = (i + 1) & (m_index.size() - 1)) {
+    int32_t slot = m_index[i];
+    if (slot < 0) return -1;
+    if (m_slots[slot].key == key) return slot;
   }
 }
+
+void
+CSLru::IndexInsert(int32_t slot)
+{
+  uint32_t i = Home(m_slots[slot].key);
+  while (m_index[i] >= 0)
+    i = (i + 1) & (m_index.size() - 1);
+  m_index[i] = slot;
+}
+
+void
+CSLru::IndexErase(NameId key)
+{
+  uint32_t mask = m_index.size() - 1;
+  uint32_t i = Home(key);
+  while (m_slots[m_index[i]].key != key)
+    i = (i + 1) & mask;
+
+  //backward-shift the rest of the cluster so probes never see a hole
+  for (uint32_t j = (i + 1) & mask; m_index[j] >= 0; j = (j + 1) & mask) {
+    uint32_t home = Home(m_slots[m_index[j]].key);
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      m_index[i] = m_index[j];
+      i = j;
+    }
+  }
+  m_index[i] = -1;
+}
+
+void
+CSLru::Grow()
+{
+  size_t size = m_index.empty() ? 16 : m_index.size() * 2;
+  while (size < (m_n + 1) * 2) size *= 2;
+  m_index.assign(size, -1);
+  for (int32_t slot = m_head; slot >= 0; slot = m_slots[slot].next)
+    IndexInsert(slot);
+}
+
+void
+CSLru::Unlink(int32_t slot)
+{
+  Slot &s = m_slots[slot];
+  if (s.prev >= 0) m_slots[s.prev].next = s.next;
+  else m_head = s.next;
+  if (s.next >= 0) m_slots[s.next].prev = s.prev;
+  else m_tail = s.prev;
+}
+
+void
+CSLru::PushFront(int32_t slot)
+{
+  m_slots[slot].prev = -1;
+  m_slots[slot].next = m_head;
+  if (m_head >= 0) m_slots[m_head].prev = slot;
+  else m_tail = slot;
+  m_head = slot;
+}
@@ -24,26 +24,52 @@
 
 #include "ns3/object.h"
 #include "content-storage.h"
-#include <list>
-#include <unordered_map>
-#include <utility>
+#include <vector>
 
 namespace ns3 {
 
+/*
+ * LRU content store over a fixed pool of slots. Recency is an intrusive
+ * doubly linked list threaded through the slots and lookups go through an
+ * open-addressing index, so once the pool has reached the cache size adding,
+ * hitting and evicting entries allocates nothing.
+ */
 class CSLru : public ContentStorage{
 public:
   static TypeId GetTypeId (void);
   CSLru();
 
-  virtual void AddEntry(uint8_t* key, uint8_t* data);
+  virtual void AddEntry(NameId key, uint8_t* data);
   virtual bool RemoveEntry();
   virtual bool CacheFull();
-  virtual uint8_t* GetEntry(uint8_t* key);
-  bool EntryExist(uint8_t* key);
+  virtual uint8_t* GetEntry(NameId key);
+  bool EntryExist(NameId key);
+  size_t GetN() const;
+
 private:
+  struct Slot {
+    NameId key;
+    uint8_t* data;
+    int32_t prev;
+    int32_t next;
+  };
+
   void Clean();
-  std::list< std::pair<uint8_t*,uint8_t*> > item_list;
-  std::unordered_map<uint8_t*, decltype(item_list.begin()) > item_map;
+  int32_t FindSlot(NameId key) const;
+  uint32_t Home(NameId key) const;
+  void IndexInsert(int32_t slot);
+  void IndexErase(NameId key);
+  void Grow();
+  void Unlink(int32_t slot);
+  void PushFront(int32_t slot);
+
+  std::vector<Slot> m_slots;
+  std::vector<int32_t> m_index;   //slot numbers, -1 when empty; power of two
+  int32_t m_head;                 //most recently used
+  int32_t m_tail;
+  int32_t m_free;                 //free slots, chained through next
+  size_t m_n;
+
 }; // class CSLru
 
 } // namespace ns3
@@ -44,7 +44,7 @@ CSRandom::CSRandom()
 }
 
 void
-CSRandom::AddEntry(uint8_t* key, uint8_t* data)
+CSRandom::AddEntry(NameId key, uint8_t* data)
 {
   NS_LOG_FUNCTION(this);
 
@@ -90,7 +90,7 @@ CSRandom::CacheFull()
 }
 
 uint8_t*
-CSRandom::GetEntry(uint8_t* key)
+CSRandom::GetEntry(NameId key)
 {
   NS_LOG_FUNCTION(this);
 
@@ -31,15 +31,15 @@ namespace ns3 {
 class CSRandom : public ContentStorage{
 public:
   //used instead of set since we are assuming key != data cached
-  typedef std::unordered_map<uint8_t*,uint8_t*> randomCache;
+  typedef std::unordered_map<NameId,uint8_t*> randomCache;
 
   static TypeId GetTypeId (void);
   CSRandom();
 
-  virtual void AddEntry(uint8_t* key, uint8_t* data);
+  virtual void AddEntry(NameId key, uint8_t* data);
   virtual bool RemoveEntry();
   virtual bool CacheFull();
-  virtual uint8_t* GetEntry(uint8_t* key);
+  virtual uint8_t* GetEntry(NameId key);
 private:
    randomCache m_cache;
 
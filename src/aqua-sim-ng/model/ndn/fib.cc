@@ -43,27 +43,38 @@ Fib::Fib() : m_strategy(MULTICAST)
   ClearTable();
 }
 
-std::list<AquaSimAddress>
-Fib::InterestRecv(uint8_t* name)
+Fib::FibI
+Fib::LongestPrefixMatch(NameId name)
 {
-  NS_LOG_DEBUG(this << name);
+  for (NameId n = name; n != NameTable::NONE; n = NameTable::GetParent(n))
+  {
+    FibI entry = FibTable.find(n);
+    if (entry != FibTable.end())
+      return entry;
+  }
+  return FibTable.end();
+}
+
+std::vector<AquaSimAddress>
+Fib::InterestRecv(NameId name)
+{
+  NS_LOG_DEBUG(this << NameTable::GetName(name));
 
-  std::list<AquaSimAddress> addressList;
+  std::vector<AquaSimAddress> addressList;
 
-  FibI iteratorEntry;
-  iteratorEntry = FibTable.find(name);
+  FibI iteratorEntry = LongestPrefixMatch(name);
   if (iteratorEntry == FibTable.end())
   {
-    NS_LOG_DEBUG(this << "No entry found in FibTable for name:" << name);
+    NS_LOG_DEBUG(this << "No entry found in FibTable for name:" << NameTable::GetName(name));
     return addressList;
   }
 
-  std::list<FibEntry> entry = iteratorEntry->second;
+  const std::vector<FibEntry> &entry = iteratorEntry->second;
   switch(m_strategy) {
     case BEST_ROUTE:
       {
         FibEntry bestEntry = entry.front();
-        for (std::list<FibEntry>::iterator it = entry.begin(); it != entry.end(); it++)
+        for (std::vector<FibEntry>::const_iterator it = entry.begin(); it != entry.end(); it++)
         {
           bestEntry = ((*it).second > bestEntry.second) ? *it : bestEntry;
         }
@@ -72,7 +83,8 @@ Fib::InterestRecv(uint8_t* name)
       }
     case MULTICAST:
       {
-        for (std::list<FibEntry>::iterator it = entry.begin(); it != entry.end(); it++)
+        addressList.reserve(entry.size());
+        for (std::vector<FibEntry>::const_iterator it = entry.begin(); it != entry.end(); it++)
         {
           addressList.push_back((*it).first);
         }
@@ -85,51 +97,46 @@ Fib::InterestRecv(uint8_t* name)
 }
 
 void
-Fib::AddEntry (uint8_t* name, AquaSimAddress address, int routeCost)
+Fib::AddEntry (NameId name, AquaSimAddress address, int routeCost)
 {
-  NS_LOG_DEBUG(this << name << address.GetAsInt() << routeCost);
+  NS_LOG_DEBUG(this << NameTable::GetName(name) << address.GetAsInt() << routeCost);
 
-  FibI entry;
-  entry = FibTable.find(name);
-  if (entry != FibTable.end())    //entry already exists
-    entry->second.push_back(std::make_pair(address,routeCost));
-  else {
-    std::list<FibEntry> newEntry;
-    newEntry.push_back(std::make_pair(address,routeCost));
-    FibTable.insert(std::make_pair(name,newEntry));
+  std::vector<FibEntry> &entry = FibTable[name];
+  for (std::vector<FibEntry>::iterator it = entry.begin(); it != entry.end(); it++)
+  {
+    if ((*it).first == address)   //address already known, refresh its cost
+    {
+      (*it).second = routeCost;
+      return;
+    }
   }
+  entry.push_back(std::make_pair(address,routeCost));
 }
 
 bool
-Fib::RemoveEntry(uint8_t* name, AquaSimAddress address)
+Fib::RemoveEntry(NameId name, AquaSimAddress address)
 {
-  NS_LOG_DEBUG(this << name << address.GetAsInt());
+  NS_LOG_DEBUG(this << NameTable::GetName(name) << address.GetAsInt());
 
   FibI entry;
   entry = FibTable.find(name);
   if (entry == FibTable.end())
   {
-    NS_LOG_WARN("Can not remove " << name << " since it does not exist in FibTable");
+    NS_LOG_WARN("Can not remove " << NameTable::GetName(name) << " since it does not exist in FibTable");
     return false;
   }
 
-  if (entry->second.size() > 1) //more than one address for this name
+  for (std::vector<FibEntry>::iterator it = entry->second.begin(); it != entry->second.end(); it++)
   {
-    for (std::list<FibEntry>::iterator it = entry->second.begin(); it != entry->second.end(); it++)
+    if ((*it).first == address)
     {
-      if ((*it).first == address)
-      {
-        entry->second.erase(it);
-        return true;
-      }
+      entry->second.erase(it);
+      if (entry->second.empty())
+        FibTable.erase(entry);
+      return true;
     }
-    return false; //no matching address found within name entry
-  }
-  else
-  {
-    FibTable.erase(entry);
-    return true;
   }
+  return false; //no matching address found within name entry
 }
 
 void
@@ -139,6 +146,12 @@ Fib::SetForwardStrategy(ForwardStrategy strategy)
   m_strategy = strategy;
 }
 
+size_t
+Fib::GetFibSize()
+{
+  return FibTable.size();
+}
+
 void
 Fib::ClearTable()
 {
@@ -24,32 +24,40 @@
 
 #include "ns3/object.h"
 #include "ns3/aqua-sim-address.h"
+#include "name-table.h"
 #include <utility>
-#include <list>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 
+/*
+ * Forwarding table keyed on interned names. A lookup matches the longest
+ * interned prefix of the interest name that has an entry, walking the
+ * name's parent links with one hash probe per component.
+ */
 class Fib : public Object {
 public:
   enum ForwardStrategy {BEST_ROUTE, MULTICAST};
   //int for Best route strategy
 
   typedef std::pair<AquaSimAddress,int > FibEntry;
-  typedef std::map<uint8_t*,std::list<FibEntry> >::iterator FibI;
+  typedef std::unordered_map<NameId,std::vector<FibEntry> >::iterator FibI;
 
   static TypeId GetTypeId (void);
   Fib();
 
-  std::list<AquaSimAddress> InterestRecv(uint8_t* name);
-  void AddEntry (uint8_t* name, AquaSimAddress address, int routeCost=0);
-  bool RemoveEntry(uint8_t* name, AquaSimAddress address);
+  std::vector<AquaSimAddress> InterestRecv(NameId name);
+  void AddEntry (NameId name, AquaSimAddress address, int routeCost=0);
+  bool RemoveEntry(NameId name, AquaSimAddress address);
   void SetForwardStrategy(ForwardStrategy strategy);
+  size_t GetFibSize();
 
 private:
   void ClearTable();
+  FibI LongestPrefixMatch(NameId name);
 
-  std::map<uint8_t*,std::list<FibEntry> > FibTable;
+  std::unordered_map<NameId,std::vector<FibEntry> > FibTable;
   ForwardStrategy m_strategy;
 
 }; // class Fib
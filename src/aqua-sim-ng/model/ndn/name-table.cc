@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "name-table.h"
+#include "ns3/assert.h"
+#include <deque>
+#include <string.h>
+#include <string_view>
+#include <unordered_map>
+
+namespace ns3 {
+
+namespace {
+
+struct NameEntry {
+  std::string name;
+  NameId parent;
+};
+
+struct Names {
+  /* a deque keeps the strings in place, so the index can view them */
+  std::deque<NameEntry> entries;
+  std::unordered_map<std::string_view, NameId> index;
+};
+
+Names&
+GetNames (void)
+{
+  static Names names;
+  return names;
+}
+
+} // namespace
+
+NameId
+NameTable::Intern (const uint8_t* name)
+{
+  const char* s = reinterpret_cast<const char*>(name);
+  return Intern (s, strlen (s));
+}
+
+NameId
+NameTable::Intern (const char* name, size_t len)
+{
+  Names& names = GetNames ();
+  std::unordered_map<std::string_view, NameId>::iterator it =
+    names.index.find (std::string_view (name, len));
+  if (it != names.index.end ())
+    return it->second;
+
+  NameId parent = NONE;
+  const char* cut = static_cast<const char*>(memrchr (name, '/', len));
+  if (cut != NULL && cut > name)
+    parent = Intern (name, cut - name);
+
+  NameId id = names.entries.size ();
+  NS_ASSERT (id != NONE);
+  names.entries.push_back (NameEntry ());
+  names.entries.back ().name.assign (name, len);
+  names.entries.back ().parent = parent;
+  names.index.insert (std::make_pair (std::string_view (names.entries.back ().name), id));
+  return id;
+}
+
+NameId
+NameTable::Find (const char* name, size_t len)
+{
+  Names& names = GetNames ();
+  std::unordered_map<std::string_view, NameId>::iterator it =
+    names.index.find (std::string_view (name, len));
+  return (it == names.index.end ()) ? NONE : it->second;
+}
+
+const std::string&
+NameTable::GetName (NameId id)
+{
+  NS_ASSERT (id < GetNames ().entries.size ());
+  return GetNames ().entries[id].name;
+}
+
+NameId
+NameTable::GetParent (NameId id)
+{
+  NS_ASSERT (id < GetNames ().entries.size ());
+  return GetNames ().entries[id].parent;
+}
+
+uint32_t
+NameTable::GetN (void)
+{
+  return GetNames ().entries.size ();
+}
+
+} // namespace ns3
@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+
+typedef uint32_t NameId;
+
+/**
+ * \brief Process-wide table of interned NDN names.
+ *
+ * Equal names map to the same NameId, so FIB, PIT and content store
+ * entries are keyed on content rather than on the buffer a packet was
+ * copied into. Every prefix of an interned name (cut at each '/') is
+ * interned with it and linked as its parent, which gives the FIB a
+ * component trie to walk for longest-prefix match. Names are never
+ * released.
+ */
+class NameTable
+{
+public:
+  static const NameId NONE = 0xffffffff;
+
+  /// Intern the NUL-terminated \p name.
+  static NameId Intern (const uint8_t* name);
+  static NameId Intern (const char* name, size_t len);
+  /// Id of \p name if it was interned, NONE otherwise.
+  static NameId Find (const char* name, size_t len);
+
+  static const std::string& GetName (NameId id);
+  /// Longest proper prefix of the name ending before a '/', or NONE.
+  static NameId GetParent (NameId id);
+  static uint32_t GetN (void);
+}; // class NameTable
+
+} // namespace ns3
+
+#endif /* NAME_TABLE_H */
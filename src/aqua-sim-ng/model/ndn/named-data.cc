@@ -113,23 +113,24 @@ NamedData::Recv(Ptr<Packet> packet)
     case (NamedDataHeader::NDN_INTEREST):
     {
       NS_LOG_INFO("Interest Packet Recv");
-      uint8_t* interest = GetInterestPktStr(packet);
+      NameId interest = GetInterestPktName(packet);
       if (m_hasCache) {
         uint8_t* potentialData = m_cs->GetEntry(interest);
         if (potentialData != NULL) {
           NS_LOG_INFO(this << "Found corresponding data to satisfy interest.");
-          SendPkt(CreateData(interest,potentialData,strlen((char*)interest),strlen((char*)potentialData)));
+          const std::string &name = NameTable::GetName(interest);
+          SendPkt(CreateData((uint8_t*)name.c_str(),potentialData,name.size(),strlen((char*)potentialData)));
           return true;
         }
       }
-      std::list<AquaSimAddress> addressList = m_fib->InterestRecv(interest);
+      std::vector<AquaSimAddress> addressList = m_fib->InterestRecv(interest);
       if (!addressList.empty()) {
         if (m_pit->AddEntry(interest, ash.GetSAddr())) {
           SendMultiplePackets(packet, addressList);
         }
       }
       else {
-        NS_LOG_INFO(this << " No known FIB paths for " << interest);
+        NS_LOG_INFO(this << " No known FIB paths for " << NameTable::GetName(interest));
         return false;
       }
     }
@@ -139,11 +140,13 @@ NamedData::Recv(Ptr<Packet> packet)
       NS_LOG_INFO("Data Packet Recv");
       std::pair<uint8_t*,uint8_t*> payload = GetInterestAndDataStr(packet);
           //payload.first == interest, payload.second == data
-      std::list<AquaSimAddress> addressList = m_pit->GetEntry(payload.first);
+      if (payload.first == NULL) return false;
+      NameId interest = NameTable::Intern(payload.first);
+      std::vector<AquaSimAddress> addressList = m_pit->GetEntry(interest);
       if (!addressList.empty()) {
-        if (m_hasCache) m_cs->AddEntry(payload.first, payload.second);
+        if (m_hasCache) m_cs->AddEntry(interest, payload.second);
         SendMultiplePackets(packet, addressList);
-        m_pit->RemoveEntry(payload.first);
+        m_pit->RemoveEntry(interest);
       }
       else {
         NS_LOG_INFO(this << "No corresponding PIT entries for given data pkt.");
@@ -157,7 +160,8 @@ NamedData::Recv(Ptr<Packet> packet)
       NameDiscovery nameDiscovery;
       std::pair<uint8_t*,AquaSimAddress> discovery = nameDiscovery.ProcessNameDiscovery(packet);
       nameDiscovery.ShortenNamePrefix(discovery.first, '/');
-      m_fib->AddEntry(discovery.first, discovery.second);
+      m_fib->AddEntry(NameTable::Intern(discovery.first), discovery.second);
+      delete[] discovery.first;
     }
     break;
     default:
@@ -293,32 +297,35 @@ NamedData::GetInterestAndDataStr(Ptr<Packet> dataPkt)
   return std::make_pair((uint8_t*)interest,(uint8_t*)token);
 }
 
-uint8_t*
-NamedData::GetInterestPktStr(Ptr<Packet> intPkt)
+NameId
+NamedData::GetInterestPktName(Ptr<Packet> intPkt)
 {
   AquaSimHeader ash; MacHeader mach; NamedDataHeader ndh;
   intPkt->RemoveAtStart(ndh.GetSerializedSize() + mach.GetSerializedSize() + ash.GetSerializedSize());
   uint32_t size = intPkt->GetSize ();
-  uint8_t *data = new uint8_t[size];
-  if (intPkt->CopyData (data, size) == 0)
+  m_nameBuf.resize(size);
+  if (size == 0 || intPkt->CopyData (m_nameBuf.data(), size) == 0)
   {
     NS_LOG_WARN(this << "Packet buffer is empty.");
   }
   intPkt->AddHeader(ndh); intPkt->AddHeader(mach); intPkt->AddHeader(ash);
-  return data;
+
+  //the name runs up to the first NUL, or the whole payload without one
+  const char *name = reinterpret_cast<const char*>(m_nameBuf.data());
+  const void *end = memchr(name, '\0', size);
+  return NameTable::Intern(name, end ? (const char*)end - name : size);
 }
 
 void
-NamedData::SendMultiplePackets(Ptr<Packet> packet, std::list<AquaSimAddress> addresses)
+NamedData::SendMultiplePackets(Ptr<Packet> packet, const std::vector<AquaSimAddress> &addresses)
 {
   AquaSimHeader ash;
 
-  while (!addresses.empty()) {
+  for (size_t i = 0; i < addresses.size(); i++) {
       packet->RemoveHeader(ash);
-      ash.SetDAddr(addresses.front());
+      ash.SetDAddr(addresses[i]);
       packet->AddHeader(ash);
       SendPkt(packet);
-      addresses.pop_front();
   }
 }
 
@@ -27,6 +27,8 @@
 #include "fib.h"
 #include "pit.h"
 #include "content-storage.h"
+#include "name-table.h"
+#include <vector>
 #include "ns3/aqua-sim-net-device.h"
 
 namespace ns3 {
@@ -52,9 +54,9 @@ public:
 
 private:
   uint8_t* GetDataStr(Ptr<Packet> dataPkt);
-  uint8_t* GetInterestPktStr(Ptr<Packet> intPkt);
+  NameId GetInterestPktName(Ptr<Packet> intPkt);
   std::pair<uint8_t*,uint8_t*> GetInterestAndDataStr(Ptr<Packet> dataPkt);
-  void SendMultiplePackets(Ptr<Packet> packet, std::list<AquaSimAddress> addresses);
+  void SendMultiplePackets(Ptr<Packet> packet, const std::vector<AquaSimAddress> &addresses);
   bool RecvCheck(Ptr<Packet> packet, uint8_t ptype);
 
   Ptr<Fib> m_fib;
@@ -62,6 +64,7 @@ private:
   Ptr<ContentStorage> m_cs;
   Ptr<AquaSimNetDevice> m_device;
   bool m_hasCache;
+  std::vector<uint8_t> m_nameBuf;  //reused payload copy for interest lookups
 
 }; // class NamedData
 
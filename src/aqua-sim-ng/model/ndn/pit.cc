@@ -20,6 +20,8 @@
 
 #include "ns3/log.h"
 #include "pit.h"
+#include "ns3/simulator.h"
+#include <algorithm>
 #include <utility>
 
 using namespace ns3;
@@ -37,16 +39,28 @@ Pit::GetTypeId (void)
       TimeValue (Seconds (120)),
       MakeTimeAccessor (&Pit::m_timeout),
       MakeTimeChecker ())
+    .AddAttribute ("WheelTick", "Granularity of PIT entry expiry",
+      TimeValue (Seconds (1)),
+      MakeTimeAccessor (&Pit::m_tick),
+      MakeTimeChecker (Time (1)))
     ;
   return tid;
 }
 
-Pit::Pit() : m_timeout(Seconds(120))
+Pit::Pit() : m_timeout(Seconds(120)), m_tick(Seconds(1)), m_seq(0), m_wheelTick(0)
 {
   NS_LOG_FUNCTION(this);
   ClearTable();
 }
 
+void
+Pit::DoDispose()
+{
+  m_wheelEvent.Cancel();
+  ClearTable();
+  Object::DoDispose();
+}
+
 size_t
 Pit::GetPitSize()
 {
@@ -54,21 +68,19 @@ Pit::GetPitSize()
 }
 
 bool
-Pit::RemoveEntry(uint8_t* name)
+Pit::RemoveEntry(NameId name)
 {
-  NS_LOG_DEBUG(this << name);
+  NS_LOG_DEBUG(this << NameTable::GetName(name));
 
   PitI entry;
   entry = PitTable.find(name);
   if (entry == PitTable.end())
   {
-    NS_LOG_WARN("Can not remove " << name << " since it does not exist in PitTable");
+    NS_LOG_WARN("Can not remove " << NameTable::GetName(name) << " since it does not exist in PitTable");
     return false;
   }
 
-  if (entry->second.timeout.IsRunning()) {
-    entry->second.timeout.Cancel();
-  }
+  //its wheel slot is dropped lazily, when the wheel gets there
   PitTable.erase(entry);
   return true;
 }
@@ -76,17 +88,13 @@ Pit::RemoveEntry(uint8_t* name)
 bool
 Pit::RemoveEntryByI(PitI entry)
 {
-  NS_LOG_DEBUG(this << entry->first);
-
   if (entry == PitTable.end())
   {
-    NS_LOG_WARN("Can not remove " << entry->first << " since it does not exist in PitTable");
+    NS_LOG_WARN("Can not remove entry since it does not exist in PitTable");
     return false;
   }
 
-  if (entry->second.timeout.IsRunning()) {
-    entry->second.timeout.Cancel();
-  }
+  NS_LOG_DEBUG(this << NameTable::GetName(entry->first));
   PitTable.erase(entry);
   return true;
 }
@@ -100,34 +108,87 @@ Pit::RemoveEntryByI(PitI entry)
  * @return		      true if entry does not exist, false if entry already in PIT
  */
 bool
-Pit::AddEntry(uint8_t* name, AquaSimAddress address)
+Pit::AddEntry(NameId name, AquaSimAddress address)
 {
-  NS_LOG_DEBUG(this << name << address);
+  NS_LOG_DEBUG(this << NameTable::GetName(name) << address);
 
-  PitI entry;
-  entry = PitTable.find(name);
-  if (entry == PitTable.end())
+  std::pair<PitI,bool> ins = PitTable.insert(std::make_pair(name, PitEntry()));
+  PitEntry &entry = ins.first->second;
+  if (ins.second)
   {
     //create new entry
-    PitEntry newEntry;
-    newEntry.address.push_back(address);
-    newEntry.timeout.SetArguments(name);
-    newEntry.timeout.SetFunction(&Pit::RemoveEntry, this);
-    newEntry.timeout.Schedule(m_timeout);
-    PitTable.insert(std::make_pair(name,newEntry));
+    entry.address.push_back(address);
+    entry.expiry = Simulator::Now() + m_timeout;
+    entry.seq = m_seq++;
+    ScheduleExpiry(name, entry);
     return true;
   }
   else
   {
-    //add new address to PitEntry
-    entry->second.address.push_back(address);
-    //assuming small address lists (so this shouldn't be too painful)
-    entry->second.address.sort(); //O(NlogN)
-    entry->second.address.unique(); //O(N)
+    //add new address to PitEntry, keeping the list sorted and unique
+    std::vector<AquaSimAddress>::iterator it =
+      std::lower_bound(entry.address.begin(), entry.address.end(), address);
+    if (it == entry.address.end() || *it != address)
+      entry.address.insert(it, address);
     return false;
   }
 }
 
+void
+Pit::ScheduleExpiry(NameId name, const PitEntry &entry)
+{
+  int64_t tick = m_tick.GetTimeStep();
+  size_t slots = m_timeout.GetTimeStep() / tick + 2;
+  if (m_wheel.size() < slots)
+  {
+    //grow only while empty-handed, so queued slots keep their meaning
+    if (PitTable.size() == 1)
+      m_wheel.assign(slots, std::vector<std::pair<NameId,uint32_t> >());
+    else
+      slots = m_wheel.size();
+  }
+
+  int64_t expiryTick = (entry.expiry.GetTimeStep() + tick - 1) / tick;
+  m_wheel[expiryTick % m_wheel.size()].push_back(std::make_pair(name, entry.seq));
+
+  if (!m_wheelEvent.IsRunning())
+  {
+    m_wheelTick = Simulator::Now().GetTimeStep() / tick + 1;
+    m_wheelEvent = Simulator::Schedule(TimeStep(m_wheelTick * tick) - Simulator::Now(),
+                                       &Pit::Tick, this);
+  }
+}
+
+void
+Pit::Tick()
+{
+  std::vector<std::pair<NameId,uint32_t> > &slot = m_wheel[m_wheelTick % m_wheel.size()];
+  size_t kept = 0;
+  for (size_t i = 0; i < slot.size(); i++)
+  {
+    PitI entry = PitTable.find(slot[i].first);
+    if (entry == PitTable.end() || entry->second.seq != slot[i].second)
+      continue;   //removed or re-added since
+    if (entry->second.expiry <= Simulator::Now())
+    {
+      NS_LOG_DEBUG(this << "PIT entry expired: " << NameTable::GetName(entry->first));
+      PitTable.erase(entry);
+    }
+    else
+      slot[kept++] = slot[i];   //a later lap of the wheel
+  }
+  slot.resize(kept);
+
+  if (PitTable.empty())
+  {
+    for (size_t i = 0; i < m_wheel.size(); i++)
+      m_wheel[i].clear();
+    return;
+  }
+  m_wheelTick++;
+  m_wheelEvent = Simulator::Schedule(m_tick, &Pit::Tick, this);
+}
+
 void
 Pit::SetTimeout(Time timeout)
 {
@@ -138,15 +199,16 @@ void
 Pit::ClearTable()
 {
   PitTable.clear();
+  m_wheel.clear();
 }
 
-std::list<AquaSimAddress>
-Pit::GetEntry(uint8_t* name)
+std::vector<AquaSimAddress>
+Pit::GetEntry(NameId name)
 {
-  NS_LOG_DEBUG(this << name);
+  NS_LOG_DEBUG(this << NameTable::GetName(name));
 
   PitI entry;
   entry = PitTable.find(name);
-  if (entry == PitTable.end()) return std::list<AquaSimAddress>();
+  if (entry == PitTable.end()) return std::vector<AquaSimAddress>();
   return entry->second.address;
 }
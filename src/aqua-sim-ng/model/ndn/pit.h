@@ -23,37 +23,58 @@
 #define PIT_H
 
 #include "ns3/object.h"
-#include "ns3/timer.h"
+#include "ns3/event-id.h"
 #include "ns3/nstime.h"
 #include "ns3/aqua-sim-address.h"
-#include <map>
+#include "name-table.h"
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
+/*
+ * Pending interest table keyed on interned names. Entries expire through
+ * a timer wheel of WheelTick slots rather than one scheduler event each:
+ * an entry is removed at the first tick at or after its EntryTimeout, and
+ * the wheel only runs while the table is not empty.
+ */
 class Pit : public Object {
 public:
   struct PitEntry {
-    std::list<AquaSimAddress> address;
-    Timer timeout;
+    std::vector<AquaSimAddress> address;  //sorted, unique
+    Time expiry;
+    uint32_t seq;                         //tells a re-added entry from a stale wheel slot
   };
 
-  typedef std::map<uint8_t*,PitEntry>::iterator PitI;
+  typedef std::unordered_map<NameId,PitEntry>::iterator PitI;
 
   static TypeId GetTypeId (void);
   Pit();
 
   size_t GetPitSize();
-  bool RemoveEntry(uint8_t* name);
+  bool RemoveEntry(NameId name);
   bool RemoveEntryByI(PitI);
-  bool AddEntry(uint8_t* name, AquaSimAddress address);
+  bool AddEntry(NameId name, AquaSimAddress address);
   void SetTimeout(Time timeout);
-  std::list<AquaSimAddress> GetEntry(uint8_t* name);
+  std::vector<AquaSimAddress> GetEntry(NameId name);
+
+protected:
+  virtual void DoDispose();
 
 private:
   void ClearTable();
+  void ScheduleExpiry(NameId name, const PitEntry &entry);
+  void Tick();
 
-  std::map<uint8_t*,PitEntry> PitTable;
+  std::unordered_map<NameId,PitEntry> PitTable;
   Time m_timeout;
+  Time m_tick;
+  uint32_t m_seq;
+  // wheel slot i holds entries expiring at ticks congruent to i
+  std::vector<std::vector<std::pair<NameId,uint32_t> > > m_wheel;
+  int64_t m_wheelTick;   //tick the wheel will process next
+  EventId m_wheelEvent;
 
 }; // class Pit
 
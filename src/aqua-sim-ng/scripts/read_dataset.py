@@ -0,0 +1,54 @@
+#!/usr/bin/python
+"""
+Memory-map a binary dataset written by ns3::AquaSimDatasetWriter (Format=Binary).
+
+    import read_dataset
+    cols = read_dataset.load("uwsn_data.bin")   # dict: column name -> numpy array
+
+Each row group is mapped in place; columns are only copied when the file
+holds more than one row group and the groups have to be concatenated.
+"""
+
+
+import sys
+import struct
+import numpy
+
+
+TYPES = {0: "<f8", 1: "<i8"}
+
+
+def read_schema(mm):
+    if bytes(mm[0:4]) != b"ASDS":
+        raise ValueError("not an AquaSimDatasetWriter file")
+    version, ncols, _ = struct.unpack_from("<III", mm, 4)
+    if version != 1:
+        raise ValueError("unsupported version %d" % version)
+    off = 16
+    schema = []
+    for _ in range(ncols):
+        ctype, nlen = struct.unpack_from("<BB", mm, off)
+        name = bytes(mm[off + 2:off + 2 + nlen]).decode()
+        schema.append((name, TYPES[ctype]))
+        off += 2 + nlen
+    return schema, (off + 7) // 8 * 8
+
+
+def load(path):
+    mm = numpy.memmap(path, dtype=numpy.uint8, mode="r")
+    schema, off = read_schema(mm)
+    groups = {name: [] for name, _ in schema}
+    while off < len(mm):
+        nrows = struct.unpack_from("<Q", mm, off)[0]
+        off += 8
+        for name, dtype in schema:
+            groups[name].append(numpy.frombuffer(mm, dtype, nrows, off))
+            off += 8 * nrows
+    return {name: (parts[0] if len(parts) == 1 else numpy.concatenate(parts or [numpy.empty(0, dtype)]))
+            for (name, dtype), parts in zip(schema, groups.values())}
+
+
+if __name__ == "__main__":
+    cols = load(sys.argv[1])
+    for name, values in cols.items():
+        print("%-12s %8d rows  first=%s" % (name, len(values), values[:1]))
@@ -0,0 +1,210 @@
+#!/usr/bin/python
+"""
+Run the uwsn-ids dataset generator over a parameter grid, several
+replications at a time, and write a manifest of the produced shards.
+
+    ./uwsn_ids_sweep.py --runTypes 0,1,2 --seeds 1-10 --numNodes 30,60 \
+                        --simTime 2000 --out corpus --jobs 8
+
+Every grid point gets its own output shard and a distinct (seed, run) RNG
+stream; the run number is derived from numNodes and runType, so it stays the
+same when the grid is extended. The manifest is rewritten atomically as each
+shard finishes, and shards it lists as finished are skipped, so an
+interrupted sweep can be resumed. The program is run
+directly rather than through ./ns3, so build it once beforehand.
+
+With --branchTime, each (numNodes, seed) point runs as one process. That
+process simulates the attack-free warm-up once and then forks one child per
+runType (uwsn-ids --branches). The warm-up uses run numNodes * 8 + 4 and
+runType t continues on run numNodes * 8 + 5 + t, so these streams never
+overlap the runs of unbranched shards.
+"""
+
+
+import argparse
+import glob
+import itertools
+import json
+import os
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+
+
+NS3_ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "../../.."))
+RUN_TYPES = {0: "normal", 1: "jump", 2: "drift"}
+
+
+def int_list(text):
+    values = []
+    for part in text.split(","):
+        if "-" in part:
+            lo, hi = part.split("-")
+            values.extend(range(int(lo), int(hi) + 1))
+        else:
+            values.append(int(part))
+    return values
+
+
+def find_program():
+    hits = glob.glob(os.path.join(NS3_ROOT, "build", "scratch", "ns3*-uwsn-ids-*"))
+    if not hits:
+        sys.exit("uwsn-ids is not built; run ./ns3 build uwsn-ids first")
+    return max(hits, key=os.path.getmtime)
+
+
+def run_shard(program, job, args):
+    cmd = [program,
+           "--runType=%d" % job["runType"],
+           "--seed=%d" % job["seed"],
+           "--run=%d" % job["run"],
+           "--numNodes=%d" % job["numNodes"],
+           "--simTime=%s" % args.simTime,
+           "--format=%s" % args.format,
+           "--csvFile=%s" % os.path.join(args.out, job["shard"])]
+    start = time.time()
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+    result = dict(job, returncode=proc.returncode, wall=time.time() - start)
+    for fields in shard_lines(proc.stdout):
+        result.update(fields)
+    if proc.returncode != 0:
+        result["stderr"] = proc.stderr[-2000:]
+    return [result]
+
+
+def run_branched(program, group, args):
+    """One warm-up forked into every job of group (same numNodes and seed)."""
+    first = group[0]
+    cmd = [program,
+           "--branches=%s" % ",".join(str(j["runType"]) for j in group),
+           "--branchTime=%s" % args.branchTime,
+           "--seed=%d" % first["seed"],
+           "--run=%d" % (first["numNodes"] * 8 + 4),
+           "--numNodes=%d" % first["numNodes"],
+           "--simTime=%s" % args.simTime,
+           "--format=%s" % args.format,
+           "--csvFile=%s" % os.path.join(args.out, "n%d_s%d.%s"
+                                         % (first["numNodes"], first["seed"], args.format))]
+    start = time.time()
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+    wall = time.time() - start
+    done = {}
+    for fields in shard_lines(proc.stdout):
+        done[fields["runType"]] = fields
+    results = []
+    for job in group:
+        # a child that did not report failed, whatever the parent returned
+        fields = done.get(job["runType"])
+        result = dict(job, run=first["numNodes"] * 8 + 5 + job["runType"],
+                      branchTime=float(args.branchTime), wall=wall / len(group),
+                      returncode=0 if fields else (proc.returncode or 1))
+        result.update(fields or {})
+        if not fields:
+            result["stderr"] = proc.stderr[-2000:]
+        results.append(result)
+    return results
+
+
+def shard_lines(stdout):
+    for line in stdout.splitlines():
+        if line.startswith("SHARD "):
+            fields = {}
+            for field in line.split()[1:]:
+                key, value = field.split("=")
+                fields["sim_" + key if key == "wall" else key] = number(value)
+            yield fields
+
+
+def number(text):
+    """int if text is one, else float ("1e6" and "nan" are floats)."""
+    try:
+        return int(text)
+    except ValueError:
+        return float(text)
+
+
+def write_manifest(path, manifest):
+    """Replace path atomically, so an interrupted sweep never leaves it torn."""
+    tmp = "%s.tmp%d" % (path, os.getpid())
+    with open(tmp, "w") as f:
+        json.dump(manifest, f, indent=1)
+        f.flush()
+        os.fsync(f.fileno())
+    os.replace(tmp, path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--runTypes", default="0,1,2", type=int_list)
+    parser.add_argument("--seeds", default="1-5", type=int_list)
+    parser.add_argument("--numNodes", default="30", type=int_list)
+    parser.add_argument("--simTime", default="2000")
+    parser.add_argument("--format", default="bin", choices=["csv", "bin"])
+    parser.add_argument("--out", default="uwsn_ids_corpus")
+    parser.add_argument("--jobs", default=os.cpu_count() or 1, type=int)
+    parser.add_argument("--program", default=None, help="uwsn-ids executable")
+    parser.add_argument("--branchTime", default=None,
+                        help="fork the runTypes of each (numNodes, seed) from one warm-up at this time (s)")
+    args = parser.parse_args()
+
+    program = args.program or find_program()
+    os.makedirs(args.out, exist_ok=True)
+    manifest_path = os.path.join(args.out, "manifest.json")
+
+    done = {}
+    if os.path.exists(manifest_path):
+        with open(manifest_path) as f:
+            for shard in json.load(f)["shards"]:
+                if shard["returncode"] == 0:
+                    done[shard["shard"]] = shard
+
+    jobs = []
+    grid = itertools.product(args.numNodes, args.runTypes, args.seeds)
+    for nodes, run_type, seed in grid:
+        run = nodes * 8 + run_type
+        shard = "%s_n%d_s%d.%s" % (RUN_TYPES.get(run_type, run_type), nodes, seed, args.format)
+        jobs.append({"shard": shard, "runType": run_type, "seed": seed,
+                     "numNodes": nodes, "run": run, "simTime": float(args.simTime)})
+
+    pending = [j for j in jobs if j["shard"] not in done]
+    print("%d shards, %d already done, %d jobs in parallel" % (len(jobs), len(done), args.jobs))
+
+    results = dict(done)
+    start = time.time()
+
+    def manifest():
+        return {"program": program,
+                "format": args.format,
+                "jobs": args.jobs,
+                "wall": time.time() - start,
+                "shards": [results[j["shard"]] for j in jobs if j["shard"] in results]}
+
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        if args.branchTime is None:
+            futures = [pool.submit(run_shard, program, j, args) for j in pending]
+        else:
+            groups = {}
+            for j in pending:
+                groups.setdefault((j["numNodes"], j["seed"]), []).append(j)
+            futures = [pool.submit(run_branched, program, g, args) for g in groups.values()]
+        for future in as_completed(futures):
+            for r in future.result():
+                results[r["shard"]] = r
+                print("%-28s rc=%d events=%s rows=%s wall=%.1fs"
+                      % (r["shard"], r["returncode"], r.get("events"), r.get("rows"), r["wall"]))
+            # after every finished shard, so a killed sweep resumes from here
+            write_manifest(manifest_path, manifest())
+
+    final = manifest()
+    write_manifest(manifest_path, final)
+
+    failed = [s for s in final["shards"] if s["returncode"] != 0]
+    print("manifest: %s (%d failed)" % (manifest_path, len(failed)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
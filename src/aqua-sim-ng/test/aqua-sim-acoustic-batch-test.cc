@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-helper.h"
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-range-propagation.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/boolean.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+/// Exposes the protected scalar kernels for comparison.
+class ScalarPropagation : public AquaSimRangePropagation
+{
+public:
+  using AquaSimPropagation::Rayleigh;
+  using AquaSimPropagation::Thorp;
+  using AquaSimPropagation::UseBatchKernels;
+};
+
+double
+RelErr (double a, double b)
+{
+  return std::fabs (a - b) / std::max (std::fabs (b), 1e-300);
+}
+
+}  // namespace
+
+/**
+ * Every batch kernel must agree with its scalar counterpart to a few ulps
+ * over the parameter ranges the models are used with.
+ */
+class AquaSimAcousticBatchTestCase : public TestCase
+{
+public:
+  AquaSimAcousticBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimAcousticBatchTestCase::AquaSimAcousticBatchTestCase ()
+  : TestCase ("Batch acoustic kernels match the scalar models")
+{
+}
+
+void
+AquaSimAcousticBatchTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (11);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  const uint32_t n = 1000;
+  const double tol = 1e-12;
+
+  Ptr<ScalarPropagation> prop = CreateObject<ScalarPropagation> ();
+  prop->SetAttribute ("Temperature", DoubleValue (12.5));
+  prop->SetAttribute ("Salinty", DoubleValue (33));
+
+  std::vector<double> dist (n), depth (n), freq (n), out (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      dist[i] = rand->GetValue (1, 10000);
+      depth[i] = rand->GetValue (0, 8000);
+      freq[i] = rand->GetValue (0.1, 100);
+    }
+
+  prop->ThorpBatch (&freq[0], &out[0], n);
+  for (uint32_t i = 0; i < n; i++)
+    NS_TEST_ASSERT_MSG_LT (RelErr (out[i], prop->Thorp (0, freq[i])), tol, "Thorp at f=" << freq[i]);
+
+  const double freqs[] = {10, 25, 70};
+  for (double f : freqs)
+    {
+      prop->RayleighBatch (&dist[0], f, &out[0], n);
+      for (uint32_t i = 0; i < n; i++)
+        NS_TEST_ASSERT_MSG_LT (RelErr (out[i], prop->Rayleigh (dist[i], f)), tol,
+                               "Rayleigh at d=" << dist[i] << " f=" << f);
+    }
+
+  prop->AcousticSpeedBatch (&depth[0], &out[0], n);
+  for (uint32_t i = 0; i < n; i++)
+    NS_TEST_ASSERT_MSG_LT (RelErr (out[i], prop->AcousticSpeed (depth[i])), tol, "speed at depth " << depth[i]);
+}
+
+/**
+ * Both forms of each kernel at inputs worked out by hand: Thorp at 25 kHz,
+ * a 1 km Rayleigh loss at that frequency, and Mackenzie's sound speed for
+ * 10 C, 35 ppt at the surface and at 1000 m.
+ */
+class AquaSimAcousticKnownValueTestCase : public TestCase
+{
+public:
+  AquaSimAcousticKnownValueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimAcousticKnownValueTestCase::AquaSimAcousticKnownValueTestCase ()
+  : TestCase ("Acoustic kernels reproduce hand-computed values")
+{
+}
+
+void
+AquaSimAcousticKnownValueTestCase::DoRun (void)
+{
+  Ptr<ScalarPropagation> prop = CreateObject<ScalarPropagation> ();
+  prop->SetAttribute ("Temperature", DoubleValue (10));
+  prop->SetAttribute ("Salinty", DoubleValue (35));
+
+  /* 0.11*625/626 + 44*625/4725 + 0.000275*625 + 0.0003 */
+  const double thorp25 = 6.10210510125598;
+  double f = 25, alpha;
+  prop->ThorpBatch (&f, &alpha, 1);
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->Thorp (0, 25), thorp25, 1e-12, "Thorp at 25 kHz");
+  NS_TEST_ASSERT_MSG_EQ_TOL (alpha, thorp25, 1e-12, "ThorpBatch at 25 kHz");
+
+  /* 1000^2 * 10^(thorp25/10) */
+  double d = 1000, att;
+  prop->RayleighBatch (&d, 25, &att, 1);
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->Rayleigh (1000, 25), 4075777.900095428, 1e-6, "Rayleigh at 1 km");
+  NS_TEST_ASSERT_MSG_EQ_TOL (att, 4075777.900095428, 1e-6, "RayleighBatch at 1 km");
+
+  /* 1448.96 + 45.91 - 5.304 + 0.2374 at the surface, plus the depth terms at d/2 = 500 */
+  double depth[] = {0, 1000}, speed[2];
+  prop->AcousticSpeedBatch (depth, speed, 2);
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->AcousticSpeed (0), 1489.8034, 1e-9, "speed at the surface");
+  NS_TEST_ASSERT_MSG_EQ_TOL (speed[0], 1489.8034, 1e-9, "batch speed at the surface");
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->AcousticSpeed (1000), 1497.994382625, 1e-9, "speed at 1000 m");
+  NS_TEST_ASSERT_MSG_EQ_TOL (speed[1], 1497.994382625, 1e-9, "batch speed at 1000 m");
+}
+
+/**
+ * Unless BatchKernels is set, ReceivedCopies evaluates every receiver with
+ * the scalar AcousticSpeed and Rayleigh, so delay and received power are
+ * bit-identical to the per-receiver models.
+ */
+class AquaSimScalarDefaultTestCase : public TestCase
+{
+public:
+  AquaSimScalarDefaultTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimScalarDefaultTestCase::AquaSimScalarDefaultTestCase ()
+  : TestCase ("ReceivedCopies uses the exact scalar models by default")
+{
+}
+
+void
+AquaSimScalarDefaultTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (20);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> pos = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    pos->Add (Vector (i * 173.0, 0, -(i * 11.0)));
+  mobility.SetPositionAllocator (pos);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  std::vector<Ptr<AquaSimNetDevice> > devices;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      asHelper.Create (*i, dev);
+      devices.push_back (dev);
+    }
+
+  Ptr<ScalarPropagation> prop = CreateObject<ScalarPropagation> ();
+  NS_TEST_ASSERT_MSG_EQ (prop->UseBatchKernels (), false, "batch kernels are opt-in");
+
+  AquaSimPacketStamp pstamp;
+  pstamp.SetTxRange (-1);
+  pstamp.SetPt (20);
+  pstamp.SetFreq (25);
+  Ptr<Packet> p = Create<Packet> (32);
+  p->AddHeader (pstamp);
+
+  std::vector<PktRecvUnit> res;
+  prop->ReceivedCopies (devices[0], p, devices, res);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), devices.size (), "unlimited range reaches every node");
+  Ptr<MobilityModel> s = nodes.Get (0)->GetObject<MobilityModel> ();
+  for (uint32_t i = 1; i < res.size (); i++)
+    {
+      Ptr<MobilityModel> r = res[i].recver->GetNode ()->GetObject<MobilityModel> ();
+      double dist = s->GetDistanceFrom (r);
+      double depth = std::fabs (r->GetPosition ().z - s->GetPosition ().z);
+      NS_TEST_ASSERT_MSG_EQ (res[i].pDelay, Time::FromDouble (dist / prop->AcousticSpeed (depth), Time::S),
+                             "delay to node " << i);
+      NS_TEST_ASSERT_MSG_EQ (res[i].pR, 20 / prop->Rayleigh (dist, 25), "received power at node " << i);
+    }
+
+  devices.clear ();
+  Simulator::Destroy ();
+}
+
+class AquaSimAcousticBatchTestSuite : public TestSuite
+{
+public:
+  AquaSimAcousticBatchTestSuite ();
+};
+
+AquaSimAcousticBatchTestSuite::AquaSimAcousticBatchTestSuite ()
+  : TestSuite ("aqua-sim-acoustic-batch", UNIT)
+{
+  AddTestCase (new AquaSimAcousticBatchTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimAcousticKnownValueTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimScalarDefaultTestCase, TestCase::QUICK);
+}
+
+static AquaSimAcousticBatchTestSuite aquaSimAcousticBatchTestSuite;
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <map>
+#include <utility>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-addr-pair-table.h"
+
+using namespace ns3;
+
+/**
+ * Random insert/erase/find sequences on the flat address-pair table,
+ * checked against a std::map; the narrow address range makes probe runs
+ * long and forces erasures from their middle.
+ */
+class AquaSimAddrPairTableTestCase : public TestCase
+{
+public:
+  AquaSimAddrPairTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimAddrPairTableTestCase::AquaSimAddrPairTableTestCase ()
+  : TestCase ("Address-pair table matches std::map")
+{
+}
+
+void
+AquaSimAddrPairTableTestCase::DoRun (void)
+{
+  typedef std::pair<uint16_t, uint16_t> Key;
+  RngSeedManager::SetSeed (13);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  AquaSimAddrPairTable<uint32_t> table;
+  std::map<Key, uint32_t> ref;
+  uint32_t peak = 0;
+
+  for (uint32_t step = 0; step < 100000; step++)
+    {
+      /* grow for a while, then shrink, then grow again */
+      double pInsert = (step / 25000) % 2 == 0 ? 0.6 : 0.35;
+      Key k (rand->GetInteger (0, 40), rand->GetInteger (0, 40));
+      AquaSimAddress a (k.first), b (k.second);
+      double r = rand->GetValue ();
+      std::map<Key, uint32_t>::iterator it = ref.find (k);
+      bool known = it != ref.end ();
+
+      if (r < pInsert)
+        {
+          bool created;
+          uint32_t *v = table.Insert (a, b, created);
+          NS_TEST_ASSERT_MSG_EQ (created, !known, "insert verdict differs");
+          if (created)
+            NS_TEST_ASSERT_MSG_EQ (*v, 0, "new value not default-constructed");
+          *v = step;
+          ref[k] = step;
+        }
+      else if (r < 0.8)
+        {
+          NS_TEST_ASSERT_MSG_EQ (table.Erase (a, b), known, "erase verdict differs");
+          if (known)
+            ref.erase (it);
+        }
+      else
+        {
+          uint32_t *v = table.Find (a, b);
+          NS_TEST_ASSERT_MSG_EQ ((v != 0), known, "find verdict differs");
+          if (v && known)
+            NS_TEST_ASSERT_MSG_EQ (*v, it->second, "value differs");
+        }
+      NS_TEST_ASSERT_MSG_EQ (table.GetN (), ref.size (), "size differs");
+      peak = std::max (peak, table.GetN ());
+    }
+
+  /* every surviving pair is still reachable */
+  for (std::map<Key, uint32_t>::iterator it = ref.begin (); it != ref.end (); it++)
+    {
+      uint32_t *v = table.Find (AquaSimAddress (it->first.first), AquaSimAddress (it->first.second));
+      NS_TEST_ASSERT_MSG_EQ ((v != 0 && *v == it->second), true, "pair lost");
+    }
+  NS_TEST_ASSERT_MSG_GT (peak, 500, "table never grew");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (AquaSimAddress (41), AquaSimAddress (0)) == 0), true,
+                         "unknown pair found");
+}
+
+/**
+ * A short fixed sequence with every result written out: pairs are
+ * ordered, re-inserting keeps the stored value, and erasing one
+ * direction leaves the other.
+ */
+class AquaSimAddrPairTableKnownTestCase : public TestCase
+{
+public:
+  AquaSimAddrPairTableKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimAddrPairTableKnownTestCase::AquaSimAddrPairTableKnownTestCase ()
+  : TestCase ("Address-pair table on a fixed sequence")
+{
+}
+
+void
+AquaSimAddrPairTableKnownTestCase::DoRun (void)
+{
+  AquaSimAddrPairTable<uint32_t> table;
+  AquaSimAddress a (1), b (2);
+  bool created;
+
+  *table.Insert (a, b, created) = 10;
+  NS_TEST_ASSERT_MSG_EQ (created, true, "(1,2) is new");
+  *table.Insert (b, a, created) = 20;
+  NS_TEST_ASSERT_MSG_EQ (created, true, "(2,1) is a different pair");
+  NS_TEST_ASSERT_MSG_EQ (*table.Insert (a, b, created), 10, "re-insert keeps the value");
+  NS_TEST_ASSERT_MSG_EQ (created, false, "(1,2) already present");
+  NS_TEST_ASSERT_MSG_EQ (table.GetN (), 2, "two pairs");
+
+  NS_TEST_ASSERT_MSG_EQ (table.Erase (b, a), true, "(2,1) erased");
+  NS_TEST_ASSERT_MSG_EQ (table.Erase (b, a), false, "(2,1) already gone");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (b, a) == 0), true, "(2,1) not found");
+  NS_TEST_ASSERT_MSG_EQ (*table.Find (a, b), 10, "(1,2) survives");
+  NS_TEST_ASSERT_MSG_EQ (table.GetN (), 1, "one pair");
+
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (table.GetN (), 0, "cleared");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (a, b) == 0), true, "(1,2) cleared");
+}
+
+/**
+ * Next-hop weights stay sorted by address across the inline-to-heap
+ * spill, as the std::map they replace iterated.
+ */
+class AquaSimNextHopWeightsTestCase : public TestCase
+{
+public:
+  AquaSimNextHopWeightsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimNextHopWeightsTestCase::AquaSimNextHopWeightsTestCase ()
+  : TestCase ("Next-hop weights keep address order")
+{
+}
+
+void
+AquaSimNextHopWeightsTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (13);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  for (uint32_t round = 0; round < 50; round++)
+    {
+      AquaSimNextHopWeights w;
+      std::map<uint16_t, double> ref;
+      uint32_t n = rand->GetInteger (1, 40);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          uint16_t addr = rand->GetInteger (0, 300);
+          double weight = rand->GetValue ();
+          bool added = w.Add (AquaSimAddress (addr), weight);
+          bool fresh = ref.count (addr) == 0;
+          NS_TEST_ASSERT_MSG_EQ (added, fresh, "add verdict differs");
+          ref.insert (std::make_pair (addr, weight));
+        }
+      NS_TEST_ASSERT_MSG_EQ (w.GetN (), ref.size (), "size differs");
+      uint32_t i = 0;
+      for (std::map<uint16_t, double>::iterator it = ref.begin (); it != ref.end (); it++, i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (w.GetAddress (i).GetAsInt (), it->first, "order differs");
+          NS_TEST_ASSERT_MSG_EQ (w.GetWeight (i), it->second, "weight differs");
+          double *p = w.Find (AquaSimAddress (it->first));
+          NS_TEST_ASSERT_MSG_EQ ((p != 0), true, "next hop not found");
+          if (p)
+            *p += 1;
+          NS_TEST_ASSERT_MSG_EQ (w.GetWeight (i), it->second + 1, "weight not updated in place");
+        }
+      NS_TEST_ASSERT_MSG_EQ ((w.Find (AquaSimAddress (301)) == 0), true, "unknown next hop found");
+    }
+}
+
+class AquaSimAddrPairTableTestSuite : public TestSuite
+{
+public:
+  AquaSimAddrPairTableTestSuite ();
+};
+
+AquaSimAddrPairTableTestSuite::AquaSimAddrPairTableTestSuite ()
+  : TestSuite ("aqua-sim-addr-pair-table", UNIT)
+{
+  AddTestCase (new AquaSimAddrPairTableTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimAddrPairTableKnownTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimNextHopWeightsTestCase, TestCase::QUICK);
+}
+
+static AquaSimAddrPairTableTestSuite aquaSimAddrPairTableTestSuite;
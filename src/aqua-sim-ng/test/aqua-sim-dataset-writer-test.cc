@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include "ns3/aqua-sim-dataset-writer.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+namespace {
+
+/// Little-endian integer from \p p, independent of the host byte order.
+uint64_t
+GetLe (const unsigned char *p, int bytes)
+{
+  uint64_t v = 0;
+  for (int i = bytes - 1; i >= 0; i--)
+    v = (v << 8) | p[i];
+  return v;
+}
+
+uint32_t
+CountLines (std::string file)
+{
+  std::ifstream in (file.c_str ());
+  std::string line;
+  uint32_t n = 0;
+  while (std::getline (in, line))
+    n++;
+  return n;
+}
+
+}  // namespace
+
+/**
+ * Rows written through a small buffer must come back intact from both the
+ * CSV and the row-group binary layout, including the partial last group
+ * flushed at Simulator::Destroy.
+ */
+class AquaSimDatasetWriterTestCase : public TestCase
+{
+public:
+  AquaSimDatasetWriterTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<AquaSimDatasetWriter> Fill (AquaSimDatasetWriter::Format format, std::string file);
+  static void Committed (uint64_t *last, uint64_t rows);
+
+  static const uint32_t N_ROWS = 10;
+  uint64_t m_committed;
+};
+
+AquaSimDatasetWriterTestCase::AquaSimDatasetWriterTestCase ()
+  : TestCase ("Dataset writer round-trips CSV and binary row groups"),
+    m_committed (0)
+{
+}
+
+void
+AquaSimDatasetWriterTestCase::Committed (uint64_t *last, uint64_t rows)
+{
+  *last = rows;
+}
+
+Ptr<AquaSimDatasetWriter>
+AquaSimDatasetWriterTestCase::Fill (AquaSimDatasetWriter::Format format, std::string file)
+{
+  Ptr<AquaSimDatasetWriter> w = CreateObject<AquaSimDatasetWriter> ();
+  w->SetAttribute ("Format", EnumValue (format));
+  w->SetAttribute ("BufferRows", UintegerValue (4));
+  w->AddColumn ("Time");
+  w->AddColumn ("NodeID", AquaSimDatasetWriter::INT64);
+  w->Open (file);
+  m_committed = 0;
+  w->TraceConnectWithoutContext ("Committed", MakeBoundCallback (&AquaSimDatasetWriterTestCase::Committed,
+                                                                 &m_committed));
+  for (uint32_t r = 0; r < N_ROWS; r++)
+    {
+      w->Set (0, r * 0.25);
+      w->Set (1, 100 + r);
+      w->Commit ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_committed, N_ROWS, "Committed trace missed rows");
+  return w;
+}
+
+void
+AquaSimDatasetWriterTestCase::DoRun (void)
+{
+  std::string csvFile = CreateTempDirFilename ("dataset.csv");
+  std::string binFile = CreateTempDirFilename ("dataset.bin");
+  Ptr<AquaSimDatasetWriter> csv = Fill (AquaSimDatasetWriter::CSV, csvFile);
+  Ptr<AquaSimDatasetWriter> bin = Fill (AquaSimDatasetWriter::BINARY, binFile);
+  NS_TEST_ASSERT_MSG_EQ (bin->GetFlushCount (), 2, "a full buffer must flush");
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (bin->IsOpen (), false, "Simulator::Destroy must close the writer");
+  NS_TEST_ASSERT_MSG_EQ (bin->GetFlushCount (), 3, "partial group not flushed on close");
+
+  std::ifstream in (csvFile.c_str ());
+  std::string line;
+  std::getline (in, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "Time,NodeID", "bad CSV header");
+  uint32_t rows = 0;
+  while (std::getline (in, line))
+    {
+      std::ostringstream expect;
+      expect << rows * 0.25 << "," << 100 + rows;
+      NS_TEST_ASSERT_MSG_EQ (line, expect.str (), "bad CSV row");
+      rows++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (rows, N_ROWS, "CSV row count");
+
+  std::ifstream b (binFile.c_str (), std::ios::binary);
+  unsigned char head[16];
+  b.read ((char *) head, sizeof (head));
+  NS_TEST_ASSERT_MSG_EQ (std::string ((char *) head, 4), "ASDS", "bad magic");
+  NS_TEST_ASSERT_MSG_EQ (GetLe (head + 4, 4), 1, "bad version");
+  NS_TEST_ASSERT_MSG_EQ (GetLe (head + 8, 4), 2, "bad column count");
+  /* 16 + (2 + 4) + (2 + 6) = 30 bytes of schema, padded to 32 */
+  b.seekg (32);
+  rows = 0;
+  unsigned char word[8];
+  while (b.read ((char *) word, 8))
+    {
+      uint64_t nrows = GetLe (word, 8);
+      std::vector<unsigned char> t (nrows * 8), id (nrows * 8);
+      b.read ((char *) t.data (), nrows * 8);
+      b.read ((char *) id.data (), nrows * 8);
+      for (uint64_t r = 0; r < nrows; r++, rows++)
+        {
+          uint64_t bits = GetLe (&t[r * 8], 8);
+          double v;
+          std::memcpy (&v, &bits, 8);
+          NS_TEST_ASSERT_MSG_EQ (v, rows * 0.25, "bad float64 column");
+          NS_TEST_ASSERT_MSG_EQ ((int64_t) GetLe (&id[r * 8], 8), 100 + rows, "bad int64 column");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (rows, N_ROWS, "binary row count");
+
+  /* reopened before Destroy, then again in the next simulation */
+  std::string first = CreateTempDirFilename ("first.csv");
+  std::string second = CreateTempDirFilename ("second.csv");
+  Ptr<AquaSimDatasetWriter> w = CreateObject<AquaSimDatasetWriter> ();
+  w->AddColumn ("Row", AquaSimDatasetWriter::INT64);
+  w->Open (first);
+  w->Close ();
+  w->Open (first);
+  w->Set (0, 1);
+  w->Commit ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (w->IsOpen (), false, "reopened writer not closed by Destroy");
+  NS_TEST_ASSERT_MSG_EQ (CountLines (first), 2, "reopened writer lost its row");
+  w->Open (second);
+  w->Set (0, 2);
+  w->Commit ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (w->IsOpen (), false, "writer not closed by the next Destroy");
+  NS_TEST_ASSERT_MSG_EQ (CountLines (second), 2, "row of the next simulation lost");
+}
+
+/**
+ * A forked child that branches the writer gets the rows written before the
+ * fork followed by its own, while the parent keeps appending to the
+ * original file; neither sees the other's rows.
+ */
+class AquaSimDatasetWriterBranchTestCase : public TestCase
+{
+public:
+  AquaSimDatasetWriterBranchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  static void Write (Ptr<AquaSimDatasetWriter> w, uint32_t first, uint32_t n);
+  static std::vector<std::string> Read (std::string file);
+};
+
+AquaSimDatasetWriterBranchTestCase::AquaSimDatasetWriterBranchTestCase ()
+  : TestCase ("Branching a dataset after fork() copies the common prefix")
+{
+}
+
+void
+AquaSimDatasetWriterBranchTestCase::Write (Ptr<AquaSimDatasetWriter> w, uint32_t first, uint32_t n)
+{
+  for (uint32_t r = first; r < first + n; r++)
+    {
+      w->Set (0, r);
+      w->Commit ();
+    }
+}
+
+std::vector<std::string>
+AquaSimDatasetWriterBranchTestCase::Read (std::string file)
+{
+  std::vector<std::string> lines;
+  std::ifstream in (file.c_str ());
+  std::string line;
+  while (std::getline (in, line))
+    lines.push_back (line);
+  return lines;
+}
+
+void
+AquaSimDatasetWriterBranchTestCase::DoRun (void)
+{
+  std::string trunk = CreateTempDirFilename ("trunk.csv");
+  std::string branch = CreateTempDirFilename ("branch.csv");
+  Ptr<AquaSimDatasetWriter> w = CreateObject<AquaSimDatasetWriter> ();
+  w->SetAttribute ("BufferRows", UintegerValue (4));
+  w->AddColumn ("Row", AquaSimDatasetWriter::INT64);
+  w->Open (trunk);
+  Write (w, 0, 6);   //one full buffer written, two rows pending
+  w->Flush ();
+
+  pid_t pid = fork ();
+  NS_TEST_ASSERT_MSG_NE (pid, -1, "fork failed");
+  if (pid == 0)
+    {
+      w->Branch (branch);
+      Write (w, 100, 3);
+      w->Close ();
+      _exit (0);
+    }
+  int status;
+  waitpid (pid, &status, 0);
+  NS_TEST_ASSERT_MSG_EQ (WIFEXITED (status) && WEXITSTATUS (status) == 0, true, "child failed");
+  Write (w, 6, 2);
+  Simulator::Destroy ();
+
+  std::vector<std::string> a = Read (trunk);
+  std::vector<std::string> b = Read (branch);
+  NS_TEST_ASSERT_MSG_EQ (a.size (), 9, "trunk rows");
+  NS_TEST_ASSERT_MSG_EQ (b.size (), 10, "branch rows");
+  for (uint32_t r = 0; r <= 6; r++)   //header and rows 0-5
+    NS_TEST_ASSERT_MSG_EQ (b[r], a[r], "branch lost the common prefix");
+  NS_TEST_ASSERT_MSG_EQ (a[7], "6", "trunk continues after the fork");
+  NS_TEST_ASSERT_MSG_EQ (b[7], "100", "branch continues with its own rows");
+  NS_TEST_ASSERT_MSG_EQ (b[9], "102", "branch continues with its own rows");
+}
+
+class AquaSimDatasetWriterTestSuite : public TestSuite
+{
+public:
+  AquaSimDatasetWriterTestSuite ();
+};
+
+AquaSimDatasetWriterTestSuite::AquaSimDatasetWriterTestSuite ()
+  : TestSuite ("aqua-sim-dataset-writer", UNIT)
+{
+  AddTestCase (new AquaSimDatasetWriterTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDatasetWriterBranchTestCase, TestCase::QUICK);
+}
+
+static AquaSimDatasetWriterTestSuite aquaSimDatasetWriterTestSuite;
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-routing-dbr.h"
+
+using namespace ns3;
+
+/**
+ * Random access/add/delete sequences on the DBR packet cache, checked
+ * against a plain recency vector with the same capacity.
+ */
+class AquaSimDbrPktCacheTestCase : public TestCase
+{
+public:
+  AquaSimDbrPktCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDbrPktCacheTestCase::AquaSimDbrPktCacheTestCase ()
+  : TestCase ("DBR packet cache evicts the least recently used packet")
+{
+}
+
+void
+AquaSimDbrPktCacheTestCase::DoRun (void)
+{
+  const int capacity = 64;
+  RngSeedManager::SetSeed (7);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  ASPktCache pc (capacity);
+  std::vector<int> ref;   // least recently used first
+  uint32_t evictions = 0;
+
+  for (uint32_t step = 0; step < 50000; step++)
+    {
+      int id = rand->GetInteger (0, 200);
+      uint32_t op = rand->GetInteger (0, 4);
+      std::vector<int>::iterator it = std::find (ref.begin (), ref.end (), id);
+      bool cached = it != ref.end ();
+
+      if (op < 2)
+        {
+          int got = pc.AccessPacket (id);
+          int expected = cached ? 1 : 0;
+          NS_TEST_ASSERT_MSG_EQ (got, expected, "access verdict differs");
+          if (cached)
+            {
+              ref.erase (it);
+              ref.push_back (id);
+            }
+        }
+      else if (op < 4)
+        {
+          pc.AddPacket (id);
+          if (cached)
+            ref.erase (it);
+          else if ((int) ref.size () == capacity)
+            {
+              ref.erase (ref.begin ());
+              evictions++;
+            }
+          ref.push_back (id);
+        }
+      else
+        {
+          pc.DeletePacket (id);
+          if (cached)
+            ref.erase (it);
+        }
+      NS_TEST_ASSERT_MSG_EQ (pc.Size (), (int) ref.size (), "cache size differs");
+    }
+
+  NS_TEST_ASSERT_MSG_GT (evictions, 0, "cache never filled up");
+  for (uint32_t i = 0; i < ref.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (pc.AccessPacket (ref[i]), 1, "cached packet missing");
+    }
+}
+
+/**
+ * The depth-ordered neighbor table must pick the same neighbor as a scan
+ * of an address-sorted table: a routed neighbor (lowest address) first,
+ * otherwise the shallowest neighbor above the caller, lowest address on ties.
+ */
+class AquaSimDbrNeighbTableTestCase : public TestCase
+{
+public:
+  AquaSimDbrNeighbTableTestCase ();
+
+private:
+  struct Ref {
+    AquaSimAddress addr;
+    double z;
+    int routeFlag;
+  };
+
+  virtual void DoRun (void);
+};
+
+AquaSimDbrNeighbTableTestCase::AquaSimDbrNeighbTableTestCase ()
+  : TestCase ("DBR neighbor table finds the shallowest neighbor")
+{
+}
+
+void
+AquaSimDbrNeighbTableTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (7);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  NeighbTable tab;
+  std::vector<Ref> ref;   // sorted by address
+  uint32_t found = 0;
+
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      AquaSimAddress addr ((uint16_t) rand->GetInteger (1, 400));
+      uint32_t i = 0;
+      while (i < ref.size () && ref[i].addr < addr)
+        i++;
+      bool known = i < ref.size () && ref[i].addr == addr;
+      uint32_t op = rand->GetInteger (0, 9);
+
+      if (op < 6)
+        {
+          NeighbEnt ne;
+          ne.m_netID = addr;
+          /* coarse depths so that ties are common */
+          ne.m_location = Vector (rand->GetValue (0, 100), rand->GetValue (0, 100),
+                                  -10.0 * rand->GetInteger (0, 40));
+          NeighbEnt *e = tab.EntAdd (&ne);
+          NS_TEST_ASSERT_MSG_EQ ((e->m_netID == addr), true, "wrong entry returned");
+          if (!known)
+            {
+              Ref r = {addr, 0, 0};
+              ref.insert (ref.begin () + i, r);
+            }
+          ref[i].z = ne.m_location.z;
+        }
+      else if (op < 8)
+        {
+          NeighbEnt ne;
+          ne.m_netID = addr;
+          tab.EntDelete (&ne);
+          if (known)
+            ref.erase (ref.begin () + i);
+        }
+      else if (op < 9)
+        {
+          /* routes are rare, so most lookups exercise the depth order */
+          int val = rand->GetValue () < 0.05 ? 1 : 0;
+          tab.UpdateRouteFlag (addr, val);
+          if (known)
+            ref[i].routeFlag = val;
+        }
+      else
+        {
+          double z = -10.0 * rand->GetInteger (0, 40);
+          int expect = -1;
+          double t = z;
+          for (uint32_t j = 0; j < ref.size (); j++)
+            {
+              if (ref[j].routeFlag == 1)
+                {
+                  expect = j;
+                  break;
+                }
+              if (ref[j].z > t)
+                {
+                  t = ref[j].z;
+                  expect = j;
+                }
+            }
+          NeighbEnt *ne = tab.EntFindShadowest (Vector (0, 0, z));
+          NS_TEST_ASSERT_MSG_EQ ((ne != 0), (expect >= 0), "neighbor presence differs");
+          if (ne && expect >= 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (ne->m_netID, ref[expect].addr, "wrong neighbor chosen");
+              found++;
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (tab.GetN (), (int) ref.size (), "table size differs");
+    }
+  NS_TEST_ASSERT_MSG_GT (found, 100, "too few neighbors chosen");
+}
+
+/**
+ * Both DBR tables on a few hand-picked operations with the expected
+ * eviction and neighbor choice written out.
+ */
+class AquaSimDbrKnownTestCase : public TestCase
+{
+public:
+  AquaSimDbrKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDbrKnownTestCase::AquaSimDbrKnownTestCase ()
+  : TestCase ("DBR cache and neighbor table on a fixed sequence")
+{
+}
+
+void
+AquaSimDbrKnownTestCase::DoRun (void)
+{
+  /* 1 is touched after 2 and 3, so adding 4 to a full cache evicts 2 */
+  ASPktCache pc (3);
+  pc.AddPacket (1);
+  pc.AddPacket (2);
+  pc.AddPacket (3);
+  NS_TEST_ASSERT_MSG_EQ (pc.AccessPacket (1), 1, "1 cached");
+  pc.AddPacket (4);
+  NS_TEST_ASSERT_MSG_EQ (pc.Size (), 3, "capacity kept");
+  NS_TEST_ASSERT_MSG_EQ (pc.AccessPacket (2), 0, "2 evicted");
+  NS_TEST_ASSERT_MSG_EQ (pc.AccessPacket (1), 1, "1 kept");
+  NS_TEST_ASSERT_MSG_EQ (pc.AccessPacket (3), 1, "3 kept");
+  NS_TEST_ASSERT_MSG_EQ (pc.AccessPacket (4), 1, "4 added");
+
+  /* 3 and 8 tie at -10 m, above 5 at -30 m */
+  NeighbTable tab;
+  const uint16_t addrs[] = {5, 8, 3};
+  const double depths[] = {-30, -10, -10};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NeighbEnt ne;
+      ne.m_netID = AquaSimAddress (addrs[i]);
+      ne.m_location = Vector (0, 0, depths[i]);
+      tab.EntAdd (&ne);
+    }
+  NeighbEnt *ne = tab.EntFindShadowest (Vector (0, 0, -50));
+  NS_TEST_ASSERT_MSG_EQ ((ne && ne->m_netID == AquaSimAddress (3)), true, "lowest address on the tie");
+  NS_TEST_ASSERT_MSG_EQ ((tab.EntFindShadowest (Vector (0, 0, -10)) == 0), true, "nothing above -10 m");
+  tab.UpdateRouteFlag (AquaSimAddress (5), 1);
+  ne = tab.EntFindShadowest (Vector (0, 0, -50));
+  NS_TEST_ASSERT_MSG_EQ ((ne && ne->m_netID == AquaSimAddress (5)), true, "routed neighbor first");
+}
+
+class AquaSimDbrCacheTestSuite : public TestSuite
+{
+public:
+  AquaSimDbrCacheTestSuite ();
+};
+
+AquaSimDbrCacheTestSuite::AquaSimDbrCacheTestSuite ()
+  : TestSuite ("aqua-sim-dbr-cache", UNIT)
+{
+  AddTestCase (new AquaSimDbrPktCacheTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDbrNeighbTableTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDbrKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimDbrCacheTestSuite aquaSimDbrCacheTestSuite;
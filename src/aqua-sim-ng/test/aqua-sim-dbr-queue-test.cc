@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <set>
+#include <tuple>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-routing-dbr.h"
+
+using namespace ns3;
+
+/**
+ * Random insert/update/purge/pop sequences on the DBR sending queue; the
+ * front must always be the earliest item, first-inserted among equal send
+ * times, as with the old sorted deque.
+ */
+class AquaSimDbrQueueTestCase : public TestCase
+{
+public:
+  AquaSimDbrQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDbrQueueTestCase::AquaSimDbrQueueTestCase ()
+  : TestCase ("DBR sending queue keeps send-time order")
+{
+}
+
+void
+AquaSimDbrQueueTestCase::DoRun (void)
+{
+  typedef std::tuple<double, uint64_t, uint32_t> Key;   // time, insertion, id
+  RngSeedManager::SetSeed (5);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  Ptr<Packet> pkt = Create<Packet> (16);
+
+  MyPacketQueue q;
+  std::set<Key> order;
+  std::map<uint32_t, Key> byId;
+  uint64_t seq = 0;
+
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      uint32_t id = rand->GetInteger (0, 300);
+      /* coarse times so that ties are common */
+      double t = rand->GetInteger (0, 50) * 0.1;
+      std::map<uint32_t, Key>::iterator it = byId.find (id);
+      uint32_t op = rand->GetInteger (0, 3);
+
+      if (op == 0)
+        {
+          /* forwarding path: update, then insert if asked to */
+          bool expect = it == byId.end () || std::get<0> (it->second) > t;
+          bool got = q.update (id, t);
+          NS_TEST_ASSERT_MSG_EQ (got, expect, "update verdict differs");
+          if (got)
+            {
+              if (it != byId.end ())
+                {
+                  order.erase (it->second);
+                  byId.erase (it);
+                }
+              q.insert (new QueueItemDbr (pkt, id, t));
+              Key k (t, seq++, id);
+              order.insert (k);
+              byId[id] = k;
+            }
+        }
+      else if (op == 1)
+        {
+          /* direct insert replaces a queued item with the same ID */
+          if (it != byId.end ())
+            {
+              order.erase (it->second);
+              byId.erase (it);
+            }
+          q.insert (new QueueItemDbr (pkt, id, t));
+          Key k (t, seq++, id);
+          order.insert (k);
+          byId[id] = k;
+        }
+      else if (op == 2)
+        {
+          bool queued = it != byId.end ();
+          NS_TEST_ASSERT_MSG_EQ (q.purge (id), queued, "purge verdict differs");
+          if (it != byId.end ())
+            {
+              order.erase (it->second);
+              byId.erase (it);
+            }
+        }
+      else if (!order.empty ())
+        {
+          QueueItemDbr *front = q.front ();
+          NS_TEST_ASSERT_MSG_EQ (front->m_packetId, std::get<2> (*order.begin ()), "wrong item popped");
+          q.pop ();
+          delete front;
+          byId.erase (std::get<2> (*order.begin ()));
+          order.erase (order.begin ());
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (q.size (), (int) order.size (), "queue size differs");
+      if (!order.empty ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (q.front ()->m_packetId, std::get<2> (*order.begin ()), "wrong front");
+          NS_TEST_ASSERT_MSG_EQ (q.front ()->m_sendTime, std::get<0> (*order.begin ()), "wrong front time");
+        }
+    }
+}
+
+/**
+ * A fixed sequence with the resulting send order written out: ties keep
+ * insertion order and an earlier update moves an item forward.
+ */
+class AquaSimDbrQueueKnownTestCase : public TestCase
+{
+public:
+  AquaSimDbrQueueKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDbrQueueKnownTestCase::AquaSimDbrQueueKnownTestCase ()
+  : TestCase ("DBR sending queue on a fixed sequence")
+{
+}
+
+void
+AquaSimDbrQueueKnownTestCase::DoRun (void)
+{
+  Ptr<Packet> pkt = Create<Packet> (16);
+  MyPacketQueue q;
+  q.insert (new QueueItemDbr (pkt, 1, 0.3));
+  q.insert (new QueueItemDbr (pkt, 2, 0.1));
+  q.insert (new QueueItemDbr (pkt, 3, 0.3));
+  q.insert (new QueueItemDbr (pkt, 4, 0.4));
+
+  NS_TEST_ASSERT_MSG_EQ (q.update (1, 0.5), false, "a later time is not an update");
+  NS_TEST_ASSERT_MSG_EQ (q.update (4, 0.2), true, "an earlier time is");
+  q.insert (new QueueItemDbr (pkt, 4, 0.2));
+  NS_TEST_ASSERT_MSG_EQ (q.purge (2), true, "2 was queued");
+  NS_TEST_ASSERT_MSG_EQ (q.purge (2), false, "2 is gone");
+  NS_TEST_ASSERT_MSG_EQ (q.size (), 3, "three items left");
+
+  const uint32_t expect[] = {4, 1, 3};
+  const double times[] = {0.2, 0.3, 0.3};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      QueueItemDbr *front = q.front ();
+      NS_TEST_ASSERT_MSG_EQ (front->m_packetId, expect[i], "send order");
+      NS_TEST_ASSERT_MSG_EQ (front->m_sendTime, times[i], "send time");
+      q.pop ();
+      delete front;
+    }
+  NS_TEST_ASSERT_MSG_EQ (q.size (), 0, "queue drained");
+}
+
+class AquaSimDbrQueueTestSuite : public TestSuite
+{
+public:
+  AquaSimDbrQueueTestSuite ();
+};
+
+AquaSimDbrQueueTestSuite::AquaSimDbrQueueTestSuite ()
+  : TestSuite ("aqua-sim-dbr-queue", UNIT)
+{
+  AddTestCase (new AquaSimDbrQueueTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDbrQueueKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimDbrQueueTestSuite aquaSimDbrQueueTestSuite;
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-ddos-model.h"
+#include "ns3/svm.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * The online SVM learns a linearly separable labelling, and only claims to
+ * be trained after enough samples of both classes.
+ */
+class AquaSimDdosModelLearnTestCase : public TestCase
+{
+public:
+  AquaSimDdosModelLearnTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDdosModelLearnTestCase::AquaSimDdosModelLearnTestCase ()
+  : TestCase ("Online DDoS SVM separates a linear labelling")
+{
+}
+
+void
+AquaSimDdosModelLearnTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (19);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  AquaSimDdosModel model (0.001, 100);
+  for (uint32_t i = 0; i < 150; i++)
+    model.Learn (SvmInput (rand->GetValue (), rand->GetValue (), false));
+  NS_TEST_ASSERT_MSG_EQ (model.IsTrained (), false, "trained on a single class");
+
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      double t = rand->GetValue (), m = rand->GetValue ();
+      model.Learn (SvmInput (t, m, t + m > 1.2));
+    }
+  NS_TEST_ASSERT_MSG_EQ (model.IsTrained (), true, "not trained after both classes");
+
+  std::vector<SvmInput> batch;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      double t = rand->GetValue (), m = rand->GetValue ();
+      batch.push_back (SvmInput (t, m, t + m > 1.2));
+    }
+  std::vector<double> labels;
+  model.Classify (batch, labels);
+  NS_TEST_ASSERT_MSG_EQ (labels.size (), batch.size (), "batch size differs");
+  uint32_t correct = 0;
+  for (uint32_t i = 0; i < batch.size (); i++)
+    {
+      bool agrees = (model.Decision (batch[i].timeoutR, batch[i].maxR) > 0) == (labels[i] == 1);
+      NS_TEST_ASSERT_MSG_EQ (agrees, true, "batch label differs from the decision value");
+      correct += (labels[i] == 1) == batch[i].compromised;
+    }
+  NS_TEST_ASSERT_MSG_GT (correct, 1900, "accuracy under 95%");
+}
+
+/**
+ * A snapshot is a libsvm model that predicts what the in-memory model
+ * does, and detectors share one model while any of them holds it.
+ */
+class AquaSimDdosModelSnapshotTestCase : public TestCase
+{
+public:
+  AquaSimDdosModelSnapshotTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDdosModelSnapshotTestCase::AquaSimDdosModelSnapshotTestCase ()
+  : TestCase ("DDoS SVM snapshots load in libsvm and the model is shared")
+{
+}
+
+void
+AquaSimDdosModelSnapshotTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (23);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  std::string file = CreateTempDirFilename ("ddos_svm.model");
+
+  std::shared_ptr<AquaSimDdosModel> model = AquaSimDdosModel::GetShared (0.01, 10);
+  NS_TEST_ASSERT_MSG_EQ ((AquaSimDdosModel::GetShared (0.5, 1) == model), true, "model not shared");
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      double t = rand->GetValue (), m = rand->GetValue ();
+      model->Learn (SvmInput (t, m, 2 * t + m > 1.5));
+    }
+  NS_TEST_ASSERT_MSG_EQ (model->Snapshot (file), true, "snapshot not started");
+  NS_TEST_ASSERT_MSG_EQ (model->Snapshot (file), false, "unchanged model written again");
+  NS_TEST_ASSERT_MSG_EQ (model->WaitSnapshot (), true, "snapshot failed");
+
+  struct svm_model *loaded = svm_load_model (file.c_str ());
+  NS_TEST_ASSERT_MSG_NE ((loaded == NULL), true, "libsvm cannot load the snapshot");
+  if (loaded != NULL)
+    {
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          struct svm_node x[3];
+          x[0].index = 0;
+          x[0].value = rand->GetValue ();
+          x[1].index = 1;
+          x[1].value = rand->GetValue ();
+          x[2].index = -1;
+          double decision = model->Decision (x[0].value, x[1].value);
+          if (decision > -1e-9 && decision < 1e-9)
+            continue;
+          double label = svm_predict (loaded, x);
+          NS_TEST_ASSERT_MSG_EQ (label, (decision > 0 ? 1 : 0), "libsvm prediction differs");
+        }
+      svm_free_and_destroy_model (&loaded);
+    }
+  remove (file.c_str ());
+
+  model.reset ();
+  std::shared_ptr<AquaSimDdosModel> fresh = AquaSimDdosModel::GetShared (0.01, 10);
+  NS_TEST_ASSERT_MSG_EQ (fresh->GetNSamples (), 0, "released model was reused");
+}
+
+/**
+ * Two Pegasos steps with lambda 0.5 worked out by hand. The first step
+ * sets w = 2 x = (2, 1, 2), which the projection scales onto the ball of
+ * radius sqrt(2); the second halves that and subtracts x = (0, 1, 1).
+ */
+class AquaSimDdosModelKnownTestCase : public TestCase
+{
+public:
+  AquaSimDdosModelKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDdosModelKnownTestCase::AquaSimDdosModelKnownTestCase ()
+  : TestCase ("DDoS SVM steps on fixed samples")
+{
+}
+
+void
+AquaSimDdosModelKnownTestCase::DoRun (void)
+{
+  const double r = std::sqrt (2.0);
+  AquaSimDdosModel model (0.5, 2);
+
+  model.Learn (SvmInput (1, 0.5, true));
+  NS_TEST_ASSERT_MSG_EQ (model.IsTrained (), false, "one class only");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.GetWeight (0), 2 * r / 3, 1e-12, "projected timeoutR weight");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.GetWeight (1), r / 3, 1e-12, "projected maxR weight");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.GetBias (), 2 * r / 3, 1e-12, "projected bias");
+
+  model.Learn (SvmInput (0, 1, false));
+  NS_TEST_ASSERT_MSG_EQ (model.IsTrained (), true, "both classes seen");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.GetWeight (0), 0.47140452079103173, 1e-12, "timeoutR weight");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.GetWeight (1), -0.7642977396044841, 1e-12, "maxR weight");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.GetBias (), -0.5285954792089682, 1e-12, "bias");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model.Decision (1, 0), 2 * r / 3 - 1, 1e-12, "decision at (1, 0)");
+}
+
+class AquaSimDdosModelTestSuite : public TestSuite
+{
+public:
+  AquaSimDdosModelTestSuite ();
+};
+
+AquaSimDdosModelTestSuite::AquaSimDdosModelTestSuite ()
+  : TestSuite ("aqua-sim-ddos-model", UNIT)
+{
+  AddTestCase (new AquaSimDdosModelLearnTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDdosModelSnapshotTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDdosModelKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimDdosModelTestSuite aquaSimDdosModelTestSuite;
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-routing-ddos.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Running DdosNodeStats must report what the queued samples gave before:
+ * the rounded window mean at each read, the compromised transaction count,
+ * and per rule set hit counts among compromised transactions.
+ */
+class AquaSimDdosStatsTestCase : public TestCase
+{
+public:
+  AquaSimDdosStatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDdosStatsTestCase::AquaSimDdosStatsTestCase ()
+  : TestCase ("DDoS running statistics match the queued sample history")
+{
+}
+
+void
+AquaSimDdosStatsTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (17);
+  RngSeedManager::SetRun (3);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  double ruleset[] = {0.6, 0.6, 0.5, 0.5};
+  std::vector<double> rules (ruleset, ruleset + 4);
+  DdosNodeStats stats;
+  std::vector<MachineLearningStruct> window, history;
+  uint32_t reads = 0;
+
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      MachineLearningStruct t;
+      t.mobility = rand->GetValue ();
+      t.pushback = rand->GetValue ();
+      t.throttle = rand->GetValue ();
+      t.timeout = rand->GetValue ();
+      stats.Add (t, rules, 0);
+      window.push_back (t);
+
+      if (rand->GetValue () > 0.05 || window.size () < 10)
+        continue;
+
+      MachineLearningStruct sum;
+      for (uint32_t j = 0; j < window.size (); j++)
+        {
+          sum.mobility += window[j].mobility;
+          sum.pushback += window[j].pushback;
+          sum.throttle += window[j].throttle;
+          sum.timeout += window[j].timeout;
+        }
+      NS_TEST_ASSERT_MSG_EQ (stats.pending, window.size (), "pending sample count differs");
+      MachineLearningStruct dist = stats.ReadDistribution ();
+      // rounding to 4 decimals may flip on the last bit of the sum
+      NS_TEST_ASSERT_MSG_EQ_TOL (dist.mobility, sum.mobility / window.size (), 1.01e-4, "mobility mean differs");
+      NS_TEST_ASSERT_MSG_EQ_TOL (dist.pushback, sum.pushback / window.size (), 1.01e-4, "pushback mean differs");
+      NS_TEST_ASSERT_MSG_EQ_TOL (dist.throttle, sum.throttle / window.size (), 1.01e-4, "throttle mean differs");
+      NS_TEST_ASSERT_MSG_EQ_TOL (dist.timeout, sum.timeout / window.size (), 1.01e-4, "timeout mean differs");
+      NS_TEST_ASSERT_MSG_EQ (stats.pending, 0, "read did not reset the window");
+      history.insert (history.end (), window.begin (), window.end ());
+      window.clear ();
+      reads++;
+    }
+
+  // the rule evaluation the queued transactions went through
+  uint32_t compromised = 0;
+  uint32_t support[4] = {0, 0, 0, 0};
+  for (uint32_t j = 0; j < history.size (); j++)
+    {
+      const MachineLearningStruct &t = history[j];
+      bool hit[4] = {(t.mobility + t.pushback + t.timeout) > rules[0] * 3,
+                     (t.mobility + t.throttle + t.timeout) > rules[1] * 3,
+                     (t.pushback + t.timeout) > rules[2] * 2,
+                     (t.throttle + t.timeout) > rules[3] * 2};
+      if (hit[0] + hit[1] + hit[2] + hit[3] < 2)
+        continue;
+      compromised++;
+      for (int r = 0; r < 4; r++)
+        support[r] += hit[r];
+    }
+
+  NS_TEST_ASSERT_MSG_GT (reads, 20, "too few windows were read");
+  NS_TEST_ASSERT_MSG_EQ (stats.transactions, history.size (), "transaction count differs");
+  NS_TEST_ASSERT_MSG_EQ (stats.compromised, compromised, "compromised count differs");
+  NS_TEST_ASSERT_MSG_GT (compromised, 0, "no compromised transactions");
+  for (int r = 0; r < 4; r++)
+    {
+      uint32_t hits = 0;
+      for (int m = 0; m < DdosNodeStats::RULE_MASKS; m++)
+        if (m & (1 << r))
+          hits += stats.masks[m];
+      NS_TEST_ASSERT_MSG_EQ (hits, support[r], "support differs for rule set " << r);
+    }
+}
+
+/**
+ * With a sample weight the mean is an exponentially weighted average that
+ * carries over between reads.
+ */
+class AquaSimDdosEwmaTestCase : public TestCase
+{
+public:
+  AquaSimDdosEwmaTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDdosEwmaTestCase::AquaSimDdosEwmaTestCase ()
+  : TestCase ("DDoS running statistics keep an exponentially weighted mean")
+{
+}
+
+void
+AquaSimDdosEwmaTestCase::DoRun (void)
+{
+  std::vector<double> rules (4, 0.6);
+  DdosNodeStats stats;
+  const double weight = 0.25;
+  double expected = 0;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      MachineLearningStruct t;
+      t.timeout = (i % 7) / 7.0;
+      expected = (i == 0) ? t.timeout : (1 - weight) * expected + weight * t.timeout;
+      stats.Add (t, rules, weight);
+      if (i % 25 == 24)
+        {
+          MachineLearningStruct dist = stats.ReadDistribution ();
+          NS_TEST_ASSERT_MSG_EQ_TOL (dist.timeout, expected, 1.01e-4, "weighted mean differs at " << i);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (stats.samples, 200, "sample count differs");
+}
+
+/**
+ * Three samples with their rule masks and window mean worked out by hand.
+ */
+class AquaSimDdosStatsKnownTestCase : public TestCase
+{
+public:
+  AquaSimDdosStatsKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimDdosStatsKnownTestCase::AquaSimDdosStatsKnownTestCase ()
+  : TestCase ("DDoS running statistics on fixed samples")
+{
+}
+
+void
+AquaSimDdosStatsKnownTestCase::DoRun (void)
+{
+  /* thresholds 1.5 on the three-field sums and 1.0 on the pairs */
+  std::vector<double> rules (4, 0.5);
+  DdosNodeStats stats;
+  MachineLearningStruct a, b, c;
+  a.mobility = 0.75; a.pushback = 0.75; a.throttle = 0.25; a.timeout = 0.5;
+  c.mobility = 0.25; c.pushback = 0.25; c.throttle = 1; c.timeout = 0.75;
+
+  NS_TEST_ASSERT_MSG_EQ (DdosNodeStats::RuleMask (a, rules), 5, "a hits rule sets 0 and 2");
+  NS_TEST_ASSERT_MSG_EQ (DdosNodeStats::RuleMask (b, rules), 0, "b hits nothing");
+  NS_TEST_ASSERT_MSG_EQ (DdosNodeStats::RuleMask (c, rules), 10, "c hits rule sets 1 and 3");
+
+  stats.Add (a, rules, 0);
+  stats.Add (b, rules, 0);
+  stats.Add (c, rules, 0);
+  MachineLearningStruct dist = stats.ReadDistribution ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (dist.mobility, 0.3333, 1e-12, "mobility mean 1/3");
+  NS_TEST_ASSERT_MSG_EQ_TOL (dist.pushback, 0.3333, 1e-12, "pushback mean 1/3");
+  NS_TEST_ASSERT_MSG_EQ_TOL (dist.throttle, 0.4166, 1e-12, "throttle mean 5/12");
+  NS_TEST_ASSERT_MSG_EQ_TOL (dist.timeout, 0.4166, 1e-12, "timeout mean 5/12");
+  NS_TEST_ASSERT_MSG_EQ (stats.transactions, 3, "three transactions");
+  NS_TEST_ASSERT_MSG_EQ (stats.compromised, 2, "a and c compromised");
+  NS_TEST_ASSERT_MSG_EQ (stats.masks[5], 1, "a's mask counted");
+  NS_TEST_ASSERT_MSG_EQ (stats.masks[10], 1, "c's mask counted");
+  NS_TEST_ASSERT_MSG_EQ (stats.masks[0], 0, "b is not compromised");
+  NS_TEST_ASSERT_MSG_EQ (stats.pending, 0, "read clears the window");
+}
+
+class AquaSimDdosStatsTestSuite : public TestSuite
+{
+public:
+  AquaSimDdosStatsTestSuite ();
+};
+
+AquaSimDdosStatsTestSuite::AquaSimDdosStatsTestSuite ()
+  : TestSuite ("aqua-sim-ddos-stats", UNIT)
+{
+  AddTestCase (new AquaSimDdosStatsTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDdosEwmaTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimDdosStatsKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimDdosStatsTestSuite aquaSimDdosStatsTestSuite;
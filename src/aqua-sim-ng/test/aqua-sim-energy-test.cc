@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/mobility-helper.h"
+
+#include "ns3/aqua-sim-helper.h"
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-phy-cmn.h"
+#include "ns3/aqua-sim-energy-model.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-header-mac.h"
+
+using namespace ns3;
+
+/**
+ * Both the lazy and the periodic idle accounting must leave every node with
+ * the energy worked out from its tx, rx and idle time by hand, the lazy one
+ * using far fewer events.
+ */
+class AquaSimLazyEnergyTestCase : public TestCase
+{
+public:
+  AquaSimLazyEnergyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  uint64_t RunNetwork (Time interval, std::vector<double> &energy);
+  static void Transmit (Ptr<AquaSimNetDevice> dev);
+
+  static const uint32_t N = 4;
+  static constexpr double SPACING = 750;   // 0.5 s at 1500 m/s
+  static constexpr double TX_TIME = 1.5;
+  static constexpr double TX_POWER = 0.5;
+  static constexpr double RX_POWER = 0.25;
+  static constexpr double IDLE_POWER = 0.01;
+  static constexpr double INITIAL = 100;
+  static constexpr double STOP = 250.7;
+  static constexpr double OFF = 120.5;
+  static constexpr double ON = 160.25;
+};
+
+AquaSimLazyEnergyTestCase::AquaSimLazyEnergyTestCase ()
+  : TestCase ("Lazy and periodic idle energy match the hand-computed budget")
+{
+}
+
+/* the sends: node k % N at 3.3 + 17.1 k, none while node 2 is powered off */
+static const uint32_t g_sends[] = { 0, 1, 2, 3, 4, 5, 10, 11 };
+
+/* hands a packet straight to the PHY, which charges TX_TIME of tx energy */
+void
+AquaSimLazyEnergyTestCase::Transmit (Ptr<AquaSimNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (60);
+  MacHeader mach;
+  AquaSimHeader ash;
+  ash.SetSize (60);
+  ash.SetDirection (AquaSimHeader::DOWN);
+  ash.SetTxTime (Seconds (TX_TIME));
+  AquaSimPacketStamp pstamp;
+  p->AddHeader (mach);
+  p->AddHeader (ash);
+  p->AddHeader (pstamp);
+  dev->SetTransmissionStatus (SEND);
+  dev->GetPhy ()->Recv (p);
+}
+
+uint64_t
+AquaSimLazyEnergyTestCase::RunNetwork (Time interval, std::vector<double> &energy)
+{
+  NodeContainer nodes;
+  nodes.Create (N);
+
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  /* StampTxInfo() sets the model's TxPower to the PHY's PT, keep them equal */
+  asHelper.SetPhy ("ns3::AquaSimPhyCmn", "EnergyUpdateInterval", TimeValue (interval),
+                   "PT", DoubleValue (TX_POWER));
+  asHelper.SetEnergyModel ("ns3::AquaSimEnergyModel",
+                           "InitialEnergy", DoubleValue (INITIAL),
+                           "TxPower", DoubleValue (TX_POWER),
+                           "RxPower", DoubleValue (RX_POWER),
+                           "IdlePower", DoubleValue (IDLE_POWER));
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> position = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    position->Add (Vector (i * SPACING, 0, 0));
+  mobility.SetPositionAllocator (position);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  std::vector<Ptr<AquaSimNetDevice> > devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      asHelper.Create (nodes.Get (i), dev);
+      dev->MacEnabled (false);   // receptions stop at the PHY, nothing is relayed
+      devices.push_back (dev);
+    }
+
+  for (uint32_t s = 0; s < sizeof (g_sends) / sizeof (g_sends[0]); s++)
+    {
+      uint32_t k = g_sends[s];
+      Simulator::Schedule (Seconds (3.3 + k * 17.1), &AquaSimLazyEnergyTestCase::Transmit,
+                           devices[k % N]);
+    }
+  Simulator::Schedule (Seconds (OFF), &AquaSimPhy::PowerOff, devices[2]->GetPhy ());
+  Simulator::Schedule (Seconds (ON), &AquaSimPhy::PowerOn, devices[2]->GetPhy ());
+
+  Simulator::Stop (Seconds (STOP));
+  Simulator::Run ();
+
+  energy.clear ();
+  for (uint32_t i = 0; i < devices.size (); i++)
+    energy.push_back (devices[i]->EnergyModel ()->GetEnergy ());
+  uint64_t events = Simulator::GetEventCount ();
+  devices.clear ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+AquaSimLazyEnergyTestCase::DoRun (void)
+{
+  uint32_t nSends = sizeof (g_sends) / sizeof (g_sends[0]);
+
+  /* every other node hears each send. The channel stamps the propagation
+     delay as the copy's TxTime, and that is what a reception is charged. */
+  std::vector<double> txTime (N, 0), rxTime (N, 0);
+  for (uint32_t s = 0; s < nSends; s++)
+    {
+      uint32_t src = g_sends[s] % N;
+      txTime[src] += TX_TIME;
+      for (uint32_t i = 0; i < N; i++)
+        rxTime[i] += (i > src ? i - src : src - i) * SPACING / 1500;
+    }
+
+  Time intervals[] = { Seconds (1), Seconds (0) };
+  uint64_t events[2];
+  for (uint32_t run = 0; run < 2; run++)
+    {
+      std::vector<double> energy;
+      events[run] = RunNetwork (intervals[run], energy);
+      for (uint32_t i = 0; i < N; i++)
+        {
+          double off = (i == 2) ? ON - OFF : 0;
+          double idle = STOP - off - txTime[i] - rxTime[i];
+          double expected = INITIAL - idle * IDLE_POWER - txTime[i] * TX_POWER
+            - rxTime[i] * RX_POWER;
+          NS_TEST_ASSERT_MSG_EQ_TOL (energy[i], expected, 1e-6,
+                                     "energy of node " << i << ", interval " << intervals[run]);
+        }
+    }
+  NS_TEST_ASSERT_MSG_LT (events[1] + 4 * 200, events[0], "lazy accounting did not save events");
+}
+
+/**
+ * Energy model recording when the phy reports depletion.
+ */
+class DepletionRecorder : public AquaSimEnergyModel
+{
+public:
+  DepletionRecorder () : m_depleted (-1) {}
+  virtual void HandleEnergyDepletion (void)
+  {
+    if (m_depleted < 0)
+      m_depleted = Simulator::Now ().GetSeconds ();
+    AquaSimEnergyModel::HandleEnergyDepletion ();
+  }
+  double m_depleted;
+};
+
+/**
+ * An idle node must deplete through the single predicted event, at the
+ * instant its idle drain exhausts the initial energy. Reading the energy
+ * on the way projects the drain without charging it.
+ */
+class AquaSimEnergyDepletionTestCase : public TestCase
+{
+public:
+  AquaSimEnergyDepletionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Query (Ptr<AquaSimEnergyModel> em);
+
+  double m_energy;
+  double m_consumed;
+};
+
+AquaSimEnergyDepletionTestCase::AquaSimEnergyDepletionTestCase ()
+  : TestCase ("Idle depletion is scheduled as one predicted event"),
+    m_energy (-1),
+    m_consumed (-1)
+{
+}
+
+void
+AquaSimEnergyDepletionTestCase::Query (Ptr<AquaSimEnergyModel> em)
+{
+  m_energy = em->GetEnergy ();
+  m_consumed = em->GetTotalEnergyConsumption ();
+}
+
+void
+AquaSimEnergyDepletionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+
+  Ptr<DepletionRecorder> em = CreateObject<DepletionRecorder> ();
+  em->SetIdlePower (0.008);
+  em->SetInitialEnergy (0.3);
+  Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+  dev->SetEnergyModel (em);
+  asHelper.Create (nodes.Get (0), dev);
+
+  Simulator::Schedule (Seconds (10), &AquaSimEnergyDepletionTestCase::Query, this, em);
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_energy, 0.3 - 10 * 0.008, 1e-9, "projected energy at 10 s");
+  NS_TEST_ASSERT_MSG_EQ (m_consumed, 0, "querying the energy charged the idle drain");
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (em->m_depleted, 0.3 / 0.008, 1e-6, "depleted at the wrong time");
+  /* periodic settlement would have taken 100 events on its own */
+  NS_TEST_ASSERT_MSG_LT (Simulator::GetEventCount (), 10, "idle drain is still event driven");
+
+  Simulator::Destroy ();
+}
+
+class AquaSimEnergyTestSuite : public TestSuite
+{
+public:
+  AquaSimEnergyTestSuite ();
+};
+
+AquaSimEnergyTestSuite::AquaSimEnergyTestSuite ()
+  : TestSuite ("aqua-sim-energy", UNIT)
+{
+  AddTestCase (new AquaSimLazyEnergyTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimEnergyDepletionTestCase, TestCase::QUICK);
+}
+
+static AquaSimEnergyTestSuite aquaSimEnergyTestSuite;
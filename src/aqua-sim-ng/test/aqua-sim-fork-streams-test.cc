@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-helper.h"
+#include "ns3/aqua-sim-application-helper.h"
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace ns3;
+
+/**
+ * Run a small on/off network up to a branch point, then fork three
+ * children the way scratch/uwsn-ids.cc --branches does: each selects a run
+ * and reassigns the streams of the devices, channel and applications.
+ * Siblings on different runs must send different traffic after the branch,
+ * siblings on the same run the same traffic.
+ */
+class AquaSimForkStreamsTestCase : public TestCase
+{
+public:
+  AquaSimForkStreamsTestCase ();
+
+private:
+  struct Digest {
+    uint64_t sent;
+    uint64_t hash;
+  };
+
+  virtual void DoRun (void);
+  void Sent (Ptr<const Packet> p);
+
+  Digest m_digest;
+};
+
+AquaSimForkStreamsTestCase::AquaSimForkStreamsTestCase ()
+  : TestCase ("Sibling forks draw application traffic from their own run")
+{
+}
+
+void
+AquaSimForkStreamsTestCase::Sent (Ptr<const Packet> p)
+{
+  m_digest.sent++;
+  m_digest.hash = m_digest.hash * 1000003
+    + Simulator::Now ().GetNanoSeconds () * (Simulator::GetContext () + 1);
+}
+
+void
+AquaSimForkStreamsTestCase::DoRun (void)
+{
+  const uint32_t runs[] = {7, 8, 7};
+  RngSeedManager::SetSeed (3);
+  RngSeedManager::SetRun (1);
+
+  NodeContainer nodes;
+  nodes.Create (3);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    positions->Add (Vector (100.0 * i, 0, -50));
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (nodes);
+
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    devices.Add (asHelper.Create (nodes.Get (i), CreateObject<AquaSimNetDevice> ()));
+
+  PacketSocketHelper socketHelper;
+  socketHelper.Install (nodes);
+  AquaSimApplicationHelper app ("ns3::PacketSocketFactory", nodes.GetN ());
+  app.SetAttribute ("OnTime", StringValue ("ns3::ExponentialRandomVariable[Mean=2]"));
+  app.SetAttribute ("OffTime", StringValue ("ns3::ExponentialRandomVariable[Mean=5]"));
+  app.SetAttribute ("DataRate", DataRateValue (DataRate ("1kb/s")));
+  app.SetAttribute ("PacketSize", UintegerValue (50));
+  ApplicationContainer apps = app.Install (nodes);
+  apps.Start (Seconds (0.5));
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    apps.Get (i)->TraceConnectWithoutContext ("Tx", MakeCallback (&AquaSimForkStreamsTestCase::Sent, this));
+
+  Simulator::Stop (Seconds (50));
+  Simulator::Run ();
+
+  Digest digests[3];
+  for (uint32_t k = 0; k < 3; k++)
+    {
+      int fd[2];
+      NS_TEST_ASSERT_MSG_EQ (pipe (fd), 0, "pipe failed");
+      pid_t pid = fork ();
+      NS_TEST_ASSERT_MSG_NE ((pid < 0), true, "fork failed");
+      if (pid == 0)
+        {
+          close (fd[0]);
+          RngSeedManager::SetRun (runs[k]);
+          int64_t stream = asHelper.AssignStreams (devices, 0);
+          app.AssignStreams (nodes, stream);
+          m_digest.sent = 0;
+          m_digest.hash = 0;
+          Simulator::Stop (Seconds (100));
+          Simulator::Run ();
+          bool ok = write (fd[1], &m_digest, sizeof (m_digest)) == sizeof (m_digest);
+          _exit (ok ? 0 : 1);
+        }
+      close (fd[1]);
+      bool ok = read (fd[0], &digests[k], sizeof (Digest)) == sizeof (Digest);
+      close (fd[0]);
+      int status;
+      waitpid (pid, &status, 0);
+      NS_TEST_ASSERT_MSG_EQ ((ok && WIFEXITED (status) && WEXITSTATUS (status) == 0), true,
+                             "branch " << k << " failed");
+    }
+
+  NS_TEST_ASSERT_MSG_GT (digests[0].sent, 0, "nothing sent after the branch");
+  NS_TEST_ASSERT_MSG_EQ (digests[0].sent, digests[2].sent, "same run, different traffic");
+  NS_TEST_ASSERT_MSG_EQ (digests[0].hash, digests[2].hash, "same run, different send times");
+  NS_TEST_ASSERT_MSG_NE (digests[0].hash, digests[1].hash, "sibling runs share their traffic");
+
+  Simulator::Destroy ();
+}
+
+class AquaSimForkStreamsTestSuite : public TestSuite
+{
+public:
+  AquaSimForkStreamsTestSuite ();
+};
+
+AquaSimForkStreamsTestSuite::AquaSimForkStreamsTestSuite ()
+  : TestSuite ("aqua-sim-fork-streams", UNIT)
+{
+  AddTestCase (new AquaSimForkStreamsTestCase, TestCase::QUICK);
+}
+
+static AquaSimForkStreamsTestSuite aquaSimForkStreamsTestSuite;
@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/constant-position-mobility-model.h"
+
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-phy-cmn.h"
+#include "ns3/aqua-sim-signal-cache.h"
+#include "ns3/aqua-sim-sinr-checker.h"
+#include "ns3/aqua-sim-noise-generator.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-header-mac.h"
+#include "ns3/aqua-sim-rx-info-tag.h"
+#include "ns3/aqua-sim-ids-detector.h"
+
+#include <cmath>
+#include <map>
+
+using namespace ns3;
+
+namespace {
+
+/// Received power at d metres for the detector's propagation model.
+double
+Power (double pT, double freq, double d)
+{
+  double f2 = freq * freq;
+  double thorp = 0.11 * f2 / (1 + f2) + 44 * f2 / (4100 + f2) + 0.000275 * f2 + 0.0003;
+  return pT / (d * d * std::exp (thorp * M_LN10 / 10000.0 * d));
+}
+
+/// A report from a sensor at pos, honest or with the position shifted.
+AquaSimIdsReception
+MakeReport (uint32_t node, Vector pos, Vector sink, double shift)
+{
+  AquaSimIdsReception rx;
+  double d = CalculateDistance (pos, sink);
+  rx.nodeId = node;
+  rx.reportedPos = Vector (pos.x + shift, pos.y + shift, pos.z);
+  rx.sendTime = Simulator::Now ();
+  rx.label = shift != 0;
+  rx.rssi = Power (20, 25, d);
+  rx.propDelay = Seconds (d / 1500);
+  return rx;
+}
+
+}  // namespace
+
+/**
+ * Features of honest reports are near zero and those of shifted reports are
+ * not; the threshold model flags exactly the shifted ones, in batches of
+ * BatchSize or after BatchInterval.
+ */
+class AquaSimIdsFeatureTestCase : public TestCase
+{
+public:
+  AquaSimIdsFeatureTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Send (Ptr<AquaSimIdsDetector> det, Ptr<UniformRandomVariable> rand, uint32_t i);
+  void Alert (const AquaSimIdsReception &rx);
+
+  Vector m_sink;
+  uint32_t m_sent;
+  uint32_t m_spoofed;
+  uint32_t m_alerts;
+  uint32_t m_wrong;
+};
+
+AquaSimIdsFeatureTestCase::AquaSimIdsFeatureTestCase ()
+  : TestCase ("IDS detector features and threshold batches flag spoofed positions"),
+    m_sink (500, 500, 950),
+    m_sent (0),
+    m_spoofed (0),
+    m_alerts (0),
+    m_wrong (0)
+{
+}
+
+void
+AquaSimIdsFeatureTestCase::Alert (const AquaSimIdsReception &rx)
+{
+  m_alerts++;
+  m_wrong += rx.label != 1;
+}
+
+void
+AquaSimIdsFeatureTestCase::Send (Ptr<AquaSimIdsDetector> det, Ptr<UniformRandomVariable> rand,
+                                 uint32_t i)
+{
+  Vector pos (rand->GetValue (0, 1000), rand->GetValue (0, 1000), rand->GetValue (0, 900));
+  double shift = i % 5 == 0 ? 500 : 0;
+  AquaSimIdsReception rx = MakeReport (i % 20, pos, m_sink, shift);
+  m_sent++;
+  m_spoofed += shift != 0;
+  det->Process (rx);
+}
+
+void
+AquaSimIdsFeatureTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (9);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  Ptr<ConstantPositionMobilityModel> sink = CreateObject<ConstantPositionMobilityModel> ();
+  sink->SetPosition (m_sink);
+  Ptr<AquaSimIdsDetector> det = CreateObject<AquaSimIdsDetector> ();
+  det->SetSinkMobility (sink);
+  // positions are redrawn for every report, so their implied speed is noise
+  det->SetModel (CreateObjectWithAttributes<AquaSimIdsThresholdModel> ("ReportedSpeed",
+                                                                        DoubleValue (0)));
+  det->SetAttribute ("BatchSize", UintegerValue (8));
+  det->SetAttribute ("BatchInterval", TimeValue (Seconds (100)));
+  det->TraceConnectWithoutContext ("Alert", MakeCallback (&AquaSimIdsFeatureTestCase::Alert, this));
+
+  // the RSSI inversion recovers the range over the whole sensor field
+  for (double d = 1; d < 2000; d *= 1.7)
+    NS_TEST_ASSERT_MSG_EQ_TOL (det->RssiRange (Power (20, 25, d)), d, d * 1e-6, "RSSI range");
+
+  // 100 reports every 10 s from 20 senders, four of which always lie: full
+  // batches of 8 plus a tail of 4 that goes out one BatchInterval after it
+  // started
+  for (uint32_t i = 0; i < 100; i++)
+    Simulator::Schedule (Seconds (10 * (i + 1)), &AquaSimIdsFeatureTestCase::Send, this, det, rand, i);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (det->GetNReceptions (), m_sent, "receptions lost");
+  NS_TEST_ASSERT_MSG_EQ (det->GetNBatches (), 13, "batching differs");
+  NS_TEST_ASSERT_MSG_EQ (m_alerts, m_spoofed, "alert count differs from spoofed reports");
+  NS_TEST_ASSERT_MSG_EQ (m_wrong, 0, "honest report flagged");
+  NS_TEST_ASSERT_MSG_EQ (det->GetTruePositives (), m_spoofed, "true positives");
+  NS_TEST_ASSERT_MSG_EQ (det->GetFalseNegatives (), 0, "false negatives");
+  bool bounded = det->GetMeanQueueDelay () > Seconds (0)
+      && det->GetMeanQueueDelay () < Seconds (100);
+  NS_TEST_ASSERT_MSG_EQ (bounded, true, "queue delay out of range");
+  uint32_t detected;
+  Time latency = det->GetMeanDetectionLatency (detected);
+  NS_TEST_ASSERT_MSG_EQ (detected, 4, "every spoofing sender is detected");
+  NS_TEST_ASSERT_MSG_LT (latency, Seconds (80), "detection latency too long");
+
+  det->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Logistic and SVM models trained on a labelled stream separate honest and
+ * spoofed reports they have not seen.
+ */
+class AquaSimIdsLearnTestCase : public TestCase
+{
+public:
+  AquaSimIdsLearnTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (Ptr<AquaSimIdsModel> model, std::string name);
+};
+
+AquaSimIdsLearnTestCase::AquaSimIdsLearnTestCase ()
+  : TestCase ("IDS logistic and SVM models learn to separate spoofed reports")
+{
+}
+
+void
+AquaSimIdsLearnTestCase::Check (Ptr<AquaSimIdsModel> model, std::string name)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  Vector sink (500, 500, 950);
+  std::vector<double> x;
+  std::vector<int> y;
+  for (uint32_t i = 0; i < 4000; i++)
+    {
+      Vector pos (rand->GetValue (0, 1000), rand->GetValue (0, 1000), rand->GetValue (0, 900));
+      double shift = rand->GetValue () < 0.2 ? rand->GetValue (100, 600) : 0;
+      double noise = rand->GetValue (0, 20);
+      AquaSimIdsReception rx = MakeReport (i, pos, sink, shift);
+      double range = CalculateDistance (rx.reportedPos, sink);
+      x.push_back (std::fabs (range - 1500 * rx.propDelay.GetSeconds ()) + noise);
+      x.push_back (std::fabs (range - CalculateDistance (pos, sink)) + noise);
+      x.push_back (rand->GetValue (0, 2));
+      x.push_back (rand->GetValue (0, 2) + (shift ? 20 : 0));
+      y.push_back (rx.label);
+    }
+
+  uint32_t half = y.size () / 2;
+  std::vector<double> before (half);
+  model->Score (&x[0], half, &before[0]);
+  for (uint32_t i = 0; i < half; i += 50)
+    model->Learn (&x[i * AquaSimIdsModel::N_FEATURES], &y[i], 50);
+
+  std::vector<double> score (half);
+  model->Score (&x[half * AquaSimIdsModel::N_FEATURES], half, &score[0]);
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < half; i++)
+    errors += (score[i] > 0) != (y[half + i] == 1);
+  NS_TEST_ASSERT_MSG_LT (errors, half / 100, name << " misclassifies held-out rows");
+  bool quiet = before[0] <= 0;
+  NS_TEST_ASSERT_MSG_EQ (quiet, true, name << " alerts before training");
+}
+
+void
+AquaSimIdsLearnTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (9);
+  RngSeedManager::SetRun (2);
+  Check (CreateObject<AquaSimIdsLogisticModel> (), "logistic");
+  Check (CreateObject<AquaSimIdsSvmModel> (), "svm");
+  Simulator::Destroy ();
+}
+
+/**
+ * Attached to a sink device, the detector takes its measurements from the
+ * PHY RxEnd trace and scores every decoded report.
+ */
+class AquaSimIdsAttachTestCase : public TestCase
+{
+public:
+  AquaSimIdsAttachTestCase ();
+
+private:
+  virtual void DoRun (void);
+  bool Report (Ptr<const Packet> p, AquaSimIdsReception &rx);
+  void Scored (const AquaSimIdsReception &rx);
+
+  std::map<uint64_t, AquaSimIdsReception> m_sent;
+  uint32_t m_scored;
+  double m_worst;
+};
+
+AquaSimIdsAttachTestCase::AquaSimIdsAttachTestCase ()
+  : TestCase ("IDS detector scores receptions from the sink PHY"),
+    m_scored (0),
+    m_worst (0)
+{
+}
+
+bool
+AquaSimIdsAttachTestCase::Report (Ptr<const Packet> p, AquaSimIdsReception &rx)
+{
+  std::map<uint64_t, AquaSimIdsReception>::const_iterator it = m_sent.find (p->GetUid ());
+  if (it == m_sent.end ())
+    return false;
+  rx.nodeId = it->second.nodeId;
+  rx.reportedPos = it->second.reportedPos;
+  rx.sendTime = it->second.sendTime;
+  rx.label = it->second.label;
+  return true;
+}
+
+void
+AquaSimIdsAttachTestCase::Scored (const AquaSimIdsReception &rx)
+{
+  m_scored++;
+  m_worst = std::max (m_worst, rx.features[AquaSimIdsModel::DELAY_RESIDUAL]);
+  m_worst = std::max (m_worst, rx.features[AquaSimIdsModel::RSSI_RESIDUAL]);
+}
+
+void
+AquaSimIdsAttachTestCase::DoRun (void)
+{
+  Vector sinkPos (500, 500, 950);
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (sinkPos);
+  node->AggregateObject (mobility);
+  Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+  dev->SetNode (node);
+  dev->MacEnabled (false);
+  Ptr<AquaSimPhyCmn> phy = CreateObject<AquaSimPhyCmn> ();
+  dev->SetPhy (phy);
+  phy->SetSinrChecker (CreateObject<AquaSimThresholdSinrChecker> ());
+  Ptr<AquaSimSinrSignalCache> cache = CreateObject<AquaSimSinrSignalCache> ();
+  phy->SetSignalCache (cache);
+  Ptr<AquaSimConstNoiseGen> noiseGen = CreateObject<AquaSimConstNoiseGen> ();
+  noiseGen->SetNoise (0);
+  cache->SetNoiseGen (noiseGen);
+
+  Ptr<AquaSimIdsDetector> det = CreateObject<AquaSimIdsDetector> ();
+  det->SetModel (CreateObject<AquaSimIdsThresholdModel> ());
+  det->SetReportCallback (MakeCallback (&AquaSimIdsAttachTestCase::Report, this));
+  det->Attach (dev);
+  det->TraceConnectWithoutContext ("Scored", MakeCallback (&AquaSimIdsAttachTestCase::Scored, this));
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Vector pos (100 * i, 50 * i, 90 * i);
+      AquaSimIdsReception rx = MakeReport (i, pos, sinkPos, 0);
+      Ptr<Packet> p = Create<Packet> (40);
+      m_sent[p->GetUid ()] = rx;
+
+      MacHeader mach;
+      AquaSimHeader ash;
+      ash.SetSize (40);
+      ash.SetDirection (AquaSimHeader::UP);
+      AquaSimRxInfoTag rxInfo;
+      rxInfo.SetPr (rx.rssi);
+      rxInfo.SetPropDelay (rx.propDelay);
+      p->AddHeader (mach);
+      p->AddHeader (ash);
+      p->AddPacketTag (rxInfo);
+      Simulator::Schedule (Seconds (10 * (i + 1)), &AquaSimSignalCache::AddNewPacket, cache, p);
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_scored, 10, "receptions not scored");
+  NS_TEST_ASSERT_MSG_LT (m_worst, 1e-3, "honest reports have residuals");
+  NS_TEST_ASSERT_MSG_EQ (det->GetNAlerts (), 0, "honest reports flagged");
+
+  det->Dispose ();
+  dev->Dispose ();
+  Simulator::Destroy ();
+}
+
+class AquaSimIdsDetectorTestSuite : public TestSuite
+{
+public:
+  AquaSimIdsDetectorTestSuite ();
+};
+
+AquaSimIdsDetectorTestSuite::AquaSimIdsDetectorTestSuite ()
+  : TestSuite ("aqua-sim-ids-detector", UNIT)
+{
+  AddTestCase (new AquaSimIdsFeatureTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimIdsLearnTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimIdsAttachTestCase, TestCase::QUICK);
+}
+
+static AquaSimIdsDetectorTestSuite aquaSimIdsDetectorTestSuite;
@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-range-propagation.h"
+#include "ns3/aqua-sim-link-cache.h"
+
+using namespace ns3;
+
+/**
+ * With the link cache enabled, ReceivedCopies and PDelay must give exactly
+ * the values of the uncached model while nodes move and change course.
+ */
+class AquaSimLinkCacheTestCase : public TestCase
+{
+public:
+  AquaSimLinkCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Compare (void);
+  void Turn (Ptr<ConstantVelocityMobilityModel> model);
+
+  std::vector<Ptr<AquaSimNetDevice> > m_devices;
+  Ptr<AquaSimRangePropagation> m_plain;
+  Ptr<AquaSimRangePropagation> m_cached;
+  Ptr<UniformRandomVariable> m_rand;
+  uint32_t m_checked;
+};
+
+AquaSimLinkCacheTestCase::AquaSimLinkCacheTestCase ()
+  : TestCase ("Cached link state matches direct propagation computation"),
+    m_checked (0)
+{
+}
+
+void
+AquaSimLinkCacheTestCase::Turn (Ptr<ConstantVelocityMobilityModel> model)
+{
+  model->SetVelocity (Vector (m_rand->GetValue (-5, 5), m_rand->GetValue (-5, 5),
+                              m_rand->GetValue (-1, 1)));
+}
+
+void
+AquaSimLinkCacheTestCase::Compare (void)
+{
+  std::vector<PktRecvUnit> plain, cached;
+  for (uint32_t s = 0; s < m_devices.size (); s += 5)
+    {
+      AquaSimPacketStamp pstamp;
+      pstamp.SetTxRange (800);
+      pstamp.SetPt (20);
+      pstamp.SetFreq (s % 2 ? 25 : 30);
+      Ptr<Packet> p = Create<Packet> (32);
+      p->AddHeader (pstamp);
+
+      m_plain->ReceivedCopies (m_devices[s], p, m_devices, plain);
+      m_cached->ReceivedCopies (m_devices[s], p, m_devices, cached);
+
+      NS_TEST_ASSERT_MSG_EQ (cached.size (), plain.size (), "receiver count differs");
+      for (uint32_t i = 0; i < plain.size () && i < cached.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (cached[i].recver, plain[i].recver, "receiver order differs");
+          NS_TEST_ASSERT_MSG_EQ (cached[i].pDelay, plain[i].pDelay, "delay differs");
+          NS_TEST_ASSERT_MSG_EQ (cached[i].pR, plain[i].pR, "received power differs");
+          Ptr<MobilityModel> a = m_devices[s]->GetNode ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> b = plain[i].recver->GetNode ()->GetObject<MobilityModel> ();
+          NS_TEST_ASSERT_MSG_EQ (m_cached->PDelay (a, b), m_plain->PDelay (a, b), "PDelay differs");
+        }
+      m_checked += plain.size ();
+    }
+}
+
+void
+AquaSimLinkCacheTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (5);
+  RngSeedManager::SetRun (2);
+  m_rand = CreateObject<UniformRandomVariable> ();
+  m_plain = CreateObject<AquaSimRangePropagation> ();
+  m_cached = CreateObject<AquaSimRangePropagation> ();
+  m_cached->SetAttribute ("LinkCache", BooleanValue (true));
+
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Vector pos (m_rand->GetValue (0, 1500), m_rand->GetValue (0, 1500), m_rand->GetValue (0, 500));
+      if (i % 3 == 0)
+        {
+          Ptr<ConstantVelocityMobilityModel> cv = CreateObject<ConstantVelocityMobilityModel> ();
+          cv->SetPosition (pos);
+          Turn (cv);
+          node->AggregateObject (cv);
+          for (double t = 10; t < 100; t += 23)
+            Simulator::Schedule (Seconds (t + i * 0.01), &AquaSimLinkCacheTestCase::Turn, this, cv);
+          /* stop some of them to exercise the moving -> static transition */
+          if (i % 2)
+            Simulator::Schedule (Seconds (60), &ConstantVelocityMobilityModel::SetVelocity, cv, Vector (0, 0, 0));
+        }
+      else
+        {
+          Ptr<ConstantPositionMobilityModel> cp = CreateObject<ConstantPositionMobilityModel> ();
+          cp->SetPosition (pos);
+          node->AggregateObject (cp);
+          if (i % 7 == 0)
+            Simulator::Schedule (Seconds (50), &ConstantPositionMobilityModel::SetPosition, cp,
+                                 pos + Vector (200, 0, 0));
+        }
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      dev->SetNode (node);
+      m_devices.push_back (dev);
+    }
+
+  for (double t = 0; t < 100; t += 3.5)
+    Simulator::Schedule (Seconds (t), &AquaSimLinkCacheTestCase::Compare, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_checked, 0, "no receivers were compared");
+  NS_TEST_ASSERT_MSG_GT (m_cached->GetLinkCache ()->GetHits (), 0, "static links were never reused");
+
+  m_plain->Dispose ();
+  m_cached->Dispose ();
+  m_devices.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * With MaxAge set, a moving link is reused until the entry is that old.
+ */
+class AquaSimLinkCacheMaxAgeTestCase : public TestCase
+{
+public:
+  AquaSimLinkCacheMaxAgeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (double expected);
+
+  Ptr<AquaSimLinkCache> m_cache;
+  Ptr<MobilityModel> m_a;
+  Ptr<MobilityModel> m_b;
+};
+
+AquaSimLinkCacheMaxAgeTestCase::AquaSimLinkCacheMaxAgeTestCase ()
+  : TestCase ("MaxAge bounds reuse of moving links")
+{
+}
+
+void
+AquaSimLinkCacheMaxAgeTestCase::Check (double expected)
+{
+  /* look up once: the assertion macro evaluates its argument more than once */
+  double dist = m_cache->Lookup (m_b, m_a).dist;
+  NS_TEST_ASSERT_MSG_EQ_TOL (dist, expected, 1e-9, "unexpected cached distance");
+}
+
+void
+AquaSimLinkCacheMaxAgeTestCase::DoRun (void)
+{
+  m_cache = CreateObject<AquaSimLinkCache> ();
+  m_cache->SetAttribute ("MaxAge", TimeValue (Seconds (10)));
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantVelocityMobilityModel> b = CreateObject<ConstantVelocityMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  b->SetPosition (Vector (100, 0, 0));
+  b->SetVelocity (Vector (1, 0, 0));
+  m_a = a;
+  m_b = b;
+
+  Simulator::Schedule (Seconds (0), &AquaSimLinkCacheMaxAgeTestCase::Check, this, 100);
+  Simulator::Schedule (Seconds (5), &AquaSimLinkCacheMaxAgeTestCase::Check, this, 100);
+  Simulator::Schedule (Seconds (10), &AquaSimLinkCacheMaxAgeTestCase::Check, this, 100);
+  Simulator::Schedule (Seconds (11), &AquaSimLinkCacheMaxAgeTestCase::Check, this, 111);
+  /* a course change invalidates regardless of age */
+  Simulator::Schedule (Seconds (12), &ConstantVelocityMobilityModel::SetVelocity, b, Vector (0, 0, 0));
+  Simulator::Schedule (Seconds (12), &AquaSimLinkCacheMaxAgeTestCase::Check, this, 112);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_cache->GetHits (), 2, "unexpected hit count");
+  NS_TEST_ASSERT_MSG_EQ (m_cache->GetMisses (), 3, "unexpected miss count");
+
+  m_cache->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * A table capped at MaxLinks stays within the cap, evicts the links a
+ * course change made stale before still valid static ones, and never
+ * returns a wrong distance.
+ */
+class AquaSimLinkCacheEvictionTestCase : public TestCase
+{
+public:
+  AquaSimLinkCacheEvictionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (uint32_t sender);
+
+  Ptr<AquaSimLinkCache> m_cache;
+  std::vector<Ptr<MobilityModel> > m_models;
+  uint32_t m_largest;
+};
+
+AquaSimLinkCacheEvictionTestCase::AquaSimLinkCacheEvictionTestCase ()
+  : TestCase ("MaxLinks bounds the link table"),
+    m_largest (0)
+{
+}
+
+void
+AquaSimLinkCacheEvictionTestCase::Check (uint32_t sender)
+{
+  Ptr<MobilityModel> s = m_models[sender];
+  for (uint32_t i = 0; i < m_models.size (); i++)
+    {
+      if (i == sender)
+        continue;
+      double dist = m_cache->Lookup (s, m_models[i]).dist;
+      NS_TEST_ASSERT_MSG_EQ (dist, s->GetDistanceFrom (m_models[i]), "distance to node " << i);
+      m_largest = std::max (m_largest, m_cache->GetNLinks ());
+    }
+}
+
+void
+AquaSimLinkCacheEvictionTestCase::DoRun (void)
+{
+  m_cache = CreateObject<AquaSimLinkCache> ();
+  /* 39 static and 45 moving links: the stale moving ones make room */
+  m_cache->SetAttribute ("MaxLinks", UintegerValue (80));
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      if (i % 2)
+        {
+          Ptr<ConstantVelocityMobilityModel> cv = CreateObject<ConstantVelocityMobilityModel> ();
+          cv->SetPosition (Vector (i * 50.0, 0, 0));
+          cv->SetVelocity (Vector (0, 1, 0));
+          m_models.push_back (cv);
+        }
+      else
+        {
+          Ptr<ConstantPositionMobilityModel> cp = CreateObject<ConstantPositionMobilityModel> ();
+          cp->SetPosition (Vector (i * 50.0, 100, 0));
+          m_models.push_back (cp);
+        }
+    }
+
+  for (uint32_t t = 0; t < 60; t++)
+    Simulator::Schedule (Seconds (t), &AquaSimLinkCacheEvictionTestCase::Check, this, (t % 3) * 2);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_largest, 80, "table outgrew MaxLinks");
+  NS_TEST_ASSERT_MSG_GT (m_cache->GetEvictions (), 0, "nothing evicted");
+  /* each sender's 14 static links survive the evictions and are reused */
+  NS_TEST_ASSERT_MSG_GT (m_cache->GetHits (), 14 * 55, "static links evicted");
+
+  m_cache->Dispose ();
+  m_models.clear ();
+  Simulator::Destroy ();
+}
+
+class AquaSimLinkCacheTestSuite : public TestSuite
+{
+public:
+  AquaSimLinkCacheTestSuite ();
+};
+
+AquaSimLinkCacheTestSuite::AquaSimLinkCacheTestSuite ()
+  : TestSuite ("aqua-sim-link-cache", UNIT)
+{
+  AddTestCase (new AquaSimLinkCacheTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimLinkCacheMaxAgeTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimLinkCacheEvictionTestCase, TestCase::QUICK);
+}
+
+static AquaSimLinkCacheTestSuite aquaSimLinkCacheTestSuite;
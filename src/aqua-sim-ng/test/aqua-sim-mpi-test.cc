@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/example-as-test.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Runs the DistributedChannel example under mpiexec and compares its TEST
+ * lines with the reference log. The logs for one and two ranks are the
+ * same file: the two-rank totals, and the receptions relayed between the
+ * ranks, must equal what the serial channel delivers.
+ */
+class AquaSimMpiTestCase : public ExampleAsTestCase
+{
+public:
+  AquaSimMpiTestCase (const std::string name, const std::string program,
+                      const std::string dataDir, int ranks)
+    : ExampleAsTestCase (name, program, dataDir),
+      m_ranks (ranks)
+  {
+  }
+
+  virtual std::string GetCommandTemplate (void) const
+  {
+    std::stringstream ss;
+    ss << "mpiexec -n " << m_ranks << " %s --test";
+    return ss.str ();
+  }
+
+  virtual std::string GetPostProcessingCommand (void) const
+  {
+    return "| grep TEST | sort ";
+  }
+
+private:
+  int m_ranks;
+};
+
+class AquaSimMpiTestSuite : public TestSuite
+{
+public:
+  AquaSimMpiTestSuite (const std::string name, int ranks)
+    : TestSuite (name, EXAMPLE)
+  {
+    AddTestCase (new AquaSimMpiTestCase (name, "DistributedChannel", NS_TEST_SOURCEDIR, ranks),
+                 TestCase::QUICK);
+  }
+};
+
+}  // namespace
+
+static AquaSimMpiTestSuite g_aquaSimMpiChannel1 ("aqua-sim-mpi-channel-1", 1);
+static AquaSimMpiTestSuite g_aquaSimMpiChannel2 ("aqua-sim-mpi-channel-2", 2);
@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/integer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-header-mac.h"
+#include "ns3/aqua-sim-localization.h"
+#include "ns3/aqua-sim-multilateration.h"
+
+#include <cmath>
+#include <set>
+
+using namespace ns3;
+
+/**
+ * ToA and TDoA solves recover a target from noisy ranges, including below
+ * coplanar anchors, and warm starts need fewer iterations than cold ones.
+ */
+class AquaSimMultilaterationSolveTestCase : public TestCase
+{
+public:
+  AquaSimMultilaterationSolveTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimMultilaterationSolveTestCase::AquaSimMultilaterationSolveTestCase ()
+  : TestCase ("Multilateration recovers targets from ToA and TDoA ranges")
+{
+}
+
+void
+AquaSimMultilaterationSolveTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (4);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  AquaSimMultilateration solver;
+
+  uint32_t coldIterations = 0, warmIterations = 0;
+  for (uint32_t trial = 0; trial < 50; trial++)
+    {
+      std::vector<Vector> anchors;
+      bool coplanar = trial % 2;
+      for (uint32_t i = 0; i < 6; i++)
+        anchors.push_back (Vector (rand->GetValue (0, 2000), rand->GetValue (0, 2000),
+                                   coplanar ? 0 : rand->GetValue (-900, 0)));
+      // well below coplanar anchors, where depth is still observable
+      Vector target (rand->GetValue (200, 1800), rand->GetValue (200, 1800),
+                     rand->GetValue (-1000, -300));
+
+      solver.Reset ();
+      for (uint32_t i = 0; i < anchors.size (); i++)
+        solver.AddRange (anchors[i], CalculateDistance (target, anchors[i]) + rand->GetValue (-1, 1));
+      bool solved = solver.Solve ();
+      NS_TEST_ASSERT_MSG_EQ (solved, true, "ToA solve failed");
+      NS_TEST_ASSERT_MSG_LT (CalculateDistance (solver.GetEstimate (), target), 10.0,
+                             "ToA estimate off, trial " << trial);
+      NS_TEST_ASSERT_MSG_LT (solver.GetRms (), 1.0, "ToA residual above the noise");
+      NS_TEST_ASSERT_MSG_GT (solver.Residual (target + Vector (300, 0, 0)), 50.0,
+                             "a displaced position fits the ranges");
+      coldIterations += solver.GetIterations ();
+
+      // the target moves a little; start from the last estimate
+      target = target + Vector (2, -1, 0.5);
+      solver.Clear ();
+      for (uint32_t i = 0; i < anchors.size (); i++)
+        solver.AddRange (anchors[i], CalculateDistance (target, anchors[i]) + rand->GetValue (-1, 1));
+      solver.Solve ();
+      NS_TEST_ASSERT_MSG_LT (CalculateDistance (solver.GetEstimate (), target), 10.0,
+                             "warm ToA estimate off");
+      warmIterations += solver.GetIterations ();
+
+      if (coplanar)
+        continue;
+      // TDoA against the first anchor, from the previous estimate
+      solver.Clear ();
+      for (uint32_t i = 1; i < anchors.size (); i++)
+        solver.AddRangeDifference (anchors[i], anchors[0],
+                                   CalculateDistance (target, anchors[i])
+                                   - CalculateDistance (target, anchors[0]));
+      solved = solver.Solve (target + Vector (100, 100, -50));
+      NS_TEST_ASSERT_MSG_EQ (solved, true, "TDoA solve failed");
+      NS_TEST_ASSERT_MSG_LT (CalculateDistance (solver.GetEstimate (), target), 0.1,
+                             "TDoA estimate off");
+    }
+  NS_TEST_ASSERT_MSG_LT (warmIterations, coldIterations, "warm starts do not help");
+
+  solver.Reset ();
+  solver.AddRange (Vector (0, 0, 0), 10);
+  solver.AddRange (Vector (10, 0, 0), 10);
+  bool solved = solver.Solve ();
+  NS_TEST_ASSERT_MSG_EQ (solved, false, "solved from two ranges");
+}
+
+/**
+ * Exact ranges from four orthogonal anchors to (300, 400, -500): the
+ * squared ranges are 50, 90, 70 and 50 (x 10^4 m^2).
+ */
+class AquaSimMultilaterationKnownTestCase : public TestCase
+{
+public:
+  AquaSimMultilaterationKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimMultilaterationKnownTestCase::AquaSimMultilaterationKnownTestCase ()
+  : TestCase ("Multilateration solves exact ranges from fixed anchors")
+{
+}
+
+void
+AquaSimMultilaterationKnownTestCase::DoRun (void)
+{
+  AquaSimMultilateration solver;
+  solver.AddRange (Vector (0, 0, 0), std::sqrt (500000.0));
+  solver.AddRange (Vector (1000, 0, 0), std::sqrt (900000.0));
+  solver.AddRange (Vector (0, 1000, 0), std::sqrt (700000.0));
+  solver.AddRange (Vector (0, 0, -1000), std::sqrt (500000.0));
+  NS_TEST_ASSERT_MSG_EQ (solver.GetN (), 4, "four ranges");
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (solver.Residual (0, Vector (0, 0, 0)), -707.1067811865476, 1e-9,
+                             "misfit of the first anchor's own position");
+  NS_TEST_ASSERT_MSG_EQ_TOL (solver.Residual (1, Vector (0, 0, 0)), 1000 - 948.6832980505138, 1e-9,
+                             "misfit of the origin against the second anchor");
+
+  NS_TEST_ASSERT_MSG_EQ (solver.Solve (), true, "solve failed");
+  Vector est = solver.GetEstimate ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (est.x, 300, 1e-6, "x");
+  NS_TEST_ASSERT_MSG_EQ_TOL (est.y, 400, 1e-6, "y");
+  NS_TEST_ASSERT_MSG_EQ_TOL (est.z, -500, 1e-6, "z");
+  NS_TEST_ASSERT_MSG_LT (solver.GetRms (), 1e-6, "exact ranges leave no residual");
+}
+
+/**
+ * A node localising itself from beacons drops the neighbour that claims a
+ * false position and flags it through the Residual trace.
+ */
+class AquaSimRBLocalizationSpoofTestCase : public TestCase
+{
+public:
+  AquaSimRBLocalizationSpoofTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Residual (int nodeId, Vector claimed, double residual, bool spoofed);
+
+  std::set<int> m_spoofed;
+  std::set<int> m_checked;
+};
+
+AquaSimRBLocalizationSpoofTestCase::AquaSimRBLocalizationSpoofTestCase ()
+  : TestCase ("Range-based localization flags a spoofed beacon position")
+{
+}
+
+void
+AquaSimRBLocalizationSpoofTestCase::Residual (int nodeId, Vector claimed, double residual,
+                                              bool spoofed)
+{
+  m_checked.insert (nodeId);
+  if (spoofed)
+    m_spoofed.insert (nodeId);
+}
+
+void
+AquaSimRBLocalizationSpoofTestCase::DoRun (void)
+{
+  Vector self (600, 700, -400);
+  Vector neighbours[] = {Vector (0, 0, 0), Vector (1500, 100, -50), Vector (200, 1400, -300),
+                         Vector (1300, 1300, -800), Vector (700, 300, -900),
+                         Vector (100, 800, -600), Vector (1000, 600, 0)};
+  const int liar = 3;
+
+  Ptr<AquaSimRBLocalization> loc = CreateObject<AquaSimRBLocalization> ();
+  loc->SetAttribute ("LocThreshold", IntegerValue (7));
+  loc->SetPr (0);
+  loc->SetPosition (Vector (0, 0, 0));
+  loc->TraceConnectWithoutContext ("Residual",
+      MakeCallback (&AquaSimRBLocalizationSpoofTestCase::Residual, this));
+
+  for (int i = 0; i < 7; i++)
+    {
+      Time sent = Seconds (i + 1);
+      Vector claimed = neighbours[i];
+      if (i == liar)
+        claimed.x += 400;
+      Ptr<Packet> p = Create<Packet> ();
+      AquaSimHeader ash;
+      MacHeader mach;
+      LocalizationHeader loch;
+      ash.SetSAddr (AquaSimAddress ((uint16_t) i));
+      ash.SetTimeStamp (sent);
+      mach.SetDemuxPType (MacHeader::UWPTYPE_LOC);
+      loch.SetNodePosition (claimed);
+      loch.SetConfidence (1);
+      p->AddHeader (loch);
+      p->AddHeader (mach);
+      p->AddHeader (ash);
+      Time arrival = sent + Seconds (CalculateDistance (self, neighbours[i]) / 1500);
+      Simulator::Schedule (arrival, &AquaSimRBLocalization::Recv, loc, p);
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_checked.size (), 7, "beacons not checked");
+  NS_TEST_ASSERT_MSG_EQ (m_spoofed.size (), 1, "wrong number of spoofed beacons");
+  NS_TEST_ASSERT_MSG_EQ (m_spoofed.count (liar), 1, "the liar was not flagged");
+  NS_TEST_ASSERT_MSG_GT (loc->GetConfidence (), 0.99, "fix from honest beacons is poor");
+
+  // the next round is checked beacon by beacon against the fix
+  m_spoofed.clear ();
+  Ptr<Packet> p = Create<Packet> ();
+  AquaSimHeader ash;
+  MacHeader mach;
+  LocalizationHeader loch;
+  ash.SetSAddr (AquaSimAddress ((uint16_t) liar));
+  ash.SetTimeStamp (Simulator::Now ());
+  loch.SetNodePosition (neighbours[liar] + Vector (0, 400, 0));
+  p->AddHeader (loch);
+  p->AddHeader (mach);
+  p->AddHeader (ash);
+  Simulator::Schedule (Seconds (CalculateDistance (self, neighbours[liar]) / 1500),
+                       &AquaSimRBLocalization::Recv, loc, p);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_spoofed.count (liar), 1, "per-beacon check missed the liar");
+
+  loc->Dispose ();
+  Simulator::Destroy ();
+}
+
+class AquaSimMultilaterationTestSuite : public TestSuite
+{
+public:
+  AquaSimMultilaterationTestSuite ();
+};
+
+AquaSimMultilaterationTestSuite::AquaSimMultilaterationTestSuite ()
+  : TestSuite ("aqua-sim-multilateration", UNIT)
+{
+  AddTestCase (new AquaSimMultilaterationSolveTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimMultilaterationKnownTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimRBLocalizationSpoofTestCase, TestCase::QUICK);
+}
+
+static AquaSimMultilaterationTestSuite aquaSimMultilaterationTestSuite;
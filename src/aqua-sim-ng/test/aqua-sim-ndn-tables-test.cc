@@ -0,0 +1,376 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/name-table.h"
+#include "ns3/fib.h"
+#include "ns3/pit.h"
+#include "ns3/cs-lru.h"
+
+#include <list>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+namespace {
+
+std::string
+RandomName (Ptr<UniformRandomVariable> rand, uint32_t maxDepth)
+{
+  std::ostringstream os;
+  uint32_t depth = rand->GetInteger (1, maxDepth);
+  for (uint32_t i = 0; i < depth; i++)
+    os << "/c" << rand->GetInteger (0, 3);
+  return os.str ();
+}
+
+NameId
+Intern (const std::string &name)
+{
+  return NameTable::Intern (name.data (), name.size ());
+}
+
+} // namespace
+
+/**
+ * Equal names from different buffers share an id, and every '/' prefix of
+ * an interned name is interned and linked as its parent.
+ */
+class AquaSimNdnNameTableTestCase : public TestCase
+{
+public:
+  AquaSimNdnNameTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimNdnNameTableTestCase::AquaSimNdnNameTableTestCase ()
+  : TestCase ("Interned names are shared and linked to their prefixes")
+{
+}
+
+void
+AquaSimNdnNameTableTestCase::DoRun (void)
+{
+  char a[] = "/ocean/sensor/temp";
+  char b[] = "/ocean/sensor/temp";
+  NameId id = NameTable::Intern ((uint8_t*)a);
+  NS_TEST_ASSERT_MSG_EQ (NameTable::Intern ((uint8_t*)b), id, "equal names got different ids");
+  NS_TEST_ASSERT_MSG_EQ (NameTable::GetName (id), std::string (a), "name not kept");
+
+  NameId parent = NameTable::GetParent (id);
+  NS_TEST_ASSERT_MSG_EQ (NameTable::GetName (parent), std::string ("/ocean/sensor"), "wrong parent");
+  NameId root = NameTable::GetParent (parent);
+  NS_TEST_ASSERT_MSG_EQ (NameTable::GetName (root), std::string ("/ocean"), "wrong grandparent");
+  NS_TEST_ASSERT_MSG_EQ (NameTable::GetParent (root), NameTable::NONE, "top component has a parent");
+  NS_TEST_ASSERT_MSG_EQ (NameTable::Find ("/ocean/sensor", 13), parent, "prefix was not interned");
+  NS_TEST_ASSERT_MSG_EQ (NameTable::Find ("/ocean/buoy", 11), NameTable::NONE, "unknown name found");
+
+  uint32_t n = NameTable::GetN ();
+  NameTable::Intern ("/ocean/sensor/temp", 18);
+  NS_TEST_ASSERT_MSG_EQ (NameTable::GetN (), n, "re-interning grew the table");
+}
+
+/**
+ * Longest-prefix match through parent links returns the same next hops as
+ * a scan of every registered prefix, while prefixes come and go.
+ */
+class AquaSimNdnFibTestCase : public TestCase
+{
+public:
+  AquaSimNdnFibTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimNdnFibTestCase::AquaSimNdnFibTestCase ()
+  : TestCase ("FIB longest-prefix match agrees with a brute-force scan")
+{
+}
+
+void
+AquaSimNdnFibTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (11);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  Ptr<Fib> fib = CreateObject<Fib> ();
+  // reference: prefix -> next hops in insertion order
+  std::map<std::string, std::list<uint16_t> > reference;
+  uint32_t matched = 0;
+
+  for (uint32_t op = 0; op < 4000; op++)
+    {
+      std::string name = RandomName (rand, 3);
+      uint16_t hop = rand->GetInteger (1, 6);
+      if (rand->GetValue () < 0.7)
+        {
+          fib->AddEntry (Intern (name), AquaSimAddress (hop));
+          std::list<uint16_t> &hops = reference[name];
+          bool known = false;
+          for (std::list<uint16_t>::iterator it = hops.begin (); it != hops.end (); it++)
+            known = known || (*it == hop);
+          if (!known)
+            hops.push_back (hop);
+        }
+      else
+        {
+          fib->RemoveEntry (Intern (name), AquaSimAddress (hop));
+          std::map<std::string, std::list<uint16_t> >::iterator it = reference.find (name);
+          if (it != reference.end ())
+            {
+              it->second.remove (hop);
+              if (it->second.empty ())
+                reference.erase (it);
+            }
+        }
+
+      std::string query = RandomName (rand, 5);
+      const std::list<uint16_t> *expected = NULL;
+      size_t best = 0;
+      for (std::map<std::string, std::list<uint16_t> >::iterator it = reference.begin ();
+           it != reference.end (); it++)
+        {
+          const std::string &prefix = it->first;
+          bool match = query.compare (0, prefix.size (), prefix) == 0 &&
+            (query.size () == prefix.size () || query[prefix.size ()] == '/');
+          if (match && prefix.size () > best)
+            {
+              best = prefix.size ();
+              expected = &it->second;
+            }
+        }
+
+      std::vector<AquaSimAddress> hops = fib->InterestRecv (Intern (query));
+      size_t expectedN = expected ? expected->size () : 0;
+      NS_TEST_ASSERT_MSG_EQ (hops.size (), expectedN, "next hop count differs for " << query);
+      if (expected && hops.size () == expectedN)
+        {
+          std::list<uint16_t>::const_iterator it = expected->begin ();
+          for (size_t i = 0; i < hops.size (); i++, it++)
+            NS_TEST_ASSERT_MSG_EQ (hops[i].GetAsInt (), *it, "next hop differs for " << query);
+          matched++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (fib->GetFibSize (), reference.size (), "table size differs");
+  NS_TEST_ASSERT_MSG_GT (matched, 1000, "too few lookups matched a prefix");
+  fib->Dispose ();
+}
+
+/**
+ * PIT entries merge requesters and leave the table within one wheel tick
+ * after their timeout, and the wheel stops once the table is empty.
+ */
+class AquaSimNdnPitTestCase : public TestCase
+{
+public:
+  AquaSimNdnPitTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Add (std::string name, uint16_t addr);
+  void Check (void);
+
+  Ptr<Pit> m_pit;
+  std::map<std::string, Time> m_added;
+  uint32_t m_expired;
+};
+
+AquaSimNdnPitTestCase::AquaSimNdnPitTestCase ()
+  : TestCase ("PIT entries expire within one wheel tick of their timeout"),
+    m_expired (0)
+{
+}
+
+void
+AquaSimNdnPitTestCase::Add (std::string name, uint16_t addr)
+{
+  bool fresh = m_pit->AddEntry (Intern (name), AquaSimAddress (addr));
+  std::map<std::string, Time>::iterator it = m_added.find (name);
+  if (it != m_added.end () && fresh)
+    {
+      // expired since the last check and came back
+      bool expired = Simulator::Now () - it->second >= Seconds (10);
+      NS_TEST_ASSERT_MSG_EQ (expired, true, "AddEntry re-created live entry " << name);
+      m_expired++;
+    }
+  else
+    NS_TEST_ASSERT_MSG_EQ (fresh, (it == m_added.end ()), "AddEntry misreported a new entry for " << name);
+  if (fresh)
+    m_added[name] = Simulator::Now ();
+}
+
+void
+AquaSimNdnPitTestCase::Check (void)
+{
+  Time timeout = Seconds (10);
+  Time tick = MilliSeconds (500);
+  std::map<std::string, Time>::iterator it = m_added.begin ();
+  while (it != m_added.end ())
+    {
+      Time age = Simulator::Now () - it->second;
+      bool present = !m_pit->GetEntry (Intern (it->first)).empty ();
+      if (age < timeout)
+        NS_TEST_ASSERT_MSG_EQ (present, true, it->first << " expired early");
+      else if (age >= timeout + tick)
+        NS_TEST_ASSERT_MSG_EQ (present, false, it->first << " outlived its timeout");
+      if (!present)
+        {
+          m_expired++;
+          m_added.erase (it++);
+        }
+      else
+        it++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_pit->GetPitSize (), m_added.size (), "table size differs");
+}
+
+void
+AquaSimNdnPitTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (7);
+  RngSeedManager::SetRun (2);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  m_pit = CreateObject<Pit> ();
+  m_pit->SetAttribute ("WheelTick", TimeValue (MilliSeconds (500)));
+  m_pit->SetTimeout (Seconds (10));
+
+  for (uint32_t i = 0; i < 600; i++)
+    {
+      Time at = MicroSeconds (rand->GetInteger (0, 30000000));
+      Simulator::Schedule (at, &AquaSimNdnPitTestCase::Add, this,
+                           RandomName (rand, 3), rand->GetInteger (1, 5));
+    }
+  for (Time t = MilliSeconds (37); t < Seconds (45); t += MilliSeconds (113))
+    Simulator::Schedule (t, &AquaSimNdnPitTestCase::Check, this);
+
+  // merged requesters come back sorted and unique
+  Simulator::Schedule (Seconds (50), &Pit::AddEntry, m_pit, Intern ("/merge"), AquaSimAddress (3));
+  Simulator::Schedule (Seconds (50), &Pit::AddEntry, m_pit, Intern ("/merge"), AquaSimAddress (1));
+  Simulator::Schedule (Seconds (50), &Pit::AddEntry, m_pit, Intern ("/merge"), AquaSimAddress (3));
+  Simulator::Stop (Seconds (50) + MilliSeconds (1));
+  Simulator::Run ();
+
+  std::vector<AquaSimAddress> merged = m_pit->GetEntry (Intern ("/merge"));
+  NS_TEST_ASSERT_MSG_EQ (merged.size (), 2, "requesters were not merged");
+  bool sorted = merged.size () == 2 && merged[0].GetAsInt () == 1 && merged[1].GetAsInt () == 3;
+  NS_TEST_ASSERT_MSG_EQ (sorted, true, "requesters not sorted");
+  NS_TEST_ASSERT_MSG_GT (m_expired, 0, "nothing expired");
+
+  // the last entry drains the wheel and the simulation runs dry
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_pit->GetPitSize (), 0, "entry survived past its timeout");
+  NS_TEST_ASSERT_MSG_LT (Simulator::Now (), Seconds (62), "wheel kept ticking on an empty table");
+
+  m_pit->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * The slot-pool LRU evicts the same keys as a list-based reference under
+ * a mix of adds and hits, including re-adds of cached keys.
+ */
+class AquaSimNdnCsLruTestCase : public TestCase
+{
+public:
+  AquaSimNdnCsLruTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimNdnCsLruTestCase::AquaSimNdnCsLruTestCase ()
+  : TestCase ("Content store LRU matches a reference LRU")
+{
+}
+
+void
+AquaSimNdnCsLruTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (13);
+  RngSeedManager::SetRun (4);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  const size_t capacity = 50;
+  Ptr<CSLru> cs = CreateObject<CSLru> ();
+  cs->SetCacheSize (capacity);
+  std::list<std::pair<NameId, uint8_t*> > reference;  //most recent first
+  static uint8_t data[256];
+  uint32_t hits = 0;
+
+  for (uint32_t op = 0; op < 20000; op++)
+    {
+      NameId key = rand->GetInteger (0, 150);
+      std::list<std::pair<NameId, uint8_t*> >::iterator it = reference.begin ();
+      while (it != reference.end () && it->first != key)
+        it++;
+
+      if (rand->GetValue () < 0.4)
+        {
+          uint8_t *d = &data[rand->GetInteger (0, 255)];
+          cs->AddEntry (key, d);
+          if (it != reference.end ())
+            reference.erase (it);
+          reference.push_front (std::make_pair (key, d));
+          if (reference.size () > capacity)
+            reference.pop_back ();
+        }
+      else
+        {
+          uint8_t *expected = NULL;
+          if (it != reference.end ())
+            {
+              expected = it->second;
+              reference.splice (reference.begin (), reference, it);
+              hits++;
+            }
+          uint8_t *got = cs->GetEntry (key);
+          NS_TEST_ASSERT_MSG_EQ ((void*)got, (void*)expected, "lookup differs for key " << key);
+        }
+      NS_TEST_ASSERT_MSG_EQ (cs->GetN (), reference.size (), "cache size differs");
+    }
+  NS_TEST_ASSERT_MSG_GT (hits, 1000, "too few cache hits");
+  cs->Dispose ();
+}
+
+class AquaSimNdnTablesTestSuite : public TestSuite
+{
+public:
+  AquaSimNdnTablesTestSuite ();
+};
+
+AquaSimNdnTablesTestSuite::AquaSimNdnTablesTestSuite ()
+  : TestSuite ("aqua-sim-ndn-tables", UNIT)
+{
+  AddTestCase (new AquaSimNdnNameTableTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimNdnFibTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimNdnPitTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimNdnCsLruTestCase, TestCase::QUICK);
+}
+
+static AquaSimNdnTablesTestSuite aquaSimNdnTablesTestSuite;
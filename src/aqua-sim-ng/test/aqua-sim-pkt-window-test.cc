@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <utility>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-address.h"
+#include "ns3/aqua-sim-datastructure.h"
+#include "ns3/aqua-sim-pkt-window.h"
+#include "ns3/aqua-sim-routing-vbf.h"
+
+using namespace ns3;
+
+/**
+ * Replays reordered per-source packet streams against the window and a map
+ * that evicts the way the old packet tables did; both must hold the same
+ * records at every step.
+ */
+class AquaSimPktWindowTestCase : public TestCase
+{
+public:
+  AquaSimPktWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimPktWindowTestCase::AquaSimPktWindowTestCase ()
+  : TestCase ("Sliding window matches map-based eviction")
+{
+}
+
+void
+AquaSimPktWindowTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (3);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  const uint32_t w = WINDOW_SIZE;
+  const uint16_t sources = 4;
+
+  AquaSimPktWindow<int> window (w);
+  std::map<std::pair<uint16_t, uint32_t>, int> reference;
+  uint32_t top[sources] = { 0 };
+
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      uint16_t src = rand->GetInteger (0, sources - 1);
+      int32_t next = (int32_t)top[src] + (int32_t)rand->GetInteger (0, 3) -
+        (int32_t)rand->GetInteger (0, w / 2);
+      uint32_t seq = next < 0 ? 0 : next;
+      top[src] = std::max (top[src], seq);
+
+      if (seq > w)
+        {
+          reference.erase (reference.lower_bound (std::make_pair (src, 0u)),
+                           reference.lower_bound (std::make_pair (src, seq - w)));
+        }
+      bool expectNew = reference.find (std::make_pair (src, seq)) == reference.end ();
+      reference[std::make_pair (src, seq)]++;
+
+      bool created;
+      int *count = window.Insert (AquaSimAddress (src), seq, created);
+      NS_TEST_ASSERT_MSG_NE (count, 0, "in-window packet refused");
+      NS_TEST_ASSERT_MSG_EQ (created, expectNew, "record creation differs");
+      (*count)++;
+
+      NS_TEST_ASSERT_MSG_EQ (window.GetN (), reference.size (), "record count differs");
+      for (uint32_t back = 0; back <= 2 * w && back <= top[src]; back++)
+        {
+          uint32_t probe = top[src] - back;
+          std::map<std::pair<uint16_t, uint32_t>, int>::iterator it =
+            reference.find (std::make_pair (src, probe));
+          int *found = window.Find (AquaSimAddress (src), probe);
+          if (it == reference.end ())
+            {
+              NS_TEST_ASSERT_MSG_EQ (found, 0, "evicted record still found");
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_NE (found, 0, "record missing");
+              NS_TEST_ASSERT_MSG_EQ (*found, it->second, "record contents differ");
+            }
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (window.Erase (AquaSimAddress (0), top[0]), true, "erase failed");
+  NS_TEST_ASSERT_MSG_EQ (window.Find (AquaSimAddress (0), top[0]), 0, "erased record found");
+  window.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (window.GetN (), 0, "clear left records");
+}
+
+/**
+ * Packets older than the window keep a slot only while no in-window packet
+ * needs it, and the VBF table still caps neighbors per packet.
+ */
+class AquaSimPktWindowLateTestCase : public TestCase
+{
+public:
+  AquaSimPktWindowLateTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimPktWindowLateTestCase::AquaSimPktWindowLateTestCase ()
+  : TestCase ("Late packets and VBF neighbor cap")
+{
+}
+
+void
+AquaSimPktWindowLateTestCase::DoRun (void)
+{
+  AquaSimPktWindow<int> window (19);   // 32 ring slots
+  AquaSimAddress src (7);
+  bool created;
+
+  NS_TEST_ASSERT_MSG_NE (window.Insert (src, 100, created), 0, "insert failed");
+  NS_TEST_ASSERT_MSG_NE (window.Insert (src, 50, created), 0, "late packet with a free slot refused");
+  NS_TEST_ASSERT_MSG_EQ (created, true, "late packet not created");
+  NS_TEST_ASSERT_MSG_NE (window.Find (src, 50), 0, "late packet not found");
+
+  /* 114 shares 50's slot and slides the window past it */
+  NS_TEST_ASSERT_MSG_NE (window.Insert (src, 114, created), 0, "insert failed");
+  NS_TEST_ASSERT_MSG_EQ (window.Find (src, 50), 0, "late packet not evicted");
+  NS_TEST_ASSERT_MSG_EQ (window.Insert (src, 82, created), 0, "late packet took an in-window slot");
+  NS_TEST_ASSERT_MSG_NE (window.Find (src, 114), 0, "in-window packet lost");
+  NS_TEST_ASSERT_MSG_NE (window.Find (src, 100), 0, "in-window packet lost");
+  NS_TEST_ASSERT_MSG_EQ (window.GetN (), 2, "unexpected record count");
+
+  /* a jump longer than the ring empties it */
+  NS_TEST_ASSERT_MSG_NE (window.Insert (src, 1000000, created), 0, "insert failed");
+  NS_TEST_ASSERT_MSG_EQ (window.GetN (), 1, "jump did not evict");
+
+  AquaSimPktHashTable table;
+  for (int i = 0; i < MAX_NEIGHBOR + 5; i++)
+    {
+      table.PutInHash (src, 3, Vector (i, 0, 0));
+    }
+  vbf_neighborhood *hood = table.GetHash (src, 3);
+  NS_TEST_ASSERT_MSG_NE (hood, 0, "VBF record missing");
+  NS_TEST_ASSERT_MSG_EQ (hood->number, MAX_NEIGHBOR, "neighbor count not capped");
+  NS_TEST_ASSERT_MSG_EQ (hood->neighbor[MAX_NEIGHBOR - 1].x, MAX_NEIGHBOR - 1, "neighbor overwritten");
+  table.PutInHash (src, 3 + WINDOW_SIZE + 1);
+  NS_TEST_ASSERT_MSG_EQ (table.GetHash (src, 3), 0, "VBF record outlived its window");
+}
+
+class AquaSimPktWindowTestSuite : public TestSuite
+{
+public:
+  AquaSimPktWindowTestSuite ();
+};
+
+AquaSimPktWindowTestSuite::AquaSimPktWindowTestSuite ()
+  : TestSuite ("aqua-sim-pkt-window", UNIT)
+{
+  AddTestCase (new AquaSimPktWindowTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimPktWindowLateTestCase, TestCase::QUICK);
+}
+
+static AquaSimPktWindowTestSuite aquaSimPktWindowTestSuite;
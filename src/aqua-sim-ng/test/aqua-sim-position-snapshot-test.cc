@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/position-allocator.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-range-propagation.h"
+#include "ns3/aqua-sim-position-snapshot.h"
+
+#include <cmath>
+
+using namespace ns3;
+
+/**
+ * Propagation results read from the snapshot must equal the ones computed
+ * from the mobility models, for random-waypoint and static nodes alike.
+ */
+class AquaSimPositionSnapshotTestCase : public TestCase
+{
+public:
+  AquaSimPositionSnapshotTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Compare (void);
+
+  NodeContainer m_nodes;
+  std::vector<Ptr<AquaSimNetDevice> > m_devices;
+  Ptr<AquaSimRangePropagation> m_plain;
+  Ptr<AquaSimRangePropagation> m_fast;
+  Ptr<AquaSimPositionSnapshot> m_snapshot;
+  uint32_t m_checked;
+};
+
+AquaSimPositionSnapshotTestCase::AquaSimPositionSnapshotTestCase ()
+  : TestCase ("Snapshot positions match the mobility models"),
+    m_checked (0)
+{
+}
+
+void
+AquaSimPositionSnapshotTestCase::Compare (void)
+{
+  m_snapshot->Update (m_devices);
+  uint32_t refreshes = m_snapshot->GetRefreshCount ();
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->IsCurrent (), true, "snapshot not current after Update");
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetN (), m_nodes.GetN (), "one slot per mobility model");
+
+  for (uint32_t i = 0; i < m_snapshot->GetN (); i++)
+    {
+      Vector pos = m_snapshot->GetModel (i)->GetPosition ();
+      NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetX ()[i], pos.x, "x of slot " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetY ()[i], pos.y, "y of slot " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetZ ()[i], pos.z, "z of slot " << i);
+    }
+
+  std::vector<PktRecvUnit> plain, fast;
+  for (uint32_t s = 0; s < m_devices.size (); s += 3)
+    {
+      AquaSimPacketStamp pstamp;
+      pstamp.SetTxRange (600);
+      pstamp.SetPt (20);
+      pstamp.SetFreq (25);
+      Ptr<Packet> p = Create<Packet> (32);
+      p->AddHeader (pstamp);
+
+      /* every transmission at this timestamp reuses the same sample */
+      m_snapshot->Update (m_devices);
+      m_plain->ReceivedCopies (m_devices[s], p, m_devices, plain);
+      m_fast->ReceivedCopies (m_devices[s], p, m_devices, fast);
+
+      NS_TEST_ASSERT_MSG_EQ (fast.size (), plain.size (), "receiver count differs");
+      for (uint32_t i = 0; i < plain.size () && i < fast.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (fast[i].recver, plain[i].recver, "receiver order differs");
+          NS_TEST_ASSERT_MSG_EQ (fast[i].pDelay, plain[i].pDelay, "delay differs");
+          NS_TEST_ASSERT_MSG_EQ (fast[i].pR, plain[i].pR, "received power differs");
+        }
+      m_checked += plain.size ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetRefreshCount (), refreshes, "resampled within one timestamp");
+
+  /* an explicit move at the snapshot time must be seen immediately */
+  Ptr<ConstantPositionMobilityModel> cp = m_nodes.Get (0)->GetObject<ConstantPositionMobilityModel> ();
+  cp->SetPosition (cp->GetPosition () + Vector (1, 0, 0));
+  Vector pos;
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetPosition (PeekPointer (cp), pos), false, "stale after SetPosition");
+  m_snapshot->Update (m_devices);
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetPosition (PeekPointer (cp), pos), true, "not refreshed");
+  NS_TEST_ASSERT_MSG_EQ (pos.x, cp->GetPosition ().x, "moved position not sampled");
+}
+
+void
+AquaSimPositionSnapshotTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (4);
+  RngSeedManager::SetRun (9);
+
+  m_nodes.Create (40);
+  NodeContainer fixed, moving;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    (i < 10 ? fixed : moving).Add (m_nodes.Get (i));
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomBoxPositionAllocator",
+    "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"),
+    "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"),
+    "Z", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=500.0]"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (fixed);
+  Ptr<PositionAllocator> waypoints = CreateObjectWithAttributes<RandomBoxPositionAllocator> (
+    "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"),
+    "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"),
+    "Z", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=500.0]"));
+  mobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+    "Speed", StringValue ("ns3::UniformRandomVariable[Min=1.0|Max=10.0]"),
+    "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=2.0]"),
+    "PositionAllocator", PointerValue (waypoints));
+  mobility.Install (moving);
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      dev->SetNode (m_nodes.Get (i));
+      m_devices.push_back (dev);
+    }
+
+  m_plain = CreateObject<AquaSimRangePropagation> ();
+  m_fast = CreateObject<AquaSimRangePropagation> ();
+  m_snapshot = CreateObject<AquaSimPositionSnapshot> ();
+  m_fast->SetPositionSnapshot (m_snapshot);
+
+  for (double t = 0.5; t < 300; t += 7.3)
+    Simulator::Schedule (Seconds (t), &AquaSimPositionSnapshotTestCase::Compare, this);
+  Simulator::Stop (Seconds (300));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_checked, 0, "no receivers were compared");
+
+  m_snapshot->Dispose ();
+  m_devices.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * One node moving at a fixed velocity and one at rest: at t = 10 s the
+ * snapshot must hold (20, -10, -5) and (30, 40, -10), 51.23 m apart.
+ */
+class AquaSimPositionSnapshotKnownTestCase : public TestCase
+{
+public:
+  AquaSimPositionSnapshotKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (void);
+
+  NodeContainer m_nodes;
+  std::vector<Ptr<AquaSimNetDevice> > m_devices;
+  Ptr<AquaSimRangePropagation> m_prop;
+  Ptr<AquaSimPositionSnapshot> m_snapshot;
+  bool m_checked;
+};
+
+AquaSimPositionSnapshotKnownTestCase::AquaSimPositionSnapshotKnownTestCase ()
+  : TestCase ("Snapshot holds hand-computed positions"),
+    m_checked (false)
+{
+}
+
+void
+AquaSimPositionSnapshotKnownTestCase::Check (void)
+{
+  m_snapshot->Update (m_devices);
+  Ptr<MobilityModel> a = m_nodes.Get (0)->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> b = m_nodes.Get (1)->GetObject<MobilityModel> ();
+  Vector pos;
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetPosition (PeekPointer (a), pos), true, "moving node sampled");
+  NS_TEST_ASSERT_MSG_EQ_TOL (pos.x, 20, 1e-9, "x after 10 s at 2 m/s");
+  NS_TEST_ASSERT_MSG_EQ_TOL (pos.y, -10, 1e-9, "y after 10 s at -1 m/s");
+  NS_TEST_ASSERT_MSG_EQ_TOL (pos.z, -5, 1e-9, "z after 10 s at 0.5 m/s");
+  NS_TEST_ASSERT_MSG_EQ (m_snapshot->GetPosition (PeekPointer (b), pos), true, "static node sampled");
+  NS_TEST_ASSERT_MSG_EQ (pos.x, 30, "static x");
+  NS_TEST_ASSERT_MSG_EQ (pos.y, 40, "static y");
+  NS_TEST_ASSERT_MSG_EQ (pos.z, -10, "static z");
+
+  /* sqrt(10^2 + 50^2 + 5^2) m at the nominal 1500 m/s */
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_prop->PDelay (a, b).GetSeconds (), std::sqrt (2625.0) / 1500, 1e-9,
+                             "nominal delay from snapshot positions");
+  m_checked = true;
+}
+
+void
+AquaSimPositionSnapshotKnownTestCase::DoRun (void)
+{
+  m_nodes.Create (2);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (m_nodes.Get (0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (m_nodes.Get (1));
+  Ptr<ConstantVelocityMobilityModel> cv = m_nodes.Get (0)->GetObject<ConstantVelocityMobilityModel> ();
+  cv->SetPosition (Vector (0, 0, -10));
+  cv->SetVelocity (Vector (2, -1, 0.5));
+  m_nodes.Get (1)->GetObject<MobilityModel> ()->SetPosition (Vector (30, 40, -10));
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      dev->SetNode (m_nodes.Get (i));
+      m_devices.push_back (dev);
+    }
+  m_prop = CreateObject<AquaSimRangePropagation> ();
+  m_snapshot = CreateObject<AquaSimPositionSnapshot> ();
+  m_prop->SetPositionSnapshot (m_snapshot);
+
+  Simulator::Schedule (Seconds (10), &AquaSimPositionSnapshotKnownTestCase::Check, this);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_checked, true, "check did not run");
+
+  m_snapshot->Dispose ();
+  m_devices.clear ();
+  Simulator::Destroy ();
+}
+
+class AquaSimPositionSnapshotTestSuite : public TestSuite
+{
+public:
+  AquaSimPositionSnapshotTestSuite ();
+};
+
+AquaSimPositionSnapshotTestSuite::AquaSimPositionSnapshotTestSuite ()
+  : TestSuite ("aqua-sim-position-snapshot", UNIT)
+{
+  AddTestCase (new AquaSimPositionSnapshotTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimPositionSnapshotKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimPositionSnapshotTestSuite aquaSimPositionSnapshotTestSuite;
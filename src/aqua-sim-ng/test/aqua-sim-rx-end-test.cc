@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/mobility-helper.h"
+
+#include "ns3/aqua-sim-helper.h"
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-phy-cmn.h"
+#include "ns3/aqua-sim-propagation.h"
+
+using namespace ns3;
+
+/**
+ * A unicast between two static nodes must fire "RxEnd" on the receiver with
+ * the sender position and the link's propagation delay.
+ */
+class AquaSimRxEndTestCase : public TestCase
+{
+public:
+  AquaSimRxEndTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void RxEnd (Ptr<const Packet> p, double rssi, Vector senderPos, Time propDelay);
+
+  uint32_t m_received;
+  double m_rssi;
+  Vector m_senderPos;
+  Time m_propDelay;
+};
+
+AquaSimRxEndTestCase::AquaSimRxEndTestCase ()
+  : TestCase ("RxEnd reports received power, sender position and propagation delay"),
+    m_received (0),
+    m_rssi (0)
+{
+}
+
+void
+AquaSimRxEndTestCase::RxEnd (Ptr<const Packet> p, double rssi, Vector senderPos, Time propDelay)
+{
+  m_received++;
+  m_rssi = rssi;
+  m_senderPos = senderPos;
+  m_propDelay = propDelay;
+}
+
+void
+AquaSimRxEndTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  AquaSimChannelHelper channel = AquaSimChannelHelper::Default ();
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channel.Create ());
+  asHelper.SetMac ("ns3::AquaSimBroadcastMac");
+  asHelper.SetRouting ("ns3::AquaSimRoutingDummy");
+
+  Ptr<ListPositionAllocator> position = CreateObject<ListPositionAllocator> ();
+  position->Add (Vector (0, 0, 0));
+  position->Add (Vector (300, 0, 0));
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (position);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  Ptr<AquaSimNetDevice> sender = CreateObject<AquaSimNetDevice> ();
+  Ptr<AquaSimNetDevice> recver = CreateObject<AquaSimNetDevice> ();
+  asHelper.Create (nodes.Get (0), sender);
+  asHelper.Create (nodes.Get (1), recver);
+
+  bool connected = recver->GetPhy ()->TraceConnectWithoutContext ("RxEnd",
+      MakeCallback (&AquaSimRxEndTestCase::RxEnd, this));
+  NS_TEST_ASSERT_MSG_EQ (connected, true, "AquaSimPhyCmn has no RxEnd trace source");
+
+  Simulator::Schedule (Seconds (1), &AquaSimNetDevice::Send, sender,
+                       Create<Packet> (40), recver->GetAddress (), 0);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, 1, "expected exactly one reception");
+  NS_TEST_ASSERT_MSG_GT (m_rssi, 0, "received power not reported");
+  NS_TEST_ASSERT_MSG_EQ (m_senderPos.x, 0, "wrong sender position");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_propDelay.GetSeconds (), 300 / SOUND_SPEED_IN_WATER, 1e-9,
+                             "wrong propagation delay");
+
+  Simulator::Destroy ();
+}
+
+class AquaSimRxEndTestSuite : public TestSuite
+{
+public:
+  AquaSimRxEndTestSuite ();
+};
+
+AquaSimRxEndTestSuite::AquaSimRxEndTestSuite ()
+  : TestSuite ("aqua-sim-rx-end", UNIT)
+{
+  AddTestCase (new AquaSimRxEndTestCase, TestCase::QUICK);
+}
+
+static AquaSimRxEndTestSuite aquaSimRxEndTestSuite;
@@ -0,0 +1,359 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/constant-position-mobility-model.h"
+
+#include "ns3/aqua-sim-helper.h"
+#include "ns3/aqua-sim-channel.h"
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-phy.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-header-mac.h"
+#include "ns3/aqua-sim-ladder-scheduler.h"
+#include "ns3/aqua-sim-adaptive-scheduler.h"
+#include "ns3/aqua-sim-recording-scheduler.h"
+
+#include <map>
+#include <tuple>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Random scheduler workload applied to \p test and a MapScheduler alike:
+ * bursts of receptions at one delay, scattered timers, far-future events
+ * and removals of pending events. Returns false at the first difference.
+ */
+bool
+SameOrder (Ptr<Scheduler> test, uint32_t steps, bool removals)
+{
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (7);
+  std::map<uint32_t, Scheduler::Event> pending;   //by uid
+  uint32_t uid = 0;
+  uint64_t now = 0;
+
+  for (uint32_t step = 0; step < steps; step++)
+    {
+      uint32_t burst = rand->GetInteger (0, 3) == 0 ? rand->GetInteger (20, 200) : 1;
+      uint64_t delay = rand->GetInteger (0, 1) ? 32000000 : rand->GetInteger (0, 2000000000);
+      if (rand->GetInteger (0, 50) == 0)
+        delay = 1000000000000000ULL + rand->GetInteger (0, 1000000);
+      for (uint32_t b = 0; b < burst; b++)
+        {
+          Scheduler::Event ev;
+          ev.impl = nullptr;
+          ev.key.m_ts = now + delay + (b % 3);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          reference->Insert (ev);
+          test->Insert (ev);
+          pending[ev.key.m_uid] = ev;
+        }
+      if (removals && !pending.empty () && rand->GetInteger (0, 3) == 0)
+        {
+          std::map<uint32_t, Scheduler::Event>::iterator victim =
+              pending.lower_bound (rand->GetInteger (0, uid - 1));
+          if (victim == pending.end ())
+            victim = pending.begin ();
+          reference->Remove (victim->second);
+          test->Remove (victim->second);
+          pending.erase (victim);
+        }
+      for (uint32_t pops = rand->GetInteger (0, burst + 1); pops > 0 && !reference->IsEmpty (); pops--)
+        {
+          if (test->IsEmpty () || test->PeekNext ().key.m_uid != reference->PeekNext ().key.m_uid)
+            return false;
+          Scheduler::Event next = reference->RemoveNext ();
+          if (test->RemoveNext ().key.m_uid != next.key.m_uid)
+            return false;
+          pending.erase (next.key.m_uid);
+          now = next.key.m_ts;
+        }
+    }
+  while (!reference->IsEmpty ())
+    {
+      if (test->IsEmpty () || test->RemoveNext ().key.m_uid != reference->RemoveNext ().key.m_uid)
+        return false;
+    }
+  return test->IsEmpty ();
+}
+
+/// (time, receiver, received power) of one delivered packet.
+typedef std::tuple<int64_t, uint32_t, double> Reception;
+
+void
+Received (std::vector<Reception> *log, uint32_t node, Ptr<const Packet> p, double pr,
+          Vector sender, Time delay)
+{
+  log->push_back (std::make_tuple (Simulator::Now ().GetTimeStep (), node, pr));
+}
+
+void
+Transmit (Ptr<AquaSimChannel> channel, Ptr<AquaSimNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (40);
+  MacHeader mach;
+  AquaSimHeader ash;
+  ash.SetSize (40);
+  ash.SetDirection (AquaSimHeader::DOWN);
+  AquaSimPacketStamp pstamp;
+  pstamp.SetPt (dev->GetPhy ()->GetPt ());
+  pstamp.SetFreq (dev->GetPhy ()->GetFrequency ());
+  pstamp.SetTxRange (250);
+  p->AddHeader (mach);
+  p->AddHeader (ash);
+  p->AddHeader (pstamp);
+  channel->Recv (p, dev->GetPhy ());
+}
+
+/// A broadcasting 8 x 8 grid run with event list \p scheduler.
+std::vector<Reception>
+RunGrid (const std::string &scheduler)
+{
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SchedulerType", StringValue (scheduler));
+
+  const uint32_t side = 8;
+  NodeContainer nodes;
+  nodes.Create (side * side);
+  AquaSimChannelHelper channelHelper = AquaSimChannelHelper::Default ();
+  channelHelper.SetPropagation ("ns3::AquaSimRangePropagation");
+  AquaSimHelper asHelper = AquaSimHelper::Default ();
+  asHelper.SetChannel (channelHelper.Create ());
+  Ptr<AquaSimChannel> channel = asHelper.GetChannel ();
+
+  std::vector<Reception> log;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (100.0 * (i % side), 100.0 * (i / side), 0));
+      node->AggregateObject (mobility);
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      asHelper.Create (node, dev);
+      dev->MacEnabled (false);
+      dev->GetPhy ()->TraceConnectWithoutContext ("RxEnd", MakeBoundCallback (&Received, &log, i));
+      for (uint32_t k = 0; k < 5; k++)
+        Simulator::Schedule (MilliSeconds (137 * i + 20011 * k), &Transmit, channel, dev);
+    }
+  Simulator::Stop (Seconds (200));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SchedulerType", StringValue ("ns3::MapScheduler"));
+  return log;
+}
+
+}  // namespace
+
+/**
+ * The ladder queue must hand events back in exactly the (time stamp, uid)
+ * order of MapScheduler, through rung spawns and removals.
+ */
+class AquaSimLadderSchedulerOrderTestCase : public TestCase
+{
+public:
+  AquaSimLadderSchedulerOrderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimLadderSchedulerOrderTestCase::AquaSimLadderSchedulerOrderTestCase ()
+  : TestCase ("Ladder scheduler keeps the MapScheduler order")
+{
+}
+
+void
+AquaSimLadderSchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<AquaSimLadderScheduler> ladder = CreateObject<AquaSimLadderScheduler> ();
+  NS_TEST_ASSERT_MSG_EQ (SameOrder (ladder, 20000, false), true, "order differs");
+  NS_TEST_ASSERT_MSG_GT (ladder->GetSpawnCount (), 10, "workload never built a rung");
+
+  ladder = CreateObject<AquaSimLadderScheduler> ();
+  NS_TEST_ASSERT_MSG_EQ (SameOrder (ladder, 20000, true), true, "order differs with removals");
+}
+
+/**
+ * A fixed event list with its pop order written out: earlier time stamps
+ * first, uid order on ties, a far-future event last, a removed one never.
+ */
+class AquaSimSchedulerKnownOrderTestCase : public TestCase
+{
+public:
+  AquaSimSchedulerKnownOrderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimSchedulerKnownOrderTestCase::AquaSimSchedulerKnownOrderTestCase ()
+  : TestCase ("Schedulers pop a fixed event list in the expected order")
+{
+}
+
+void
+AquaSimSchedulerKnownOrderTestCase::DoRun (void)
+{
+  const uint64_t ts[] = {5, 3, 5, 1, 3, 1000000000000ULL, 1};
+  const uint32_t expect[] = {3, 6, 1, 4, 0, 5};
+  Ptr<Scheduler> schedulers[] = {CreateObject<AquaSimLadderScheduler> (),
+                                 CreateObject<AquaSimAdaptiveScheduler> ()};
+  for (Ptr<Scheduler> sched : schedulers)
+    {
+      Scheduler::Event removed;
+      for (uint32_t uid = 0; uid < 7; uid++)
+        {
+          Scheduler::Event ev;
+          ev.impl = nullptr;
+          ev.key.m_ts = ts[uid];
+          ev.key.m_uid = uid;
+          ev.key.m_context = 0;
+          sched->Insert (ev);
+          if (uid == 2)
+            removed = ev;
+        }
+      sched->Remove (removed);
+      for (uint32_t i = 0; i < 6; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (sched->IsEmpty (), false, "ran out at pop " << i);
+          NS_TEST_ASSERT_MSG_EQ (sched->PeekNext ().key.m_uid, expect[i], "peek " << i);
+          NS_TEST_ASSERT_MSG_EQ (sched->RemoveNext ().key.m_uid, expect[i], "pop " << i);
+        }
+      NS_TEST_ASSERT_MSG_EQ (sched->IsEmpty (), true, "removed event popped");
+    }
+}
+
+/**
+ * Simulations must not change with the event list: a grid delivers the
+ * same receptions on MapScheduler, the ladder queue, the adaptive
+ * scheduler and the recorder, whose trace must pair every insert with its
+ * removal.
+ */
+class AquaSimSchedulerSimulationTestCase : public TestCase
+{
+public:
+  AquaSimSchedulerSimulationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimSchedulerSimulationTestCase::AquaSimSchedulerSimulationTestCase ()
+  : TestCase ("Simulations are identical on every scheduler and record a complete trace")
+{
+}
+
+void
+AquaSimSchedulerSimulationTestCase::DoRun (void)
+{
+  std::vector<Reception> reference = RunGrid ("ns3::MapScheduler");
+  NS_TEST_ASSERT_MSG_GT (reference.size (), 1000, "grid delivers too little");
+  bool same = RunGrid ("ns3::AquaSimLadderScheduler") == reference;
+  NS_TEST_ASSERT_MSG_EQ (same, true, "ladder scheduler changed the receptions");
+
+  Config::SetDefault ("ns3::AquaSimAdaptiveScheduler::Observe", UintegerValue (500));
+  same = RunGrid ("ns3::AquaSimAdaptiveScheduler") == reference;
+  Config::SetDefault ("ns3::AquaSimAdaptiveScheduler::Observe", UintegerValue (10000));
+  NS_TEST_ASSERT_MSG_EQ (same, true, "adaptive scheduler changed the receptions");
+
+  std::string trace = CreateTempDirFilename ("events.bin");
+  Config::SetDefault ("ns3::AquaSimRecordingScheduler::File", StringValue (trace));
+  Config::SetDefault ("ns3::AquaSimRecordingScheduler::Scheduler",
+                      StringValue ("ns3::AquaSimLadderScheduler"));
+  same = RunGrid ("ns3::AquaSimRecordingScheduler") == reference;
+  NS_TEST_ASSERT_MSG_EQ (same, true, "recording scheduler changed the receptions");
+
+  std::vector<AquaSimRecordingScheduler::Record> ops = AquaSimRecordingScheduler::Load (trace);
+  int64_t queued = 0;
+  for (const AquaSimRecordingScheduler::Record &op : ops)
+    {
+      queued += (op.op == AquaSimRecordingScheduler::INSERT) ? 1 : -1;
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (queued, 0, "removal before insert");
+    }
+  NS_TEST_ASSERT_MSG_GT (ops.size (), 2 * reference.size (), "trace too short");
+  NS_TEST_ASSERT_MSG_EQ (queued, 0, "events left in the trace");
+}
+
+/**
+ * The adaptive scheduler keeps a remove-heavy long queue on MapScheduler,
+ * moves everything else to the ladder queue, and loses no event either way.
+ */
+class AquaSimAdaptiveSchedulerTestCase : public TestCase
+{
+public:
+  AquaSimAdaptiveSchedulerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimAdaptiveSchedulerTestCase::AquaSimAdaptiveSchedulerTestCase ()
+  : TestCase ("Adaptive scheduler chooses from queue statistics")
+{
+}
+
+void
+AquaSimAdaptiveSchedulerTestCase::DoRun (void)
+{
+  Ptr<AquaSimAdaptiveScheduler> adaptive = CreateObject<AquaSimAdaptiveScheduler> ();
+  adaptive->SetAttribute ("Observe", UintegerValue (2000));
+  NS_TEST_ASSERT_MSG_EQ (SameOrder (adaptive, 20000, false), true, "order differs");
+  NS_TEST_ASSERT_MSG_EQ (adaptive->GetChoice (), "ns3::AquaSimLadderScheduler", "choice");
+  NS_TEST_ASSERT_MSG_EQ (adaptive->GetRemoveShare (), 0, "removals counted");
+
+  adaptive = CreateObject<AquaSimAdaptiveScheduler> ();
+  adaptive->SetAttribute ("Observe", UintegerValue (2000));
+  adaptive->SetAttribute ("LargeQueue", DoubleValue (10));
+  adaptive->SetAttribute ("RemoveShare", DoubleValue (0.001));
+  NS_TEST_ASSERT_MSG_EQ (SameOrder (adaptive, 20000, true), true, "order differs with removals");
+  NS_TEST_ASSERT_MSG_EQ (adaptive->GetChoice (), "ns3::MapScheduler", "choice with removals");
+  NS_TEST_ASSERT_MSG_GT (adaptive->GetMeanQueue (), 10, "mean queue");
+  NS_TEST_ASSERT_MSG_GT (adaptive->GetRemoveShare (), 0.001, "removal share");
+}
+
+class AquaSimSchedulerTestSuite : public TestSuite
+{
+public:
+  AquaSimSchedulerTestSuite ();
+};
+
+AquaSimSchedulerTestSuite::AquaSimSchedulerTestSuite ()
+  : TestSuite ("aqua-sim-scheduler", UNIT)
+{
+  AddTestCase (new AquaSimLadderSchedulerOrderTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimSchedulerKnownOrderTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimSchedulerSimulationTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimAdaptiveSchedulerTestCase, TestCase::QUICK);
+}
+
+static AquaSimSchedulerTestSuite aquaSimSchedulerTestSuite;
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-phy-cmn.h"
+#include "ns3/aqua-sim-signal-cache.h"
+#include "ns3/aqua-sim-sinr-checker.h"
+#include "ns3/aqua-sim-noise-generator.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-header-mac.h"
+#include "ns3/aqua-sim-rx-info-tag.h"
+
+#include <set>
+
+using namespace ns3;
+
+/**
+ * Feed a dense, random burst of overlapping receptions into
+ * AquaSimSinrSignalCache and compare the delivered packets with a
+ * brute-force evaluation: a packet survives iff at every arrival during its
+ * reception its power over (all other active powers + noise) passes the
+ * threshold.
+ */
+class AquaSimSinrSignalCacheTestCase : public TestCase
+{
+public:
+  AquaSimSinrSignalCacheTestCase ();
+
+private:
+  struct Signal {
+    Time start;
+    Time end;
+    double pr;
+    bool error;
+    uint64_t uid;
+  };
+
+  virtual void DoRun (void);
+  void Delivered (Ptr<Packet> p, double noise);
+
+  std::set<uint64_t> m_delivered;
+};
+
+AquaSimSinrSignalCacheTestCase::AquaSimSinrSignalCacheTestCase ()
+  : TestCase ("SINR signal cache matches brute-force collision outcomes")
+{
+}
+
+void
+AquaSimSinrSignalCacheTestCase::Delivered (Ptr<Packet> p, double noise)
+{
+  m_delivered.insert (p->GetUid ());
+}
+
+void
+AquaSimSinrSignalCacheTestCase::DoRun (void)
+{
+  const double noise = 0.5;
+  const double threshold = 1.0;
+  const uint32_t sizes[] = {20, 40, 80};
+
+  RngSeedManager::SetSeed (5);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+  dev->SetNode (node);
+  dev->MacEnabled (false);
+  Ptr<AquaSimPhyCmn> phy = CreateObject<AquaSimPhyCmn> ();
+  dev->SetPhy (phy);
+  Ptr<AquaSimThresholdSinrChecker> sinr = CreateObject<AquaSimThresholdSinrChecker> ();
+  sinr->SetAttribute ("DecodeableThresh", DoubleValue (threshold));
+  phy->SetSinrChecker (sinr);
+  Ptr<AquaSimSinrSignalCache> cache = CreateObject<AquaSimSinrSignalCache> ();
+  phy->SetSignalCache (cache);
+  Ptr<AquaSimConstNoiseGen> noiseGen = CreateObject<AquaSimConstNoiseGen> ();
+  noiseGen->SetNoise (noise);
+  cache->SetNoiseGen (noiseGen);
+  phy->TraceConnectWithoutContext ("Rx", MakeCallback (&AquaSimSinrSignalCacheTestCase::Delivered, this));
+
+  std::vector<Signal> signals;
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      uint32_t size = sizes[rand->GetInteger (0, 2)];
+      Signal s;
+      s.start = MicroSeconds (rand->GetInteger (1, 40000000));
+      s.end = s.start + Seconds (phy->Modulation (NULL)->TxTime (size * 8));
+      s.pr = rand->GetValue (1, 20);
+      s.error = rand->GetValue () < 0.1;
+
+      Ptr<Packet> p = Create<Packet> (size);
+      s.uid = p->GetUid ();
+      MacHeader mach;
+      AquaSimHeader ash;
+      ash.SetSize (size);
+      ash.SetDirection (AquaSimHeader::UP);
+      ash.SetErrorFlag (s.error);
+      AquaSimRxInfoTag rxInfo;
+      rxInfo.SetPr (s.pr);
+      p->AddHeader (mach);
+      p->AddHeader (ash);
+      p->AddPacketTag (rxInfo);
+      Simulator::Schedule (s.start, &AquaSimSignalCache::AddNewPacket, cache, p);
+      signals.push_back (s);
+    }
+  Simulator::Stop (Seconds (50));
+  Simulator::Run ();
+
+  uint32_t expectedOk = 0, expectedLost = 0;
+  for (uint32_t i = 0; i < signals.size (); i++)
+    {
+      const Signal &s = signals[i];
+      bool ok = !s.error;
+      for (uint32_t j = 0; ok && j < signals.size (); j++)
+        {
+          Time t = signals[j].start;
+          if (t < s.start || t >= s.end)
+            continue;
+          double interference = 0;
+          for (uint32_t k = 0; k < signals.size (); k++)
+            {
+              if (k != i && signals[k].start <= t && t < signals[k].end)
+                interference += signals[k].pr;
+            }
+          ok = s.pr / (interference + noise) > threshold;
+        }
+      ok ? expectedOk++ : expectedLost++;
+      bool delivered = m_delivered.count (s.uid) == 1;
+      NS_TEST_ASSERT_MSG_EQ (delivered, ok,
+                             "collision outcome differs for signal " << i);
+    }
+  NS_TEST_ASSERT_MSG_GT (expectedOk, 0, "scenario delivers nothing");
+  NS_TEST_ASSERT_MSG_GT (expectedLost, 40, "scenario has too few collisions");
+  NS_TEST_ASSERT_MSG_EQ (cache->m_pktNum, 0, "receptions left in the cache");
+
+  dev->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Four receptions with their outcome worked out by hand (noise 0.5,
+ * threshold 1): A (10) survives B (4) arriving mid-reception, 10/4.5;
+ * B does not, 4/10.5; C (0.8) alone passes, 1.6; D (0.4) alone fails, 0.8.
+ */
+class AquaSimSinrSignalCacheKnownTestCase : public TestCase
+{
+public:
+  AquaSimSinrSignalCacheKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Delivered (Ptr<Packet> p, double noise);
+
+  std::set<uint64_t> m_delivered;
+};
+
+AquaSimSinrSignalCacheKnownTestCase::AquaSimSinrSignalCacheKnownTestCase ()
+  : TestCase ("SINR signal cache on fixed receptions")
+{
+}
+
+void
+AquaSimSinrSignalCacheKnownTestCase::Delivered (Ptr<Packet> p, double noise)
+{
+  m_delivered.insert (p->GetUid ());
+}
+
+void
+AquaSimSinrSignalCacheKnownTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+  dev->SetNode (node);
+  dev->MacEnabled (false);
+  Ptr<AquaSimPhyCmn> phy = CreateObject<AquaSimPhyCmn> ();
+  dev->SetPhy (phy);
+  Ptr<AquaSimThresholdSinrChecker> sinr = CreateObject<AquaSimThresholdSinrChecker> ();
+  sinr->SetAttribute ("DecodeableThresh", DoubleValue (1.0));
+  phy->SetSinrChecker (sinr);
+  Ptr<AquaSimSinrSignalCache> cache = CreateObject<AquaSimSinrSignalCache> ();
+  phy->SetSignalCache (cache);
+  Ptr<AquaSimConstNoiseGen> noiseGen = CreateObject<AquaSimConstNoiseGen> ();
+  noiseGen->SetNoise (0.5);
+  cache->SetNoiseGen (noiseGen);
+  phy->TraceConnectWithoutContext ("Rx", MakeCallback (&AquaSimSinrSignalCacheKnownTestCase::Delivered, this));
+
+  const uint32_t size = 80;
+  Time txTime = Seconds (phy->Modulation (NULL)->TxTime (size * 8));
+  const Time starts[] = {Seconds (1), Seconds (1) + txTime / 2, Seconds (20), Seconds (30)};
+  const double prs[] = {10, 4, 0.8, 0.4};
+  const bool expect[] = {true, false, true, false};
+  uint64_t uids[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (size);
+      uids[i] = p->GetUid ();
+      MacHeader mach;
+      AquaSimHeader ash;
+      ash.SetSize (size);
+      ash.SetDirection (AquaSimHeader::UP);
+      AquaSimRxInfoTag rxInfo;
+      rxInfo.SetPr (prs[i]);
+      p->AddHeader (mach);
+      p->AddHeader (ash);
+      p->AddPacketTag (rxInfo);
+      Simulator::Schedule (starts[i], &AquaSimSignalCache::AddNewPacket, cache, p);
+    }
+  Simulator::Stop (Seconds (50));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < 4; i++)
+    NS_TEST_ASSERT_MSG_EQ ((m_delivered.count (uids[i]) == 1), expect[i], "outcome of reception " << i);
+  NS_TEST_ASSERT_MSG_EQ (cache->m_pktNum, 0, "receptions left in the cache");
+
+  dev->Dispose ();
+  Simulator::Destroy ();
+}
+
+class AquaSimSignalCacheTestSuite : public TestSuite
+{
+public:
+  AquaSimSignalCacheTestSuite ();
+};
+
+AquaSimSignalCacheTestSuite::AquaSimSignalCacheTestSuite ()
+  : TestSuite ("aqua-sim-signal-cache", UNIT)
+{
+  AddTestCase (new AquaSimSinrSignalCacheTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimSinrSignalCacheKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimSignalCacheTestSuite aquaSimSignalCacheTestSuite;
@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+
+#include "ns3/aqua-sim-net-device.h"
+#include "ns3/aqua-sim-header.h"
+#include "ns3/aqua-sim-range-propagation.h"
+#include "ns3/aqua-sim-spatial-index.h"
+
+using namespace ns3;
+
+/**
+ * Receivers found through the grid must match a full scan of the device
+ * list, entry by entry, while nodes move and change course.
+ */
+class AquaSimSpatialIndexTestCase : public TestCase
+{
+public:
+  AquaSimSpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Compare (void);
+  void Turn (Ptr<ConstantVelocityMobilityModel> model);
+
+  std::vector<Ptr<AquaSimNetDevice> > m_devices;
+  Ptr<AquaSimRangePropagation> m_prop;
+  Ptr<AquaSimSpatialIndex> m_index;
+  Ptr<UniformRandomVariable> m_rand;
+  double m_range;
+  uint32_t m_checked;
+};
+
+AquaSimSpatialIndexTestCase::AquaSimSpatialIndexTestCase ()
+  : TestCase ("Spatial index candidates match brute-force ReceivedCopies"),
+    m_range (300),
+    m_checked (0)
+{
+}
+
+void
+AquaSimSpatialIndexTestCase::Turn (Ptr<ConstantVelocityMobilityModel> model)
+{
+  model->SetVelocity (Vector (m_rand->GetValue (-5, 5), m_rand->GetValue (-5, 5),
+                              m_rand->GetValue (-1, 1)));
+}
+
+void
+AquaSimSpatialIndexTestCase::Compare (void)
+{
+  std::vector<Ptr<AquaSimNetDevice> > candidates;
+  std::vector<PktRecvUnit> full, fast;
+  for (uint32_t s = 0; s < m_devices.size (); s += 7)
+    {
+      AquaSimPacketStamp pstamp;
+      pstamp.SetTxRange (m_range);
+      pstamp.SetPt (20);
+      pstamp.SetFreq (25);
+      Ptr<Packet> p = Create<Packet> (32);
+      p->AddHeader (pstamp);
+
+      Vector pos = m_devices[s]->GetNode ()->GetObject<MobilityModel> ()->GetPosition ();
+      m_index->GetCandidates (pos, m_range, m_devices, candidates);
+
+      m_prop->ReceivedCopies (m_devices[s], p, m_devices, full);
+      m_prop->ReceivedCopies (m_devices[s], p, candidates, fast);
+
+      NS_TEST_ASSERT_MSG_EQ (fast.size (), full.size (), "receiver count differs");
+      for (uint32_t i = 0; i < full.size () && i < fast.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (fast[i].recver, full[i].recver, "receiver order differs");
+          NS_TEST_ASSERT_MSG_EQ (fast[i].pDelay, full[i].pDelay, "delay differs");
+          NS_TEST_ASSERT_MSG_EQ (fast[i].pR, full[i].pR, "received power differs");
+        }
+      m_checked += full.size ();
+    }
+}
+
+void
+AquaSimSpatialIndexTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (3);
+  RngSeedManager::SetRun (7);
+  m_rand = CreateObject<UniformRandomVariable> ();
+  m_prop = CreateObject<AquaSimRangePropagation> ();
+  m_index = CreateObject<AquaSimSpatialIndex> ();
+
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Vector pos (m_rand->GetValue (0, 2000), m_rand->GetValue (0, 2000), m_rand->GetValue (0, 500));
+      if (i % 2)
+        {
+          Ptr<ConstantVelocityMobilityModel> cv = CreateObject<ConstantVelocityMobilityModel> ();
+          cv->SetPosition (pos);
+          Turn (cv);
+          node->AggregateObject (cv);
+          for (double t = 10; t < 200; t += 37)
+            Simulator::Schedule (Seconds (t + i * 0.01), &AquaSimSpatialIndexTestCase::Turn, this, cv);
+        }
+      else
+        {
+          Ptr<ConstantPositionMobilityModel> cp = CreateObject<ConstantPositionMobilityModel> ();
+          cp->SetPosition (pos);
+          node->AggregateObject (cp);
+        }
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      dev->SetNode (node);
+      m_devices.push_back (dev);
+    }
+
+  for (double t = 0; t < 200; t += 4.5)
+    Simulator::Schedule (Seconds (t), &AquaSimSpatialIndexTestCase::Compare, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_checked, 0, "no receivers were compared");
+  NS_TEST_ASSERT_MSG_GT (m_index->GetRebuildCount (), 1, "drift never forced a rebuild");
+
+  m_index->Dispose ();
+  m_devices.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Static nodes on a 100 m grid with the candidate set worked out by hand
+ * for a 100 m query at the origin: padding makes it span cells -2..1 on
+ * each axis, which hold nodes 0, 1, 2 and 5; node 2 is a candidate but
+ * out of range. Eighty distant nodes keep that 4x4x4 box smaller than the
+ * occupied grid.
+ */
+class AquaSimSpatialIndexKnownTestCase : public TestCase
+{
+public:
+  AquaSimSpatialIndexKnownTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimSpatialIndexKnownTestCase::AquaSimSpatialIndexKnownTestCase ()
+  : TestCase ("Spatial index returns the expected cells for a fixed layout")
+{
+}
+
+void
+AquaSimSpatialIndexKnownTestCase::DoRun (void)
+{
+  std::vector<Vector> positions;
+  positions.push_back (Vector (0, 0, 0));
+  positions.push_back (Vector (60, 0, 0));
+  positions.push_back (Vector (190, 0, 0));
+  positions.push_back (Vector (210, 0, 0));
+  positions.push_back (Vector (0, -250, 0));
+  positions.push_back (Vector (-50, -50, -50));
+  for (uint32_t i = 0; i < 80; i++)
+    positions.push_back (Vector (2000 + 200 * i, 2000, 0));
+
+  std::vector<Ptr<AquaSimNetDevice> > devices;
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<ConstantPositionMobilityModel> cp = CreateObject<ConstantPositionMobilityModel> ();
+      cp->SetPosition (positions[i]);
+      node->AggregateObject (cp);
+      Ptr<AquaSimNetDevice> dev = CreateObject<AquaSimNetDevice> ();
+      dev->SetNode (node);
+      devices.push_back (dev);
+    }
+
+  Ptr<AquaSimSpatialIndex> index = CreateObject<AquaSimSpatialIndex> ();
+  index->SetAttribute ("CellSize", DoubleValue (100));
+  std::vector<Ptr<AquaSimNetDevice> > candidates;
+  index->GetCandidates (positions[0], 100, devices, candidates);
+  const uint32_t expect[] = {0, 1, 2, 5};
+  NS_TEST_ASSERT_MSG_EQ (candidates.size (), 4, "candidate count");
+  for (uint32_t i = 0; i < 4 && i < candidates.size (); i++)
+    NS_TEST_ASSERT_MSG_EQ (candidates[i], devices[expect[i]], "candidate " << i);
+
+  AquaSimPacketStamp pstamp;
+  pstamp.SetTxRange (100);
+  pstamp.SetPt (20);
+  pstamp.SetFreq (25);
+  Ptr<Packet> p = Create<Packet> (32);
+  p->AddHeader (pstamp);
+  std::vector<PktRecvUnit> res;
+  Ptr<AquaSimRangePropagation> prop = CreateObject<AquaSimRangePropagation> ();
+  prop->ReceivedCopies (devices[0], p, candidates, res);
+  const uint32_t inRange[] = {0, 1, 5};
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 3, "receivers within 100 m");
+  for (uint32_t i = 0; i < 3 && i < res.size (); i++)
+    NS_TEST_ASSERT_MSG_EQ (res[i].recver, devices[inRange[i]], "receiver " << i);
+
+  index->Dispose ();
+  devices.clear ();
+  Simulator::Destroy ();
+}
+
+class AquaSimSpatialIndexTestSuite : public TestSuite
+{
+public:
+  AquaSimSpatialIndexTestSuite ();
+};
+
+AquaSimSpatialIndexTestSuite::AquaSimSpatialIndexTestSuite ()
+  : TestSuite ("aqua-sim-spatial-index", UNIT)
+{
+  AddTestCase (new AquaSimSpatialIndexTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimSpatialIndexKnownTestCase, TestCase::QUICK);
+}
+
+static AquaSimSpatialIndexTestSuite aquaSimSpatialIndexTestSuite;
@@ -1,7 +1,7 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 // Include a header file from your module to test.
-#include "ns3/aqua-sim.h"
+#include "ns3/aqua-sim-ng-module.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
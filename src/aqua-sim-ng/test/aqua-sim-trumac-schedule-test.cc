@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 University of Connecticut
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include "ns3/aqua-sim-trumac-schedule.h"
+
+using namespace ns3;
+
+/**
+ * The nearest-neighbor pass must build the tour the old map scan built from
+ * the same start, and 2-opt must only shorten it: on points in convex
+ * position it has to reach the hull order, which is optimal.
+ */
+class AquaSimTrumacTourTestCase : public TestCase
+{
+public:
+  AquaSimTrumacTourTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimTrumacTourTestCase::AquaSimTrumacTourTestCase ()
+  : TestCase ("TR-MAC nearest-neighbor and 2-opt tours")
+{
+}
+
+void
+AquaSimTrumacTourTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (11);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  for (uint32_t round = 0; round < 5; round++)
+    {
+      uint32_t n = 20 + 30 * round;
+      std::vector<Vector> pos;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          /* coarse grid so that equal distances are common */
+          pos.push_back (Vector (rand->GetInteger (0, 20) * 50, rand->GetInteger (0, 20) * 50,
+                                 rand->GetInteger (0, 5) * 50));
+        }
+      std::vector<double> dist = AquaSimTrumacSchedule::DistanceMatrix (pos);
+
+      /* the old greedy construction: cheapest unvisited node, lowest ID on ties */
+      uint32_t start = rand->GetInteger (0, n - 1);
+      std::vector<uint32_t> ref (1, start);
+      std::vector<bool> visited (n, false);
+      visited[start] = true;
+      while (ref.size () < n)
+        {
+          uint32_t cur = ref.back (), best = n;
+          for (uint32_t j = 0; j < n; j++)
+            {
+              if (!visited[j] && (best == n || dist[cur * n + j] < dist[cur * n + best]))
+                best = j;
+            }
+          visited[best] = true;
+          ref.push_back (best);
+        }
+      std::vector<uint32_t> tour = AquaSimTrumacSchedule::NearestNeighborTour (dist, n, start);
+      bool same = tour == ref;
+      NS_TEST_ASSERT_MSG_EQ (same, true, "nearest-neighbor tour differs for " << n << " nodes");
+
+      double nnLength = AquaSimTrumacSchedule::TourLength (dist, tour);
+      AquaSimTrumacSchedule::TwoOpt (dist, tour, 100000000);
+      std::vector<uint32_t> sorted = tour;
+      std::sort (sorted.begin (), sorted.end ());
+      bool permutation = true;
+      for (uint32_t i = 0; i < n; i++)
+        permutation = permutation && sorted[i] == i;
+      NS_TEST_ASSERT_MSG_EQ (permutation, true, "2-opt tour is not a permutation");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (AquaSimTrumacSchedule::TourLength (dist, tour), nnLength,
+                                   "2-opt made the tour longer");
+    }
+
+  /* shuffled points on a circle */
+  const uint32_t n = 60;
+  const double r = 1000;
+  std::vector<uint32_t> order;
+  for (uint32_t i = 0; i < n; i++)
+    order.push_back (i);
+  for (uint32_t i = n - 1; i > 0; i--)
+    std::swap (order[i], order[rand->GetInteger (0, i)]);
+  std::vector<Vector> circle (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double a = 2 * M_PI * order[i] / n;
+      circle[i] = Vector (r * std::cos (a), r * std::sin (a), 0);
+    }
+  AquaSimTrumacSchedule s (circle, 100000000);
+  double perimeter = n * 2 * r * std::sin (M_PI / n);
+  NS_TEST_ASSERT_MSG_EQ_TOL (s.GetLength (), perimeter, 1e-6, "2-opt missed the hull order");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      /* neighbors on the circle follow each other, in one direction or the other */
+      uint32_t step = (order[s.GetNext (i)] + n - order[i]) % n;
+      NS_TEST_ASSERT_MSG_EQ ((step == 1 || step == n - 1), true, "successor is not adjacent");
+    }
+
+  /* a budget stops the refinement early */
+  AquaSimTrumacSchedule capped (circle, 10);
+  NS_TEST_ASSERT_MSG_EQ (capped.GetTwoOptMoves (), 10, "budget not honoured");
+}
+
+/**
+ * Nodes with the same view get the same schedule object; a different view
+ * or budget gets its own, and schedules go away with their last holder.
+ */
+class AquaSimTrumacShareTestCase : public TestCase
+{
+public:
+  AquaSimTrumacShareTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AquaSimTrumacShareTestCase::AquaSimTrumacShareTestCase ()
+  : TestCase ("TR-MAC schedules are shared across identical views")
+{
+}
+
+void
+AquaSimTrumacShareTestCase::DoRun (void)
+{
+  std::vector<Vector> pos;
+  for (uint32_t i = 0; i < 30; i++)
+    pos.push_back (Vector (i * 37 % 500, i * 91 % 700, i * 13 % 100));
+  std::vector<Vector> moved = pos;
+  moved[7].x += 1;
+
+  uint32_t before = AquaSimTrumacSchedule::GetNShared ();
+  {
+    std::shared_ptr<const AquaSimTrumacSchedule> a = AquaSimTrumacSchedule::Get (pos, 1000);
+    std::shared_ptr<const AquaSimTrumacSchedule> b = AquaSimTrumacSchedule::Get (pos, 1000);
+    std::shared_ptr<const AquaSimTrumacSchedule> c = AquaSimTrumacSchedule::Get (moved, 1000);
+    std::shared_ptr<const AquaSimTrumacSchedule> d = AquaSimTrumacSchedule::Get (pos, 0);
+    NS_TEST_ASSERT_MSG_EQ ((a == b), true, "identical views not shared");
+    NS_TEST_ASSERT_MSG_EQ ((a != c), true, "different views shared");
+    NS_TEST_ASSERT_MSG_EQ ((a != d), true, "different budgets shared");
+    NS_TEST_ASSERT_MSG_EQ (AquaSimTrumacSchedule::GetNShared (), before + 3, "wrong number of schedules");
+  }
+  NS_TEST_ASSERT_MSG_EQ (AquaSimTrumacSchedule::GetNShared (), before, "schedules outlive their holders");
+}
+
+class AquaSimTrumacScheduleTestSuite : public TestSuite
+{
+public:
+  AquaSimTrumacScheduleTestSuite ();
+};
+
+AquaSimTrumacScheduleTestSuite::AquaSimTrumacScheduleTestSuite ()
+  : TestSuite ("aqua-sim-trumac-schedule", UNIT)
+{
+  AddTestCase (new AquaSimTrumacTourTestCase, TestCase::QUICK);
+  AddTestCase (new AquaSimTrumacShareTestCase, TestCase::QUICK);
+}
+
+static AquaSimTrumacScheduleTestSuite aquaSimTrumacScheduleTestSuite;